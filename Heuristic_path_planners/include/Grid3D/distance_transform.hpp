@@ -0,0 +1,246 @@
+#ifndef __DISTANCE_TRANSFORM_HPP__
+#define __DISTANCE_TRANSFORM_HPP__
+
+/**
+ * @file distance_transform.hpp
+ * @brief Exact separable Euclidean distance transform (Felzenszwalb & Huttenlocher) from a
+ * point cloud to the cells of a regular grid.
+ *
+ * The occupied points do not need to lie on the grid lattice: each axis is processed over
+ * the sorted set of distinct point coordinates (octomap leaf centers) and evaluated on the
+ * grid coordinates. The squared distance is accumulated as dx*dx + dy*dy + dz*dz in float,
+ * in the same order used by the FLANN L2 distance, so the result is the same as a nearest
+ * neighbour search over the cloud.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+class DistanceTransform3d
+{
+public:
+
+	/**
+	 * @brief Computes the squared distance from every grid cell (ix*res, iy*res, iz*res) to the closest point.
+	 * Cells are stored as ix + iy*sizeX + iz*sizeX*sizeY. Returns false if there are no points.
+	 */
+	template<typename PointContainer>
+	static bool compute(const PointContainer &points, int sizeX, int sizeY, int sizeZ, float resolution,
+						std::vector<float> &sqDist, unsigned int numThreads = 0)
+	{
+		const float inf = std::numeric_limits<float>::infinity();
+		sqDist.assign(static_cast<size_t>(sizeX)*sizeY*sizeZ, inf);
+		if(points.size() == 0)
+			return false;
+
+		if(numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// Distinct coordinates of the points along each axis
+		std::vector<float> siteX, siteY, siteZ;
+		uniqueCoordinates(points, 0, siteX);
+		uniqueCoordinates(points, 1, siteY);
+		uniqueCoordinates(points, 2, siteZ);
+		const int nSy = siteY.size(), nSz = siteZ.size();
+
+		// Grid coordinates (computed as the kdtree query points)
+		std::vector<float> queryX(sizeX), queryY(sizeY), queryZ(sizeZ);
+		for(int i = 0; i < sizeX; i++)
+			queryX[i] = i*resolution;
+		for(int i = 0; i < sizeY; i++)
+			queryY[i] = i*resolution;
+		for(int i = 0; i < sizeZ; i++)
+			queryZ[i] = i*resolution;
+
+		// Occupied x-sites of every (y-site, z-site) row
+		std::vector<std::vector<int>> rows(static_cast<size_t>(nSy)*nSz);
+		for(const auto &p: points)
+		{
+			int jx = std::lower_bound(siteX.begin(), siteX.end(), p.x) - siteX.begin();
+			int jy = std::lower_bound(siteY.begin(), siteY.end(), p.y) - siteY.begin();
+			int jz = std::lower_bound(siteZ.begin(), siteZ.end(), p.z) - siteZ.begin();
+			rows[jy + static_cast<size_t>(jz)*nSy].push_back(jx);
+		}
+
+		// Passes 1 and 2, parallel over z-sites: slices[jz](qx, qy) = min over (x, y) sites of dx^2 + dy^2
+		std::vector<float> slices(static_cast<size_t>(sizeX)*sizeY*nSz, inf);
+		parallelFor(0, nSz, numThreads, [&](int jz)
+		{
+			std::vector<float> rowDist(static_cast<size_t>(sizeX)*nSy, inf);
+			std::vector<float> f(nSy), out(sizeY);
+			Envelope envelope(nSy);
+			bool any = false;
+
+			// 1 - Along x: distance to the closest site of the row
+			for(int jy = 0; jy < nSy; jy++)
+			{
+				std::vector<int> &row = rows[jy + static_cast<size_t>(jz)*nSy];
+				if(row.empty())
+					continue;
+				any = true;
+				std::sort(row.begin(), row.end());
+				row.erase(std::unique(row.begin(), row.end()), row.end());
+				size_t k = 0;
+				for(int qx = 0; qx < sizeX; qx++)
+				{
+					while(k + 1 < row.size() && siteX[row[k+1]] <= queryX[qx])
+						k++;
+					float d = queryX[qx] - siteX[row[k]];
+					float best = d*d;
+					if(k + 1 < row.size())
+					{
+						d = queryX[qx] - siteX[row[k+1]];
+						best = std::min(best, d*d);
+					}
+					rowDist[qx + static_cast<size_t>(jy)*sizeX] = best;
+				}
+			}
+			if(!any)
+				return;
+
+			// 2 - Along y: lower envelope of the parabolas centered at the y-sites
+			float *slice = &slices[static_cast<size_t>(jz)*sizeX*sizeY];
+			for(int qx = 0; qx < sizeX; qx++)
+			{
+				for(int jy = 0; jy < nSy; jy++)
+					f[jy] = rowDist[qx + static_cast<size_t>(jy)*sizeX];
+				envelope.transform(siteY, f, queryY, out);
+				for(int qy = 0; qy < sizeY; qy++)
+					slice[qx + static_cast<size_t>(qy)*sizeX] = out[qy];
+			}
+		});
+
+		// 3 - Along z, parallel over y rows of the grid
+		parallelFor(0, sizeY, numThreads, [&](int qy)
+		{
+			std::vector<float> f(nSz), out(sizeZ);
+			Envelope envelope(nSz);
+			for(int qx = 0; qx < sizeX; qx++)
+			{
+				const size_t column = qx + static_cast<size_t>(qy)*sizeX;
+				for(int jz = 0; jz < nSz; jz++)
+					f[jz] = slices[column + static_cast<size_t>(jz)*sizeX*sizeY];
+				envelope.transform(siteZ, f, queryZ, out);
+				for(int qz = 0; qz < sizeZ; qz++)
+					sqDist[column + static_cast<size_t>(qz)*sizeX*sizeY] = out[qz];
+			}
+		});
+
+		return true;
+	}
+
+	/** @brief Runs body(i) for i in [begin, end) over numThreads threads */
+	template<typename Body>
+	static void parallelFor(int begin, int end, unsigned int numThreads, Body body)
+	{
+		std::atomic<int> next(begin);
+		auto worker = [&]()
+		{
+			for(int i = next++; i < end; i = next++)
+				body(i);
+		};
+		std::vector<std::thread> threads;
+		for(unsigned int t = 1; t < numThreads; t++)
+			threads.emplace_back(worker);
+		worker();
+		for(auto &t: threads)
+			t.join();
+	}
+
+private:
+
+	template<typename PointContainer>
+	static void uniqueCoordinates(const PointContainer &points, int axis, std::vector<float> &coords)
+	{
+		coords.clear();
+		coords.reserve(points.size());
+		for(const auto &p: points)
+			coords.push_back(axis == 0 ? p.x : (axis == 1 ? p.y : p.z));
+		std::sort(coords.begin(), coords.end());
+		coords.erase(std::unique(coords.begin(), coords.end()), coords.end());
+	}
+
+	/**
+	 * @brief 1D lower envelope of parabolas f[j] + (q - site[j])^2 with arbitrary (sorted) vertices,
+	 * evaluated at sorted query positions. Infinite f values are skipped.
+	 */
+	class Envelope
+	{
+	public:
+		Envelope(int n): v(n), z(n+1) {}
+
+		void transform(const std::vector<float> &site, const std::vector<float> &f,
+					   const std::vector<float> &query, std::vector<float> &out)
+		{
+			const double inf = std::numeric_limits<double>::infinity();
+			int k = -1;
+			for(size_t q = 0; q < site.size(); q++)
+			{
+				if(f[q] == std::numeric_limits<float>::infinity())
+					continue;
+				if(k < 0)
+				{
+					k = 0;
+					v[0] = q;
+					z[0] = -inf;
+					z[1] = inf;
+					continue;
+				}
+				double s = intersection(site, f, v[k], q);
+				while(s <= z[k])
+				{
+					k--;
+					if(k < 0)
+						break;
+					s = intersection(site, f, v[k], q);
+				}
+				k++;
+				v[k] = q;
+				z[k] = k == 0 ? -inf : s;
+				z[k+1] = inf;
+			}
+
+			if(k < 0)
+			{
+				std::fill(out.begin(), out.end(), std::numeric_limits<float>::infinity());
+				return;
+			}
+
+			int j = 0;
+			for(size_t q = 0; q < query.size(); q++)
+			{
+				while(z[j+1] < query[q])
+					j++;
+				// The neighbours are also checked so that ties are resolved with the float value
+				float best = evaluate(site, f, v[j], query[q]);
+				if(j > 0)
+					best = std::min(best, evaluate(site, f, v[j-1], query[q]));
+				if(j < k)
+					best = std::min(best, evaluate(site, f, v[j+1], query[q]));
+				out[q] = best;
+			}
+		}
+
+	private:
+		static double intersection(const std::vector<float> &site, const std::vector<float> &f, int p, int q)
+		{
+			const double sp = site[p], sq = site[q];
+			return ((f[q] + sq*sq) - (f[p] + sp*sp)) / (2.0*(sq - sp));
+		}
+
+		static float evaluate(const std::vector<float> &site, const std::vector<float> &f, int j, float query)
+		{
+			float d = query - site[j];
+			return f[j] + d*d;
+		}
+
+		std::vector<int> v;
+		std::vector<double> z;
+	};
+};
+
+#endif
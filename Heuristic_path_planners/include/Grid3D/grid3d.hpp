@@ -21,21 +21,50 @@
 #include <cmath>
 
 #include "utils/utils.hpp"
+#include "Grid3D/distance_transform.hpp"
 
 #include <sstream> //for std::ostringstream
 #include <fstream>
 #include <iomanip> //for std::setw, std::hex, and std::setfill
 #include <openssl/evp.h> //for all other OpenSSL function calls
 #include <openssl/sha.h> //for SHA512_DIGEST_LENGTH
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 // #include "utils/ros/ROSInterfaces.hpp"
 
 // #ifdef BUILD_VORONOI
 // #include "voro++-0.4.6/src/voro++.hh"
 // #endif
 
+// Header of the .gridm cache. The cells are stored after it, starting at a page boundary (payloadOffset),
+// so that the payload can be mmapped directly as the gridCell array
+struct GridFileHeader
+{
+	char magic[8];				// "GRIDM"
+	uint32_t version;
+	uint32_t headerSize;
+	int32_t gridSizeX, gridSizeY, gridSizeZ;
+	int32_t useCostmapFunction;
+	int64_t gridSize;
+	float resolution, sensorDev;
+	double originX, originY, originZ;
+	// Recorded only: the cells (prob = dist) don't depend on useCostmapFunction, sensorDev or these cost
+	// parameters, so changing them doesn't make the cache stale
+	double costScalingFactor, robotRadius;
+	uint64_t payloadOffset, payloadBytes;
+	uint64_t hashChunkSize;
+	char octomapHash[129];		// SHA3-512 (hex) of the octomap file the grid was computed from
+	char payloadHash[129];		// Chunked SHA3-512 (hex) of the whole payload
+};
+
 class Grid3d
 {
-private:
+protected:
 	
 	// Ros parameters
 	ros::NodeHandle m_nh;
@@ -54,6 +83,16 @@ private:
 	Planners::utils::gridCell *m_grid;
 	int m_gridSize, m_gridSizeX, m_gridSizeY, m_gridSizeZ;
 	int m_gridStepY, m_gridStepZ;
+	// m_grid points to a read-only mapping of the .gridm file instead of a new[] allocation
+	void *m_gridMapping{nullptr};
+	size_t m_gridMappingSize{0};
+
+	// Octomap origin (metric min) and hash of the octomap file, used to detect stale .gridm files
+	double m_originX{0.0}, m_originY{0.0}, m_originZ{0.0};
+	std::string m_octomapHash;
+	bool m_verifyGridHash;
+	static constexpr uint32_t m_gridFileVersion = 2;
+	static constexpr size_t m_hashChunkSize = 16*1024*1024;
 	
 	// 3D point clound representation of the map
 	pcl::PointCloud<pcl::PointXYZ>::Ptr m_cloud;
@@ -72,13 +111,22 @@ private:
 	//Parameters added to allow a new exp function to test different gridmaps
 	double cost_scaling_factor, robot_radius;
 	bool use_costmap_function;
+	// Use the (slow) per-cell kdtree search instead of the distance transform to compute the grid
+	bool m_useKdtreeGrid;
 	
 public:
-	Grid3d(): m_cloud(new pcl::PointCloud<pcl::PointXYZ>)
+	/**
+	 * @param _lnh Node handle of the parameters. The private one of the node, or of the nodelet, whose
+	 * callback queue also runs the publishing timers
+	 */
+	Grid3d(const ros::NodeHandle &_lnh = ros::NodeHandle("~")): m_cloud(new pcl::PointCloud<pcl::PointXYZ>)
 	{
 		// Load paraeters
 		double value;
-		ros::NodeHandle lnh("~");
+		ros::NodeHandle lnh(_lnh);
+		// The publishers keep their global names, but the timers go to the callback queue of the node or
+		// nodelet, so they never run while one of its callbacks is writing the grid
+		m_nh.setCallbackQueue(lnh.getCallbackQueue());
 		lnh.param("name", m_nodeName, std::string("grid3d"));
 		if(!lnh.getParam("global_frame_id", m_globalFrameId))
 			m_globalFrameId = "map";	
@@ -100,6 +148,10 @@ public:
 		lnh.param("cost_scaling_factor", cost_scaling_factor, 0.8); //0.8		
 		lnh.param("robot_radius", robot_radius, 0.4);		//0.4
 		lnh.param("use_costmap_function", use_costmap_function, (bool)true);		
+		lnh.param("use_kdtree_grid", m_useKdtreeGrid, (bool)false);
+		// The header (format, octomap hash and size) is always checked. Hashing the whole payload also catches
+		// a corrupted cache, it reads every page of the mapping once. Disable it for an O(1) cached load
+		lnh.param("verify_gridm_hash", m_verifyGridHash, (bool)true);
 
 		// Load octomap 
 		m_octomap = NULL;
@@ -118,8 +170,8 @@ public:
 				path = m_mapPath.substr(0,m_mapPath.find(".ot"))+".gridm";
 			if(!loadGrid(path))
 			{						
-				// Compute the gridMap using kdtree search over the point-cloud
-				std::cout << "Computing 3D occupancy grid. This will take some time..." << std::endl;
+				// Compute the gridMap using a distance transform (or kdtree search) over the point-cloud
+				std::cout << "Computing 3D occupancy grid..." << std::endl;
 				computeGrid();
 				std::cout << "\tdone!" << std::endl;
 				
@@ -150,8 +202,7 @@ public:
 	{
 		if(m_octomap != NULL)
 			delete m_octomap;
-		if(m_grid != NULL)
-			delete []m_grid;
+		releaseGrid();
 	}
 	bool setCostParams(const double &_cost_scaling_factor, const double &_robot_radius){
 
@@ -264,8 +315,7 @@ protected:
 		// release previously loaded data
 		if(m_octomap != NULL)
 			delete m_octomap;
-		if(m_grid != NULL)
-			delete []m_grid;
+		releaseGrid();
 		
 		// Load octomap
 		octomap::AbstractOcTree *tree;
@@ -306,6 +356,10 @@ protected:
 		m_octomap->getMetricMin(minX, minY, minZ);
 		m_octomap->getMetricMax(maxX, maxY, maxZ);
 		res = m_octomap->getResolution();
+		m_originX = minX;
+		m_originY = minY;
+		m_originZ = minZ;
+		m_octomapHash = fileHash(path);
 		m_maxX = (float)(maxX-minX);
 		m_maxY = (float)(maxY-minY);
 		m_maxZ = (float)(maxZ-minZ);
@@ -329,7 +383,7 @@ protected:
 	    return stream.str();
 	}
 	//perform the SHA3-512 hash
-	std::string sha3_512(const char * _input,int _size)
+	std::string sha3_512(const char * _input, size_t _size)
 	{
 	    uint32_t digest_length = SHA512_DIGEST_LENGTH;
 	    const EVP_MD* algorithm = EVP_sha3_512();
@@ -343,94 +397,199 @@ protected:
 	    OPENSSL_free(digest);
 	    return output;
 	}
+	// SHA3-512 of the concatenation of the SHA3-512 of every chunk. Chunks are hashed in parallel
+	std::string chunkedSha3_512(const char *_input, size_t _size, size_t _chunkSize)
+	{
+		const size_t numChunks = _size == 0 ? 1 : (_size + _chunkSize - 1) / _chunkSize;
+		std::vector<std::string> chunkHashes(numChunks);
+		DistanceTransform3d::parallelFor(0, numChunks, std::max(1u, std::thread::hardware_concurrency()), [&](int i)
+		{
+			size_t begin = i * _chunkSize;
+			chunkHashes[i] = sha3_512(_input + begin, std::min(_chunkSize, _size - begin));
+		});
+		std::string concatenated;
+		for(const auto &h: chunkHashes)
+			concatenated += h;
+		return sha3_512(concatenated.c_str(), concatenated.size());
+	}
+
+	std::string fileHash(const std::string &fileName)
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if(fd < 0)
+			return "";
+		struct stat st;
+		if(fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			close(fd);
+			return "";
+		}
+		void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(data == MAP_FAILED)
+			return "";
+		std::string hash = chunkedSha3_512((const char*)data, st.st_size, m_hashChunkSize);
+		munmap(data, st.st_size);
+		return hash;
+	}
+
+	void releaseGrid(void)
+	{
+		if(m_gridMapping != nullptr)
+			munmap(m_gridMapping, m_gridMappingSize);
+		else if(m_grid != NULL)
+			delete []m_grid;
+		m_gridMapping = nullptr;
+		m_gridMappingSize = 0;
+		m_grid = NULL;
+	}
+
+	void fillGridHeader(GridFileHeader &header)
+	{
+		memset(&header, 0, sizeof(GridFileHeader));
+		strncpy(header.magic, "GRIDM", sizeof(header.magic));
+		header.version = m_gridFileVersion;
+		header.headerSize = sizeof(GridFileHeader);
+		header.gridSizeX = m_gridSizeX;
+		header.gridSizeY = m_gridSizeY;
+		header.gridSizeZ = m_gridSizeZ;
+		header.useCostmapFunction = use_costmap_function;
+		header.gridSize = m_gridSize;
+		header.resolution = m_resolution;
+		header.sensorDev = m_sensorDev;
+		header.originX = m_originX;
+		header.originY = m_originY;
+		header.originZ = m_originZ;
+		header.costScalingFactor = cost_scaling_factor;
+		header.robotRadius = robot_radius;
+		header.payloadOffset = pageAligned(sizeof(GridFileHeader));
+		header.payloadBytes = (uint64_t)m_gridSize * sizeof(Planners::utils::gridCell);
+		header.hashChunkSize = m_hashChunkSize;
+		strncpy(header.octomapHash, m_octomapHash.c_str(), sizeof(header.octomapHash) - 1);
+	}
+
+	static uint64_t pageAligned(uint64_t _size)
+	{
+		const uint64_t page = sysconf(_SC_PAGESIZE);
+		return ((_size + page - 1) / page) * page;
+	}
+
 	bool saveGrid(std::string &fileName)
 	{
-		FILE *pf;
-		
-		// Open file
-		pf = fopen(fileName.c_str(), "wb");
+		GridFileHeader header;
+		fillGridHeader(header);
+		auto sha_value = chunkedSha3_512((const char*)m_grid, header.payloadBytes, header.hashChunkSize);
+		strncpy(header.payloadHash, sha_value.c_str(), sizeof(header.payloadHash) - 1);
+		std::cout << "Sha512 value: " << sha_value << std::endl;
+
+		// Write to a temporary file and rename it, so that a crash never leaves a truncated cache
+		std::string tmpName = fileName + ".tmp";
+		FILE *pf = fopen(tmpName.c_str(), "wb");
 		if(pf == NULL)
 		{
-			std::cout << "Error opening file " << fileName << " for writing" << std::endl;
+			std::cout << "Error opening file " << tmpName << " for writing" << std::endl;
 			return false;
 		}
-		
-		// Write grid general info 
-		fwrite(&m_gridSize, sizeof(int), 1, pf);
-		fwrite(&m_gridSizeX, sizeof(int), 1, pf);
-		fwrite(&m_gridSizeY, sizeof(int), 1, pf);
-		fwrite(&m_gridSizeZ, sizeof(int), 1, pf);
-		fwrite(&m_sensorDev, sizeof(float), 1, pf);
-		
-		// Write grid cells
-		fwrite(m_grid, sizeof(Planners::utils::gridCell), m_gridSize, pf);
-		
-		auto sha_value = sha3_512((const char*)m_grid, m_gridSize);
-		std::cout << "Sha512 value: " << sha_value << std::endl;
-		std::ofstream sha_file;
-		sha_file.open(fileName+"sha", std::ofstream::trunc);
-		sha_file << sha_value; 
-		sha_file.close();
-		// Close file
-		fclose(pf);
-		
+
+		std::vector<char> padding(header.payloadOffset - sizeof(GridFileHeader), 0);
+		bool ok = fwrite(&header, sizeof(GridFileHeader), 1, pf) == 1;
+		ok = ok && fwrite(padding.data(), 1, padding.size(), pf) == padding.size();
+		ok = ok && fwrite(m_grid, sizeof(Planners::utils::gridCell), m_gridSize, pf) == (size_t)m_gridSize;
+		ok = (fclose(pf) == 0) && ok;
+		if(!ok || rename(tmpName.c_str(), fileName.c_str()) != 0)
+		{
+			std::cout << "Error writing file " << fileName << std::endl;
+			remove(tmpName.c_str());
+			return false;
+		}
+
 		return true;
 	}
 
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"	
 	bool loadGrid(std::string &fileName)
 	{
-		FILE *pf;
-		
-		// Open file
-		pf = fopen(fileName.c_str(), "rb");
-		if(pf == NULL)
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if(fd < 0)
 		{
 			std::cout << "Error opening file " << fileName << " for reading" << std::endl;
 			return false;
 		}
-		
-		// Write grid general info 
-		fread(&m_gridSize, sizeof(int), 1, pf);
-		fread(&m_gridSizeX, sizeof(int), 1, pf);
-		fread(&m_gridSizeY, sizeof(int), 1, pf);
-		fread(&m_gridSizeZ, sizeof(int), 1, pf);
-		fread(&m_sensorDev, sizeof(float), 1, pf);
-		m_gridStepY = m_gridSizeX;
-		m_gridStepZ = m_gridSizeX*m_gridSizeY;
-		
-		// Write grid cells
-		if(m_grid != NULL)
-			delete []m_grid;
-		m_grid = new Planners::utils::gridCell[m_gridSize];
-		fread(m_grid, sizeof(Planners::utils::gridCell), m_gridSize, pf);
-		fclose(pf);
-		
-		std::ifstream input_sha;
-		auto sha_value = sha3_512((const char*)m_grid, m_gridSize);
-		ROS_INFO("[Grid3D] Calculated SHA512 value: %s", sha_value.c_str());
-
-		input_sha.open(fileName+"sha");
-		std::string readed_sha;
-		if(input_sha.is_open()){
-			getline(input_sha, readed_sha);
-			ROS_INFO("[Grid3D] Readed SHA512 from file: %s", readed_sha.c_str());
-			input_sha.close();
-		}else{
-			ROS_ERROR("[Grid3D] Couldn't read SHA512 data of gridm file, recomputing grid");
+
+		GridFileHeader header;
+		struct stat st;
+		if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(GridFileHeader) ||
+		   pread(fd, &header, sizeof(GridFileHeader), 0) != (ssize_t)sizeof(GridFileHeader))
+		{
+			ROS_ERROR("[Grid3D] Couldn't read gridm header, recomputing grid");
+			close(fd);
 			return false;
 		}
-		//Check that both are the same
-		if(readed_sha.compare(sha_value) != 0){
-			ROS_ERROR("[Grid3D] Found different SHA values between for gridm!");
+		if(strncmp(header.magic, "GRIDM", sizeof(header.magic)) != 0 || header.version != m_gridFileVersion ||
+		   header.headerSize != sizeof(GridFileHeader))
+		{
+			ROS_ERROR("[Grid3D] Old or unknown gridm format, recomputing grid");
+			close(fd);
 			return false;
 		}
-		
+
+		// Check that the cache was computed from this octomap
+		GridFileHeader expected;
+		m_gridSizeX = (int)(m_maxX*m_oneDivRes);
+		m_gridSizeY = (int)(m_maxY*m_oneDivRes);
+		m_gridSizeZ = (int)(m_maxZ*m_oneDivRes);
+		m_gridSize = m_gridSizeX*m_gridSizeY*m_gridSizeZ;
+		fillGridHeader(expected);
+		header.octomapHash[sizeof(header.octomapHash) - 1] = 0;
+		header.payloadHash[sizeof(header.payloadHash) - 1] = 0;
+		if(header.gridSizeX != expected.gridSizeX || header.gridSizeY != expected.gridSizeY || header.gridSizeZ != expected.gridSizeZ ||
+		   header.gridSize != expected.gridSize || header.resolution != expected.resolution ||
+		   header.originX != expected.originX || header.originY != expected.originY || header.originZ != expected.originZ ||
+		   m_octomapHash.compare(header.octomapHash) != 0)
+		{
+			ROS_ERROR("[Grid3D] Stale gridm (octomap changed), recomputing grid");
+			close(fd);
+			return false;
+		}
+		if(header.payloadOffset != expected.payloadOffset || header.payloadBytes != expected.payloadBytes ||
+		   (uint64_t)st.st_size < header.payloadOffset + header.payloadBytes)
+		{
+			ROS_ERROR("[Grid3D] Truncated gridm file, recomputing grid");
+			close(fd);
+			return false;
+		}
+
+		// Map the cells read-only: no copy, pages are loaded on demand
+		void *mapping = mmap(NULL, header.payloadOffset + header.payloadBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(mapping == MAP_FAILED)
+		{
+			ROS_ERROR("[Grid3D] Couldn't mmap gridm file, recomputing grid");
+			return false;
+		}
+
+		const char *payload = (const char*)mapping + header.payloadOffset;
+		if(m_verifyGridHash)
+		{
+			auto sha_value = chunkedSha3_512(payload, header.payloadBytes, header.hashChunkSize);
+			ROS_INFO("[Grid3D] Calculated SHA512 value: %s", sha_value.c_str());
+			ROS_INFO("[Grid3D] Readed SHA512 from file: %s", header.payloadHash);
+			//Check that both are the same
+			if(sha_value.compare(header.payloadHash) != 0){
+				ROS_ERROR("[Grid3D] Found different SHA values between for gridm!");
+				munmap(mapping, header.payloadOffset + header.payloadBytes);
+				return false;
+			}
+		}
+
+		releaseGrid();
+		m_gridMapping = mapping;
+		m_gridMappingSize = header.payloadOffset + header.payloadBytes;
+		m_grid = (Planners::utils::gridCell*)payload;
+		m_gridStepY = m_gridSizeX;
+		m_gridStepZ = m_gridSizeX*m_gridSizeY;
+
 		return true;
 	}
-#pragma GCC diagnostic pop
 	
 	void computePointCloud(void)
 	{
@@ -465,9 +624,6 @@ protected:
 
 	void computeGrid(void)
 	{
-		//Publish percent variable
-		std_msgs::Float32 percent_msg;
-		percent_msg.data = 0;
 		// Alloc the 3D grid
 		m_gridSizeX = (int)(m_maxX*m_oneDivRes);
 		m_gridSizeY = (int)(m_maxY*m_oneDivRes); 
@@ -475,16 +631,65 @@ protected:
 		m_gridSize = m_gridSizeX*m_gridSizeY*m_gridSizeZ;
 		m_gridStepY = m_gridSizeX;
 		m_gridStepZ = m_gridSizeX*m_gridSizeY;
+		releaseGrid();
 		m_grid = new Planners::utils::gridCell[m_gridSize];
 
+		auto start = std::chrono::high_resolution_clock::now();
+		if(m_useKdtreeGrid)
+			computeGridKdtree();
+		else
+			computeGridDistanceTransform();
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		ROS_INFO("[Grid3D] Grid of %d cells computed in %.2f s", m_gridSize, elapsed.count());
+	}
+
+	void setCellDistance(int index, float dist)
+	{
+		m_grid[index].dist = dist;
+		if(!use_costmap_function){
+			//m_grid[index].prob = gaussConst1*exp(-dist*dist*gaussConst2);
+			m_grid[index].prob = dist;
+		}else{
+			//double prob =  100*exp(-cost_scaling_factor*std::fabs((dist - robot_radius)));
+			//JAC: Include the computation of prob considering the distance to the nearest voronoi edge.
+			//m_grid[index].prob = prob;
+			m_grid[index].prob = dist;
+		}
+	}
+
+	// Exact separable EDT over the point-cloud, same values as the kdtree search
+	void computeGridDistanceTransform(void)
+	{
+		std::vector<float> sqDist;
+		if(!DistanceTransform3d::compute(m_cloud->points, m_gridSizeX, m_gridSizeY, m_gridSizeZ, m_resolution, sqDist))
+		{
+			for(int index = 0; index < m_gridSize; index++)
+			{
+				m_grid[index].dist = -1.0;
+				m_grid[index].prob =  0.0;
+			}
+			return;
+		}
+
+		DistanceTransform3d::parallelFor(0, m_gridSizeZ, std::max(1u, std::thread::hardware_concurrency()), [&](int iz)
+		{
+			for(int index = iz*m_gridStepZ; index < (iz+1)*m_gridStepZ; index++)
+				setCellDistance(index, sqrt(sqDist[index]));
+		});
+	}
+
+	void computeGridKdtree(void)
+	{
+		//Publish percent variable
+		std_msgs::Float32 percent_msg;
+		percent_msg.data = 0;
+
 		// Setup kdtree
 		m_kdtree.setInputCloud(m_cloud);
 
 		// Compute the distance to the closest point of the grid
 		int index;
 		float dist;
-		float gaussConst1 = 1./(m_sensorDev*sqrt(2*M_PI));
-		float gaussConst2 = 1./(2*m_sensorDev*m_sensorDev);
 		pcl::PointXYZ searchPoint;
 		std::vector<int> pointIdxNKNSearch(1);
 		std::vector<float> pointNKNSquaredDistance(1);
@@ -512,17 +717,7 @@ protected:
 					if(m_kdtree.nearestKSearch(searchPoint, 1, pointIdxNKNSearch, pointNKNSquaredDistance) > 0)
 					{
 						dist = sqrt(pointNKNSquaredDistance[0]);
-						m_grid[index].dist = dist;
-						if(!use_costmap_function){
-							//m_grid[index].prob = gaussConst1*exp(-dist*dist*gaussConst2);
-							m_grid[index].prob = dist;
-						}else{
-							//double prob =  100*exp(-cost_scaling_factor*std::fabs((dist - robot_radius)));
-							// ROS_INFO("[%f, %f, %f] Dist: %f Probability: %f", searchPoint.x, searchPoint.y, searchPoint.z, dist, prob);
-							//JAC: Include the computation of prob considering the distance to the nearest voronoi edge.
-							//m_grid[index].prob = prob;
-							m_grid[index].prob = dist;
-						}
+						setCellDistance(index, dist);
 					}
 					else
 					{
@@ -27,6 +27,7 @@
 #include <pcl/io/pcd_io.h>
 
 #include "utils/utils.hpp"
+#include "utils/LatencyMetrics.hpp"
 
 #include <torch/torch.h>
 #include <torch/script.h>
@@ -40,6 +41,9 @@
 #include <openssl/evp.h> //for all other OpenSSL function calls
 #include <openssl/sha.h> //for SHA512_DIGEST_LENGTH
 #include <chrono>
+#include <limits>
+#include <vector>
+#include <algorithm>
 // #include "utils/ros/ROSInterfaces.hpp"
 
 // #ifdef BUILD_VORONOI
@@ -96,6 +100,16 @@ private:
 	//Parameters added to allow a new exp function to test different gridmaps
 	double cost_scaling_factor, robot_radius;
 	bool use_costmap_function;
+
+	// Adaptive sampling of the SDF, see computeLocalGridAdaptive
+	bool m_adaptiveSampling, m_adaptiveSamplingCheck;
+	int m_adaptiveBlock;
+	double m_lipschitzMargin;
+	std::vector<uint8_t> m_sampled;
+	size_t m_lastEvaluations{0};
+	uint64_t m_inferenceUsec{0}; // Accumulated by querySdf
+
+	Planners::utils::LatencyMetrics *m_metrics{nullptr};
 	
 public:
 	// 3D probabilistic grid cell
@@ -103,13 +117,22 @@ public:
 	int m_gridSize, m_gridSizeX, m_gridSizeY, m_gridSizeZ;
 	int m_gridStepY, m_gridStepZ;
 	float m_resolution;
+	// World position of cell (0,0,0), updated in computeLocalGrid
+	float m_originX{0.0}, m_originY{0.0}, m_originZ{0.0};
 
 	// Local_Grid3d(): m_cloud(new pcl::PointCloud<pcl::PointXYZI>)
-	Local_Grid3d(): m_cloud(new pcl::PointCloud<pcl::PointXYZ>)
+	/**
+	 * @param _lnh Node handle of the parameters. The private one of the node, or of the nodelet, whose
+	 * callback queue also runs the publishing timers
+	 */
+	Local_Grid3d(const ros::NodeHandle &_lnh = ros::NodeHandle("~")): m_cloud(new pcl::PointCloud<pcl::PointXYZ>)
 	{
 		// Load parameters INCLUDE PARAMETERS OF THE SIZE OF THE LOCAL SIZE
 		double value;
-		ros::NodeHandle lnh("~");
+		ros::NodeHandle lnh(_lnh);
+		// The publishers keep their global names, but the timers go to the callback queue of the node or
+		// nodelet, so they never run while one of its callbacks is writing the grid
+		m_nh.setCallbackQueue(lnh.getCallbackQueue());
 		lnh.param("name", m_nodeName, std::string("local_grid3d"));
 		if(!lnh.getParam("global_frame_id", m_globalFrameId)) // JAC: Local planner --> base_link or occupancy map?
 			m_globalFrameId = "map";	
@@ -132,6 +155,11 @@ public:
 		lnh.param("robot_radius", robot_radius, 0.4);		//0.4
 		lnh.param("use_costmap_function", use_costmap_function, (bool)true);	
 
+		lnh.param("adaptive_sampling", m_adaptiveSampling, (bool)false);
+		lnh.param("adaptive_sampling_block", m_adaptiveBlock, 8);
+		lnh.param("adaptive_sampling_margin", m_lipschitzMargin, 0.1);
+		lnh.param("adaptive_sampling_check", m_adaptiveSamplingCheck, (bool)false);
+
 		m_grid = NULL;
         if(m_grid != NULL)
 			delete []m_grid;
@@ -172,6 +200,13 @@ public:
 		if(m_grid != NULL)
 			delete []m_grid;
 	}
+	/**
+	 * @brief The coordinates and inference times of computeLocalGrid are recorded in _metrics, if not null
+	 */
+	void setMetrics(Planners::utils::LatencyMetrics *_metrics){ m_metrics = _metrics; }
+
+	Planners::utils::LatencyMetrics* getMetrics() const { return m_metrics; }
+
 	bool setCostParams(const double &_cost_scaling_factor, const double &_robot_radius){
 
 		cost_scaling_factor = std::fabs(_cost_scaling_factor);
@@ -277,6 +312,18 @@ public:
 		// printf("-- Executing computeLocalGrid --\n");
 
 
+		m_originX = drone_x - ((m_gridSizeX -1) / 2) * m_resolution;
+		m_originY = drone_y - ((m_gridSizeY -1) / 2) * m_resolution;
+		m_originZ = drone_z - ((m_gridSizeZ -1) / 2) * m_resolution;
+
+		if(m_adaptiveSampling)
+		{
+			computeLocalGridAdaptive(loaded_sdf);
+			return;
+		}
+
+		auto coordinates_start = std::chrono::high_resolution_clock::now();
+
 		// Build global positions vector
 		std::vector<std::vector<float>> coordinates_vector;
         coordinates_vector.reserve(m_gridSizeX*m_gridSizeY*m_gridSizeZ);
@@ -322,6 +369,11 @@ public:
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double, std::milli> duration = end - start;
         //std::cout << "Points queried: " << num_points <<" |  Time taken to query model: " << duration.count() << " ms" << std::endl;
+		if(m_metrics != nullptr)
+		{
+			m_metrics->record(Planners::utils::LatencyMetrics::COORDINATES, std::chrono::duration_cast<std::chrono::microseconds>(start - coordinates_start).count());
+			m_metrics->record(Planners::utils::LatencyMetrics::INFERENCE, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+		}
 
 		// Place the queried values into the m_grid distance data field
 		for(int iz=0; iz<m_gridSizeZ; iz++)
@@ -354,6 +406,220 @@ public:
 
 	}
 
+	/**
+	 * @brief Same grid as the dense computeLocalGrid with fewer network evaluations.
+	 *
+	 * The SDF is evaluated first at the corners of blocks of m_adaptiveBlock cells. The distance
+	 * changes at most 1 m per meter, so no cell of a block can be closer to an obstacle than the
+	 * smallest corner value minus half the block diagonal. If that bound, minus m_lipschitzMargin for
+	 * the error of the network, is over m_resolution (the collision test of configureLocalWorldCosts)
+	 * the block is filled by trilinear interpolation of its corners. The other blocks are split in 8
+	 * until their corners are adjacent cells, so only the cells near the surfaces are evaluated.
+	 */
+	void computeLocalGridAdaptive(torch::jit::script::Module& loaded_sdf)
+	{
+		struct SampleBlock
+		{
+			int lo[3], hi[3]; // Corner cells, both included
+		};
+
+		const int size[3] = {m_gridSizeX, m_gridSizeY, m_gridSizeZ};
+		const int step = std::max(1, m_adaptiveBlock);
+
+		// Coarse lattice, the last block of each axis can be smaller
+		std::vector<std::pair<int, int>> intervals[3];
+		for(int axis = 0; axis < 3; axis++)
+		{
+			int lo = 0;
+			do{
+				const int hi = std::min(lo + step, size[axis] - 1);
+				intervals[axis].push_back({lo, hi});
+				lo = hi;
+			}while(lo < size[axis] - 1);
+		}
+		std::vector<SampleBlock> active, next, interpolated;
+		for(const auto &z: intervals[2])
+			for(const auto &y: intervals[1])
+				for(const auto &x: intervals[0])
+					active.push_back({{x.first, y.first, z.first}, {x.second, y.second, z.second}});
+
+		auto cellIndex = [this](int ix, int iy, int iz){ return ix + iy*m_gridStepY + iz*m_gridStepZ; };
+
+		const auto start = std::chrono::steady_clock::now();
+		m_sampled.assign(m_gridSize, 0);
+		m_lastEvaluations = 0;
+		m_inferenceUsec = 0;
+		std::vector<int> indices;
+		std::vector<float> positions, values;
+		while(!active.empty())
+		{
+			// Evaluate the corners not evaluated yet, all the blocks of the level in one batch
+			indices.clear();
+			positions.clear();
+			for(const auto &block: active)
+				for(int c = 0; c < 8; c++)
+				{
+					const int ix = (c & 1) ? block.hi[0] : block.lo[0];
+					const int iy = (c & 2) ? block.hi[1] : block.lo[1];
+					const int iz = (c & 4) ? block.hi[2] : block.lo[2];
+					const int index = cellIndex(ix, iy, iz);
+					if(m_sampled[index])
+						continue;
+					m_sampled[index] = 1;
+					indices.push_back(index);
+					positions.insert(positions.end(), {m_originX + ix * m_resolution, m_originY + iy * m_resolution, m_originZ + iz * m_resolution});
+				}
+			querySdf(loaded_sdf, positions, values);
+			for(size_t i = 0; i < indices.size(); i++)
+				m_grid[indices[i]].dist = values[i];
+			m_lastEvaluations += indices.size();
+
+			next.clear();
+			for(const auto &block: active)
+			{
+				// Every cell is a corner
+				if(block.hi[0] - block.lo[0] <= 1 && block.hi[1] - block.lo[1] <= 1 && block.hi[2] - block.lo[2] <= 1)
+					continue;
+
+				float min_dist = std::numeric_limits<float>::max();
+				for(int c = 0; c < 8; c++)
+					min_dist = std::min(min_dist, m_grid[cellIndex((c & 1) ? block.hi[0] : block.lo[0],
+					                                               (c & 2) ? block.hi[1] : block.lo[1],
+					                                               (c & 4) ? block.hi[2] : block.lo[2])].dist);
+
+				const float dx = block.hi[0] - block.lo[0], dy = block.hi[1] - block.lo[1], dz = block.hi[2] - block.lo[2];
+				const float half_diagonal = 0.5 * m_resolution * std::sqrt(dx*dx + dy*dy + dz*dz);
+				if(min_dist - half_diagonal - m_lipschitzMargin > m_resolution)
+				{
+					interpolated.push_back(block);
+					continue;
+				}
+
+				// Split the axes longer than one cell
+				int split[3][3];
+				for(int axis = 0; axis < 3; axis++)
+				{
+					split[axis][0] = block.lo[axis];
+					split[axis][2] = block.hi[axis];
+					split[axis][1] = block.hi[axis] - block.lo[axis] > 1 ? (block.lo[axis] + block.hi[axis]) / 2 : block.hi[axis];
+				}
+				for(int c = 0; c < 8; c++)
+				{
+					SampleBlock child;
+					bool empty = false;
+					for(int axis = 0; axis < 3; axis++)
+					{
+						const int half = (c >> axis) & 1;
+						if(half == 1 && split[axis][1] == split[axis][2])
+							empty = true;
+						child.lo[axis] = split[axis][half];
+						child.hi[axis] = split[axis][half + 1];
+					}
+					if(!empty)
+						next.push_back(child);
+				}
+			}
+			active.swap(next);
+		}
+
+		for(const auto &block: interpolated)
+		{
+			float corner[8];
+			for(int c = 0; c < 8; c++)
+				corner[c] = m_grid[cellIndex((c & 1) ? block.hi[0] : block.lo[0],
+				                             (c & 2) ? block.hi[1] : block.lo[1],
+				                             (c & 4) ? block.hi[2] : block.lo[2])].dist;
+
+			for(int iz = block.lo[2]; iz <= block.hi[2]; iz++)
+			{
+				const float tz = block.hi[2] > block.lo[2] ? float(iz - block.lo[2]) / (block.hi[2] - block.lo[2]) : 0.0;
+				for(int iy = block.lo[1]; iy <= block.hi[1]; iy++)
+				{
+					const float ty = block.hi[1] > block.lo[1] ? float(iy - block.lo[1]) / (block.hi[1] - block.lo[1]) : 0.0;
+					for(int ix = block.lo[0]; ix <= block.hi[0]; ix++)
+					{
+						const int index = cellIndex(ix, iy, iz);
+						if(m_sampled[index])
+							continue;
+
+						const float tx = block.hi[0] > block.lo[0] ? float(ix - block.lo[0]) / (block.hi[0] - block.lo[0]) : 0.0;
+						const float c00 = corner[0] + (corner[1] - corner[0]) * tx, c10 = corner[2] + (corner[3] - corner[2]) * tx;
+						const float c01 = corner[4] + (corner[5] - corner[4]) * tx, c11 = corner[6] + (corner[7] - corner[6]) * tx;
+						const float c0 = c00 + (c10 - c00) * ty, c1 = c01 + (c11 - c01) * ty;
+						m_grid[index].dist = c0 + (c1 - c0) * tz;
+					}
+				}
+			}
+		}
+
+		// Everything but the network evaluations is accounted as coordinates generation
+		if(m_metrics != nullptr)
+		{
+			const uint64_t total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			m_metrics->record(Planners::utils::LatencyMetrics::COORDINATES, total > m_inferenceUsec ? total - m_inferenceUsec : 0);
+			m_metrics->record(Planners::utils::LatencyMetrics::INFERENCE, m_inferenceUsec);
+		}
+
+		if(m_adaptiveSamplingCheck)
+			checkAdaptiveSampling(loaded_sdf);
+	}
+
+	/**
+	 * @brief Network evaluations of the last computeLocalGrid call
+	 */
+	size_t getLastEvaluations() const { return m_lastEvaluations; }
+
+	/**
+	 * @brief Evaluates the whole grid and prints the error of the adaptive sampling.
+	 * Only for tuning adaptive_sampling_block and adaptive_sampling_margin, it costs a dense evaluation
+	 */
+	void checkAdaptiveSampling(torch::jit::script::Module& loaded_sdf)
+	{
+		std::vector<float> positions, values;
+		positions.reserve(3 * m_gridSize);
+		for(int iz = 0; iz < m_gridSizeZ; iz++)
+			for(int iy = 0; iy < m_gridSizeY; iy++)
+				for(int ix = 0; ix < m_gridSizeX; ix++)
+					positions.insert(positions.end(), {m_originX + ix * m_resolution, m_originY + iy * m_resolution, m_originZ + iz * m_resolution});
+		querySdf(loaded_sdf, positions, values);
+
+		double max_error = 0.0, sum_error = 0.0;
+		int collision_mismatches = 0;
+		for(int i = 0; i < m_gridSize; i++)
+		{
+			const double error = std::fabs(m_grid[i].dist - values[i]);
+			max_error = std::max(max_error, error);
+			sum_error += error;
+			if((m_grid[i].dist <= m_resolution) != (values[i] <= m_resolution))
+				collision_mismatches++;
+		}
+		ROS_INFO("Adaptive SDF sampling: %lu of %d cells evaluated (%.1f%% saved). Error: max %.4f m, mean %.4f m. Collision mismatches: %d",
+		         m_lastEvaluations, m_gridSize, 100.0 * (m_gridSize - m_lastEvaluations) / m_gridSize, max_error, sum_error / m_gridSize, collision_mismatches);
+	}
+
+	/**
+	 * @brief One batched evaluation of the network
+	 *
+	 * @param _positions x, y, z of each point in global coordinates
+	 * @param _values Distance of each point
+	 */
+	void querySdf(torch::jit::script::Module& loaded_sdf, const std::vector<float> &_positions, std::vector<float> &_values)
+	{
+		const long num_points = _positions.size() / 3;
+		_values.resize(num_points);
+		if(num_points == 0)
+			return;
+
+		torch::NoGradGuard no_grad;
+		torch::Tensor coordinates_tensor = torch::empty({num_points, 3}, torch::kFloat);
+		std::copy(_positions.begin(), _positions.end(), coordinates_tensor.data_ptr<float>());
+		const auto start = std::chrono::steady_clock::now();
+		torch::Tensor output = loaded_sdf.forward({coordinates_tensor}).toTensor().reshape({num_points}).contiguous();
+		m_inferenceUsec += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		const float* output_ptr = output.data_ptr<float>();
+		std::copy(output_ptr, output_ptr + num_points, _values.begin());
+	}
+
 	// // JAC
 	// void computeLocalGrid(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &_cloud) //void
 	// {
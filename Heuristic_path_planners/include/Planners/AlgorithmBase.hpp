@@ -19,12 +19,15 @@
 #include <vector>
 #include <set>
 #include <functional>
+#include <algorithm>
 
 #include <cmath>
 
 #include "utils/world.hpp"
 #include "utils/heuristic.hpp"
 #include "utils/utils.hpp"
+#include "utils/PlanResult.hpp"
+#include "utils/SearchCorridor.hpp"
 #include "utils/time.hpp"
 #include "utils/geometry_utils.hpp"
 #include "utils/LineOfSight.hpp"
@@ -36,6 +39,7 @@ namespace Planners
 {
     using namespace utils;
     using HeuristicFunction = std::function<unsigned int(Vec3i, Vec3i)>;
+    using WorldChangeFunction = std::function<void(const Vec3i &, const Vec3i &)>; /*!< First and last cell (inclusive) of the box changed */
 
     class Heuristic;
     class Clock;
@@ -48,6 +52,14 @@ namespace Planners
     {
 
     public:
+        /**
+         * @brief Inflation implementations
+         * INFLATE_NODE_AS_CUBE: inflateNodeAsCube is called for each obstacle (default)
+         * INFLATE_DT_CUBE: same cells as INFLATE_NODE_AS_CUBE, computed in one pass over the world for a set of obstacles
+         * INFLATE_DT_SPHERE: every cell within inflation_steps (euclidean, in cells) of an obstacle, obstacle included
+         */
+        enum InflationMode { INFLATE_NODE_AS_CUBE, INFLATE_DT_CUBE, INFLATE_DT_SPHERE };
+
         /**
          * @brief Construct a new AlgorithmBase object
          * 
@@ -75,6 +87,12 @@ namespace Planners
          */
         AlgorithmBase(bool _use_3d, const std::string &_algorithm_name);
 
+        /**
+         * @brief The algorithms are owned through AlgorithmBase pointers
+         *
+         */
+        virtual ~AlgorithmBase() = default;
+
         /**
          * @brief Set the World Size object. This method call the resizeWorld method 
          * from the internal discrete world object
@@ -121,6 +139,16 @@ namespace Planners
          */
         utils::DiscreteWorld* getInnerWorld();
 
+        /**
+         * @brief Plan on the same map and with the same configuration (heuristic, inflation,
+         * cost weight and line of sight) as another algorithm object. The search state is not
+         * shared, so both objects can run findPath at the same time while the map is not modified.
+         * See DiscreteWorld::shareMap
+         * 
+         * @param _other algorithm with the configured map
+         */
+        void shareMapFrom(const AlgorithmBase &_other);
+
         /**
          * @brief Configure the heuristic from the list of static functions in the heuristic.hpp
          * header
@@ -145,6 +173,25 @@ namespace Planners
          */
         void addCollision(const Vec3i &coordinates_);
 
+        /**
+         * @brief Mark a set of coordinates as occupied. With the distance transform inflation modes 
+         * the raw obstacles are collected first and dilated in a single pass over the world. With do_inflate,
+         * the cells marked are those of the inflation mode, so with 0 steps the cube modes mark nothing, as
+         * addCollision, and the sphere mode marks the obstacles
+         * 
+         * @param _coordinates Discrete coordinates of the obstacles
+         * @param do_inflate enable inflation
+         * @param steps inflation steps (in multiples of the resolution value)
+         */
+        void addCollisions(const CoordinateList &_coordinates, bool do_inflate, unsigned int steps);
+
+        /**
+         * @brief Calls the addCollisions with the internal inflation configuration values
+         * 
+         * @param _coordinates Discrete coordinates of the obstacles
+         */
+        void addCollisions(const CoordinateList &_coordinates);
+
         /**
          * @brief Calls removeCollision for a given coordinate
          * 
@@ -173,14 +220,14 @@ namespace Planners
 
         /**
          * @brief Main function that should be inherit by each algorithm. 
-         * This function should accept two VALID start and goal discrete coordinates and return
-         * a PathData object containing the necessary information (path, time....)
+         * This function should accept two VALID start and goal discrete coordinates and fill
+         * a PlanResult object with the necessary information (path, time....)
          * 
          * @param _source Start discrete coordinates
          * @param _target Goal discrete coordinates
-         * @return PathData Results stored as PathData object
+         * @param _result Output. It can be reused between calls to avoid allocating the path
          */
-        virtual PathData findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf) = 0;
+        virtual void findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf, PlanResult &_result) = 0;
 
         /**
          * @brief Configure the simple inflation implementation
@@ -191,6 +238,13 @@ namespace Planners
         void setInflationConfig(const bool _inflate, const unsigned int _inflation_steps) 
         { do_inflate_ = _inflate; inflate_steps_ = _inflation_steps;}
 
+        /**
+         * @brief Select the inflation implementation
+         * 
+         * @param _mode One of the InflationMode values
+         */
+        void setInflationMode(const InflationMode _mode){ inflation_mode_ = _mode; }
+
         /**
          * @brief Set the Cost Factor object
          * 
@@ -203,6 +257,38 @@ namespace Planners
          * @param _max_line_of_sight 
          */
         virtual void setMaxLineOfSight(const float &_max_line_of_sight){ max_line_of_sight_cells_ = std::floor(_max_line_of_sight/discrete_world_.getResolution()); }
+
+        /**
+         * @brief Enable or disable the path statistics (PlanResult::statistics). They walk
+         * the adjacent cells of the path, so they should be disabled when planning in a loop.
+         * Enabled by default if the package is compiled with COMPUTE_STATISTICS
+         * 
+         * @param _compute 
+         */
+        void setComputeStatistics(const bool _compute){ compute_statistics_ = _compute; }
+
+        /**
+         * @brief Restrict the neighbours explored by the next searches to the clusters of a corridor
+         * 
+         * @param _corridor Must outlive the searches. nullptr to search the whole world (default)
+         */
+        void setSearchCorridor(const SearchCorridor *_corridor){ corridor_ = _corridor; }
+
+        /**
+         * @brief Cells that addCollision can mark as occupied around an obstacle with the current configuration
+         * 
+         * @return unsigned int 0 if inflation is disabled
+         */
+        unsigned int getInflationSteps() const { return do_inflate_ ? inflate_steps_ : 0; }
+
+        /**
+         * @brief Called with the box of cells whose occupancy may have changed after every modification of 
+         * the world through this object: collisions added or removed, world resized, cleaned or shared. 
+         * The box can exceed the world bounds
+         * 
+         * @param _callback empty function to remove it
+         */
+        void setWorldChangeCallback(WorldChangeFunction _callback){ world_change_callback_ = _callback; }
         /**
          * @brief Deleted function to be inherit from
          * 
@@ -223,21 +309,84 @@ namespace Planners
         void inflateNodeAsCube(const Vec3i &_ref,
                                const CoordinateList &_directions,
                                const unsigned int &_inflate_steps);
+
+        /**
+         * @brief Marks the same cells as calling inflateNodeAsCube for every obstacle. 
+         * For each direction, a single scan over the world keeps the number of steps 
+         * from the last obstacle found along that direction
+         * 
+         * @param _coordinates Discrete coordinates of the obstacles
+         * @param _inflate_steps number of cells to inflate in each direction
+         */
+        void inflateCollisionsAsCube(const CoordinateList &_coordinates, const unsigned int _inflate_steps);
+
+        /**
+         * @brief Marks every cell whose euclidean distance (in cells) to an obstacle is lower 
+         * or equal than _inflate_steps, using an exact distance transform of the obstacles
+         * 
+         * @param _coordinates Discrete coordinates of the obstacles
+         * @param _inflate_steps inflation radius in cells
+         */
+        void inflateCollisionsAsSphere(const CoordinateList &_coordinates, const unsigned int _inflate_steps);
+
+        /**
+         * @brief Bounding box of the obstacles that can inflate cells inside the world, grown by _pad 
+         * and clipped to the world grown by _pad
+         * 
+         * @return false if no obstacle is close enough to the world
+         */
+        bool inflationBox(const CoordinateList &_coordinates, const Vec3i &_pad, Vec3i &_min, Vec3i &_max);
+
+        /**
+         * @brief Set as occupied the world cells marked in a box mask
+         * 
+         * @param _covered Mask of the box, x-major
+         * @param _box_min World coordinates of the first cell of the box
+         * @param _box_size Box dimensions
+         */
+        void markInflatedCells(const std::vector<uint8_t> &_covered, const Vec3i &_box_min, const Vec3i &_box_size);
         
         /**
-         * @brief Create a Result Data Object object
+         * @brief Fill the result of a search
          * 
-         * @param _last 
-         * @param _timer 
+         * @param _last Last node popped from the open list
+         * @param _timer Search timer, already stopped
          * @param _explored_nodes 
          * @param _solved 
          * @param _start 
          * @param _sight_checks 
-         * @return PathData 
+         * @param _result Output object. The path buffer is reused
+         */
+        void fillPlanResult(const Node* _last, utils::Clock &_timer, 
+                            const size_t _explored_nodes, bool _solved, 
+                            const Vec3i &_start, const unsigned int _sight_checks, PlanResult &_result);
+
+        /**
+         * @brief Costs accumulated along the adjacent cells of the path. Must be called
+         * before resetting the world, as it reads the H and C values of the search
+         * 
+         * @param _path 
+         * @param _statistics 
+         */
+        void computePathStatistics(const CoordinateList &_path, PathStatistics &_statistics);
+
+        /**
+         * @brief Report to the world change callback, if any, the cells at a distance lower or equal than _margin from _cell
+         */
+        inline void notifyWorldChange(const Vec3i &_cell, const int _margin){
+            if( world_change_callback_ )
+                world_change_callback_({_cell.x - _margin, _cell.y - _margin, _cell.z - _margin}, 
+                                       {_cell.x + _margin, _cell.y + _margin, _cell.z + _margin});
+        }
+        /**
+         * @brief Report to the world change callback, if any, the whole world
          */
-        virtual PathData createResultDataObject(const Node* _last, utils::Clock &_timer, 
-                                                const size_t _explored_nodes, bool _solved, 
-                                                const Vec3i &_start, const unsigned int _sight_checks);
+        inline void notifyWorldChange(){
+            if( world_change_callback_ ){
+                const auto size = discrete_world_.getWorldSize();
+                world_change_callback_({0, 0, 0}, {size.x - 1, size.y - 1, size.z - 1});
+            }
+        }
 
                                                         
         HeuristicFunction heuristic; /*!< TODO Comment */
@@ -246,10 +395,19 @@ namespace Planners
         utils::DiscreteWorld discrete_world_; /*!< TODO Comment */
         unsigned int inflate_steps_{1}; /*!< TODO Comment */
         bool do_inflate_{false}; /*!< TODO Comment */
+        InflationMode inflation_mode_{INFLATE_NODE_AS_CUBE}; /*!< Inflation implementation used by addCollisions */
 
         double cost_weight_{0}; /*!< TODO Comment */
         unsigned int max_line_of_sight_cells_{0}; /*!< TODO Comment */
 
+#ifdef COMPUTE_STATISTICS
+        bool compute_statistics_{true}; /*!< Fill PlanResult::statistics */
+#else
+        bool compute_statistics_{false}; /*!< Fill PlanResult::statistics */
+#endif
+        const SearchCorridor *corridor_{nullptr}; /*!< If set, neighbours outside the corridor are not explored */
+        WorldChangeFunction world_change_callback_; /*!< See setWorldChangeCallback */
+
         const std::string algorithm_name_{""}; /*!< TODO Comment */
 
     private:
@@ -0,0 +1,504 @@
+#ifndef HEURISTICSEARCH_HPP
+#define HEURISTICSEARCH_HPP
+/**
+ * @file HeuristicSearch.hpp
+ * @author Rafael Rey (reyarcenegui@gmail.com)
+ * @author Jose Antonio Cobano (jacobsua@upo.es)
+ * @brief Search core shared by A*, Theta*, Lazy Theta* and their cost aware versions.
+ * Each algorithm is a composition of a cost policy, a line of sight policy and an open list
+ * policy (see SearchPolicies.hpp). The old class names (AStar, ThetaStarM1, ...) are aliases
+ * of these compositions.
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <Planners/HeuristicSearchBase.hpp>
+#include <Planners/SearchPolicies.hpp>
+
+namespace Planners{
+
+    /**
+     * @brief Heuristic search algorithm resolved at compile time
+     *
+     * @tparam CostPolicy NoCostPolicy, CostAwarePolicy, CostAwareModPolicy, SirenCostPolicy or SafetyCostPolicy
+     * @tparam LineOfSightPolicy NoLineOfSight (A*), EagerLineOfSight (Theta*) or LazyLineOfSight (Lazy Theta*)
+     * @tparam OpenListPolicy MultiIndexOpenList or BinaryHeapOpenList
+     */
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy = MultiIndexOpenList>
+    class HeuristicSearch : public HeuristicSearchBase
+    {
+
+    public:
+        /**
+         * @brief Construct a new HeuristicSearch object
+         * @param _use_3d This parameter allows the user to choose between
+         * planning on a plane (8 directions possibles) or in the 3D full space (26 directions)
+         *
+         * @param _name Algorithm name stored internally
+         *
+         */
+        HeuristicSearch(bool _use_3d, std::string _name): HeuristicSearchBase(_use_3d, _name){
+            open_list_.reserve(50000);
+        }
+
+        /**
+         * @brief Construct a new HeuristicSearch object named after its policies, e.g. "lazythetastarm1"
+         *
+         * @param _use_3d
+         */
+        HeuristicSearch(bool _use_3d): HeuristicSearch(_use_3d, std::string(LineOfSightPolicy::prefix) + CostPolicy::suffix) {}
+
+        /**
+         * @brief Main function of the algorithm
+         *
+         * @param _source Start discrete coordinates. It should be a valid coordinates, i.e. it should not
+         * be marked as occupied and it should be inside the configured workspace.
+         * @param _target Goal discrete coordinates. It should be a valid coordinates, i.e. it should not
+         * be marked as occupied and it should be inside the configured workspace.
+         * @param loaded_sdf SIREN network, only queried by the SirenCostPolicy compositions
+         * @param _result Output, see PlanResult
+         */
+        void findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf, PlanResult &_result) override;
+
+    protected:
+
+        /**
+         * @brief Iterates over the neighbours of a node, skipping the explored or occupied ones,
+         * and computes their G and H values and parents.
+         *
+         * @param _current A pointer to the current node
+         * @param _target A reference to the target coordinates of the GOAL.
+         */
+        inline void exploreNeighbours(Node* _current, const Vec3i &_target);
+
+        /**
+         * @brief G function of A*: G of _current plus the distance to _suc plus the cost term
+         * of the cost policy
+         *
+         * @param _current Pointer to the current node
+         * @param _suc Pointer to the successor node
+         * @param _n_i The index of the direction in the directions vector.
+         * @param _dirs Number of directions used (to distinguish between 2D and 3D)
+         * @return unsigned int The G Value calculated by the function
+         */
+        inline unsigned int computeG(const Node* _current, Node* _suc, unsigned int _n_i, unsigned int _dirs){
+            return cost_.stepCost(_current, _suc, neighbourDistance(_n_i, _dirs));
+        }
+
+        /**
+         * @brief Theta* Update Vertex function. Re-orders _s2 in the open list if its G value decreased
+         *
+         * @param _s Pointer to node s
+         * @param _s2 Pointer to node s2
+         */
+        inline void UpdateVertex(Node *_s, Node *_s2);
+
+        /**
+         * @brief Theta* Compute cost function: tries to connect _s2 with the parent of _s.
+         * Lazy Theta* assumes line of sight, it is checked later in SetVertex
+         *
+         * @param _s_aux Pointer to node s
+         * @param _s2_aux Pointer to node s2
+         */
+        inline void ComputeCost(Node *_s_aux, Node *_s2_aux);
+
+        /**
+         * @brief Lazy Theta* Set Vertex function: if there is no line of sight between the
+         * node and its parent, the best closed neighbour is used as parent
+         *
+         * @param _s_aux Pointer to node s
+         */
+        inline void SetVertex(Node *_s_aux);
+
+        CostPolicy cost_; /*!< Cost policy, configured at the start of every search */
+        OpenListPolicy open_list_; /*!< Open list */
+    };
+
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy>
+    void HeuristicSearch<CostPolicy, LineOfSightPolicy, OpenListPolicy>::findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf, PlanResult &_result)
+    {
+        Node *current = nullptr;
+        bool solved{false};
+
+        source_parent_ = Node(_source);
+        discrete_world_.getNodePtr(_source)->parent = &source_parent_;
+        discrete_world_.setOpenValue(_source, true);
+        //Timer to record the execution time, not
+        //really important
+        utils::Clock main_timer;
+        main_timer.tic();
+
+        line_of_sight_checks_ = 0;
+        cost_.configure(cost_weight_, &loaded_sdf);
+
+        open_list_.insert(discrete_world_.getNodePtr(_source));
+
+        while (!open_list_.empty()) {
+            //Get the element at the start of the open set ordered by cost
+            Node *next = open_list_.pop();
+            if ( next == nullptr )
+                break;
+            current = next;
+
+            if (current->coordinates == _target) { solved = true; break; }
+
+            closedSet_.push_back(current);
+            //This flags are used to avoid search in the containers,
+            //for speed reasons.
+            current->isInOpenList = false;
+            current->isInClosedList = true;
+
+            if constexpr ( LineOfSightPolicy::lazy )
+                SetVertex(current);
+
+#if defined(ROS) && defined(PUB_EXPLORED_NODES)
+            publishROSDebugData(current, open_list_, closedSet_);
+#endif
+            exploreNeighbours(current, _target);
+        }
+        main_timer.toc();
+        fillPlanResult(current, main_timer, closedSet_.size(), solved, _source, line_of_sight_checks_, _result);
+        //Clear internal variables. This should be done
+        //the same way in every new algorithm implemented.
+#if defined(ROS) && defined(PUB_EXPLORED_NODES)
+        explored_node_marker_.points.clear();
+#endif
+        // Only the nodes touched by the search are reset, so the cost does not depend on the world size
+        if ( discrete_world_.isSparse() ) {
+            discrete_world_.resetWorld();
+        } else {
+            for (auto &it: closedSet_)
+                discrete_world_.resetNode(*it);
+            open_list_.forEachNode([this](Node *_node){ discrete_world_.resetNode(*_node); });
+            if ( current != nullptr )
+                discrete_world_.resetNode(*current);
+        }
+        closedSet_.clear();
+        open_list_.clear();
+    }
+
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy>
+    inline void HeuristicSearch<CostPolicy, LineOfSightPolicy, OpenListPolicy>::exploreNeighbours(Node* _current, const Vec3i &_target)
+    {
+        for (unsigned int i = 0; i < direction.size(); ++i) {
+
+            Vec3i newCoordinates = _current->coordinates + direction[i];
+            Node *successor = discrete_world_.getNodePtr(newCoordinates);
+            //Skip the neighbour if it is not valid, occupied, or already in the
+            //closed list
+            if ( successor == nullptr ||
+                 successor->isInClosedList ||
+                 successor->occuppied )
+                continue;
+            if ( corridor_ != nullptr && !corridor_->contains(newCoordinates) )
+                continue;
+
+            if constexpr ( !LineOfSightPolicy::any_angle ) {
+                unsigned int totalCost = computeG(_current, successor, i, direction.size());
+
+                if ( !successor->isInOpenList ) {
+                    successor->parent = _current;
+                    successor->G = totalCost;
+                    successor->H = heuristic(successor->coordinates, _target);
+                    successor->gplush = successor->G + successor->H;
+                    successor->isInOpenList = true;
+                    open_list_.insert(successor);
+                }
+                else if (totalCost < successor->G) {
+                    successor->parent = _current;
+                    successor->G = totalCost;
+                    successor->gplush = successor->G + successor->H;
+                    open_list_.update(successor);
+                }
+            } else {
+                if ( !successor->isInOpenList ) {
+                    successor->parent = _current;
+                    successor->G = computeG(_current, successor, i, direction.size());
+                    successor->H = heuristic(successor->coordinates, _target);
+                    successor->gplush = successor->G + successor->H;
+                    successor->isInOpenList = true;
+                    open_list_.insert(successor);
+                }
+
+                UpdateVertex(_current, successor);
+            }
+        }
+    }
+
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy>
+    inline void HeuristicSearch<CostPolicy, LineOfSightPolicy, OpenListPolicy>::UpdateVertex(Node *_s, Node *_s2)
+    {
+        unsigned int g_old = _s2->G;
+
+        ComputeCost(_s, _s2);
+        if (_s2->G < g_old)
+            open_list_.update(_s2);
+    }
+
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy>
+    inline void HeuristicSearch<CostPolicy, LineOfSightPolicy, OpenListPolicy>::ComputeCost(Node *_s_aux, Node *_s2_aux)
+    {
+        if constexpr ( LineOfSightPolicy::lazy ) {
+
+            if constexpr ( CostPolicy::edge_cost ) {
+                line_of_sight_checks_++;
+                if (LineOfSight::bresenham3D(_s_aux->parent, _s2_aux, discrete_world_, checked_nodes)) {
+
+                    los_neighbour_ = true;
+
+                    auto dist2   = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+                    auto edge2   = cost_.edgeCost(checked_nodes, _s_aux->parent, _s2_aux, discrete_world_);
+
+                    if ( ( _s_aux->parent->G + dist2 + edge2 ) < _s2_aux->G )
+                    {
+                        _s2_aux->parent = _s_aux->parent;
+                        _s2_aux->G      = _s2_aux->parent->G + dist2 + edge2;
+                        _s2_aux->C      = edge2;
+                        _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                    }
+                }
+                checked_nodes->clear();
+            }
+            else if constexpr ( CostPolicy::node_cost ) {
+                auto distanceParent2 = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+
+                auto cost_term = cost_.lineTerm(_s_aux->parent, _s2_aux, discrete_world_, max_line_of_sight_cells_);
+                if ( ( _s_aux->parent->G + distanceParent2 + cost_term ) < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux->parent;
+                    _s2_aux->G      = _s2_aux->parent->G + geometry::distanceBetween2Nodes(_s2_aux->parent, _s2_aux) +  cost_term;
+                    _s2_aux->C      = cost_term;
+                }
+            }
+            else {
+                auto distanceParent2 = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+
+                if ( (_s_aux->parent->G + distanceParent2) < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux->parent;
+                    _s2_aux->G      = _s2_aux->parent->G + distanceParent2;
+                    _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                }
+            }
+
+        } else if constexpr ( CostPolicy::edge_cost ) {
+
+            line_of_sight_checks_++;
+            if (LineOfSight::bresenham3D(_s_aux->parent, _s2_aux, discrete_world_, checked_nodes))
+            {
+                auto dist2   = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+                auto edge2   = cost_.edgeCost(checked_nodes, _s_aux->parent, _s2_aux, discrete_world_);
+
+                line_of_sight_checks_++;
+                LineOfSight::bresenham3D(_s_aux, _s2_aux, discrete_world_, checked_nodes_current);
+
+                auto dist1   = geometry::distanceBetween2Nodes(_s_aux, _s2_aux);
+                auto edge1   = cost_.edgeCost(checked_nodes_current, _s_aux, _s2_aux, discrete_world_);
+
+                if ( ( _s_aux->parent->G + dist2 + edge2 ) < ( _s_aux->G + dist1 + edge1))
+                {
+                    _s2_aux->parent = _s_aux->parent;
+                    _s2_aux->G      = _s_aux->parent->G + dist2 + edge2;
+                    _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                    _s2_aux->C      = edge2;
+                }
+                else{
+                    _s2_aux->parent =_s_aux;
+                    _s2_aux->G      = _s_aux->G + dist1 + edge1;
+                    _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                    _s2_aux->C      = edge1;
+                }
+            } else {
+
+                _s2_aux->parent=_s_aux;
+
+                line_of_sight_checks_++;
+                LineOfSight::bresenham3D(_s_aux, _s2_aux, discrete_world_, checked_nodes);
+
+                auto dist1   = geometry::distanceBetween2Nodes(_s_aux, _s2_aux);
+                auto edge1   = cost_.edgeCost(checked_nodes, _s_aux, _s2_aux, discrete_world_);
+
+                _s2_aux->G      = _s_aux->G + dist1 + edge1;
+                _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                _s2_aux->C      = edge1;
+            }
+            checked_nodes->clear();
+            checked_nodes_current->clear();
+
+        } else if constexpr ( CostPolicy::node_cost ) {
+
+            auto distanceParent2 = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+            auto node_term = cost_.nodeTerm(_s2_aux);
+
+            line_of_sight_checks_++;
+            if (LineOfSight::bresenham3D(_s_aux->parent, _s2_aux, discrete_world_, checked_nodes))
+            {
+                auto n_checked_nodes = checked_nodes->size();
+                if (n_checked_nodes == 0)
+                    n_checked_nodes = 1;
+
+                auto cost_term = node_term * n_checked_nodes;
+                if ( (_s_aux->parent->G + distanceParent2 + cost_term) < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux->parent;
+                    _s2_aux->G      = _s_aux->parent->G + distanceParent2 + cost_term;
+                    _s2_aux->C      = cost_term;
+                    _s2_aux->gplush = _s2_aux->H + _s2_aux->G;
+                }
+
+            } else {
+                auto distance2 = geometry::distanceBetween2Nodes(_s_aux, _s2_aux);
+
+                unsigned int G_new = _s_aux->G + distance2 + node_term;
+                if ( G_new < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux;
+                    _s2_aux->G      = G_new;
+                    _s2_aux->C      = node_term;
+                    _s2_aux->gplush = _s2_aux->H + _s2_aux->G;
+                }
+            }
+            checked_nodes->clear();
+
+        } else {
+
+            auto distanceParent2 = geometry::distanceBetween2Nodes(_s_aux->parent, _s2_aux);
+            line_of_sight_checks_++;
+            if ( LineOfSight::bresenham3D(_s_aux->parent, _s2_aux, discrete_world_) )
+            {
+                if ( ( _s_aux->parent->G + distanceParent2 ) < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux->parent;
+                    _s2_aux->G      = _s_aux->parent->G + distanceParent2;
+                    _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                }
+
+            } else {
+
+                auto distance2 = geometry::distanceBetween2Nodes(_s_aux, _s2_aux);
+                if ( ( _s_aux->G + distance2 ) < _s2_aux->G )
+                {
+                    _s2_aux->parent = _s_aux;
+                    _s2_aux->G      = _s_aux->G + distance2;
+                    _s2_aux->gplush = _s2_aux->G + _s2_aux->H;
+                }
+            }
+        }
+    }
+
+    template<class CostPolicy, class LineOfSightPolicy, class OpenListPolicy>
+    inline void HeuristicSearch<CostPolicy, LineOfSightPolicy, OpenListPolicy>::SetVertex(Node *_s_aux)
+    {
+        if constexpr ( CostPolicy::edge_cost ) {
+            // ComputeCost already found line of sight from the parent
+            if( !los_neighbour_ ){
+
+                unsigned int G_max = std::numeric_limits<unsigned int>::max();
+                unsigned int G_new;
+
+                for (const auto &i: direction)
+                {
+                    Vec3i newCoordinates(_s_aux->coordinates + i);
+                    Node *successor2 = discrete_world_.getNodePtr(newCoordinates);
+                    if (successor2 == nullptr || successor2->occuppied ) continue;
+
+                    if ( successor2->isInClosedList )
+                    {
+                        auto dist = geometry::distanceBetween2Nodes(successor2, _s_aux);
+
+                        G_new  = static_cast<unsigned int>(  successor2-> G + dist +
+                        ( static_cast<double>(_s_aux->cost) + static_cast<double>(successor2->cost) ) / 2);
+
+                        if (G_new < G_max)
+                        {
+                            _s_aux->parent = successor2;
+                            _s_aux->G      = G_new;
+                            _s_aux->C      = (static_cast<double>(_s_aux->cost) + static_cast<double>(successor2->cost)) / 2;
+                            _s_aux->gplush = _s_aux->G + _s_aux->H;
+                        }
+                    }
+                }
+            }
+            los_neighbour_ = false;
+
+        } else if constexpr ( CostPolicy::node_cost ) {
+            line_of_sight_checks_++;
+            if (!LineOfSight::bresenham3DWithMaxThreshold(_s_aux->parent, _s_aux, discrete_world_, max_line_of_sight_cells_ ))
+            {
+                unsigned int G_max = std::numeric_limits<unsigned int>::max();
+                unsigned int G_new;
+
+                for (const auto &i: direction)
+                {
+                    Vec3i newCoordinates(_s_aux->coordinates + i);
+                    Node *successor2 = discrete_world_.getNodePtr(newCoordinates);
+                    if (successor2 == nullptr || successor2->occuppied ) continue;
+
+                    if ( successor2->isInClosedList )
+                    {
+                        auto cost_term = cost_.nodeTerm(successor2);
+                        G_new = successor2->G +  geometry::distanceBetween2Nodes(successor2, _s_aux) + cost_term;
+                        if (G_new < G_max)
+                        {
+                            _s_aux->parent = successor2;
+                            _s_aux->G      = G_new;
+                            _s_aux->C      = cost_term;
+                            _s_aux->gplush = _s_aux->G + _s_aux->H;
+                        }
+                    }
+                }
+            }
+
+        } else {
+            line_of_sight_checks_++;
+            if (!LineOfSight::bresenham3D(_s_aux->parent, _s_aux, discrete_world_))
+            {
+                unsigned int G_max = std::numeric_limits<unsigned int>::max();
+                unsigned int G_new;
+
+                for (const auto &i: direction)
+                {
+                    Vec3i newCoordinates(_s_aux->coordinates + i);
+                    Node *successor2 = discrete_world_.getNodePtr(newCoordinates);
+
+                    if (successor2 == nullptr || successor2->occuppied ) continue;
+
+                    if ( successor2->isInClosedList )
+                    {
+                        G_new = successor2->G + geometry::distanceBetween2Nodes(successor2, _s_aux);
+                        if (G_new < G_max)
+                        {
+                            G_max = G_new;
+                            _s_aux->parent = successor2;
+                            _s_aux->G = G_new;
+                            _s_aux->gplush = _s_aux->G + _s_aux->H;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+     The compositions used by the package are explicitly instantiated in
+     HeuristicSearch.cpp (see the alias headers, e.g. LazyThetaStarM1.hpp)
+     */
+    extern template class HeuristicSearch<NoCostPolicy,       NoLineOfSight>;
+    extern template class HeuristicSearch<CostAwarePolicy,    NoLineOfSight>;
+    extern template class HeuristicSearch<SafetyCostPolicy,   NoLineOfSight>;
+    extern template class HeuristicSearch<SirenCostPolicy,    NoLineOfSight>;
+    extern template class HeuristicSearch<NoCostPolicy,       EagerLineOfSight>;
+    extern template class HeuristicSearch<CostAwarePolicy,    EagerLineOfSight>;
+    extern template class HeuristicSearch<SafetyCostPolicy,   EagerLineOfSight>;
+    extern template class HeuristicSearch<SirenCostPolicy,    EagerLineOfSight>;
+    extern template class HeuristicSearch<NoCostPolicy,       LazyLineOfSight>;
+    extern template class HeuristicSearch<CostAwarePolicy,    LazyLineOfSight>;
+    extern template class HeuristicSearch<CostAwareModPolicy, LazyLineOfSight>;
+    extern template class HeuristicSearch<SafetyCostPolicy,   LazyLineOfSight>;
+    extern template class HeuristicSearch<SirenCostPolicy,    LazyLineOfSight>;
+
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef HEURISTICSEARCHBASE_HPP
+#define HEURISTICSEARCHBASE_HPP
+/**
+ * @file HeuristicSearchBase.hpp
+ * @author Rafael Rey (reyarcenegui@gmail.com)
+ * @author Jose Antonio Cobano (jacobsua@upo.es)
+ * @brief Non templated part of the heuristic search algorithms (A*, Theta*, Lazy Theta* and
+ * their cost aware versions): the containers shared by the search loop and the ROS debug features.
+ * The search itself is implemented by the HeuristicSearch template.
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <Planners/AlgorithmBase.hpp>
+
+
+/**
+ * @brief
+ * This Header includes some auxiliar ROS features
+ * that the search algorithms as Lazy Theta* and so on will inherit
+ * These ROS Debug helps the user analyzing the inner
+ * behavior of the algorithm, allowing step-by-step node processing
+ * and visualizing the open and closed set in RViz.
+ *
+ */
+#ifdef ROS
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+#include <chrono>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_ros/point_cloud.h>
+#include "utils/ros/ROSInterfaces.hpp"
+#include "utils/FCNet.hpp"
+#include <torch/script.h>
+#endif
+
+namespace Planners{
+
+    /**
+     * @brief Common base of the HeuristicSearch compositions
+     *
+     */
+    class HeuristicSearchBase : public AlgorithmBase
+    {
+
+    public:
+        /**
+         * @brief Construct a new HeuristicSearchBase object
+         * @param _use_3d This parameter allows the user to choose between
+         * planning on a plane (8 directions possibles) or in the 3D full space (26 directions)
+         *
+         * @param _name Algorithm name stored internally
+         *
+         */
+        HeuristicSearchBase(bool _use_3d, std::string _name);
+
+        /**
+         * @brief Published occupation markers map to visualize the loaded map in RVIZ
+         * if the package is compiled without the ROS definition in the CMakeLists, this function will
+         * be empty. It can help the user to verify if the inflation parameters produced the desired result.
+         */
+        void publishOccupationMarkersMap() override;
+
+        /**
+         * @brief Published occupation marker map to visualize the loaded LOCAL map in RVIZ
+         * if the package is compiled without the ROS definition in the CMakeLists, this function will
+         * be empty. It can help the user to verify if the inflation parameters produced the desired result.
+         */
+        void publishLocalOccupationMarkersMap() override;
+
+        /**
+         * @brief For this function to be compiled you should
+         * enable in CMakeLists all the ROS Related options (ROS and PUB_EXPLORED_NODES macros)
+         *
+         * Note: If you want to do STEP BY STEP evaluation, uncomment the
+         * getchar(); line at the end of this function, and you will be able
+         * to advance in the exploration just pressing a key.
+         *
+         * @param _node The current node the algorithm is evaluating. Will be marked as a
+         * sphere to distinguish it between the open set and closed set markers
+         * @param _open_set: The closed set container
+         * @param _closed_set: The open set container
+         */
+        template<typename T, typename U>
+        void publishROSDebugData(const Node* _node, const T &_open_set, const U &_closed_set);
+
+    protected:
+
+        /**
+         * @brief This function is called by the constructor.
+         * It reserves 50000 nodes in the closed set and 5000 in the line of sight
+         * containers to avoid container resizing operations.
+         * If ROS macro is defined through CMake, it will also configure the markers
+         * publishers and the markers objects
+         */
+        void configAlgorithm();
+
+        /**
+         * @brief Step cost between two adjacent nodes, i.e. the distance component
+         * of the G function of A*
+         *
+         * @param _n_i The index of the direction in the directions vector
+         * @param _dirs Number of directions used (to distinguish between 2D and 3D)
+         * @return unsigned int
+         */
+        inline unsigned int neighbourDistance(unsigned int _n_i, unsigned int _dirs) const{
+            if(_dirs == 8)
+                return (_n_i < 4 ? dist_scale_factor_ : dd_2D_); //This is more efficient
+
+            return (_n_i < 6 ? dist_scale_factor_ : (_n_i < 18 ? dd_2D_ : dd_3D_)); //This is more efficient
+        }
+
+        unsigned int line_of_sight_checks_{0};  /*!< TODO Comment */
+        std::vector<Node*> closedSet_; /*!< TODO Comment */
+        Node source_parent_; /*!< Parent of the start node, reused between searches. The path ends with the start coordinates twice */
+
+        utils::CoordinateListPtr checked_nodes, checked_nodes_current; /*!< Cells traversed by the last line of sight checks */
+
+        bool los_neighbour_{false}; /*!< Lazy Theta* with edge costs: the last ComputeCost found line of sight from the parent, so SetVertex is skipped */
+
+#ifdef ROS
+        ros::NodeHandle lnh_{"~"}; /*!< TODO Comment */
+        ros::Publisher explored_nodes_marker_pub_, occupancy_marker_pub_, local_occupancy_marker_pub_, /*!< TODO Comment */
+                       openset_marker_pub_, closedset_marker_pub_, /*!< TODO Comment */
+                       best_node_marker_pub_, aux_text_marker_pub_; /*!< TODO Comment */
+        visualization_msgs::Marker explored_node_marker_, openset_markers_,  /*!< TODO Comment */
+                                   closed_set_markers_, best_node_marker_, aux_text_marker_; /*!< TODO Comment */
+        ros::Duration duration_pub_{0.001}; /*!< TODO Comment */
+        ros::Time last_publish_tamp_; /*!< TODO Comment */
+        float resolution_; /*!< TODO Comment */
+    	pcl::PointCloud<pcl::PointXYZ>  occupancy_marker_, local_occupancy_marker_;  /*!< TODO Comment */
+
+#endif
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+template<typename T, typename U>
+void HeuristicSearchBase::publishROSDebugData(const Node* _node, const T &_open_set, const U &_closed_set)
+{
+#if defined(ROS) && defined(PUB_EXPLORED_NODES)
+    if( (ros::Time::now() - last_publish_tamp_ ).toSec() > duration_pub_.toSec() ){
+        last_publish_tamp_ = ros::Time::now();
+        explored_node_marker_.header.stamp = ros::Time();
+        explored_node_marker_.header.seq++;
+        openset_markers_.header.stamp = ros::Time();
+        openset_markers_.header.seq++;
+        closed_set_markers_.header.stamp = ros::Time();
+        closed_set_markers_.header.seq++;
+
+        openset_markers_.points.clear();
+        closed_set_markers_.points.clear();
+
+        explored_node_marker_.points.push_back(continousPoint(_node->coordinates, resolution_));
+
+        for(const auto &it: _open_set)
+            openset_markers_.points.push_back(continousPoint(it->coordinates, resolution_));
+
+        for(const auto &it: _closed_set)
+            closed_set_markers_.points.push_back(continousPoint(it->coordinates, resolution_));
+
+        best_node_marker_.pose.position = continousPoint(_node->coordinates, resolution_);
+        best_node_marker_.pose.position.z += resolution_;
+
+        aux_text_marker_.text = "Best node G = " + std::to_string(_node->G) + "\nBest node G+H = " + std::to_string(_node->G+_node->H) +
+                     std::string("\nCost = ") + std::to_string(static_cast<int>(cost_weight_ * _node->cost * (dist_scale_factor_/100)));
+	    aux_text_marker_.pose = best_node_marker_.pose;
+        aux_text_marker_.pose.position.z += 5 * resolution_;
+
+        closedset_marker_pub_.publish(closed_set_markers_);
+        openset_marker_pub_.publish(openset_markers_);
+        best_node_marker_pub_.publish(best_node_marker_);
+        explored_nodes_marker_pub_.publish(explored_node_marker_);
+        aux_text_marker_pub_.publish(aux_text_marker_);
+        // usleep(1e4);
+        // std::cout << "Please a key to go to the next iteration..." << std::endl;
+        // getchar(); // Comentar para no usar tecla.
+    }
+
+#endif
+
+}
+#pragma GCC diagnostic pop
+
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef HIERARCHICALPLANNER_HPP
+#define HIERARCHICALPLANNER_HPP
+/**
+ * @file HierarchicalPlanner.hpp
+ * @brief Hierarchical path planning (HPA*) on top of any of the algorithms of the package.
+ *
+ * The world is partitioned in clusters (cubes of cluster_size cells, squares in 2D). Every
+ * connected free region of the face between two adjacent clusters is an entrance, represented
+ * by a transition between one cell at each side. The abstract graph has the transition cells as
+ * nodes, connected by the step between the two sides of each transition and by the grid distances
+ * inside each cluster, precomputed with Dijkstra.
+ *
+ * A query connects the start and the goal to the entrances of their clusters, searches the abstract
+ * graph and then runs the wrapped algorithm restricted to the corridor of clusters of the abstract
+ * path, so the cost of a query depends on the length of the path and not on the size of the world.
+ *
+ * Every change of the occupancy made through the algorithm (see AlgorithmBase::setWorldChangeCallback)
+ * marks the clusters it touches as dirty. The dirty clusters and their neighbours are rebuilt before
+ * the next query.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <vector>
+#include <cstdint>
+
+#include "Planners/AlgorithmBase.hpp"
+#include "utils/SearchCorridor.hpp"
+
+namespace Planners
+{
+    class HierarchicalPlanner
+    {
+    public:
+        /**
+         * @brief Construct a new Hierarchical Planner object. build() must be called once the map is loaded
+         *
+         * @param _algorithm Algorithm used to refine the abstract path. Its world is the one partitioned.
+         * It must outlive the hierarchical planner
+         * @param _use_3d Same value used to construct the algorithm
+         * @param _cluster_size Cells of each cluster side
+         */
+        HierarchicalPlanner(AlgorithmBase &_algorithm, const bool _use_3d, const unsigned int _cluster_size = 16);
+
+        /**
+         * @brief Removes the world change callback of the algorithm. Only one hierarchical planner
+         * can wrap an algorithm at a time
+         */
+        ~HierarchicalPlanner();
+
+        HierarchicalPlanner(const HierarchicalPlanner &) = delete;
+        HierarchicalPlanner& operator=(const HierarchicalPlanner &) = delete;
+
+        /**
+         * @brief Compute the whole abstraction, one cluster per thread
+         *
+         * @param _n_threads 0 to use one thread per core. Also used for the updates before each query
+         */
+        void build(unsigned int _n_threads = 0);
+
+        /**
+         * @brief Calls the addCollision of the algorithm, which marks the clusters that the inflated obstacle can change
+         */
+        void addCollision(const Vec3i &_coordinates);
+
+        /**
+         * @brief Calls the addCollisions of the algorithm, which marks the clusters that the inflated obstacles can change
+         */
+        void addCollisions(const CoordinateList &_coordinates);
+
+        /**
+         * @brief Calls the removeCollision of the algorithm, which marks the cluster of the cell if it was occupied
+         */
+        void removeCollision(const Vec3i &_coordinates);
+
+        /**
+         * @brief Mark as dirty the clusters with cells at a distance lower or equal than _margin from _cell.
+         * Only needed if the world of the algorithm is modified directly, through getInnerWorld()
+         */
+        void markDirty(const Vec3i &_cell, const unsigned int _margin = 0);
+
+        /**
+         * @brief Mark as dirty the clusters with cells inside a box. It is clipped to the world
+         *
+         * @param _min First cell of the box
+         * @param _max Last cell of the box (inclusive)
+         */
+        void markDirty(const Vec3i &_min, const Vec3i &_max);
+
+        /**
+         * @brief Same interface as AlgorithmBase::findPath. time_spent includes the abstract search.
+         * If the corridor search fails (e.g. the only way between two clusters is through a diagonal step
+         * across an edge) the whole world is searched, unless the fallback is disabled (see setFullWorldFallback).
+         * usedFallback() reports it
+         */
+        void findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf, PlanResult &_result);
+
+        /**
+         * @brief Search the whole world when there is no path inside the corridor (default). If disabled, 
+         * those queries are not solved
+         */
+        void setFullWorldFallback(const bool _fallback){ full_world_fallback_ = _fallback; }
+
+        /**
+         * @brief True if the last query had no path inside the corridor and searched the whole world
+         */
+        bool usedFallback() const { return used_fallback_; }
+
+        /**
+         * @brief Grow the corridor by _dilation clusters in every direction. Gives room to
+         * the any-angle algorithms to shorten the path, at the cost of more explored nodes
+         */
+        void setCorridorDilation(const unsigned int _dilation){ corridor_dilation_ = _dilation; }
+
+        /**
+         * @brief Number of nodes of the abstract graph
+         */
+        size_t getAbstractNodes() const;
+
+        /**
+         * @brief Clusters traversed by the last abstract path, before the dilation
+         */
+        size_t getLastCorridorSize() const { return last_corridor_size_; }
+
+    private:
+
+        struct Transition
+        {
+            Vec3i inside;  /*!< Cell in the cluster that owns the face */
+            Vec3i outside; /*!< Cell in the next cluster along the axis of the face */
+        };
+
+        struct Entrance
+        {
+            Vec3i cell;
+            Vec3i other;    /*!< Cell at the other side of the transition */
+            int neighbour;  /*!< Cluster of the other cell */
+            int partner{-1}; /*!< Index of the other cell in the entrances of the neighbour */
+        };
+
+        struct Cluster
+        {
+            std::vector<Entrance> entrances;
+            std::vector<uint32_t> distances; /*!< Distance between entrances i and j at i * n + j */
+        };
+
+        void update(unsigned int _n_threads = 1);
+
+        /**
+         * @brief Recompute the transitions of a face
+         *
+         * @return true if they changed
+         */
+        bool buildFace(const int _cluster, const int _axis);
+
+        void buildCluster(const int _cluster);
+
+        void resolvePartners(const int _cluster);
+
+        /**
+         * @brief Dijkstra from _source restricted to the box of _cluster
+         */
+        void clusterDistances(const int _cluster, const Vec3i &_source, std::vector<uint32_t> &_distances) const;
+
+        /**
+         * @brief Search the abstract graph and fill the corridor
+         *
+         * @return false if the goal is not reachable in the abstract graph
+         */
+        bool abstractSearch(const Vec3i &_source, const Vec3i &_target);
+
+        inline Vec3i clusterCoordinates(const Vec3i &_cell) const{
+            return {_cell.x / cluster_size_.x, _cell.y / cluster_size_.y, _cell.z / cluster_size_.z};
+        }
+        inline int clusterOf(const Vec3i &_cell) const{
+            return static_cast<int>(corridor_.clusterIndex(clusterCoordinates(_cell)));
+        }
+        inline Vec3i clusterFromIndex(const int _index) const{
+            return {_index % n_clusters_.x, ( _index / n_clusters_.x ) % n_clusters_.y, _index / ( n_clusters_.x * n_clusters_.y )};
+        }
+        /**
+         * @brief Index of the neighbour cluster along _axis (0, 1 or 2) in direction _sign, -1 if outside the world
+         */
+        int neighbourCluster(const int _cluster, const int _axis, const int _sign) const;
+
+        /**
+         * @brief First and last + 1 cells of a cluster
+         */
+        void clusterBox(const int _cluster, Vec3i &_min, Vec3i &_max) const;
+
+        static constexpr uint32_t unreachable_{0xFFFFFFFF};
+
+        AlgorithmBase &algorithm_;
+        const DiscreteWorld &world_;
+        bool use_3d_;
+        Vec3i world_size_;
+        Vec3i cluster_size_;
+        Vec3i n_clusters_;
+        unsigned int n_axes_;
+        unsigned int n_threads_{1};
+
+        std::vector<std::vector<Transition>> faces_; /*!< Face between cluster c and the next one along axis a at c * 3 + a */
+        std::vector<Cluster> clusters_;
+        std::vector<uint8_t> dirty_;
+        std::vector<int> dirty_list_;
+
+        SearchCorridor corridor_;
+        std::vector<int> corridor_list_; /*!< Clusters set in the corridor mask, to clear them in the next query */
+        unsigned int corridor_dilation_{0};
+        size_t last_corridor_size_{0};
+        bool full_world_fallback_{true};
+        bool used_fallback_{false};
+    };
+
+}
+
+#endif
@@ -0,0 +1,376 @@
+#ifndef SEARCHPOLICIES_HPP
+#define SEARCHPOLICIES_HPP
+/**
+ * @file SearchPolicies.hpp
+ * @brief Policies composed by the HeuristicSearch template. Each algorithm of the
+ * package is a combination of:
+ *
+ *  - A cost policy: how the cell costs of the world are added to the G function.
+ *  - A line of sight policy: A* (none), Theta* (checked when expanding) or Lazy Theta*
+ *    (checked when the node is popped from the open list).
+ *  - An open list policy: the container used to get the node with the lowest G + H.
+ *
+ * Policies are resolved at compile time, so the calls inside the search loop are inlined
+ * instead of going through virtual functions.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "utils/utils.hpp"
+#include "utils/world.hpp"
+#include "utils/LineOfSight.hpp"
+
+#include <torch/script.h>
+
+namespace Planners
+{
+    using namespace utils;
+
+    /**
+     * @brief Distance only. The cell cost is stored in the C field of the nodes.
+     *
+     */
+    class NoCostPolicy
+    {
+    public:
+        static constexpr const char *suffix{""};
+        static constexpr bool node_cost{false}; /*!< Cost term computed from the cost of a single cell */
+        static constexpr bool edge_cost{false}; /*!< Cost term computed from the cells traversed by an edge */
+
+        void configure(double _cost_weight, torch::jit::script::Module *_sdf){}
+
+        /**
+         * @brief G value of _suc when reached from _current through a step of length _distance
+         */
+        inline unsigned int stepCost(const Node *_current, Node *_suc, unsigned int _distance) const{
+            _suc->C = _suc->cost;
+            return _current->G + _distance;
+        }
+    };
+
+    /**
+     * @brief Cost aware (M1) algorithms: each cell adds cost_weight / cell cost, so
+     * cells with small cost values (close to the obstacles) are penalized.
+     *
+     */
+    class CostAwarePolicy
+    {
+    public:
+        static constexpr const char *suffix{"m1"};
+        static constexpr bool node_cost{true};
+        static constexpr bool edge_cost{false};
+
+        void configure(double _cost_weight, torch::jit::script::Module *_sdf){ cost_weight_ = _cost_weight; }
+
+        /**
+         * @brief Cost term of a single cell
+         */
+        inline unsigned int nodeTerm(const Node *_node) const{
+            return static_cast<unsigned int>(cost_weight_ / (_node->cost * dist_scale_factor_reduced_));
+        }
+
+        inline unsigned int stepCost(const Node *_current, Node *_suc, unsigned int _distance) const{
+            auto cost_term = nodeTerm(_suc);
+            _suc->C = cost_term;
+            return _current->G + _distance + cost_term;
+        }
+
+        /**
+         * @brief Cost term of the straight line from _parent to _node used by Lazy Theta*:
+         * the term of _node repeated for every cell of the line
+         */
+        inline unsigned int lineTerm(const Node *_parent, const Node *_node, const DiscreteWorld &_world, unsigned int _max_line_of_sight_cells) const{
+            auto line_nodes = LineOfSight::nodesInLineBetweenTwoNodes(_parent, _node, _world, _max_line_of_sight_cells);
+            if ( line_nodes == 0 )
+                line_nodes = 1;
+
+            return nodeTerm(_node) * line_nodes;
+        }
+
+    protected:
+        double cost_weight_{0};
+    };
+
+    /**
+     * @brief Lazy Theta* M1 modification: the line term of the lazy update is
+     * cost_weight * cell cost, without walking the line
+     *
+     */
+    class CostAwareModPolicy : public CostAwarePolicy
+    {
+    public:
+        static constexpr const char *suffix{"m1mod"};
+
+        inline unsigned int lineTerm(const Node *_parent, const Node *_node, const DiscreteWorld &_world, unsigned int _max_line_of_sight_cells) const{
+            return static_cast<unsigned int>(cost_weight_ * _node->cost * dist_scale_factor_reduced_);
+        }
+    };
+
+    /**
+     * @brief Same as CostAwarePolicy but the distance to the closest obstacle is queried to the
+     * SIREN network instead of being read from the cell
+     *
+     */
+    class SirenCostPolicy : public CostAwarePolicy
+    {
+    public:
+        static constexpr const char *suffix{"siren"};
+
+        void configure(double _cost_weight, torch::jit::script::Module *_sdf){
+            cost_weight_ = _cost_weight;
+            sdf_ = _sdf;
+        }
+
+        inline unsigned int nodeTerm(const Node *_node) const{
+            torch::NoGradGuard no_grad;
+            torch::Tensor input_tensor = torch::tensor({{static_cast<float>(_node->coordinates.x * map_resolution_),
+                                                         static_cast<float>(_node->coordinates.y * map_resolution_),
+                                                         static_cast<float>(_node->coordinates.z * map_resolution_)}}, torch::kFloat32);
+            float model_output = sdf_->forward({input_tensor}).toTensor().item<float>();
+
+            return static_cast<unsigned int>(cost_weight_ / (model_output * dist_scale_factor_reduced_));
+        }
+
+        inline unsigned int stepCost(const Node *_current, Node *_suc, unsigned int _distance) const{
+            auto cost_term = nodeTerm(_suc);
+            _suc->C = cost_term;
+            return _current->G + _distance + cost_term;
+        }
+
+        inline unsigned int lineTerm(const Node *_parent, const Node *_node, const DiscreteWorld &_world, unsigned int _max_line_of_sight_cells) const{
+            auto line_nodes = LineOfSight::nodesInLineBetweenTwoNodes(_parent, _node, _world, _max_line_of_sight_cells);
+            if ( line_nodes == 0 )
+                line_nodes = 1;
+
+            return nodeTerm(_node) * line_nodes;
+        }
+
+    private:
+        static constexpr double map_resolution_{0.2}; /*!< Resolution of the maps the network has been trained with */
+        torch::jit::script::Module *sdf_{nullptr};
+    };
+
+    /**
+     * @brief Safety cost (M2) algorithms: each edge adds the mean cost of the
+     * cells it traverses, scaled by cost_weight
+     *
+     */
+    class SafetyCostPolicy
+    {
+    public:
+        static constexpr const char *suffix{"m2"};
+        static constexpr bool node_cost{false};
+        static constexpr bool edge_cost{true};
+
+        void configure(double _cost_weight, torch::jit::script::Module *_sdf){ cost_weight_ = _cost_weight; }
+
+        inline unsigned int stepCost(const Node *_current, Node *_suc, unsigned int _distance) const{
+            double cc = ( _current->cost + _suc->cost ) / 2;
+
+            auto edge_neighbour = static_cast<unsigned int>( cc * cost_weight_ * dist_scale_factor_reduced_);
+            _suc->C = edge_neighbour;
+
+            return _distance + ( _current->G + edge_neighbour );
+        }
+
+        /**
+         * @brief Cost term of the edge from _s to _s2
+         *
+         * @param _checked_nodes cells traversed by the line of sight check of the edge
+         */
+        inline unsigned int edgeCost(const utils::CoordinateListPtr _checked_nodes, const Node *_s, const Node *_s2, DiscreteWorld &_world) const{
+
+            double dist_cost{0};
+            double mean_dist_cost{0};
+
+            auto n_checked_nodes = _checked_nodes->size();
+            if( n_checked_nodes >= 1 )
+                for(auto &it: *_checked_nodes)
+                    dist_cost += _world.getNodePtr(it)->cost;
+
+            if( n_checked_nodes > 1){
+                mean_dist_cost = (( _s->cost - _s2->cost ) / 2) + dist_cost;
+            }
+            else if (n_checked_nodes == 1){
+                mean_dist_cost = (( _s->cost + _s2->cost ) / 2) + dist_cost;
+            }
+            else{
+                mean_dist_cost = (( _s->cost + _s2->cost ) / 2);
+            }
+            return static_cast<unsigned int>( mean_dist_cost * cost_weight_ * dist_scale_factor_reduced_);
+        }
+
+    private:
+        double cost_weight_{0};
+    };
+
+    /**
+     * @brief A*: the parent of a node is always one of its neighbours
+     *
+     */
+    struct NoLineOfSight
+    {
+        static constexpr const char *prefix{"astar"};
+        static constexpr bool any_angle{false};
+        static constexpr bool lazy{false};
+    };
+
+    /**
+     * @brief Theta*: line of sight to the parent of the expanded node is checked for every neighbour
+     *
+     */
+    struct EagerLineOfSight
+    {
+        static constexpr const char *prefix{"thetastar"};
+        static constexpr bool any_angle{true};
+        static constexpr bool lazy{false};
+    };
+
+    /**
+     * @brief Lazy Theta*: line of sight is assumed when expanding and checked when
+     * the node is popped from the open list
+     *
+     */
+    struct LazyLineOfSight
+    {
+        static constexpr const char *prefix{"lazythetastar"};
+        static constexpr bool any_angle{true};
+        static constexpr bool lazy{true};
+    };
+
+    /**
+     * @brief Open list over the MagicalMultiSet: ordered by G + H and indexed by world position,
+     * so updating a node erases and re-inserts it. Nodes with the same G + H are popped in
+     * insertion order.
+     *
+     */
+    class MultiIndexOpenList
+    {
+    public:
+        MultiIndexOpenList(): by_cost_(set_.get<IndexByCost>()), by_position_(set_.get<IndexByWorldPosition>()) {}
+
+        void reserve(size_t _size){ set_.reserve(_size); }
+
+        inline bool empty() const { return by_cost_.empty(); }
+
+        inline void insert(Node *_node){ by_cost_.insert(_node); }
+
+        inline Node* pop(){
+            Node *node = *by_cost_.begin();
+            by_cost_.erase(by_cost_.begin());
+            return node;
+        }
+
+        /**
+         * @brief Re-orders a node already in the open list after its G + H value changed
+         */
+        inline void update(Node *_node){
+            auto found = by_position_.find(_node->world_index);
+            by_position_.erase(found);
+            by_position_.insert(_node);
+        }
+
+        void clear(){ set_.clear(); }
+
+        /**
+         * @brief Calls _function for every node in the list
+         */
+        template<typename Function>
+        void forEachNode(Function _function) const{
+            for(const auto &it: by_cost_)
+                _function(it);
+        }
+
+        node_by_cost::const_iterator begin() const { return by_cost_.begin(); }
+        node_by_cost::const_iterator end() const { return by_cost_.end(); }
+
+    private:
+        MagicalMultiSet set_;
+        node_by_cost &by_cost_;
+        node_by_position &by_position_;
+    };
+
+    /**
+     * @brief Binary heap open list with lazy deletion: an update pushes a new entry and the
+     * outdated ones are skipped when they reach the top. Cheaper than the multi index container
+     * but, when an update keeps the same G + H value, the node keeps its previous position among the
+     * nodes with the same value.
+     *
+     */
+    class BinaryHeapOpenList
+    {
+    public:
+        struct Entry
+        {
+            unsigned int gplush;
+            uint64_t order;
+            Node *node;
+
+            const Node* operator->() const { return node; }
+        };
+
+        void reserve(size_t _size){ heap_.reserve(_size); }
+
+        inline bool empty() const { return heap_.empty(); }
+
+        inline void insert(Node *_node){
+            heap_.push_back({_node->gplush, order_++, _node});
+            std::push_heap(heap_.begin(), heap_.end(), Greater());
+        }
+
+        /**
+         * @brief Node with the lowest G + H, or nullptr if only outdated entries were left
+         */
+        inline Node* pop(){
+            while( !heap_.empty() ){
+                std::pop_heap(heap_.begin(), heap_.end(), Greater());
+                Entry top = heap_.back();
+                heap_.pop_back();
+
+                if( top.node->isInOpenList && top.gplush == top.node->gplush )
+                    return top.node;
+            }
+            return nullptr;
+        }
+
+        inline void update(Node *_node){ insert(_node); }
+
+        void clear(){
+            heap_.clear();
+            order_ = 0;
+        }
+
+        /**
+         * @brief Calls _function for every entry in the heap, outdated ones included
+         */
+        template<typename Function>
+        void forEachNode(Function _function) const{
+            for(const auto &it: heap_)
+                _function(it.node);
+        }
+
+        std::vector<Entry>::const_iterator begin() const { return heap_.begin(); }
+        std::vector<Entry>::const_iterator end() const { return heap_.end(); }
+
+    private:
+        struct Greater
+        {
+            bool operator()(const Entry &_a, const Entry &_b) const {
+                return _a.gplush > _b.gplush || ( _a.gplush == _b.gplush && _a.order > _b.order );
+            }
+        };
+
+        std::vector<Entry> heap_;
+        uint64_t order_{0};
+    };
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef CERES_ANALYTIC_UTILS
+#define CERES_ANALYTIC_UTILS
+
+#include <cmath>
+
+// Helpers shared by the analytic (SizedCostFunction) versions of the trajectory constraints.
+// They reproduce exactly the branches used by the templated autodiff functors, so that both
+// versions return the same residual and the same derivatives.
+
+namespace CeresAnalytic{
+
+    // Norm with the same dead zone used by the functors: |v|^2 < 0.0001 -> norm = 0 (and zero derivative)
+    inline double clampedNorm(const double v[3])
+    {
+        double arg = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+        if (arg < 0.0001 && arg > -0.0001)
+            return 0.0;
+        return std::sqrt(arg);
+    }
+
+    // cos(angle) between a and b and its gradient w.r.t. both vectors.
+    // Returns false (cos = 0, gradients = 0) in the degenerate case, as the autodiff functors do.
+    inline bool cosineWithGradient(const double a[3], const double b[3], double &cos_angle, double dcos_da[3], double dcos_db[3])
+    {
+        double norm_a = clampedNorm(a);
+        double norm_b = clampedNorm(b);
+
+        if (norm_a < 0.0001 || norm_b < 0.0001)
+        {
+            cos_angle = 0.0;
+            for (int k = 0; k < 3; ++k)
+                dcos_da[k] = dcos_db[k] = 0.0;
+            return false;
+        }
+
+        double dot_product = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        double inv_norms = 1.0 / (norm_a * norm_b);
+        cos_angle = dot_product * inv_norms;
+
+        // d(cos)/da = b/(|a||b|) - cos * a/|a|^2  (and symmetric for b)
+        double inv_a2 = 1.0 / (norm_a * norm_a);
+        double inv_b2 = 1.0 / (norm_b * norm_b);
+        for (int k = 0; k < 3; ++k)
+        {
+            dcos_da[k] = b[k] * inv_norms - cos_angle * a[k] * inv_a2;
+            dcos_db[k] = a[k] * inv_norms - cos_angle * b[k] * inv_b2;
+        }
+        return true;
+    }
+
+    // Residual used by the angle-based constraints: maps cos in [-1, 1] linearly to [20, 0]
+    inline double cosineResidual(const double cos_angle)
+    {
+        const double min_expected_cos = -1.0;
+        const double max_expected_cos = 1.0;
+        const double min_cos_residual = 20.0;
+        const double max_cos_residual = 0.0;
+        return min_cos_residual + ((cos_angle - min_expected_cos) * (max_cos_residual - min_cos_residual) / (max_expected_cos - min_expected_cos));
+    }
+
+    // Derivative of cosineResidual w.r.t. cos
+    inline double cosineResidualSlope()
+    {
+        return (0.0 - 20.0) / (1.0 - (-1.0));
+    }
+
+    inline void zeroJacobian(double *jacobian, const int size)
+    {
+        for (int k = 0; k < size; ++k)
+            jacobian[k] = 0.0;
+    }
+}
+
+#endif
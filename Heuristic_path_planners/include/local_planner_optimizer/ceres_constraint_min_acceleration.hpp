@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -81,4 +83,62 @@ private:
 
 };
 
+// Analytic version of MinAccelerationFunctor (same residual, hand-derived jacobians)
+class MinAccelerationCostFunction : public SizedCostFunction<1, 6, 6> {
+
+public:
+    MinAccelerationCostFunction(double weight): weight_(weight) {}
+
+    virtual ~MinAccelerationCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+        const double* stateWP2 = parameters[1];
+
+        double vel_start[3] = {stateWP1[3], stateWP1[4], stateWP1[5]};
+        double vel_end[3] = {stateWP2[3], stateWP2[4], stateWP2[5]};
+
+        double cos_angle, dcos_dstart[3], dcos_dend[3];
+        CeresAnalytic::cosineWithGradient(vel_start, vel_end, cos_angle, dcos_dstart, dcos_dend);
+
+        double displacement[3] = {stateWP2[0] - stateWP1[0], stateWP2[1] - stateWP1[1], stateWP2[2] - stateWP1[2]};
+        double displacement_mod = std::sqrt(displacement[0] * displacement[0] + displacement[1] * displacement[1] + displacement[2] * displacement[2]);
+        bool clamped = false;
+        if (displacement_mod < 0.0001)
+        {
+            displacement_mod = 0.0001;
+            clamped = true;
+        }
+
+        double numerator = weight_ * CeresAnalytic::cosineResidual(cos_angle);
+        residuals[0] = numerator / displacement_mod;
+
+        if (jacobians == nullptr)
+            return true;
+
+        const double slope = weight_ * CeresAnalytic::cosineResidualSlope() / displacement_mod;
+        // d(1/|d|)/dWP2 = -d/|d|^3, zero when the displacement is clamped
+        const double dmod = clamped ? 0.0 : -numerator / (displacement_mod * displacement_mod * displacement_mod);
+        for (int k = 0; k < 3; ++k)
+        {
+            if (jacobians[0] != nullptr)
+            {
+                jacobians[0][k] = -dmod * displacement[k];
+                jacobians[0][k + 3] = slope * dcos_dstart[k];
+            }
+            if (jacobians[1] != nullptr)
+            {
+                jacobians[1][k] = dmod * displacement[k];
+                jacobians[1][k + 3] = slope * dcos_dend[k];
+            }
+        }
+
+        return true;
+    }
+
+    double weight_;
+
+};
+
 #endif
\ No newline at end of file
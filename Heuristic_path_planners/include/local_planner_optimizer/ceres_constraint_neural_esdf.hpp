@@ -0,0 +1,140 @@
+#ifndef CERES_CONSTRAINTS_NEURAL_ESDF
+#define CERES_CONSTRAINTS_NEURAL_ESDF
+
+#include <iostream>
+#include <vector>
+#include "Grid3D/local_grid3d.hpp"
+
+#include <torch/torch.h>
+#include <torch/script.h>
+
+#include <ceres/ceres.h>
+
+using ceres::SizedCostFunction;
+using ceres::EvaluationCallback;
+
+// Queries the SIREN network once per Ceres evaluation point for all the waypoints:
+// one batched forward (distances) and, when Ceres asks for jacobians, one backward pass
+// (gradients). The cost functions below only read the cached values.
+class NeuralEsdfEvaluationCallback : public EvaluationCallback {
+
+public:
+    NeuralEsdfEvaluationCallback(torch::jit::script::Module* loaded_sdf, Local_Grid3d* grid_): sdf_(loaded_sdf), g_3D(grid_) {}
+
+    virtual ~NeuralEsdfEvaluationCallback(void) {}
+
+    // Registers a waypoint parameter block and returns its index in the batch
+    int addWaypoint(double* parameter)
+    {
+        waypoints_.push_back(parameter);
+        dist_.push_back(0.0);
+        grad_.insert(grad_.end(), 3, 0.0);
+        return waypoints_.size() - 1;
+    }
+
+    virtual void PrepareForEvaluation(bool evaluate_jacobians, bool new_evaluation_point)
+    {
+        if (new_evaluation_point)
+            has_gradients_ = false;
+        else if (has_gradients_ || !evaluate_jacobians)
+            return;
+
+        const long num_points = waypoints_.size();
+        if (num_points == 0)
+            return;
+
+        // Waypoints are in local grid cells -> global coordinates of the network
+        torch::Tensor coordinates_tensor = torch::empty({num_points, 3}, torch::kFloat);
+        float* coordinates = coordinates_tensor.data_ptr<float>();
+        for (long i = 0; i < num_points; ++i)
+        {
+            coordinates[3*i]   = g_3D->m_originX + waypoints_[i][0] * g_3D->m_resolution;
+            coordinates[3*i+1] = g_3D->m_originY + waypoints_[i][1] * g_3D->m_resolution;
+            coordinates[3*i+2] = g_3D->m_originZ + waypoints_[i][2] * g_3D->m_resolution;
+        }
+
+        if (evaluate_jacobians)
+        {
+            // Every output only depends on its own input point, so the gradient of the sum gives all the per-point gradients
+            coordinates_tensor.set_requires_grad(true);
+            torch::Tensor output_tensor = sdf_->forward({coordinates_tensor}).toTensor().reshape({num_points});
+            output_tensor.sum().backward();
+
+            torch::Tensor output = output_tensor.detach().contiguous();
+            torch::Tensor gradient = coordinates_tensor.grad().contiguous();
+            const float* output_ptr = output.data_ptr<float>();
+            const float* gradient_ptr = gradient.data_ptr<float>();
+            for (long i = 0; i < num_points; ++i)
+            {
+                dist_[i] = output_ptr[i];
+                // d(dist)/d(cell) = d(dist)/d(meters) * resolution
+                for (int k = 0; k < 3; ++k)
+                    grad_[3*i+k] = gradient_ptr[3*i+k] * g_3D->m_resolution;
+            }
+            has_gradients_ = true;
+        }
+        else
+        {
+            torch::NoGradGuard no_grad;
+            torch::Tensor output = sdf_->forward({coordinates_tensor}).toTensor().reshape({num_points}).contiguous();
+            const float* output_ptr = output.data_ptr<float>();
+            for (long i = 0; i < num_points; ++i)
+                dist_[i] = output_ptr[i];
+        }
+    }
+
+    double distance(int index) const { return dist_[index]; }
+    const double* gradient(int index) const { return &grad_[3*index]; }
+
+private:
+    torch::jit::script::Module* sdf_;
+    Local_Grid3d* g_3D;
+    std::vector<double*> waypoints_;
+    std::vector<double> dist_, grad_;
+    bool has_gradients_{false};
+
+};
+
+// Same residual as ObstacleDistanceCostFunctor, but with the distance and gradient of the network
+class NeuralObstacleDistanceCostFunction : public SizedCostFunction<1, 6> {
+
+public:
+    NeuralObstacleDistanceCostFunction(NeuralEsdfEvaluationCallback* callback, double* parameter, double weight): callback_(callback), weight_(weight)
+    {
+        index_ = callback_->addWaypoint(parameter);
+    }
+
+    virtual ~NeuralObstacleDistanceCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const
+    {
+        double dist_ = callback_->distance(index_);
+
+        if (dist_ > 0.01)
+            residuals[0] = weight_ / dist_;
+        else
+            residuals[0] = weight_ * 100.0;
+
+        if (jacobians != nullptr && jacobians[0] != nullptr)
+        {
+            const double* grad = callback_->gradient(index_);
+            // Constant residual inside obstacles
+            double cte = dist_ > 0.01 ? -weight_ / (dist_ * dist_) : 0.0;
+            jacobians[0][0] = cte * grad[0];
+            jacobians[0][1] = cte * grad[1];
+            jacobians[0][2] = cte * grad[2];
+            jacobians[0][3] = 0.0;
+            jacobians[0][4] = 0.0;
+            jacobians[0][5] = 0.0;
+        }
+        return true;
+    }
+
+    NeuralEsdfEvaluationCallback* callback_;
+    double weight_;
+    int index_;
+
+private:
+};
+
+#endif
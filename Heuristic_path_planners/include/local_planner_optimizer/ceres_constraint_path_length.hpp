@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -46,6 +48,44 @@ public:
 private:
 
 
+};
+
+// Analytic version of PathLengthFunctor (same residual, hand-derived jacobians)
+class PathLengthCostFunction : public SizedCostFunction<1, 6, 6> {
+
+public:
+    PathLengthCostFunction(double weight): weight_(weight) {}
+
+    virtual ~PathLengthCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+        const double* stateWP2 = parameters[1];
+
+        double d[3] = {stateWP2[0] - stateWP1[0], stateWP2[1] - stateWP1[1], stateWP2[2] - stateWP1[2]};
+
+        residuals[0] = weight_ * (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+        if (jacobians == nullptr)
+            return true;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (jacobians[0] != nullptr)
+                jacobians[0][k] = -2.0 * weight_ * d[k];
+            if (jacobians[1] != nullptr)
+                jacobians[1][k] = 2.0 * weight_ * d[k];
+        }
+        for (int i = 0; i < 2; ++i)
+            if (jacobians[i] != nullptr)
+                CeresAnalytic::zeroJacobian(jacobians[i] + 3, 3);
+
+        return true;
+    }
+
+    double weight_;
+
 };
 
 #endif
\ No newline at end of file
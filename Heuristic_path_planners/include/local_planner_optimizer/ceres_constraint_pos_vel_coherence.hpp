@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -74,6 +76,53 @@ public:
 private:
 
 
+};
+
+// Analytic version of PosVelCoherenceFunctor (same residual, hand-derived jacobians)
+class PosVelCoherenceCostFunction : public SizedCostFunction<1, 6, 6> {
+
+public:
+    PosVelCoherenceCostFunction(double weight): weight_(weight) {}
+
+    virtual ~PosVelCoherenceCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+        const double* stateWP2 = parameters[1];
+
+        double vel_total[3] = {stateWP1[3] + stateWP2[3], stateWP1[4] + stateWP2[4], stateWP1[5] + stateWP2[5]};
+        double pos_dif[3] = {stateWP2[0] - stateWP1[0], stateWP2[1] - stateWP1[1], stateWP2[2] - stateWP1[2]};
+
+        double cos_angle, dcos_dvel[3], dcos_dpos[3];
+        CeresAnalytic::cosineWithGradient(vel_total, pos_dif, cos_angle, dcos_dvel, dcos_dpos);
+
+        residuals[0] = weight_ * CeresAnalytic::cosineResidual(cos_angle);
+
+        if (jacobians == nullptr)
+            return true;
+
+        // vel_total = v1 + v2, pos_dif = p2 - p1
+        const double slope = weight_ * CeresAnalytic::cosineResidualSlope();
+        for (int k = 0; k < 3; ++k)
+        {
+            if (jacobians[0] != nullptr)
+            {
+                jacobians[0][k] = -slope * dcos_dpos[k];
+                jacobians[0][k + 3] = slope * dcos_dvel[k];
+            }
+            if (jacobians[1] != nullptr)
+            {
+                jacobians[1][k] = slope * dcos_dpos[k];
+                jacobians[1][k + 3] = slope * dcos_dvel[k];
+            }
+        }
+
+        return true;
+    }
+
+    double weight_;
+
 };
 
 #endif
\ No newline at end of file
@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -75,6 +77,53 @@ public:
 private:
 
 
+};
+
+// Analytic version of SmoothnessFunctor (same residual, hand-derived jacobians)
+class SmoothnessCostFunction : public SizedCostFunction<1, 6, 6, 6> {
+
+public:
+    SmoothnessCostFunction(double weight): weight_(weight) {}
+
+    virtual ~SmoothnessCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+        const double* stateWP2 = parameters[1];
+        const double* stateWP3 = parameters[2];
+
+        double vecAB[3] = {stateWP2[0]-stateWP1[0], stateWP2[1]-stateWP1[1], stateWP2[2]-stateWP1[2]};
+        double vecBC[3] = {stateWP3[0]-stateWP2[0], stateWP3[1]-stateWP2[1], stateWP3[2]-stateWP2[2]};
+
+        double cos_angle, dcos_dab[3], dcos_dbc[3];
+        CeresAnalytic::cosineWithGradient(vecAB, vecBC, cos_angle, dcos_dab, dcos_dbc);
+
+        residuals[0] = weight_ * CeresAnalytic::cosineResidual(cos_angle);
+
+        if (jacobians == nullptr)
+            return true;
+
+        // AB = WP2 - WP1, BC = WP3 - WP2
+        const double slope = weight_ * CeresAnalytic::cosineResidualSlope();
+        for (int k = 0; k < 3; ++k)
+        {
+            if (jacobians[0] != nullptr)
+                jacobians[0][k] = -slope * dcos_dab[k];
+            if (jacobians[1] != nullptr)
+                jacobians[1][k] = slope * (dcos_dab[k] - dcos_dbc[k]);
+            if (jacobians[2] != nullptr)
+                jacobians[2][k] = slope * dcos_dbc[k];
+        }
+        for (int i = 0; i < 3; ++i)
+            if (jacobians[i] != nullptr)
+                CeresAnalytic::zeroJacobian(jacobians[i] + 3, 3);
+
+        return true;
+    }
+
+    double weight_;
+
 };
 
 #endif
\ No newline at end of file
@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -48,6 +50,44 @@ public:
 private:
 
 
+};
+
+// Analytic version of VelocityChangeFunctor (same residual, hand-derived jacobians)
+class VelocityChangeCostFunction : public SizedCostFunction<1, 6> {
+
+public:
+    VelocityChangeCostFunction(double weight, double desired_vel): weight_(weight), desired_vel_(desired_vel) {}
+
+    virtual ~VelocityChangeCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+
+        double vel_module = std::sqrt(stateWP1[3] * stateWP1[3] + stateWP1[4] * stateWP1[4] + stateWP1[5] * stateWP1[5]);
+        double error = desired_vel_ - vel_module;
+
+        residuals[0] = weight_ * error * error;
+
+        if (jacobians == nullptr || jacobians[0] == nullptr)
+            return true;
+
+        CeresAnalytic::zeroJacobian(jacobians[0], 6);
+        // The derivative of the module is not defined for a null velocity, leave it as zero
+        if (vel_module > 0.0)
+        {
+            const double cte = -2.0 * weight_ * error / vel_module;
+            jacobians[0][3] = cte * stateWP1[3];
+            jacobians[0][4] = cte * stateWP1[4];
+            jacobians[0][5] = cte * stateWP1[5];
+        }
+
+        return true;
+    }
+
+    double weight_;
+    double desired_vel_;
+
 };
 
 #endif
\ No newline at end of file
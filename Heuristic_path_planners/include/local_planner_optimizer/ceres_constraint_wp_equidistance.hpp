@@ -17,8 +17,10 @@
 #include "Grid3D/local_grid3d.hpp"
 
 #include <ceres/ceres.h>
+#include "local_planner_optimizer/ceres_analytic_utils.hpp"
 
 using ceres::AutoDiffCostFunction;
+using ceres::SizedCostFunction;
 using ceres::CostFunction;
 using ceres::Problem;
 using ceres::Solve;
@@ -49,6 +51,48 @@ public:
 private:
 
 
+};
+
+// Analytic version of EquidistanceFunctor (same residual, hand-derived jacobians)
+class EquidistanceCostFunction : public SizedCostFunction<1, 6, 6, 6> {
+
+public:
+    EquidistanceCostFunction(double weight): weight_(weight) {}
+
+    virtual ~EquidistanceCostFunction(void) {}
+
+    virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+
+        const double* stateWP1 = parameters[0];
+        const double* stateWP2 = parameters[1];
+        const double* stateWP3 = parameters[2];
+
+        double d1[3] = {stateWP2[0] - stateWP1[0], stateWP2[1] - stateWP1[1], stateWP2[2] - stateWP1[2]};
+        double d2[3] = {stateWP3[0] - stateWP2[0], stateWP3[1] - stateWP2[1], stateWP3[2] - stateWP2[2]};
+
+        residuals[0] = weight_ * ((d2[0] * d2[0] + d2[1] * d2[1] + d2[2] * d2[2]) - (d1[0] * d1[0] + d1[1] * d1[1] + d1[2] * d1[2]));
+
+        if (jacobians == nullptr)
+            return true;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (jacobians[0] != nullptr)
+                jacobians[0][k] = 2.0 * weight_ * d1[k];
+            if (jacobians[1] != nullptr)
+                jacobians[1][k] = -2.0 * weight_ * (d2[k] + d1[k]);
+            if (jacobians[2] != nullptr)
+                jacobians[2][k] = 2.0 * weight_ * d2[k];
+        }
+        for (int i = 0; i < 3; ++i)
+            if (jacobians[i] != nullptr)
+                CeresAnalytic::zeroJacobian(jacobians[i] + 3, 3);
+
+        return true;
+    }
+
+    double weight_;
+
 };
 
 #endif
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include <ceres/ceres.h>
 
 #include "local_planner_optimizer/ceres_constraint_dist_to_obstacle.hpp"
+#include "local_planner_optimizer/ceres_constraint_neural_esdf.hpp"
 #include "local_planner_optimizer/ceres_constraint_wp_equidistance.hpp"
 #include "local_planner_optimizer/ceres_constraint_path_length.hpp"
 #include "local_planner_optimizer/ceres_constraint_smoothness.hpp"
@@ -48,8 +49,16 @@ struct parameterBlockPathWP{
 
 namespace Ceresopt{
     std::vector<double> InitVelCalculator(std::vector<parameterBlockTrajectoryWP> wp_state_vector, float total_travel_time, int num_wp, float res);
-    Planners::utils::OptimizedPath ceresOptimizerPath(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float resolution_);
-    Planners::utils::OptimizedTrajectory ceresOptimizerTrajectory(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float resolution_);
+    Planners::utils::OptimizedPath ceresOptimizerPath(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float resolution_, bool analytic_jacobians = false);
+    // loaded_sdf != nullptr -> obstacle term evaluated with the network (batched value+gradient) instead of the grid interpolation
+    Planners::utils::OptimizedTrajectory ceresOptimizerTrajectory(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float resolution_, bool analytic_jacobians = false, torch::jit::script::Module* loaded_sdf = nullptr);
+
+    ceres::CostFunction* equidistanceCost(double weight, bool analytic);
+    ceres::CostFunction* smoothnessCost(double weight, bool analytic);
+    ceres::CostFunction* pathLengthCost(double weight, bool analytic);
+    ceres::CostFunction* velocityChangeCost(double weight, double desired_vel, bool analytic);
+    ceres::CostFunction* minAccelerationCost(double weight, bool analytic);
+    ceres::CostFunction* posVelCoherenceCost(double weight, bool analytic);
 }
 
 
@@ -0,0 +1,122 @@
+#ifndef CLOUDVOXELIZER_HPP
+#define CLOUDVOXELIZER_HPP
+/**
+ * @file CloudVoxelizer.hpp
+ * @brief Single pass from the raw buffer of a point cloud to the list of occupied voxels
+ *
+ * The rigid transform, the crop to a box and the quantization are fused in one loop over the points,
+ * read straight from the interleaved buffer (e.g. the data of a sensor_msgs::PointCloud2). With SSE2
+ * and packed x, y, z fields each point is loaded, transformed and compared as one 4-float vector,
+ * otherwise the same loop is done with scalars. The voxels are deduplicated with a bitset over the
+ * box, so each occupied voxel is emitted (and inflated by the algorithm) only once.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "utils/utils.hpp"
+
+namespace Planners
+{
+    namespace utils
+    {
+        class CloudVoxelizer
+        {
+        public:
+            /**
+             * @brief Layout of the points in the buffer. Only float32 coordinates are supported
+             */
+            struct Layout
+            {
+                size_t point_step{12}; /*!< Bytes between consecutive points */
+                size_t x_offset{0};
+                size_t y_offset{4};
+                size_t z_offset{8};
+            };
+
+            CloudVoxelizer(){ setTransform(nullptr, nullptr); }
+
+            /**
+             * @brief Rigid transform applied to the points before cropping them
+             *
+             * @param _rotation Row-major 3x3 matrix, identity if null
+             * @param _translation Identity if null
+             */
+            void setTransform(const float *_rotation, const float *_translation);
+
+            /**
+             * @brief Points are kept if _min <= p <= _max in each axis, after the transform.
+             * The voxel of a point p is round(p / _resolution), as discretePoint
+             *
+             * @param _min Meters
+             * @param _max Meters
+             * @param _resolution Meters
+             */
+            void setCropBox(const float _min[3], const float _max[3], const double _resolution);
+
+            /**
+             * @brief Append to _voxels the distinct voxels of the points inside the crop box. The voxels are
+             * distinct over all the rows, e.g. the beams of an organized cloud
+             *
+             * @param _data First byte of the first point
+             * @param _width Points of each row
+             * @param _height Rows
+             * @param _row_step Bytes between the first points of consecutive rows, which can be padded
+             * @param _layout
+             * @param _voxels Not cleared
+             * @return size_t Points inside the crop box, duplicates included
+             */
+            size_t voxelize(const uint8_t *_data, const size_t _width, const size_t _height, const size_t _row_step, const Layout &_layout, CoordinateList &_voxels);
+
+            /**
+             * @brief Same as above for a single row of _n_points
+             */
+            size_t voxelize(const uint8_t *_data, const size_t _n_points, const Layout &_layout, CoordinateList &_voxels)
+            {
+                return voxelize(_data, _n_points, 1, 0, _layout, _voxels);
+            }
+
+        private:
+            /**
+             * @brief Append the voxels of one row, without clearing the bitset
+             */
+            size_t voxelizeRow(const uint8_t *_data, const size_t _n_points, const Layout &_layout, CoordinateList &_voxels);
+
+            /**
+             * @brief Append the voxel if it was not seen before in this call
+             */
+            inline void addVoxel(const int _x, const int _y, const int _z, CoordinateList &_voxels)
+            {
+                const size_t bit = bitIndex(_x, _y, _z);
+                uint64_t &word = seen_[bit >> 6];
+                const uint64_t mask = uint64_t(1) << ( bit & 63 );
+                if( word & mask )
+                    return;
+                word |= mask;
+                _voxels.push_back({_x, _y, _z});
+            }
+
+            inline size_t bitIndex(const int _x, const int _y, const int _z) const
+            {
+                return ( static_cast<size_t>(_z - min_key_.z) * box_cells_.y + ( _y - min_key_.y ) ) * box_cells_.x + ( _x - min_key_.x );
+            }
+
+            float rotation_[9];
+            float translation_[3];
+            float min_[3]{0, 0, 0}, max_[3]{0, 0, 0};
+            float inv_resolution_{1};
+
+            Vec3i min_key_{0, 0, 0};   /*!< Voxel of _min, origin of the bitset */
+            Vec3i box_cells_{0, 0, 0};
+            std::vector<uint64_t> seen_;
+        };
+    }
+}
+
+#endif
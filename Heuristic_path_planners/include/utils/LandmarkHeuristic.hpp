@@ -0,0 +1,127 @@
+#ifndef LANDMARKHEURISTIC_HPP
+#define LANDMARKHEURISTIC_HPP
+/**
+ * @file LandmarkHeuristic.hpp
+ * @brief ALT (A*, Landmarks, Triangle inequality) heuristic for a static world
+ *
+ * The grid distances from K landmark cells to every cell are precomputed with Dijkstra.
+ * By the triangle inequality, |d(L, t) - d(L, s)| <= d(s, t) for every landmark L, so
+ * the maximum over the landmarks is a lower bound of the distance between s and t
+ * that, unlike the geometric heuristics, takes the obstacles into account.
+ *
+ * The tables are only valid for the occupancy they were computed with: they must be
+ * recomputed if cells are freed or occupied afterwards.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "utils/utils.hpp"
+#include "utils/world.hpp"
+
+namespace Planners
+{
+    using namespace utils;
+
+    /**
+     * @brief Landmark distance tables and the ALT estimate. The estimate is const and can be
+     * shared between threads, e.g. by the workers of the batch planning service.
+     *
+     */
+    class LandmarkHeuristic
+    {
+    public:
+        /**
+         * @brief Chooses _n_landmarks free cells spread over the world (farthest point sampling) and
+         * computes the distance tables from each of them, one landmark per thread.
+         *
+         * @param _world World with the static occupancy (already inflated)
+         * @param _n_landmarks Number of landmarks. Memory used: 4 bytes per landmark and cell
+         * @param _use_3d 26 directions if true, 8 directions in each Z plane otherwise
+         * @param _n_threads 0 to use one thread per core
+         * @return true if at least one landmark was found
+         */
+        bool compute(const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d, unsigned int _n_threads = 0);
+
+        /**
+         * @brief Saves the tables next to the .gridm cache. It writes a temporary file and
+         * renames it, as Grid3d::saveGrid does
+         *
+         * @return true if the file was written
+         */
+        bool save(const std::string &_file_path) const;
+
+        /**
+         * @brief Loads the tables if the file was computed for the same occupancy, world size,
+         * number of landmarks and directions
+         *
+         * @return false if the file does not exist or is stale
+         */
+        bool load(const std::string &_file_path, const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d);
+
+        /**
+         * @brief True if the tables were computed for the current occupancy of _world
+         */
+        bool matches(const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d) const;
+
+        /**
+         * @brief Theta* and Lazy Theta* paths can be shorter than the grid paths the tables are
+         * computed with. If enabled, the landmark bound is divided by the maximum ratio between
+         * the grid distance and the euclidean distance (about 1.082 in 2D and 1.128 in 3D)
+         * so that it is still a lower bound
+         */
+        void setAnyAngle(const bool _any_angle){ any_angle_ = _any_angle; }
+
+        /**
+         * @brief ALT estimate, never lower than Heuristic::euclidean
+         *
+         * @param _source
+         * @param _target
+         * @return unsigned int
+         */
+        unsigned int operator()(const Vec3i &_source, const Vec3i &_target) const;
+
+        const CoordinateList& getLandmarks() const { return landmarks_; }
+
+        size_t getMemoryUsage() const { return distances_.size() * sizeof(uint32_t); }
+
+    private:
+        /**
+         * @brief One byte per cell, 1 if occupied
+         */
+        static std::vector<uint8_t> occupancySnapshot(const DiscreteWorld &_world);
+
+        /**
+         * @brief FNV-1a of the occupancy snapshot, stored in the file to detect stale tables
+         */
+        static uint64_t occupancyHash(const std::vector<uint8_t> &_occupancy);
+
+        void selectLandmarks(const std::vector<uint8_t> &_occupancy, const unsigned int _n_landmarks);
+
+        void dijkstra(const std::vector<uint8_t> &_occupancy, const Vec3i &_landmark, std::vector<uint32_t> &_distances) const;
+
+        inline size_t cellIndex(const Vec3i &_pos) const{
+            return ( static_cast<size_t>(_pos.z) * world_size_.y + _pos.y ) * world_size_.x + _pos.x;
+        }
+
+        static constexpr uint32_t unreachable_{0xFFFFFFFF};
+        static constexpr uint32_t file_version_{1};
+
+        Vec3i world_size_{0, 0, 0};
+        bool use_3d_{true};
+        bool any_angle_{false};
+        uint64_t occupancy_hash_{0};
+
+        CoordinateList landmarks_;
+        std::vector<uint32_t> distances_; /*!< Interleaved by cell: distances_[cell * K + landmark] */
+    };
+
+}
+
+#endif
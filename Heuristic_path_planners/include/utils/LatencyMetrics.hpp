@@ -0,0 +1,162 @@
+#ifndef LATENCYMETRICS_HPP
+#define LATENCYMETRICS_HPP
+/**
+ * @file LatencyMetrics.hpp
+ * @brief Per-stage latency histograms of the local planning loop
+ *
+ * Each stage has a log-linear histogram in the style of HdrHistogram: 32 linear sub-buckets
+ * per power of two of microseconds, so the percentiles have a relative error under 3.2%
+ * with a fixed memory of about 9 KB per stage. Recording is a relaxed atomic increment,
+ * it does not lock or allocate and it can be called from any thread.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace Planners
+{
+    namespace utils
+    {
+        class LatencyHistogram
+        {
+        public:
+            LatencyHistogram(){ reset(); }
+
+            /**
+             * @brief Add one sample
+             *
+             * @param _usec Microseconds, values over ~12 days are saturated
+             */
+            inline void record(uint64_t _usec)
+            {
+                _usec = _usec < max_value_ ? _usec : max_value_;
+                counts_[bucketIndex(_usec)].fetch_add(1, std::memory_order_relaxed);
+                count_.fetch_add(1, std::memory_order_relaxed);
+                sum_.fetch_add(_usec, std::memory_order_relaxed);
+
+                uint64_t max = max_.load(std::memory_order_relaxed);
+                while( _usec > max && !max_.compare_exchange_weak(max, _usec, std::memory_order_relaxed) );
+            }
+
+            /**
+             * @brief Value under which _percentile % of the samples are
+             *
+             * @param _percentile In [0, 100]
+             * @return uint64_t Microseconds, the upper bound of the bucket. 0 if empty
+             */
+            uint64_t percentile(const double _percentile) const;
+
+            uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+            uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+            double mean() const;
+
+            void reset();
+
+        private:
+            static constexpr unsigned int sub_bucket_bits_{5};
+            static constexpr uint64_t sub_buckets_{1u << sub_bucket_bits_};
+            static constexpr unsigned int max_bits_{40};
+            static constexpr uint64_t max_value_{( uint64_t(1) << max_bits_ ) - 1};
+            static constexpr size_t n_buckets_{sub_buckets_ * ( max_bits_ - sub_bucket_bits_ + 1 )};
+
+            /**
+             * @brief Values under 32 have their own bucket, then 32 buckets per power of two
+             */
+            static inline size_t bucketIndex(const uint64_t _value)
+            {
+                if( _value < sub_buckets_ )
+                    return _value;
+
+                const unsigned int msb = 63 - __builtin_clzll(_value);
+                const unsigned int shift = msb - sub_bucket_bits_;
+                return sub_buckets_ * ( shift + 1 ) + ( ( _value >> shift ) - sub_buckets_ );
+            }
+
+            /**
+             * @brief Highest value that falls in the bucket
+             */
+            static uint64_t bucketUpperBound(const size_t _index);
+
+            std::array<std::atomic<uint64_t>, n_buckets_> counts_;
+            std::atomic<uint64_t> count_, sum_, max_;
+        };
+
+        /**
+         * @brief One histogram per stage of the local planning loop
+         *
+         */
+        class LatencyMetrics
+        {
+        public:
+            enum Stage
+            {
+                MODEL_RELOAD,
+                COORDINATES,
+                INFERENCE,
+                WORLD_UPDATE,
+                SEARCH,
+                OPTIMIZATION,
+                TICK,
+                PATH_TRANSPORT, /*!< From the publication of the global path to its callback */
+                VOXELIZE,       /*!< Transform, crop and discretization of a point cloud */
+                CLOUD_UPDATE,   /*!< Occupied cells of a point cloud added to the local world */
+                N_STAGES
+            };
+
+            /**
+             * @brief Records the time from its construction to its destruction. Does nothing if the metrics are null
+             *
+             */
+            class ScopedTimer
+            {
+            public:
+                ScopedTimer(LatencyMetrics *_metrics, const Stage _stage): metrics_(_metrics), stage_(_stage), start_(std::chrono::steady_clock::now()) {}
+
+                ~ScopedTimer(){
+                    if( metrics_ != nullptr )
+                        metrics_->record(stage_, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count());
+                }
+
+                ScopedTimer(const ScopedTimer &) = delete;
+                ScopedTimer& operator=(const ScopedTimer &) = delete;
+
+            private:
+                LatencyMetrics *metrics_;
+                Stage stage_;
+                std::chrono::steady_clock::time_point start_;
+            };
+
+            inline void record(const Stage _stage, const uint64_t _usec){ histograms_[_stage].record(_usec); }
+
+            const LatencyHistogram& histogram(const Stage _stage) const { return histograms_[_stage]; }
+
+            static const char* stageName(const Stage _stage);
+
+            /**
+             * @brief Appends one row per stage with the count, mean, p50, p90, p99, p99.9 and max in milliseconds.
+             * The header is written if the file is new
+             *
+             * @param _stamp Seconds, first column of the rows
+             * @return false if the file could not be opened
+             */
+            bool appendCsv(const std::string &_file_path, const double _stamp) const;
+
+            void reset();
+
+        private:
+            std::array<LatencyHistogram, N_STAGES> histograms_;
+        };
+    }
+}
+
+#endif
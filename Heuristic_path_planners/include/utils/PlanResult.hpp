@@ -0,0 +1,104 @@
+#ifndef PLANRESULT_HPP
+#define PLANRESULT_HPP
+/**
+ * @file PlanResult.hpp
+ * @brief Typed result of the findPath function of the algorithms.
+ *
+ * The object can be reused between calls: the path buffer keeps its capacity, so
+ * planning in a loop does not allocate once the buffer is big enough.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <string>
+#include "utils/utils.hpp"
+
+namespace Planners
+{
+    namespace utils
+    {
+        /**
+         * @brief Costs accumulated along the adjacent cells of the path. They are only
+         * computed if the algorithm has the statistics enabled (see AlgorithmBase::setComputeStatistics)
+         *
+         */
+        struct PathStatistics
+        {
+            bool computed{false}; /*!< False if the statistics were not requested for the last search */
+
+            unsigned int total_cost1{0}; /*!< g_cost1 + grid_cost1 */
+            unsigned int total_cost2{0}; /*!< g_cost2 + grid_cost2 */
+            unsigned int h_cost{0};      /*!< Sum of the H values */
+            unsigned int g_cost1{0};     /*!< Sum of the distances between adjacent cells */
+            unsigned int g_cost2{0};     /*!< Sum of the distances between adjacent cells */
+            unsigned int c_cost{0};      /*!< Sum of the C values */
+            unsigned int grid_cost1{0};  /*!< Cost term of the M1 algorithms */
+            unsigned int grid_cost2{0};  /*!< Cost term of the M2 algorithms */
+
+            void clear(){ *this = PathStatistics(); }
+        };
+
+        /**
+         * @brief Result of a findPath call
+         *
+         */
+        struct PlanResult
+        {
+            bool solved{false};
+            std::string algorithm;
+            CoordinateList path; /*!< From the goal to the start, empty if not solved */
+            Vec3i start_coords;
+            Vec3i goal_coords;   /*!< Coordinates of the last expanded node */
+            unsigned int g_final_node{0};
+            double time_spent{0}; /*!< Microseconds */
+            size_t explored_nodes{0};
+            double path_length{0};
+            unsigned int line_of_sight_checks{0};
+            unsigned int max_line_of_sight_cells{0};
+            double cost_weight{0};
+
+            PathStatistics statistics;
+
+            /**
+             * @brief Map with the fields used by the DataVariantSaver. The statistics
+             * fields are zero if they were not computed.
+             *
+             * @return PathData
+             */
+            PathData toPathData() const
+            {
+                PathData result_data;
+
+                result_data["solved"]                  = solved;
+                result_data["goal_coords"]             = goal_coords;
+                result_data["g_final_node"]            = g_final_node;
+                result_data["algorithm"]               = algorithm;
+                result_data["path"]                    = path;
+                result_data["time_spent"]              = time_spent;
+                result_data["explored_nodes"]          = explored_nodes;
+                result_data["start_coords"]            = start_coords;
+                result_data["path_length"]             = path_length;
+
+                result_data["total_cost1"]             = statistics.total_cost1;
+                result_data["total_cost2"]             = statistics.total_cost2;
+                result_data["h_cost"]                  = statistics.h_cost;
+                result_data["g_cost1"]                 = statistics.g_cost1;
+                result_data["g_cost2"]                 = statistics.g_cost2;
+                result_data["c_cost"]                  = statistics.c_cost;
+                result_data["grid_cost1"]              = statistics.grid_cost1;
+                result_data["grid_cost2"]              = statistics.grid_cost2;
+
+                result_data["line_of_sight_checks"]    = line_of_sight_checks;
+                result_data["max_line_of_sight_cells"] = max_line_of_sight_cells;
+                result_data["cost_weight"]             = cost_weight;
+
+                return result_data;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SEARCHCORRIDOR_HPP
+#define SEARCHCORRIDOR_HPP
+/**
+ * @file SearchCorridor.hpp
+ * @brief Set of clusters of the world (boxes of the same size) the search is restricted to.
+ * Used by the HierarchicalPlanner to refine the abstract path only inside the clusters it traverses.
+ *
+ * @version 0.1
+ * @date 2021-06-29
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <vector>
+#include <cstdint>
+
+#include "utils/utils.hpp"
+
+namespace Planners
+{
+    namespace utils
+    {
+        struct SearchCorridor
+        {
+            Vec3i cluster_size{1, 1, 1}; /*!< Cells of a cluster in each axis */
+            Vec3i n_clusters{0, 0, 0};   /*!< Clusters in each axis */
+            std::vector<uint8_t> clusters; /*!< 1 if the cluster belongs to the corridor, x-major */
+
+            inline size_t clusterIndex(const Vec3i &_cluster) const{
+                return ( static_cast<size_t>(_cluster.z) * n_clusters.y + _cluster.y ) * n_clusters.x + _cluster.x;
+            }
+
+            /**
+             * @brief True if the cell, which must be inside the world, belongs to a cluster of the corridor
+             */
+            inline bool contains(const Vec3i &_cell) const{
+                return clusters[clusterIndex({_cell.x / cluster_size.x, _cell.y / cluster_size.y, _cell.z / cluster_size.z})];
+            }
+        };
+    }
+}
+
+#endif
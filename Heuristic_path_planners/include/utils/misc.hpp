@@ -17,7 +17,7 @@ namespace Planners
          * @param _V 
          * @return utils::Vec3i 
          */
-        utils::Vec3i HSVtoRGB(float _H,const float _S,const float _V)
+        inline utils::Vec3i HSVtoRGB(float _H,const float _S,const float _V)
         {
             if (_S > 100 || _S < 0 || _V > 100 || _V < 0)
             {
@@ -16,12 +16,15 @@
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Pose.h>
 #include <nav_msgs/OccupancyGrid.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <costmap_2d/cost_values.h>
 
 #include <pcl_ros/point_cloud.h>
 #include <pcl_ros/transforms.h>
 
 #include "utils/utils.hpp"
+#include "utils/CloudVoxelizer.hpp"
+#include "utils/LatencyMetrics.hpp"
 #include "Grid3D/grid3d.hpp"
 #include "Grid3D/local_grid3d.hpp"
 #include "Planners/AlgorithmBase.hpp"
@@ -139,15 +142,32 @@ namespace Planners
          */
         bool configureWorldFromPointCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &_points, AlgorithmBase &_algorithm, const double &_resolution);
 
+        /**
+         * @brief Same as configureWorldFromPointCloud but straight from the PointCloud2 buffer: the points are
+         * transformed, cropped and discretized in one pass by the voxelizer, and each occupied cell is added once
+         * 
+         * @param _cloud PointCloud2 with float32 x, y and z fields
+         * @param _transform From the frame of the cloud to the frame of the crop box of the voxelizer
+         * @param _voxelizer Crop box and resolution already set
+         * @param _algorithm algorithm object
+         * @param _voxels Cleared and filled with the cells added. Kept by the caller to reuse its memory
+         * @param _metrics If set, the voxelization and the world update are recorded in the VOXELIZE and CLOUD_UPDATE stages
+         * @return true 
+         * @return false If the cloud has no float32 x, y, z fields
+         */
+        bool configureWorldFromPointCloud2(const sensor_msgs::PointCloud2 &_cloud, const tf::Transform &_transform, CloudVoxelizer &_voxelizer, AlgorithmBase &_algorithm, CoordinateList &_voxels, LatencyMetrics *_metrics = nullptr);
+
         /**
          * @brief 
          * 
          * @param _grid 
          * @param _algorithm 
+         * @param _far_field If > 0, costs are clamped to it. Cells whose cost equals the default cost
+         * of the world (see DiscreteWorld::setDefaultCost) do not allocate sparse cost blocks
          * @return true 
          * @return false 
          */
-        bool configureWorldCosts(Grid3d &_grid, AlgorithmBase &_algorithm);
+        bool configureWorldCosts(Grid3d &_grid, AlgorithmBase &_algorithm, const double _far_field = 0);
 
         /**
          * @brief 
@@ -12,7 +12,12 @@
  * 
  */
 #include <vector>
+#include <memory>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
 #include "utils/utils.hpp"
 
 namespace Planners{
@@ -25,6 +30,12 @@ namespace utils
     /**
      * @brief Class implementing the data structure storing the map related data that algorithms uses internally
      * 
+     * Two storage backends are available:
+     *  - Dense (default): one Node per cell, allocated when the world is resized.
+     *  - Sparse: the world is split in blocks of 8x8x8 cells (8x8x1 in 2D worlds). Occupancy is stored 
+     *    as bitmasks and the cost as floats, both allocated when a cell of the block is written. Nodes 
+     *    are only allocated when the search touches a block and they are released by resetWorld().
+     *    Cells that have never been set as occupied or free are unknown, see setUnknownAsOccupied().
      */
     class DiscreteWorld
     {
@@ -44,6 +55,17 @@ namespace utils
          */
         void cleanWorld()
         {
+            if(sparse_){
+                // As in the dense backend every cell becomes free, also the unknown ones
+                SparseMap &map = mutableMap();
+                std::fill(map.occupancy_directory.begin(), map.occupancy_directory.end(), 0);
+                map.occupancy_pool.clear();
+                map.cleaned = true;
+                for(auto &block: node_pool_)
+                    for(int i = 0; i < block_cells_; ++i)
+                        block[i].occuppied = false;
+                return;
+            }
             for(long unsigned int i = 0; i < discrete_world_vector_.size(); ++i){
                 discrete_world_vector_[i].occuppied = false;
             }
@@ -88,8 +110,14 @@ namespace utils
             x_y_size_      = static_cast<long>(world_x_size_) * world_y_size_;
 
             discrete_world_vector_.clear();
+            if(sparse_){
+                discrete_world_vector_.shrink_to_fit();
+                resizeBlocks();
+                return;
+            }
             discrete_world_vector_.resize(static_cast<long>(world_x_size_) * world_y_size_ * world_z_size_);
             Node node;
+            node.cost = default_cost_;
             std::fill(discrete_world_vector_.begin(), discrete_world_vector_.end(), node);
             
             for(long unsigned int i = 0; i < discrete_world_vector_.size(); ++i){
@@ -133,9 +161,15 @@ namespace utils
             x_y_size_      = static_cast<long>(world_x_size_) * world_y_size_; // Change x_y_size --> x_y_local_size?
 
             discrete_world_vector_.clear(); 
+            if(sparse_){
+                discrete_world_vector_.shrink_to_fit();
+                resizeBlocks();
+                return;
+            }
             discrete_world_vector_.resize(static_cast<long>(world_x_size_) * world_y_size_ * world_z_size_); // JAC Corrected: _world_z_size should be world_z_size_
 
             Node node;
+            node.cost = default_cost_;
             std::fill(discrete_world_vector_.begin(), discrete_world_vector_.end(), node);
 
             // std::cout << "LOCAL WORLD SIZE: "      << discrete_world_vector_.size()  << std::endl;
@@ -148,6 +182,149 @@ namespace utils
 
 
 
+        /**
+         * @brief Select the storage backend. It must be called before resizeWorld/resizeLocalWorld, 
+         * which create the storage of the selected backend
+         * 
+         * @param _sparse true to use the sparse block storage, false for the dense vector of nodes
+         */
+        void setSparse(const bool _sparse){
+            sparse_ = _sparse;
+        }
+        /**
+         * @brief Check the storage backend in use
+         * 
+         * @return true if the sparse block storage is used
+         */
+        bool isSparse() const{
+            return sparse_;
+        }
+        /**
+         * @brief Sparse backend: how the cells that have never been set as occupied or free are treated.
+         * The dense backend treats them as free, which is also the default here. After cleanWorld() 
+         * every cell is known and free, as in the dense backend.
+         * 
+         * @param _value true to treat unknown cells as occupied
+         */
+        void setUnknownAsOccupied(const bool _value){
+            unknown_as_occupied_ = _value;
+        }
+        /**
+         * @brief Cost of the cells whose cost has never been set, 0 by default. It must be called 
+         * before resizeWorld/resizeLocalWorld. Setting it to the cost of most of the cells (e.g. the 
+         * far-field cost) keeps the sparse backend from allocating cost blocks for them
+         * 
+         * @param _cost default cost value
+         */
+        void setDefaultCost(const double _cost){
+            default_cost_ = _cost;
+        }
+        double getDefaultCost() const{
+            return default_cost_;
+        }
+        /**
+         * @brief Check if a cell has never been set as occupied or free. In the dense backend, and in the
+         * sparse one after cleanWorld(), every cell inside the workspace is known.
+         * 
+         * @param _vec discrete coordinates
+         * @return true if the cell is outside the workspace or it is unknown
+         */
+        bool isUnknown(const Vec3i &_vec) const{
+            if(!checkValid(_vec))
+                return true;
+            if(!sparse_ || map_->cleaned)
+                return false;
+
+            const uint64_t *occupancy = occupancyBlock(_vec);
+            if(occupancy == nullptr)
+                return true;
+            const int cell = cellIndex(_vec.x, _vec.y, _vec.z);
+            return !(occupancy[occupancy_words_ + (cell >> 6)] & (uint64_t{1} << (cell & 63)));
+        }
+        /**
+         * @brief Approximate memory used by the world storage
+         * 
+         * @return size_t bytes allocated for nodes, occupancy, costs and block directories
+         */
+        size_t getMemoryUsage() const{
+            if(!sparse_)
+                return discrete_world_vector_.capacity() * sizeof(Node);
+
+            return node_pool_.size() * block_cells_ * sizeof(Node) +
+                   node_directory_.capacity() * sizeof(uint32_t) +
+                   (map_ == nullptr ? 0 : map_->occupancy_pool.capacity() * sizeof(uint64_t) +
+                                          map_->cost_pool.capacity() * sizeof(float) +
+                                          (map_->occupancy_directory.capacity() + map_->cost_directory.capacity()) * sizeof(uint32_t));
+        }
+        /**
+         * @brief Get the coordinates of every occupied cell
+         * 
+         * @return CoordinateList with the discrete coordinates of the occupied cells
+         */
+        CoordinateList getOccupiedCoordinates() const{
+            CoordinateList occupied;
+            if(!sparse_){
+                for(const auto &it: discrete_world_vector_)
+                    if(it.occuppied)
+                        occupied.push_back(it.coordinates);
+                return occupied;
+            }
+            for(long unsigned int block = 0; block < map_->occupancy_directory.size(); ++block){
+                if(map_->occupancy_directory[block] == 0)
+                    continue;
+                const uint64_t *occupancy = &map_->occupancy_pool[(map_->occupancy_directory[block] - 1) * occupancy_words_ * 2];
+                const Vec3i origin = blockOrigin(block);
+                for(int cell = 0; cell < block_cells_; ++cell){
+                    if(!(occupancy[cell >> 6] & (uint64_t{1} << (cell & 63))))
+                        continue;
+                    occupied.push_back(origin + cellOffset(cell));
+                }
+            }
+            return occupied;
+        }
+
+        /**
+         * @brief Configure this world to plan on the same map as another one. Each world keeps its 
+         * own search state (nodes, open and closed flags), so several searches can run in parallel
+         * while the map is not modified. The occupancy and cost blocks of the sparse backend are 
+         * shared, and a world that modifies them afterwards gets its own copy.
+         * 
+         * This world always uses the sparse backend. If _other is dense, its occupancy and costs are 
+         * converted once into sparse blocks owned by this world: share the map of this world with 
+         * the rest of the worlds so that they do not convert it again.
+         * 
+         * @param _other world with the map data
+         */
+        void shareMap(const DiscreteWorld &_other){
+
+            unknown_as_occupied_ = _other.unknown_as_occupied_;
+            default_cost_ = _other.default_cost_;
+            world_x_size_ = _other.world_x_size_;
+            world_y_size_ = _other.world_y_size_;
+            world_z_size_ = _other.world_z_size_;
+            resolution_   = _other.resolution_;
+            x_y_size_     = _other.x_y_size_;
+
+            sparse_ = true;
+            discrete_world_vector_.clear();
+            discrete_world_vector_.shrink_to_fit();
+            if(!_other.sparse_){
+                resizeBlocks();
+                convertDenseMap(_other.discrete_world_vector_);
+                return;
+            }
+            block_z_bits_    = _other.block_z_bits_;
+            block_cells_     = _other.block_cells_;
+            occupancy_words_ = _other.occupancy_words_;
+            blocks_x_ = _other.blocks_x_;
+            blocks_y_ = _other.blocks_y_;
+            blocks_z_ = _other.blocks_z_;
+            node_pool_.clear();
+            touched_blocks_.clear();
+            node_directory_.assign(_other.node_directory_.size(), 0);
+            map_ = _other.map_;
+        }
+
         /**
          * @brief Set the Node Cost object overloaded function for continous coordinates
          * 
@@ -177,6 +354,25 @@ namespace utils
             if(!checkValid(_vec))
                 return false;
             
+            if(sparse_){
+                const long unsigned int block = getBlockIndex(_vec.x, _vec.y, _vec.z);
+                const int cell = cellIndex(_vec.x, _vec.y, _vec.z);
+                // Writing the stored value (the default cost in blocks without costs) neither allocates
+                // the block nor copies a shared map
+                const uint32_t entry = map_->cost_directory[block];
+                const float stored = entry == 0 ? static_cast<float>(default_cost_) : map_->cost_pool[(entry - 1) * block_cells_ + cell];
+                if(stored == static_cast<float>(_cost))
+                    return true;
+                SparseMap &map = mutableMap();
+                if(map.cost_directory[block] == 0){
+                    map.cost_pool.resize(map.cost_pool.size() + block_cells_, static_cast<float>(default_cost_));
+                    map.cost_directory[block] = map.cost_pool.size() / block_cells_;
+                }
+                map.cost_pool[(map.cost_directory[block] - 1) * block_cells_ + cell] = _cost;
+                if(node_directory_[block] != 0)
+                    node_pool_[node_directory_[block] - 1][cell].cost = _cost;
+                return true;
+            }
             discrete_world_vector_[getWorldIndex(_vec)].cost = _cost;
 
         return true;
@@ -187,6 +383,14 @@ namespace utils
          */
         void resetWorld(){
             
+            if(sparse_){
+                // The nodes are rebuilt from the occupancy and cost blocks when the next search touches them
+                for(const auto &block: touched_blocks_)
+                    node_directory_[block] = 0;
+                touched_blocks_.clear();
+                node_pool_.clear();
+                return;
+            }
             for(auto &it: discrete_world_vector_){
                 it.isInClosedList = false;
                 it.isInOpenList = false;
@@ -194,6 +398,18 @@ namespace utils
                 it.parent = nullptr;
             }
         }
+        /**
+         * @brief Set to its default state the search values of a single node. Used by the searches
+         * to reset only the nodes they touched instead of the whole world (dense storage)
+         * 
+         * @param _node 
+         */
+        void resetNode(Node &_node){
+            _node.isInClosedList = false;
+            _node.isInOpenList = false;
+            _node.H = _node.G = _node.C = 0;
+            _node.parent = nullptr;
+        }
         /**
          * @brief Function to check is the node is valid 
          * 
@@ -210,6 +426,9 @@ namespace utils
                 return true;
             }
 
+            if (sparse_)
+                return sparseOccupied(_x, _y, _z);
+
             if (discrete_world_vector_[getWorldIndex(_x, _y, _z)].occuppied)
             {
                 return true;
@@ -250,6 +469,9 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return;
 
+            if (sparse_)
+                return setSparseOccupancy(_x, _y, _z, true);
+
             discrete_world_vector_[getWorldIndex(_x, _y, _z)].occuppied = true;
         }
         /**
@@ -272,6 +494,9 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return;
 
+            if (sparse_)
+                return setSparseOccupancy(_x, _y, _z, false);
+
             discrete_world_vector_[getWorldIndex(_x, _y, _z)].occuppied = false;
             
         }
@@ -299,6 +524,11 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return false;
 
+            if (sparse_){
+                const Node *node = findNode(_x, _y, _z);
+                return node != nullptr && node->isInOpenList;
+            }
+
             if (discrete_world_vector_[getWorldIndex(_x, _y, _z)].isInOpenList)
                 return true;
 
@@ -337,6 +567,11 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return false;
 
+            if (sparse_){
+                const Node *node = findNode(_x, _y, _z);
+                return node != nullptr && node->isInClosedList;
+            }
+
             if (discrete_world_vector_[getWorldIndex(_x, _y, _z)].isInClosedList)
                 return true;
 
@@ -374,7 +609,7 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return;
 
-            discrete_world_vector_[getWorldIndex(_x, _y, _z)].isInClosedList = _value;
+            nodeAt(_x, _y, _z).isInClosedList = _value;
         }
         /**
          * @brief Set the Closed Value object overloaded function for Vec3i
@@ -386,7 +621,7 @@ namespace utils
             if (!checkValid(_pos))
                 return;
 
-            discrete_world_vector_[getWorldIndex(_pos)].isInClosedList = _value;
+            nodeAt(_pos.x, _pos.y, _pos.z).isInClosedList = _value;
         }
         /**
          * @brief Set the Closed Value object
@@ -410,7 +645,7 @@ namespace utils
             if (!checkValid(_x, _y, _z))
                 return;
 
-            discrete_world_vector_[getWorldIndex(_x, _y, _z)].isInOpenList = _value;
+            nodeAt(_x, _y, _z).isInOpenList = _value;
         }
         /**
          * @brief Overloaded function for Vec3i. Set the is in open list internal flag of the node associated to 
@@ -424,7 +659,7 @@ namespace utils
             if(!checkValid(_pos))
                 return;
             
-            discrete_world_vector_[getWorldIndex(_pos)].isInOpenList = _value;
+            nodeAt(_pos.x, _pos.y, _pos.z).isInOpenList = _value;
         }
         /**
          * @brief Set the Open Value object
@@ -447,10 +682,11 @@ namespace utils
             if(!checkValid(_vec))
                 return nullptr;
 
-            return &discrete_world_vector_[getWorldIndex(_vec)];
+            return &nodeAt(_vec.x, _vec.y, _vec.z);
         }
         /**
-         * @brief get the inner world object
+         * @brief get the inner world object. It is empty when the sparse backend is used, 
+         * see getOccupiedCoordinates()
          * 
          * @return const std::vector<Planners::utils::Node>& Reference to the world object stored inside
          */
@@ -550,8 +786,238 @@ namespace utils
             return {x, y, z};
         }
 
+        /**
+         * @brief Node associated to valid discrete coordinates. In the sparse backend the block 
+         * of nodes is created if it does not exist yet.
+         */
+        inline Node& nodeAt(const int _x, const int _y, const int _z){
+
+            if(!sparse_)
+                return discrete_world_vector_[getWorldIndex(_x, _y, _z)];
+
+            const long unsigned int block = getBlockIndex(_x, _y, _z);
+            if(node_directory_[block] == 0)
+                allocateNodeBlock(block);
+
+            return node_pool_[node_directory_[block] - 1][cellIndex(_x, _y, _z)];
+        }
+        /**
+         * @brief Sparse backend: node associated to valid discrete coordinates if its block exists
+         */
+        inline const Node* findNode(const int _x, const int _y, const int _z) const{
+
+            const long unsigned int block = getBlockIndex(_x, _y, _z);
+            if(node_directory_[block] == 0)
+                return nullptr;
+
+            return &node_pool_[node_directory_[block] - 1][cellIndex(_x, _y, _z)];
+        }
+        /**
+         * @brief Sparse backend: create the nodes of a block with the occupancy and cost already stored
+         */
+        void allocateNodeBlock(const long unsigned int _block){
+
+            std::unique_ptr<Node[]> nodes(new Node[block_cells_]);
+            const Vec3i origin = blockOrigin(_block);
+            const uint64_t *occupancy = map_->occupancy_directory[_block] == 0 ? nullptr : 
+                                        &map_->occupancy_pool[(map_->occupancy_directory[_block] - 1) * occupancy_words_ * 2];
+            const float *cost = map_->cost_directory[_block] == 0 ? nullptr : 
+                                &map_->cost_pool[(map_->cost_directory[_block] - 1) * block_cells_];
+
+            for(int cell = 0; cell < block_cells_; ++cell){
+                Node &node = nodes[cell];
+                node.coordinates = origin + cellOffset(cell);
+                node.world_index = getWorldIndex(node.coordinates);
+                node.cost = cost == nullptr ? static_cast<float>(default_cost_) : cost[cell];
+                if(occupancy == nullptr)
+                    node.occuppied = unknownOccupied();
+                else if(occupancy[occupancy_words_ + (cell >> 6)] & (uint64_t{1} << (cell & 63)))
+                    node.occuppied = occupancy[cell >> 6] & (uint64_t{1} << (cell & 63));
+                else
+                    node.occuppied = unknownOccupied();
+            }
+            node_pool_.push_back(std::move(nodes));
+            node_directory_[_block] = node_pool_.size();
+            touched_blocks_.push_back(_block);
+        }
+        /**
+         * @brief Sparse backend: occupancy state of valid discrete coordinates
+         */
+        inline bool sparseOccupied(const int _x, const int _y, const int _z) const{
+
+            const uint32_t entry = map_->occupancy_directory[getBlockIndex(_x, _y, _z)];
+            if(entry == 0)
+                return unknownOccupied();
+
+            const uint64_t *occupancy = &map_->occupancy_pool[(entry - 1) * occupancy_words_ * 2];
+            const int cell = cellIndex(_x, _y, _z);
+            const uint64_t bit = uint64_t{1} << (cell & 63);
+            if(!(occupancy[occupancy_words_ + (cell >> 6)] & bit))
+                return unknownOccupied();
+
+            return occupancy[cell >> 6] & bit;
+        }
+        /**
+         * @brief Sparse backend: occupancy of the cells never set as occupied or free
+         */
+        inline bool unknownOccupied() const{
+
+            return unknown_as_occupied_ && !map_->cleaned;
+        }
+        /**
+         * @brief Sparse backend: mark valid discrete coordinates as known and occupied/free
+         */
+        void setSparseOccupancy(const int _x, const int _y, const int _z, const bool _occupied){
+
+            const long unsigned int block = getBlockIndex(_x, _y, _z);
+            SparseMap &map = mutableMap();
+            if(map.occupancy_directory[block] == 0){
+                map.occupancy_pool.resize(map.occupancy_pool.size() + occupancy_words_ * 2, 0);
+                map.occupancy_directory[block] = map.occupancy_pool.size() / (occupancy_words_ * 2);
+            }
+            uint64_t *occupancy = &map.occupancy_pool[(map.occupancy_directory[block] - 1) * occupancy_words_ * 2];
+            const int cell = cellIndex(_x, _y, _z);
+            const uint64_t bit = uint64_t{1} << (cell & 63);
+            occupancy[occupancy_words_ + (cell >> 6)] |= bit;
+            if(_occupied)
+                occupancy[cell >> 6] |= bit;
+            else
+                occupancy[cell >> 6] &= ~bit;
+
+            if(node_directory_[block] != 0)
+                node_pool_[node_directory_[block] - 1][cell].occuppied = _occupied;
+        }
+        /**
+         * @brief Sparse backend: clear the blocks and size the block directories for the current world size
+         */
+        void resizeBlocks(){
+
+            block_z_bits_ = world_z_size_ > 1 ? block_bits_ : 0;
+            block_cells_  = 1 << (2 * block_bits_ + block_z_bits_);
+            occupancy_words_ = (block_cells_ + 63) / 64;
+
+            blocks_x_ = (world_x_size_ + (1 << block_bits_) - 1) >> block_bits_;
+            blocks_y_ = (world_y_size_ + (1 << block_bits_) - 1) >> block_bits_;
+            blocks_z_ = (world_z_size_ + (1 << block_z_bits_) - 1) >> block_z_bits_;
+            const long unsigned int num_blocks = static_cast<long unsigned int>(blocks_x_) * blocks_y_ * blocks_z_;
+            if(num_blocks > std::numeric_limits<uint32_t>::max())
+                throw std::out_of_range("World too big for the sparse world directory");
+
+            node_pool_.clear();
+            touched_blocks_.clear();
+            node_directory_.assign(num_blocks, 0);
+            map_ = std::make_shared<SparseMap>();
+            map_->occupancy_directory.assign(num_blocks, 0);
+            map_->cost_directory.assign(num_blocks, 0);
+        }
+        /**
+         * @brief Sparse backend: fill the empty blocks created by resizeBlocks() with the map of a dense 
+         * world of the same size. Every dense cell is known, so the map is flagged as cleaned and only the 
+         * blocks with occupied cells, or with costs other than the default one, are allocated
+         */
+        void convertDenseMap(const std::vector<Node> &_dense){
+
+            SparseMap &map = *map_;
+            map.cleaned = true;
+            const float default_cost = static_cast<float>(default_cost_);
+            for(const auto &node: _dense){
+                const Vec3i &pos = node.coordinates;
+                const long unsigned int block = getBlockIndex(pos.x, pos.y, pos.z);
+                const int cell = cellIndex(pos.x, pos.y, pos.z);
+                if(node.occuppied){
+                    if(map.occupancy_directory[block] == 0){
+                        map.occupancy_pool.resize(map.occupancy_pool.size() + occupancy_words_ * 2, 0);
+                        map.occupancy_directory[block] = map.occupancy_pool.size() / (occupancy_words_ * 2);
+                    }
+                    uint64_t *occupancy = &map.occupancy_pool[(map.occupancy_directory[block] - 1) * occupancy_words_ * 2];
+                    const uint64_t bit = uint64_t{1} << (cell & 63);
+                    occupancy[cell >> 6] |= bit;
+                    occupancy[occupancy_words_ + (cell >> 6)] |= bit;
+                }
+                if(static_cast<float>(node.cost) != default_cost){
+                    if(map.cost_directory[block] == 0){
+                        map.cost_pool.resize(map.cost_pool.size() + block_cells_, default_cost);
+                        map.cost_directory[block] = map.cost_pool.size() / block_cells_;
+                    }
+                    map.cost_pool[(map.cost_directory[block] - 1) * block_cells_ + cell] = node.cost;
+                }
+            }
+        }
+        /**
+         * @brief Sparse backend: index of the block containing valid discrete coordinates
+         */
+        inline long unsigned int getBlockIndex(const int _x, const int _y, const int _z) const{
+
+            return (static_cast<long unsigned int>(_z >> block_z_bits_) * blocks_y_ + (_y >> block_bits_)) * blocks_x_ + (_x >> block_bits_);
+        }
+        /**
+         * @brief Sparse backend: index of the cell inside its block
+         */
+        inline int cellIndex(const int _x, const int _y, const int _z) const{
+
+            const int mask = (1 << block_bits_) - 1;
+            return (_x & mask) | ((_y & mask) << block_bits_) | ((_z & ((1 << block_z_bits_) - 1)) << (2 * block_bits_));
+        }
+        /**
+         * @brief Sparse backend: discrete coordinates of a cell relative to the origin of its block
+         */
+        inline Vec3i cellOffset(const int _cell) const{
+
+            const int mask = (1 << block_bits_) - 1;
+            return {_cell & mask, (_cell >> block_bits_) & mask, _cell >> (2 * block_bits_)};
+        }
+        /**
+         * @brief Sparse backend: discrete coordinates of the first cell of a block
+         */
+        inline Vec3i blockOrigin(const long unsigned int _block) const{
+
+            const int bx = _block % blocks_x_;
+            const int by = (_block / blocks_x_) % blocks_y_;
+            const int bz = _block / (static_cast<long unsigned int>(blocks_x_) * blocks_y_);
+            return {bx << block_bits_, by << block_bits_, bz << block_z_bits_};
+        }
+        inline const uint64_t* occupancyBlock(const Vec3i &_vec) const{
+
+            const uint32_t entry = map_->occupancy_directory[getBlockIndex(_vec.x, _vec.y, _vec.z)];
+            return entry == 0 ? nullptr : &map_->occupancy_pool[(entry - 1) * occupancy_words_ * 2];
+        }
+
         std::vector<Planners::utils::Node> discrete_world_vector_;
 
+        /**
+         * @brief Sparse backend: occupancy and cost blocks. It can be shared by several worlds (see shareMap), 
+         * each one with its own nodes. The directories store, for each block, 1 + its position in the pool (0 if not allocated)
+         */
+        struct SparseMap
+        {
+            std::vector<uint32_t> occupancy_directory, cost_directory;
+            std::vector<uint64_t> occupancy_pool; // Per block: occupied bits followed by known bits
+            std::vector<float> cost_pool;
+            bool cleaned{false}; // Set by cleanWorld(): the cells never set since then are free, not unknown
+        };
+        /**
+         * @brief Sparse backend: map blocks for writing. If the map is shared with other worlds, 
+         * this world gets its own copy first, so the other worlds keep seeing the previous map
+         */
+        SparseMap& mutableMap(){
+
+            if(map_.use_count() > 1)
+                map_ = std::make_shared<SparseMap>(*map_);
+
+            return *map_;
+        }
+
+        bool sparse_{false};
+        bool unknown_as_occupied_{false};
+        double default_cost_{0};
+        static constexpr int block_bits_{3};
+        int block_z_bits_{block_bits_}, block_cells_{1 << (3 * block_bits_)}, occupancy_words_{8};
+        unsigned int blocks_x_{0}, blocks_y_{0}, blocks_z_{0};
+        std::vector<uint32_t> node_directory_;
+        std::vector<std::unique_ptr<Node[]>> node_pool_;
+        std::vector<long unsigned int> touched_blocks_;
+        std::shared_ptr<SparseMap> map_;
+
         long unsigned int x_y_size_, x_y_local_size;
 
         unsigned int world_x_size_, world_y_size_, world_z_size_;
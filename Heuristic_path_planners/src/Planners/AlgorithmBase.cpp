@@ -1,4 +1,5 @@
 #include "Planners/AlgorithmBase.hpp"
+#include "Grid3D/distance_transform.hpp"
 
 namespace Planners
 {
@@ -30,18 +31,21 @@ namespace Planners
     void AlgorithmBase::setWorldSize(const Vec3i &_worldSize,const double _resolution)
     {
         discrete_world_.resizeWorld(_worldSize, _resolution);
+        notifyWorldChange();
     }
        // // JAC QUITAR setLocalWorldSize?
     void AlgorithmBase::setLocalWorldSize(const Vec3i &_worldSize,const double _resolution)
     {
         // el resizeLocalWorld lo hace bien (sept-2024)
         discrete_world_.resizeLocalWorld(_worldSize, _resolution); // Hay un error y parece que proviene del getWorldIndex en el world.hpp porque toma los valores del world_x_size y x_y_size en lugar de los "local"
+        notifyWorldChange();
     }
 
     // JAC
     void AlgorithmBase::cleanLocalWorld()
     {
         discrete_world_.cleanWorld();
+        notifyWorldChange();
     }
     
     Vec3i AlgorithmBase::getWorldSize(){
@@ -53,6 +57,18 @@ namespace Planners
     utils::DiscreteWorld* AlgorithmBase::getInnerWorld(){
         return &discrete_world_;
     }
+    void AlgorithmBase::shareMapFrom(const AlgorithmBase &_other)
+    {
+        discrete_world_.shareMap(_other.discrete_world_);
+        heuristic                = _other.heuristic;
+        do_inflate_              = _other.do_inflate_;
+        inflate_steps_           = _other.inflate_steps_;
+        inflation_mode_          = _other.inflation_mode_;
+        cost_weight_             = _other.cost_weight_;
+        max_line_of_sight_cells_ = _other.max_line_of_sight_cells_;
+        compute_statistics_      = _other.compute_statistics_;
+        notifyWorldChange();
+    }
 
     void AlgorithmBase::setHeuristic(HeuristicFunction heuristic_)
     {
@@ -72,13 +88,59 @@ namespace Planners
         {
             discrete_world_.setOccupied(coordinates_);
         }
+        notifyWorldChange(coordinates_, do_inflate ? steps : 0);
     }
     void AlgorithmBase::addCollision(const Vec3i &coordinates_)
     {
         addCollision(coordinates_, do_inflate_, inflate_steps_);
     }
+    void AlgorithmBase::addCollisions(const CoordinateList &_coordinates, bool do_inflate, unsigned int steps)
+    {
+        if (!do_inflate)
+        {
+            for (const auto &it : _coordinates)
+                discrete_world_.setOccupied(it);
+        }
+        else if (steps == 0)
+        {
+            // As inflateNodeAsCube, the cube modes do not mark the obstacles themselves. The sphere of radius 0 is the obstacle
+            if (inflation_mode_ == INFLATE_DT_SPHERE)
+                for (const auto &it : _coordinates)
+                    discrete_world_.setOccupied(it);
+        }
+        else if (inflation_mode_ == INFLATE_DT_CUBE)
+        {
+            inflateCollisionsAsCube(_coordinates, steps);
+        }
+        else if (inflation_mode_ == INFLATE_DT_SPHERE)
+        {
+            inflateCollisionsAsSphere(_coordinates, steps);
+        }
+        else
+        {
+            for (const auto &it : _coordinates)
+                inflateNodeAsCube(it, direction, steps);
+        }
+        const int margin = do_inflate ? steps : 0;
+        if (world_change_callback_)
+            for (const auto &it : _coordinates)
+                notifyWorldChange(it, margin);
+    }
+    void AlgorithmBase::addCollisions(const CoordinateList &_coordinates)
+    {
+        addCollisions(_coordinates, do_inflate_, inflate_steps_);
+    }
     void AlgorithmBase::removeCollision(const Vec3i &coordinates_)
     {
+        // Only a cell that was occupied changes the world
+        if (world_change_callback_)
+        {
+            const auto size = discrete_world_.getWorldSize();
+            if (coordinates_.x >= 0 && coordinates_.y >= 0 && coordinates_.z >= 0 &&
+                coordinates_.x < size.x && coordinates_.y < size.y && coordinates_.z < size.z &&
+                discrete_world_.isOccupied(coordinates_))
+                notifyWorldChange(coordinates_, 0);
+        }
         discrete_world_.setUnoccupied(coordinates_);
     }
     bool AlgorithmBase::detectCollision(const Vec3i &coordinates_)
@@ -101,86 +163,232 @@ namespace Planners
         }
     }
 
-    PathData AlgorithmBase::createResultDataObject(const Node* _last, utils::Clock &_timer, 
-                                                    const size_t _explored_nodes, bool _solved,
-                                                    const Vec3i &_start, const unsigned int _sight_checks){
-                                    
-        PathData result_data;
+    bool AlgorithmBase::inflationBox(const CoordinateList &_coordinates, const Vec3i &_pad, Vec3i &_min, Vec3i &_max)
+    {
+        // Obstacles outside the world but closer than _pad cells can still inflate cells inside it
+        const Vec3i world_size = discrete_world_.getWorldSize();
+        const Vec3i lower = Vec3i{0, 0, 0} - _pad;
+        const Vec3i upper = world_size + _pad - Vec3i{1, 1, 1};
+        bool any = false;
+        for (const auto &it : _coordinates)
+        {
+            if (it.x < lower.x || it.y < lower.y || it.z < lower.z || it.x > upper.x || it.y > upper.y || it.z > upper.z)
+                continue;
+            if (!any)
+            {
+                _min = _max = it;
+                any = true;
+                continue;
+            }
+            _min = {std::min(_min.x, it.x), std::min(_min.y, it.y), std::min(_min.z, it.z)};
+            _max = {std::max(_max.x, it.x), std::max(_max.y, it.y), std::max(_max.z, it.z)};
+        }
+        if (!any)
+            return false;
 
-        result_data["solved"]       = _solved;
-        result_data["goal_coords"]  = _last->coordinates;
-        result_data["g_final_node"] = _last->G;
+        // Bounding box of the obstacles grown by _pad and clipped to the padded world
+        _min = _min - _pad;
+        _max = _max + _pad;
+        _min = {std::max(_min.x, lower.x), std::max(_min.y, lower.y), std::max(_min.z, lower.z)};
+        _max = {std::min(_max.x, upper.x), std::min(_max.y, upper.y), std::min(_max.z, upper.z)};
+        return true;
+    }
 
-        CoordinateList path;
-        
+    void AlgorithmBase::inflateCollisionsAsCube(const CoordinateList &_coordinates, const unsigned int _inflate_steps)
+    {
+        const bool use_3d = std::any_of(direction.begin(), direction.end(), [](const Vec3i &d){ return d.z != 0; });
+        const int r = _inflate_steps;
+        Vec3i box_min, box_max;
+        if (!inflationBox(_coordinates, {r, r, use_3d ? r : 0}, box_min, box_max))
+            return;
+
+        const Vec3i size = box_max - box_min + Vec3i{1, 1, 1};
+        const long size_xy = static_cast<long>(size.x) * size.y;
+        const long cells = size_xy * size.z;
+
+        std::vector<uint8_t> obstacle(cells, 0), covered(cells, 0);
+        for (const auto &it : _coordinates)
+        {
+            Vec3i p = it - box_min;
+            if (p.x >= 0 && p.y >= 0 && p.z >= 0 && p.x < size.x && p.y < size.y && p.z < size.z)
+                obstacle[p.x + p.y * size.x + p.z * size_xy] = 1;
+        }
+
+        // steps[c] = number of steps from c to the closest obstacle found going backwards along the direction
+        const uint16_t far = static_cast<uint16_t>(std::min<unsigned int>(_inflate_steps + 1, 65535));
+        std::vector<uint16_t> steps(cells);
+        for (const auto &d : direction)
+        {
+            // Traverse the rows so that the row of c - d is always visited before the row of c
+            const int y0 = d.y >= 0 ? 0 : size.y - 1, dy = d.y >= 0 ? 1 : -1;
+            const int z0 = d.z >= 0 ? 0 : size.z - 1, dz = d.z >= 0 ? 1 : -1;
+
+            for (int k = 0, z = z0; k < size.z; ++k, z += dz)
+            {
+                for (int j = 0, y = y0; j < size.y; ++j, y += dy)
+                {
+                    const long row = y * size.x + z * size_xy;
+                    uint16_t *row_steps = &steps[row];
+                    uint8_t *row_covered = &covered[row];
+                    const uint8_t *row_obstacle = &obstacle[row];
+
+                    if (d.y == 0 && d.z == 0)
+                    {
+                        // Along the row: sequential dependency
+                        const int x0 = d.x >= 0 ? 0 : size.x - 1;
+                        uint16_t from_previous = far;
+                        for (int i = 0, x = x0; i < size.x; ++i, x += d.x)
+                        {
+                            // The obstacle itself is only marked if another obstacle reaches it
+                            row_covered[x] |= (from_previous < far);
+                            row_steps[x] = row_obstacle[x] ? 0 : from_previous;
+                            from_previous = std::min<uint16_t>(row_steps[x] + 1, far);
+                        }
+                        continue;
+                    }
+
+                    const int py = y - d.y, pz = z - d.z;
+                    if (py < 0 || pz < 0 || py >= size.y || pz >= size.z)
+                    {
+                        // The previous row is outside the box
+                        for (int x = 0; x < size.x; ++x)
+                            row_steps[x] = row_obstacle[x] ? 0 : far;
+                        continue;
+                    }
+
+                    // Different rows: no dependency inside the row
+                    const uint16_t *prev_steps = &steps[py * size.x + pz * size_xy];
+                    const int x_begin = std::max(0, d.x), x_end = std::min(size.x, size.x + d.x);
+                    for (int x = 0; x < x_begin; ++x)
+                        row_steps[x] = row_obstacle[x] ? 0 : far;
+                    for (int x = x_end; x < size.x; ++x)
+                        row_steps[x] = row_obstacle[x] ? 0 : far;
+                    for (int x = x_begin; x < x_end; ++x)
+                    {
+                        const uint16_t from_previous = std::min<uint16_t>(prev_steps[x - d.x] + 1, far);
+                        row_covered[x] |= (from_previous < far);
+                        row_steps[x] = row_obstacle[x] ? 0 : from_previous;
+                    }
+                }
+            }
+        }
+
+        markInflatedCells(covered, box_min, size);
+    }
+
+    void AlgorithmBase::inflateCollisionsAsSphere(const CoordinateList &_coordinates, const unsigned int _inflate_steps)
+    {
+        const bool use_3d = std::any_of(direction.begin(), direction.end(), [](const Vec3i &d){ return d.z != 0; });
+        const int r = _inflate_steps;
+        const float max_sq_dist = static_cast<float>(r) * r;
+
+        // In 2D every z layer is inflated independently
+        const int layers = use_3d ? 1 : discrete_world_.getWorldSize().z;
+        for (int layer = 0; layer < layers; ++layer)
+        {
+            CoordinateList layer_coordinates;
+            if (!use_3d)
+            {
+                for (const auto &it : _coordinates)
+                    if (it.z == layer)
+                        layer_coordinates.push_back(it);
+            }
+            const CoordinateList &obstacles_world = use_3d ? _coordinates : layer_coordinates;
+
+            Vec3i box_min, box_max;
+            if (!inflationBox(obstacles_world, {r, r, use_3d ? r : 0}, box_min, box_max))
+                continue;
+            const Vec3i size = box_max - box_min + Vec3i{1, 1, 1};
+
+            CoordinateList obstacles;
+            for (const auto &it : obstacles_world)
+            {
+                Vec3i p = it - box_min;
+                if (p.x >= 0 && p.y >= 0 && p.z >= 0 && p.x < size.x && p.y < size.y && p.z < size.z)
+                    obstacles.push_back(p);
+            }
+
+            std::vector<float> sq_dist;
+            if (!DistanceTransform3d::compute(obstacles, size.x, size.y, size.z, 1.0f, sq_dist))
+                continue;
+
+            std::vector<uint8_t> covered(sq_dist.size());
+            for (size_t i = 0; i < sq_dist.size(); ++i)
+                covered[i] = sq_dist[i] <= max_sq_dist;
+            markInflatedCells(covered, box_min, size);
+        }
+    }
+
+    void AlgorithmBase::markInflatedCells(const std::vector<uint8_t> &_covered, const Vec3i &_box_min, const Vec3i &_box_size)
+    {
+        long index = 0;
+        for (int z = 0; z < _box_size.z; ++z)
+            for (int y = 0; y < _box_size.y; ++y)
+                for (int x = 0; x < _box_size.x; ++x, ++index)
+                    if (_covered[index])
+                        discrete_world_.setOccupied(x + _box_min.x, y + _box_min.y, z + _box_min.z);
+    }
+
+    void AlgorithmBase::fillPlanResult(const Node* _last, utils::Clock &_timer, 
+                                       const size_t _explored_nodes, bool _solved,
+                                       const Vec3i &_start, const unsigned int _sight_checks, PlanResult &_result){
+
+        _result.solved       = _solved;
+        _result.goal_coords  = _last->coordinates;
+        _result.g_final_node = _last->G;
+
+        _result.path.clear();
         if(_solved){
             while (_last != nullptr) {
                 
-                path.push_back(_last->coordinates);
+                _result.path.push_back(_last->coordinates);
                 _last = _last->parent;
             }
         }else{
             std::cout << "Error impossible to calculate a solution" << std::endl;
         }
-        
-        unsigned int total_cost1{0};
-        unsigned int total_cost2{0};
-        
-        unsigned int total_H{0};
-        unsigned int total_G1{0};
-        unsigned int total_G2{0};
-        unsigned int total_C{0};
 
-        unsigned int total_grid_cost1{0};
-        unsigned int total_grid_cost2{0};
+        _result.statistics.clear();
+        if( compute_statistics_ )
+            computePathStatistics(_result.path, _result.statistics);
 
-#ifdef COMPUTE_STATISTICS
-        
-        auto adjacent_path = utils::geometry::getAdjacentPath(path, discrete_world_);
+        _result.algorithm               = algorithm_name_;
+        _result.time_spent              = _timer.getElapsedMicroSeconds();
+        _result.explored_nodes          = _explored_nodes;
+        _result.start_coords            = _start;
+        _result.path_length             = geometry::calculatePathLength(_result.path, discrete_world_.getResolution());
+
+        _result.line_of_sight_checks    = _sight_checks;
+        _result.max_line_of_sight_cells = max_line_of_sight_cells_;
+        _result.cost_weight             = cost_weight_;
+    }
+
+    void AlgorithmBase::computePathStatistics(const CoordinateList &_path, PathStatistics &_statistics){
+
+        auto adjacent_path = utils::geometry::getAdjacentPath(_path, discrete_world_);
         
-        for(size_t i = 0; i < adjacent_path.size() - 1; ++i){
+        for(size_t i = 0; i + 1 < adjacent_path.size(); ++i){
             auto node_current = discrete_world_.getNodePtr(adjacent_path[i]);
             auto node         = discrete_world_.getNodePtr(adjacent_path[i+1]);
             if( node == nullptr )
                 continue;
             
-            total_H         += node->H;
-            total_C         += node->C;
+            _statistics.h_cost += node->H;
+            _statistics.c_cost += node->C;
 
-            total_grid_cost1 += static_cast<unsigned int>( cost_weight_ * node_current->cost * dist_scale_factor_reduced_ );  // CAA*+M1
-            total_grid_cost2 += static_cast<unsigned int>( ( ( node->cost + node_current->cost ) / 2) *  cost_weight_ * dist_scale_factor_reduced_); ; //CAA*+M2         
+            _statistics.grid_cost1 += static_cast<unsigned int>( cost_weight_ * node_current->cost * dist_scale_factor_reduced_ );  // CAA*+M1
+            _statistics.grid_cost2 += static_cast<unsigned int>( ( ( node->cost + node_current->cost ) / 2) *  cost_weight_ * dist_scale_factor_reduced_); //CAA*+M2         
 
             unsigned int g_real1 = utils::geometry::distanceBetween2Nodes(adjacent_path[i], adjacent_path[i+1]); 
             unsigned int g_real2 = utils::geometry::distanceBetween2Nodes(adjacent_path[i], adjacent_path[i+1]);  // Conmensurable
 
-            total_G1 += g_real1; 
-            total_G2 += g_real2;            
+            _statistics.g_cost1 += g_real1; 
+            _statistics.g_cost2 += g_real2;            
         }
         
-        total_cost1 = total_G1 + total_grid_cost1; 
-        total_cost2 = total_G2 + total_grid_cost2; 
-#endif
-        result_data["algorithm"]               = algorithm_name_;
-        result_data["path"]                    = path;
-        result_data["time_spent"]              = _timer.getElapsedMicroSeconds();
-        result_data["explored_nodes"]          = _explored_nodes;
-        result_data["start_coords"]            = _start;
-        result_data["path_length"]             = geometry::calculatePathLength(path, discrete_world_.getResolution());
-
-        result_data["total_cost1"]              = total_cost1;
-        result_data["total_cost2"]              = total_cost2;
-        result_data["h_cost"]                   = total_H;
-        result_data["g_cost1"]                  = total_G1;
-        result_data["g_cost2"]                  = total_G2;
-        result_data["c_cost"]                   = total_C;
-        result_data["grid_cost1"]               = total_grid_cost1;
-        result_data["grid_cost2"]               = total_grid_cost2;
-
-        result_data["line_of_sight_checks"]    = _sight_checks;
-        result_data["max_line_of_sight_cells"] = max_line_of_sight_cells_;
-        result_data["cost_weight"]             = cost_weight_;
-    
-        return result_data;
+        _statistics.total_cost1 = _statistics.g_cost1 + _statistics.grid_cost1; 
+        _statistics.total_cost2 = _statistics.g_cost2 + _statistics.grid_cost2; 
+        _statistics.computed    = true;
     }
 
 }
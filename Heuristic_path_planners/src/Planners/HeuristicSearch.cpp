@@ -0,0 +1,19 @@
+#include "Planners/HeuristicSearch.hpp"
+
+namespace Planners{
+
+    template class HeuristicSearch<NoCostPolicy,       NoLineOfSight>;
+    template class HeuristicSearch<CostAwarePolicy,    NoLineOfSight>;
+    template class HeuristicSearch<SafetyCostPolicy,   NoLineOfSight>;
+    template class HeuristicSearch<SirenCostPolicy,    NoLineOfSight>;
+    template class HeuristicSearch<NoCostPolicy,       EagerLineOfSight>;
+    template class HeuristicSearch<CostAwarePolicy,    EagerLineOfSight>;
+    template class HeuristicSearch<SafetyCostPolicy,   EagerLineOfSight>;
+    template class HeuristicSearch<SirenCostPolicy,    EagerLineOfSight>;
+    template class HeuristicSearch<NoCostPolicy,       LazyLineOfSight>;
+    template class HeuristicSearch<CostAwarePolicy,    LazyLineOfSight>;
+    template class HeuristicSearch<CostAwareModPolicy, LazyLineOfSight>;
+    template class HeuristicSearch<SafetyCostPolicy,   LazyLineOfSight>;
+    template class HeuristicSearch<SirenCostPolicy,    LazyLineOfSight>;
+
+}
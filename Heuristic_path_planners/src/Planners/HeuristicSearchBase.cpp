@@ -0,0 +1,115 @@
+#include "Planners/HeuristicSearchBase.hpp"
+
+namespace Planners{
+
+HeuristicSearchBase::HeuristicSearchBase(bool _use_3d, std::string _name): AlgorithmBase(_use_3d, _name)
+{
+    configAlgorithm();
+}
+void HeuristicSearchBase::configAlgorithm(){
+
+    closedSet_.reserve(50000);
+
+    checked_nodes.reset(new CoordinateList);
+    checked_nodes_current.reset(new CoordinateList);
+
+    checked_nodes->reserve(5000);
+    checked_nodes_current->reserve(5000);
+    //If compiled with ros and visualization
+#ifdef ROS
+    explored_nodes_marker_pub_ = lnh_.advertise<visualization_msgs::Marker>("explored_nodes",   1);
+    openset_marker_pub_        = lnh_.advertise<visualization_msgs::Marker>("openset_nodes",    1);
+    closedset_marker_pub_      = lnh_.advertise<visualization_msgs::Marker>("closed_set_nodes", 1);
+    best_node_marker_pub_      = lnh_.advertise<visualization_msgs::Marker>("best_node_marker", 1);
+    aux_text_marker_pub_       = lnh_.advertise<visualization_msgs::Marker>("aux_text_marker",  1);
+	occupancy_marker_pub_ = lnh_.advertise<pcl::PointCloud<pcl::PointXYZ>>("occupancy_markers", 1, true);
+    local_occupancy_marker_pub_ = lnh_.advertise<pcl::PointCloud<pcl::PointXYZ>>("occupancy_markers", 1, true);
+
+    std::string frame_id;
+    lnh_.param("frame_id", frame_id, std::string("map"));	
+    lnh_.param("resolution", resolution_, (float)0.2);
+	occupancy_marker_.header.frame_id = frame_id; // "world";
+
+    //JAC
+    std::string frame_id_local;
+    // lnh_.param("frame_id_local", frame_id_local, std::string("base_link"));	
+    lnh_.param("frame_id_local", frame_id_local, std::string("occupancy_map"));	
+    lnh_.param("resolution", resolution_, (float)0.2);
+	local_occupancy_marker_.header.frame_id = frame_id_local; // "base_link";
+
+    explored_node_marker_.header.frame_id = frame_id; //"world";
+	explored_node_marker_.header.stamp = ros::Time();
+	explored_node_marker_.ns = "debug";
+	explored_node_marker_.id = 66;
+	explored_node_marker_.type = visualization_msgs::Marker::CUBE_LIST;
+	explored_node_marker_.action = visualization_msgs::Marker::ADD;
+	explored_node_marker_.pose.orientation.w = 1.0;
+	explored_node_marker_.scale.x = 1.0 * resolution_;
+	explored_node_marker_.scale.y = 1.0 * resolution_;
+	explored_node_marker_.scale.z = 1.0 * resolution_;
+	explored_node_marker_.color.a = 0.7;
+	explored_node_marker_.color.r = 0.0;
+	explored_node_marker_.color.g = 1.0;
+	explored_node_marker_.color.b = 0.0;
+
+    openset_markers_    = explored_node_marker_;
+    openset_markers_.color.b = 1.0;
+    openset_markers_.color.g = 0.0;
+	openset_markers_.id      = 67;
+
+    closed_set_markers_ = explored_node_marker_;
+    closed_set_markers_.color.g = 0.0;
+    closed_set_markers_.color.r = 1.0;
+	explored_node_marker_.id = 68;
+
+    best_node_marker_ = explored_node_marker_;
+    best_node_marker_.color.g = 0.7;
+    best_node_marker_.color.b = 0.7;
+    best_node_marker_.id     = 69;
+	best_node_marker_.type = visualization_msgs::Marker::SPHERE;
+
+    aux_text_marker_   = explored_node_marker_;
+	aux_text_marker_.type = visualization_msgs::Marker::TEXT_VIEW_FACING;
+	aux_text_marker_.id = 70;
+	aux_text_marker_.color.a = 0.7;
+	aux_text_marker_.color.g = 0.0;
+    aux_text_marker_.text = "";
+	aux_text_marker_.scale.z = 3.0 * resolution_;
+    last_publish_tamp_ = ros::Time::now();
+#endif
+
+}
+void HeuristicSearchBase::publishOccupationMarkersMap()
+{
+#ifdef ROS
+	occupancy_marker_.clear();
+    for(const auto &it: discrete_world_.getOccupiedCoordinates()){
+        pcl::PointXYZ point;
+
+		point.x = it.x * resolution_;
+		point.y = it.y * resolution_;
+		point.z = it.z * resolution_;
+		occupancy_marker_.push_back(point);
+    }
+
+	occupancy_marker_pub_.publish(occupancy_marker_);
+#endif
+}
+
+void HeuristicSearchBase::publishLocalOccupationMarkersMap()
+{
+#ifdef ROS
+	local_occupancy_marker_.clear();    
+    for(const auto &it: discrete_world_.getOccupiedCoordinates()){
+        pcl::PointXYZ point;
+
+		point.x = it.x * resolution_;
+		point.y = it.y * resolution_;
+		point.z = it.z * resolution_;
+		local_occupancy_marker_.push_back(point);
+    }
+	local_occupancy_marker_pub_.publish(local_occupancy_marker_);
+#endif
+}
+
+}
@@ -0,0 +1,533 @@
+#include "Planners/HierarchicalPlanner.hpp"
+#include "utils/heuristic.hpp"
+
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+
+namespace Planners
+{
+    namespace
+    {
+        /** @brief Runs _body(i) for i in [0, _n) over _n_threads threads */
+        template<typename Body>
+        void parallelFor(const size_t _n, unsigned int _n_threads, Body _body)
+        {
+            if( _n_threads == 0 )
+                _n_threads = std::max(1u, std::thread::hardware_concurrency());
+            _n_threads = std::max<size_t>(1, std::min<size_t>(_n_threads, _n));
+
+            std::atomic<size_t> next{0};
+            auto worker = [&](){
+                for(size_t i = next++; i < _n; i = next++)
+                    _body(i);
+            };
+            std::vector<std::thread> threads;
+            for(unsigned int t = 1; t < _n_threads; ++t)
+                threads.emplace_back(worker);
+            worker();
+            for(auto &thread: threads)
+                thread.join();
+        }
+
+        inline bool sameCell(const Vec3i &_a, const Vec3i &_b)
+        {
+            return _a.x == _b.x && _a.y == _b.y && _a.z == _b.z;
+        }
+
+        inline int& component(Vec3i &_vec, const int _axis)
+        {
+            return _axis == 0 ? _vec.x : ( _axis == 1 ? _vec.y : _vec.z );
+        }
+
+        inline int component(const Vec3i &_vec, const int _axis)
+        {
+            return _axis == 0 ? _vec.x : ( _axis == 1 ? _vec.y : _vec.z );
+        }
+    }
+
+    HierarchicalPlanner::HierarchicalPlanner(AlgorithmBase &_algorithm, const bool _use_3d, const unsigned int _cluster_size):
+        algorithm_(_algorithm), world_(*_algorithm.getInnerWorld()), use_3d_(_use_3d)
+    {
+        world_size_   = world_.getWorldSize();
+        const int size = std::max(2u, _cluster_size);
+        cluster_size_ = {size, size, use_3d_ ? size : 1};
+        n_clusters_   = {( world_size_.x + cluster_size_.x - 1 ) / cluster_size_.x,
+                         ( world_size_.y + cluster_size_.y - 1 ) / cluster_size_.y,
+                         ( world_size_.z + cluster_size_.z - 1 ) / cluster_size_.z};
+        n_axes_ = use_3d_ ? 3 : 2;
+
+        const size_t n_clusters = static_cast<size_t>(n_clusters_.x) * n_clusters_.y * n_clusters_.z;
+        corridor_.cluster_size = cluster_size_;
+        corridor_.n_clusters   = n_clusters_;
+        corridor_.clusters.assign(n_clusters, 0);
+
+        faces_.resize(3 * n_clusters);
+        clusters_.resize(n_clusters);
+        dirty_.assign(n_clusters, 0);
+
+        algorithm_.setWorldChangeCallback([this](const Vec3i &_min, const Vec3i &_max){ markDirty(_min, _max); });
+    }
+
+    HierarchicalPlanner::~HierarchicalPlanner()
+    {
+        algorithm_.setWorldChangeCallback(WorldChangeFunction());
+    }
+
+    void HierarchicalPlanner::build(unsigned int _n_threads)
+    {
+        n_threads_ = _n_threads;
+        dirty_list_.clear();
+        for(size_t i = 0; i < clusters_.size(); ++i){
+            dirty_[i] = 1;
+            dirty_list_.push_back(i);
+        }
+        update(_n_threads);
+    }
+
+    void HierarchicalPlanner::addCollision(const Vec3i &_coordinates)
+    {
+        algorithm_.addCollision(_coordinates);
+    }
+
+    void HierarchicalPlanner::addCollisions(const CoordinateList &_coordinates)
+    {
+        algorithm_.addCollisions(_coordinates);
+    }
+
+    void HierarchicalPlanner::removeCollision(const Vec3i &_coordinates)
+    {
+        algorithm_.removeCollision(_coordinates);
+    }
+
+    void HierarchicalPlanner::markDirty(const Vec3i &_cell, const unsigned int _margin)
+    {
+        const int margin = _margin;
+        markDirty({_cell.x - margin, _cell.y - margin, _cell.z - margin}, {_cell.x + margin, _cell.y + margin, _cell.z + margin});
+    }
+
+    void HierarchicalPlanner::markDirty(const Vec3i &_min, const Vec3i &_max)
+    {
+        const Vec3i min{std::max(0, _min.x), std::max(0, _min.y), std::max(0, _min.z)};
+        const Vec3i max{std::min(world_size_.x - 1, _max.x), std::min(world_size_.y - 1, _max.y),
+                        std::min(world_size_.z - 1, _max.z)};
+        if( min.x > max.x || min.y > max.y || min.z > max.z )
+            return;
+
+        const auto first = clusterCoordinates(min);
+        const auto last  = clusterCoordinates(max);
+        for(int z = first.z; z <= last.z; ++z)
+            for(int y = first.y; y <= last.y; ++y)
+                for(int x = first.x; x <= last.x; ++x){
+                    const int cluster = corridor_.clusterIndex({x, y, z});
+                    if( !dirty_[cluster] ){
+                        dirty_[cluster] = 1;
+                        dirty_list_.push_back(cluster);
+                    }
+                }
+    }
+
+    void HierarchicalPlanner::findPath(const Vec3i &_source, const Vec3i &_target, torch::jit::script::Module& loaded_sdf, PlanResult &_result)
+    {
+        utils::Clock abstract_timer;
+        abstract_timer.tic();
+        update(n_threads_);
+        const bool abstract_solved = abstractSearch(_source, _target);
+        abstract_timer.toc();
+
+        double time_spent = abstract_timer.getElapsedMicroSeconds();
+        _result.solved = false;
+        _result.path.clear();
+        used_fallback_ = false;
+        if( abstract_solved ){
+            algorithm_.setSearchCorridor(&corridor_);
+            algorithm_.findPath(_source, _target, loaded_sdf, _result);
+            algorithm_.setSearchCorridor(nullptr);
+            time_spent += _result.time_spent;
+        }
+        if( !_result.solved && full_world_fallback_ ){
+            used_fallback_ = true;
+            algorithm_.findPath(_source, _target, loaded_sdf, _result);
+            time_spent += _result.time_spent;
+        }
+        _result.time_spent = time_spent;
+    }
+
+    size_t HierarchicalPlanner::getAbstractNodes() const
+    {
+        size_t n_nodes{0};
+        for(const auto &it: clusters_)
+            n_nodes += it.entrances.size();
+
+        return n_nodes;
+    }
+
+    void HierarchicalPlanner::update(unsigned int _n_threads)
+    {
+        if( dirty_list_.empty() )
+            return;
+
+        // Faces of the dirty clusters
+        std::vector<int> faces, rebuilt;
+        for(const auto &cluster: dirty_list_){
+            rebuilt.push_back(cluster);
+            for(unsigned int axis = 0; axis < n_axes_; ++axis){
+                faces.push_back(3 * cluster + axis);
+                const int previous = neighbourCluster(cluster, axis, -1);
+                if( previous >= 0 )
+                    faces.push_back(3 * previous + axis);
+            }
+            dirty_[cluster] = 0;
+        }
+        dirty_list_.clear();
+
+        auto unique = [](std::vector<int> &_vector){
+            std::sort(_vector.begin(), _vector.end());
+            _vector.erase(std::unique(_vector.begin(), _vector.end()), _vector.end());
+        };
+        unique(faces);
+
+        std::vector<uint8_t> changed(faces.size());
+        parallelFor(faces.size(), _n_threads, [&](size_t i){ changed[i] = buildFace(faces[i] / 3, faces[i] % 3); });
+
+        // The clusters at both sides of a changed face have different entrances
+        for(size_t i = 0; i < faces.size(); ++i)
+            if( changed[i] ){
+                rebuilt.push_back(faces[i] / 3);
+                rebuilt.push_back(neighbourCluster(faces[i] / 3, faces[i] % 3, 1));
+            }
+        unique(rebuilt);
+        parallelFor(rebuilt.size(), _n_threads, [&](size_t i){ buildCluster(rebuilt[i]); });
+
+        // The entrances of the rebuilt clusters may have changed their order
+        std::vector<int> partners(rebuilt);
+        for(const auto &cluster: rebuilt)
+            for(unsigned int axis = 0; axis < n_axes_; ++axis)
+                for(const int sign: {-1, 1}){
+                    const int neighbour = neighbourCluster(cluster, axis, sign);
+                    if( neighbour >= 0 )
+                        partners.push_back(neighbour);
+                }
+        unique(partners);
+        for(const auto &cluster: partners)
+            resolvePartners(cluster);
+    }
+
+    bool HierarchicalPlanner::buildFace(const int _cluster, const int _axis)
+    {
+        auto &transitions = faces_[3 * _cluster + _axis];
+        const auto previous = std::move(transitions);
+        transitions.clear();
+        if( neighbourCluster(_cluster, _axis, 1) < 0 )
+            return false;
+
+        Vec3i min, max;
+        clusterBox(_cluster, min, max);
+
+        // Axes of the face plane
+        const int u_axis = _axis == 0 ? 1 : 0;
+        const int v_axis = _axis == 2 ? 1 : 2;
+        const int u_min = component(min, u_axis), u_size = component(max, u_axis) - u_min;
+        const int v_min = component(min, v_axis), v_size = component(max, v_axis) - v_min;
+
+        auto faceCell = [&](const int _u, const int _v, const int _side) -> Vec3i {
+            Vec3i cell;
+            component(cell, _axis)  = component(max, _axis) - 1 + _side;
+            component(cell, u_axis) = u_min + _u;
+            component(cell, v_axis) = v_min + _v;
+            return cell;
+        };
+
+        // Cells of the face where both sides are free
+        std::vector<uint8_t> free(u_size * v_size);
+        for(int v = 0; v < v_size; ++v)
+            for(int u = 0; u < u_size; ++u)
+                free[v * u_size + u] = !world_.isOccupied(faceCell(u, v, 0)) && !world_.isOccupied(faceCell(u, v, 1));
+
+        // One transition per 8-connected region, at the cell closest to its centroid
+        std::vector<int> region, stack;
+        for(int start = 0; start < u_size * v_size; ++start){
+            if( !free[start] )
+                continue;
+
+            region.clear();
+            stack.assign(1, start);
+            free[start] = 0;
+            double u_mean{0}, v_mean{0};
+            while( !stack.empty() ){
+                const int cell = stack.back();
+                stack.pop_back();
+                region.push_back(cell);
+                const int u = cell % u_size, v = cell / u_size;
+                u_mean += u;
+                v_mean += v;
+                for(int dv = -1; dv <= 1; ++dv)
+                    for(int du = -1; du <= 1; ++du){
+                        const int nu = u + du, nv = v + dv;
+                        if( nu < 0 || nv < 0 || nu >= u_size || nv >= v_size || !free[nv * u_size + nu] )
+                            continue;
+                        free[nv * u_size + nu] = 0;
+                        stack.push_back(nv * u_size + nu);
+                    }
+            }
+            u_mean /= region.size();
+            v_mean /= region.size();
+
+            int best = region.front();
+            double best_distance = std::numeric_limits<double>::max();
+            for(const auto &cell: region){
+                const double du = cell % u_size - u_mean, dv = cell / u_size - v_mean;
+                if( du * du + dv * dv < best_distance ){
+                    best_distance = du * du + dv * dv;
+                    best = cell;
+                }
+            }
+            transitions.push_back({faceCell(best % u_size, best / u_size, 0), faceCell(best % u_size, best / u_size, 1)});
+        }
+
+        return transitions.size() != previous.size() ||
+               !std::equal(transitions.begin(), transitions.end(), previous.begin(), [](const Transition &_a, const Transition &_b){
+                   return sameCell(_a.inside, _b.inside) && sameCell(_a.outside, _b.outside);
+               });
+    }
+
+    void HierarchicalPlanner::buildCluster(const int _cluster)
+    {
+        auto &cluster = clusters_[_cluster];
+        cluster.entrances.clear();
+
+        for(unsigned int axis = 0; axis < n_axes_; ++axis){
+            const int previous = neighbourCluster(_cluster, axis, -1);
+            if( previous >= 0 )
+                for(const auto &it: faces_[3 * previous + axis])
+                    cluster.entrances.push_back({it.outside, it.inside, previous});
+
+            const int next = neighbourCluster(_cluster, axis, 1);
+            if( next >= 0 )
+                for(const auto &it: faces_[3 * _cluster + axis])
+                    cluster.entrances.push_back({it.inside, it.outside, next});
+        }
+
+        Vec3i min, max;
+        clusterBox(_cluster, min, max);
+        const Vec3i size{max.x - min.x, max.y - min.y, max.z - min.z};
+        auto localIndex = [&](const Vec3i &_cell){
+            return ( ( _cell.z - min.z ) * size.y + ( _cell.y - min.y ) ) * size.x + ( _cell.x - min.x );
+        };
+
+        const size_t n = cluster.entrances.size();
+        cluster.distances.assign(n * n, unreachable_);
+        std::vector<uint32_t> distances;
+        for(size_t i = 0; i < n; ++i){
+            clusterDistances(_cluster, cluster.entrances[i].cell, distances);
+            for(size_t j = 0; j < n; ++j)
+                cluster.distances[i * n + j] = distances[localIndex(cluster.entrances[j].cell)];
+        }
+    }
+
+    void HierarchicalPlanner::resolvePartners(const int _cluster)
+    {
+        for(auto &entrance: clusters_[_cluster].entrances){
+            entrance.partner = -1;
+            const auto &others = clusters_[entrance.neighbour].entrances;
+            for(size_t i = 0; i < others.size(); ++i)
+                if( others[i].neighbour == _cluster && sameCell(others[i].cell, entrance.other) && sameCell(others[i].other, entrance.cell) ){
+                    entrance.partner = i;
+                    break;
+                }
+        }
+    }
+
+    void HierarchicalPlanner::clusterDistances(const int _cluster, const Vec3i &_source, std::vector<uint32_t> &_distances) const
+    {
+        Vec3i min, max;
+        clusterBox(_cluster, min, max);
+        const Vec3i size{max.x - min.x, max.y - min.y, max.z - min.z};
+        _distances.assign(static_cast<size_t>(size.x) * size.y * size.z, unreachable_);
+
+        using QueueEntry = std::pair<uint32_t, int>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+        const int source = ( ( _source.z - min.z ) * size.y + ( _source.y - min.y ) ) * size.x + ( _source.x - min.x );
+        _distances[source] = 0;
+        queue.push({0, source});
+
+        while( !queue.empty() ){
+            const auto [distance, index] = queue.top();
+            queue.pop();
+            if( distance != _distances[index] )
+                continue;
+
+            const int x = index % size.x, y = ( index / size.x ) % size.y, z = index / ( size.x * size.y );
+            for(int dz = -1; dz <= 1; ++dz){
+                if( !use_3d_ && dz != 0 )
+                    continue;
+                for(int dy = -1; dy <= 1; ++dy)
+                    for(int dx = -1; dx <= 1; ++dx){
+                        const int n_axes = std::abs(dx) + std::abs(dy) + std::abs(dz);
+                        const int nx = x + dx, ny = y + dy, nz = z + dz;
+                        if( n_axes == 0 || nx < 0 || ny < 0 || nz < 0 || nx >= size.x || ny >= size.y || nz >= size.z )
+                            continue;
+                        if( world_.isOccupied(min.x + nx, min.y + ny, min.z + nz) )
+                            continue;
+
+                        // Same step costs used by the search
+                        const uint32_t next_distance = distance + ( n_axes == 1 ? dist_scale_factor_ : ( n_axes == 2 ? dd_2D_ : dd_3D_ ) );
+                        const int next = ( nz * size.y + ny ) * size.x + nx;
+                        if( next_distance < _distances[next] ){
+                            _distances[next] = next_distance;
+                            queue.push({next_distance, next});
+                        }
+                    }
+            }
+        }
+    }
+
+    bool HierarchicalPlanner::abstractSearch(const Vec3i &_source, const Vec3i &_target)
+    {
+        const int source_cluster = clusterOf(_source);
+        const int target_cluster = clusterOf(_target);
+
+        // Connect the start and the goal to the entrances of their clusters
+        std::vector<uint32_t> source_distances, target_distances;
+        clusterDistances(source_cluster, _source, source_distances);
+        clusterDistances(target_cluster, _target, target_distances);
+
+        auto localDistance = [this](const int _cluster, const std::vector<uint32_t> &_distances, const Vec3i &_cell){
+            Vec3i min, max;
+            clusterBox(_cluster, min, max);
+            return _distances[( ( _cell.z - min.z ) * ( max.y - min.y ) + ( _cell.y - min.y ) ) * ( max.x - min.x ) + ( _cell.x - min.x )];
+        };
+
+        // Abstract nodes: cluster << 32 | entrance, plus the start and the goal
+        constexpr uint64_t start_key = std::numeric_limits<uint64_t>::max() - 1;
+        constexpr uint64_t goal_key  = std::numeric_limits<uint64_t>::max();
+        auto key = [](const uint64_t _cluster, const uint64_t _entrance){ return ( _cluster << 32 ) | _entrance; };
+
+        struct State
+        {
+            uint32_t g;
+            uint64_t parent;
+            bool closed;
+        };
+        std::unordered_map<uint64_t, State> states;
+        using QueueEntry = std::tuple<uint32_t, uint64_t>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+
+        auto relax = [&](const uint64_t _key, const Vec3i &_cell, const uint32_t _g, const uint64_t _parent){
+            auto it = states.find(_key);
+            if( it != states.end() && ( it->second.closed || it->second.g <= _g ) )
+                return;
+            states[_key] = {_g, _parent, false};
+            open.push({_g + ( _key == goal_key ? 0 : Heuristic::euclidean(_cell, _target) ), _key});
+        };
+
+        states[start_key] = {0, start_key, false};
+        open.push({0, start_key});
+
+        bool solved{false};
+        while( !open.empty() ){
+            const auto [f, current] = open.top();
+            open.pop();
+            auto &state = states[current];
+            if( state.closed )
+                continue;
+            state.closed = true;
+            const uint32_t g = state.g;
+
+            if( current == goal_key ){
+                solved = true;
+                break;
+            }
+            if( current == start_key ){
+                const auto &entrances = clusters_[source_cluster].entrances;
+                for(size_t i = 0; i < entrances.size(); ++i){
+                    const auto distance = localDistance(source_cluster, source_distances, entrances[i].cell);
+                    if( distance != unreachable_ )
+                        relax(key(source_cluster, i), entrances[i].cell, distance, start_key);
+                }
+                if( source_cluster == target_cluster ){
+                    const auto distance = localDistance(source_cluster, source_distances, _target);
+                    if( distance != unreachable_ )
+                        relax(goal_key, _target, distance, start_key);
+                }
+                continue;
+            }
+
+            const int cluster_index = current >> 32;
+            const size_t entrance_index = current & 0xFFFFFFFF;
+            const auto &cluster  = clusters_[cluster_index];
+            const auto &entrance = cluster.entrances[entrance_index];
+            const size_t n = cluster.entrances.size();
+
+            for(size_t j = 0; j < n; ++j){
+                const auto distance = cluster.distances[entrance_index * n + j];
+                if( j != entrance_index && distance != unreachable_ )
+                    relax(key(cluster_index, j), cluster.entrances[j].cell, g + distance, current);
+            }
+            if( entrance.partner >= 0 )
+                relax(key(entrance.neighbour, entrance.partner), entrance.other, g + dist_scale_factor_, current);
+
+            if( cluster_index == target_cluster ){
+                const auto distance = localDistance(target_cluster, target_distances, entrance.cell);
+                if( distance != unreachable_ )
+                    relax(goal_key, _target, g + distance, current);
+            }
+        }
+
+        // Corridor: clusters of the abstract path, dilated
+        for(const auto &it: corridor_list_)
+            corridor_.clusters[it] = 0;
+        corridor_list_.clear();
+        last_corridor_size_ = 0;
+        if( !solved )
+            return false;
+
+        std::vector<int> path_clusters{source_cluster, target_cluster};
+        for(uint64_t current = states[goal_key].parent; current != start_key; current = states[current].parent)
+            path_clusters.push_back(current >> 32);
+
+        const int dilation = corridor_dilation_;
+        for(const auto &it: path_clusters){
+            if( !corridor_.clusters[it] )
+                last_corridor_size_++;
+
+            const auto center = clusterFromIndex(it);
+            for(int z = std::max(0, center.z - dilation); z <= std::min(n_clusters_.z - 1, center.z + dilation); ++z)
+                for(int y = std::max(0, center.y - dilation); y <= std::min(n_clusters_.y - 1, center.y + dilation); ++y)
+                    for(int x = std::max(0, center.x - dilation); x <= std::min(n_clusters_.x - 1, center.x + dilation); ++x){
+                        const auto index = corridor_.clusterIndex({x, y, z});
+                        if( !corridor_.clusters[index] ){
+                            corridor_.clusters[index] = 1;
+                            corridor_list_.push_back(index);
+                        }
+                    }
+        }
+        return true;
+    }
+
+    int HierarchicalPlanner::neighbourCluster(const int _cluster, const int _axis, const int _sign) const
+    {
+        auto cluster = clusterFromIndex(_cluster);
+        const int value = component(cluster, _axis) + _sign;
+        if( value < 0 || value >= component(n_clusters_, _axis) )
+            return -1;
+
+        component(cluster, _axis) = value;
+        return corridor_.clusterIndex(cluster);
+    }
+
+    void HierarchicalPlanner::clusterBox(const int _cluster, Vec3i &_min, Vec3i &_max) const
+    {
+        const auto cluster = clusterFromIndex(_cluster);
+        _min = {cluster.x * cluster_size_.x, cluster.y * cluster_size_.y, cluster.z * cluster_size_.z};
+        _max = {std::min(world_size_.x, _min.x + cluster_size_.x),
+                std::min(world_size_.y, _min.y + cluster_size_.y),
+                std::min(world_size_.z, _min.z + cluster_size_.z)};
+    }
+
+}
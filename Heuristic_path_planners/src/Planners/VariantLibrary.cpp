@@ -0,0 +1,6 @@
+/**
+ * @file VariantLibrary.cpp
+ * @brief Source of the libraries that keep the names of the former per-variant planner libraries
+ * (AStar, ThetaStarM1, LazyThetaStarSIREN...). The planners are compiled in HeuristicSearch, these
+ * libraries only link it, so the packages that link the old names still find every variant.
+ */
@@ -16,6 +16,7 @@
 #include "utils/geometry_utils.hpp"
 #include "utils/metrics.hpp"
 #include "utils/CeresOpt.hpp"
+#include "utils/LatencyMetrics.hpp"
 
 #include "Grid3D/local_grid3d.hpp"
 
@@ -32,6 +33,7 @@
 #include <pcl/point_types.h>
 
 #include <nav_msgs/OccupancyGrid.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
@@ -40,6 +42,7 @@
 #include <heuristic_planners/SetAlgorithm.h>
 #include <heuristic_planners/Vec3i.h>
 #include <heuristic_planners/CoordinateList.h>
+#include <heuristic_planners/StampedCoordinateList.h>
 
 #define USING_PREPLANNING 1
 #define USING_CERES 0
@@ -58,7 +61,10 @@ class HeuristicLocalPlannerROS
 {
 
 public:
-    HeuristicLocalPlannerROS()
+    /**
+     * @param _lnh Private node handle: the one of the node, or of the nodelet
+     */
+    HeuristicLocalPlannerROS(const ros::NodeHandle &_lnh = ros::NodeHandle("~")): lnh_(_lnh)
     {
 
         std::string algorithm_name;
@@ -67,10 +73,26 @@ public:
         
         configureAlgorithm(algorithm_name, heuristic_);
 
-        // pointcloud_local_sub_     = lnh_.subscribe<pcl::PointCloud<pcl::PointXYZ>>("/points", 1, &HeuristicLocalPlannerROS::pointCloudCallback, this);
-        // pointcloud_local_sub_     = lnh_.subscribe<sensor_msgs::PointCloud2>("/points", 1, &HeuristicLocalPlannerROS::pointCloudCallback, this);
+        // Ceres: analytic jacobians (true) or autodiff (false) for the trajectory constraints
+        lnh_.param("analytic_jacobians", analytic_jacobians_, (bool)false);
+        // Ceres: obstacle term from the SIREN network (true) or from the interpolated local grid (false)
+        lnh_.param("neural_esdf_cost", neural_esdf_cost_, (bool)false);
 
-        path_local_sub_     = lnh_.subscribe<heuristic_planners::CoordinateList>("/planner_ros_node/global_path", 1, &HeuristicLocalPlannerROS::globalPathCallback, this);
+        // pointcloud_local_sub_     = lnh_.subscribe<pcl::PointCloud<pcl::PointXYZ>>("/points", 1, &HeuristicLocalPlannerROS::pointCloudCallback, this);
+        // The local world is rebuilt from the neural SDF on each tick, the /points scans only feed it (and the
+        // voxelize and cloud_update latencies) if enabled
+        bool subscribe_points;
+        lnh_.param("subscribe_points", subscribe_points, (bool)false);
+        if(subscribe_points)
+            pointcloud_local_sub_ = lnh_.subscribe<sensor_msgs::PointCloud2>("/points", 1, &HeuristicLocalPlannerROS::pointCloudCallback, this);
+
+        // The stamped global paths carry their publication time, to report the path_transport latency
+        bool stamped_global_path;
+        lnh_.param("stamped_global_path", stamped_global_path, (bool)false);
+        if(stamped_global_path)
+            path_local_sub_ = lnh_.subscribe<heuristic_planners::StampedCoordinateList>("/planner_ros_node/global_path_stamped", 1, &HeuristicLocalPlannerROS::stampedGlobalPathCallback, this);
+        else
+            path_local_sub_ = lnh_.subscribe<heuristic_planners::CoordinateList>("/planner_ros_node/global_path", 1, &HeuristicLocalPlannerROS::globalPathCallback, this);
         
         //GLOBAL POSITIONING SUBSCRIBER - for SDF query
         globalposition_local_sub_ = lnh_.subscribe<geometry_msgs::PoseStamped>("/ground_truth_to_tf/pose", 1, &HeuristicLocalPlannerROS::globalPositionCallback, this);
@@ -89,6 +111,14 @@ public:
         networkReceivedFlag_ = 1;
         globalPathReceived_ = 0;
         timed_local_path_ = lnh_.createTimer(ros::Duration(1), &HeuristicLocalPlannerROS::localtimedCallback, this);
+
+        // Stage latency percentiles, published on /diagnostics and optionally appended to a CSV file
+        double metrics_period;
+        lnh_.param("metrics_period", metrics_period, 10.0);
+        lnh_.param("metrics_csv", metrics_csv_, std::string(""));
+        diagnostics_pub_ = lnh_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+        if(metrics_period > 0)
+            metrics_timer_ = lnh_.createTimer(ros::Duration(metrics_period), &HeuristicLocalPlannerROS::metricsTimerCallback, this);
     }
 
     void plan(){
@@ -113,11 +143,25 @@ private:
     void globalPathCallback(const heuristic_planners::CoordinateList::ConstPtr& msg)
     {
         std::cout << "Entered global path retrieving callback" << std::endl;
+        setGlobalPath(msg->coordinates);
+    }
+
+    void stampedGlobalPathCallback(const heuristic_planners::StampedCoordinateList::ConstPtr& msg)
+    {
+        std::cout << "Entered global path retrieving callback" << std::endl;
+        // Time since the global planner published it: serialization and transport, or nothing within a nodelet manager
+        if(!msg->header.stamp.isZero())
+            metrics_.record(Planners::utils::LatencyMetrics::PATH_TRANSPORT, std::max<int64_t>(0, (ros::Time::now() - msg->header.stamp).toNSec() / 1000));
+        setGlobalPath(msg->coordinates);
+    }
+
+    void setGlobalPath(const std::vector<heuristic_planners::Vec3i> &_coordinates)
+    {
         //Vaciamos la variable del path global anteriormente
         global_path_.clear();
 
         //Pasamos el mensaje a la variable global_path
-        for (const auto& vec : msg->coordinates) {
+        for (const auto& vec : _coordinates) {
             // Convert each your_package::Vec3i to Planners::utils::Vec3i
             Planners::utils::Vec3i vec_intermedio;
             vec_intermedio.x = vec.x;
@@ -161,12 +205,13 @@ private:
         if(globalPathReceived_ == 1){
 
             auto loop_start = std::chrono::high_resolution_clock::now();
-        
+            Planners::utils::LatencyMetrics::ScopedTimer tick_timer(&metrics_, Planners::utils::LatencyMetrics::TICK);
 
 
             // 1. Update Neural Network State (if new state available)
             if(networkReceivedFlag_ == 1)
             {
+                Planners::utils::LatencyMetrics::ScopedTimer reload_timer(&metrics_, Planners::utils::LatencyMetrics::MODEL_RELOAD);
                 printf("Importing new neural network state\n");
                 loaded_sdf_ = torch::jit::load("/home/ros/exchange/weight_data/model.pt", c10::kCPU); 
                 networkReceivedFlag_ = 0;
@@ -186,6 +231,49 @@ private:
         }
     }
 
+    /**
+     * @brief Publishes the percentiles of each stage since the last call on /diagnostics and
+     * appends them to metrics_csv, if set
+     */
+    void metricsTimerCallback(const ros::TimerEvent& event)
+    {
+        using Planners::utils::LatencyMetrics;
+
+        diagnostic_msgs::DiagnosticArray diagnostics;
+        diagnostics.header.stamp = ros::Time::now();
+        for(int i = 0; i < LatencyMetrics::N_STAGES; ++i){
+            const auto stage = static_cast<LatencyMetrics::Stage>(i);
+            const auto &histogram = metrics_.histogram(stage);
+
+            diagnostic_msgs::DiagnosticStatus status;
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.name = std::string("local_planner/") + LatencyMetrics::stageName(stage);
+            status.hardware_id = "local_planner_ros_node";
+            status.message = histogram.count() == 0 ? "No samples" : "Latency in ms";
+
+            auto addValue = [&status](const std::string &_key, const double _value){
+                diagnostic_msgs::KeyValue key_value;
+                key_value.key = _key;
+                key_value.value = std::to_string(_value);
+                status.values.push_back(key_value);
+            };
+            addValue("count", histogram.count());
+            addValue("mean", histogram.mean() / 1e3);
+            addValue("p50", histogram.percentile(50) / 1e3);
+            addValue("p90", histogram.percentile(90) / 1e3);
+            addValue("p99", histogram.percentile(99) / 1e3);
+            addValue("p99.9", histogram.percentile(99.9) / 1e3);
+            addValue("max", histogram.max() / 1e3);
+            diagnostics.status.push_back(status);
+        }
+        diagnostics_pub_.publish(diagnostics);
+
+        if(!metrics_csv_.empty() && !metrics_.appendCsv(metrics_csv_, diagnostics.header.stamp.toSec()))
+            ROS_WARN("Could not write the latency metrics to %s", metrics_csv_.c_str());
+
+        metrics_.reset();
+    }
+
     // From lazy_theta_star_planners
     // void pointCloudCallback(const PointCloud::ConstPtr &points)
     // void pointCloudCallback(const sensor_msgs::PointCloud2::ConstPtr &_points)
@@ -193,7 +281,6 @@ private:
     {
         // // ROS_INFO_COND(debug, PRINTF_MAGENTA "Collision Map Received");
         mapReceived = true; // At the end to run the calculate3Dpath after generating PointCloud?
-        sensor_msgs::PointCloud2 base_cloud;
 
         // laser0 in bag
         // std::cout << "frame cloud: "      << cloud->header.frame_id  << std::endl;
@@ -225,8 +312,9 @@ private:
 
         // transformPointCloud (const std::string &target_frame, const tf::Transform &net_transform, const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out)
 
-        // Transform a sensor_msgs::PointCloud2 dataset from its frame to a given TF target frame. 
-        pcl_ros::transformPointCloud(baseFrameId, pclTf, *cloud, base_cloud); // Transform pointcloud to our TF --> baseCloud
+        // The transform to baseFrameId, the crop to the local map and the discretization are done by cloud_voxelizer_
+        // in one pass over the PointCloud2 buffer, instead of pcl_ros::transformPointCloud + PointCloud2_to_PointXYZ_pcl
+        // pcl_ros::transformPointCloud(baseFrameId, pclTf, *cloud, base_cloud); // Transform pointcloud to our TF --> baseCloud
         // pcl_ros::transformPointCloud(globalFrameId, pclTf, *cloud, base_cloud); // Transform pointcloud to map/world (globalFrameId) --> baseCloud JAC
         
         // std::cout << "frame base_cloud: "      << base_cloud.header.frame_id  << std::endl;
@@ -252,22 +340,21 @@ private:
 		// 	local_cloud_[i].z = downCloud[i].z;			
 		// }
 
-        // Local Point Cloud from Velodyne by considering only the size of local map. This is done in PointCloud2_to_PointXYZ_pcl
-        pcl::PointCloud<pcl::PointXYZ> local_cloud_;
-        local_cloud_.header.frame_id = baseFrameId;
-
-        // sensor_msgs::PointCloud2 --> pcl::PointCloud<pcl::PointXYZ> to configure the local map. Only points inside local map are considered.
-		PointCloud2_to_PointXYZ_pcl(base_cloud,local_cloud_);
-        // std::cout << "Size: "      << local_cloud_.size()  << std::endl;        
-        // std::cout << "frame local_cloud: "      << local_cloud_.header.frame_id  << std::endl;
-
-        // Publisher to show that local_cloud_ is correctly generated and it corresponds to the point cloud from velodyne.
-        cloud_test.publish(local_cloud_);
-
         // Clean the world before generating it for each iteration
         algorithm_->cleanLocalWorld();
-        // Configure the local world from the PointCloud (for the local map)
-        Planners::utils::configureWorldFromPointCloud(boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>(local_cloud_), *algorithm_, resolution_); 
+        // Configure the local world from the PointCloud (for the local map). Only points inside local map are considered, once per cell
+        if(!Planners::utils::configureWorldFromPointCloud2(*cloud, pclTf, cloud_voxelizer_, *algorithm_, cloud_voxels_, &metrics_))
+            return;
+
+        // Publisher to show that the local map corresponds to the point cloud from velodyne: one point per occupied cell
+        if(cloud_test.getNumSubscribers() > 0){
+            pcl::PointCloud<pcl::PointXYZ> local_cloud_;
+            local_cloud_.header.frame_id = baseFrameId;
+            local_cloud_.reserve(cloud_voxels_.size());
+            for(const auto &it: cloud_voxels_)
+                local_cloud_.push_back(pcl::PointXYZ(it.x * resolution_, it.y * resolution_, it.z * resolution_));
+            cloud_test.publish(local_cloud_);
+        }
         // Publish the Occupancy Map
         algorithm_->publishLocalOccupationMarkersMap();
 
@@ -474,13 +561,14 @@ private:
             //std::cout << "Local path: " << local_path << std::endl;
 
             auto local_planning_start = std::chrono::high_resolution_clock::now();
-            auto local_path_data = algorithm_->findPath(discrete_start, discrete_goal, loaded_sdf_);
+            algorithm_->findPath(discrete_start, discrete_goal, loaded_sdf_, plan_result_);
             auto local_planning_stop = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double, std::milli> local_duration = local_planning_stop - local_planning_start;
             printf("TIEMPO TOTAL DEL PLANIFICADOR LOCAL: %.2f ms\n", local_duration.count());
+            metrics_.record(Planners::utils::LatencyMetrics::SEARCH, std::chrono::duration_cast<std::chrono::microseconds>(local_duration).count());
 
-            if(std::get<bool>(local_path_data["solved"])){
-                local_path = std::get<Planners::utils::CoordinateList>(local_path_data["path"]);
+            if(plan_result_.solved){
+                local_path = plan_result_.path;
                 local_path.pop_back(); // Delete last coordinate (duplicate)
                 std::reverse(local_path.begin(), local_path.end());
                 planning_solved = 1;
@@ -511,17 +599,19 @@ private:
                 Planners::utils::OptimizedTrajectory opt_local_trajectory;
                 auto ceres_start = std::chrono::high_resolution_clock::now();
                 if(CERES_PATH_PLANNER){
-                    opt_local_path = Ceresopt::ceresOptimizerPath(local_path, *m_local_grid3d_, resolution_);
+                    opt_local_path = Ceresopt::ceresOptimizerPath(local_path, *m_local_grid3d_, resolution_, analytic_jacobians_);
                     opt_local_path_positions = opt_local_path.positions;
                 }
                 else if(CERES_TRAJECTORY_PLANNER){
-                    opt_local_trajectory = Ceresopt::ceresOptimizerTrajectory(local_path, *m_local_grid3d_, resolution_);
+                    opt_local_trajectory = Ceresopt::ceresOptimizerTrajectory(local_path, *m_local_grid3d_, resolution_, analytic_jacobians_,
+                                                                              neural_esdf_cost_ ? &loaded_sdf_ : nullptr);
                     opt_local_path_positions = opt_local_trajectory.positions;
                     opt_local_path_velocities = opt_local_trajectory.velocities;
                 }
                 auto ceres_stop = std::chrono::high_resolution_clock::now();
                 std::chrono::duration<double, std::milli> ceres_duration = ceres_stop - ceres_start;
                 printf("TIEMPO TOTAL DEL OPTIMIZADOR: %.2f ms\n", ceres_duration.count());
+                metrics_.record(Planners::utils::LatencyMetrics::OPTIMIZATION, std::chrono::duration_cast<std::chrono::microseconds>(ceres_duration).count());
         
                 //Convert the local path to GLOBAL COORDINATES and push them into the markers
 
@@ -656,6 +746,11 @@ private:
         local_world_size_.y = std::floor((2*ws_y) / resolution_) + 1;
         local_world_size_.z = std::floor((2*ws_z) / resolution_) + 1;
 
+        // Same crop as PointCloud2_to_PointXYZ_pcl: x and y use the size in x
+        const float crop_max[3] = {static_cast<float>(local_world_size_meters.x), static_cast<float>(local_world_size_meters.x), static_cast<float>(local_world_size_meters.z)};
+        const float crop_min[3] = {-crop_max[0], -crop_max[1], -crop_max[2]};
+        cloud_voxelizer_.setCropBox(crop_min, crop_max, resolution_);
+
         lnh_.param("use3d", use3d_, (bool)true);
 
         if( algorithm_name == "astar" ){
@@ -710,12 +805,23 @@ private:
         }
         algorithm_->setInflationConfig(inflate_, inflation_steps_);
 
-        m_local_grid3d_.reset(new Local_Grid3d); //TODO Costs not implement yet  // Is this necessary in the Local Planner?
+        // node_as_cube (default), cube or sphere. The last two use a distance transform of the obstacles
+        std::string inflation_mode;
+        lnh_.param("inflation_mode", inflation_mode, std::string("node_as_cube"));
+        if (inflation_mode == "cube")
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_DT_CUBE);
+        else if (inflation_mode == "sphere")
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_DT_SPHERE);
+        else
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_NODE_AS_CUBE);
+
+        m_local_grid3d_.reset(new Local_Grid3d(lnh_)); //TODO Costs not implement yet  // Is this necessary in the Local Planner?
         double cost_scaling_factor, robot_radius;
         lnh_.param("cost_scaling_factor", cost_scaling_factor, 0.8);		
 		lnh_.param("robot_radius", robot_radius, 0.4);		
         
         m_local_grid3d_->setCostParams(cost_scaling_factor, robot_radius);
+        m_local_grid3d_->setMetrics(&metrics_);
 
         // Read node parameters
 		// if(!lnh.getParam("in_cloud", m_inCloudTopic))
@@ -755,6 +861,8 @@ private:
         lnh_.param("cost_weight", cost_weight, (float)0.0);
         algorithm_->setMaxLineOfSight(sight_dist);
         algorithm_->setCostFactor(cost_weight);
+        // The local planner runs every cycle and only uses the path
+        algorithm_->setComputeStatistics(false);
 
         lnh_.param("overlay_markers", overlay_markers_, (bool)false);
 
@@ -904,6 +1012,7 @@ private:
     std::unique_ptr<Local_Grid3d> m_local_grid3d_;
 
     std::unique_ptr<Planners::AlgorithmBase> algorithm_;
+    Planners::utils::PlanResult plan_result_; // Reused between cycles to keep the path buffer
         
     visualization_msgs::Marker local_path_line_markers_, local_path_points_markers_, local_path_velocity_markers_;
     
@@ -916,6 +1025,8 @@ private:
 
     bool save_data_;
     bool use3d_{true};
+    bool analytic_jacobians_{false};
+    bool neural_esdf_cost_{false};
 
     bool inflate_{false};
     unsigned int inflation_steps_{0};
@@ -928,6 +1039,8 @@ private:
     //! Indicates that the local transfrom for the pointcloud is cached
 	bool m_tfCache;
 	tf::StampedTransform pclTf;
+    Planners::utils::CloudVoxelizer cloud_voxelizer_;
+    Planners::utils::CoordinateList cloud_voxels_;
 
     //! Node parameters
 	// std::string m_inCloudTopic;
@@ -969,6 +1082,12 @@ private:
     // local pathplanner loop timer
     ros::Timer timed_local_path_;
 
+    // Stage latencies of the loop, reset after each publication
+    Planners::utils::LatencyMetrics metrics_;
+    ros::Publisher diagnostics_pub_;
+    ros::Timer metrics_timer_;
+    std::string metrics_csv_;
+
 };
 // int main(int argc, char **argv)
 // {
@@ -980,6 +1099,30 @@ private:
 // return 0;
 // }
 
+#ifdef HEURISTIC_PLANNERS_NODELET
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace heuristic_planners
+{
+    /**
+     * @brief The local planner as a nodelet. The global paths from a PlannerNodelet in the same
+     * manager are received as the published pointer, without serialization
+     * 
+     */
+    class LocalPlannerNodelet : public nodelet::Nodelet
+    {
+        void onInit() override
+        {
+            local_planner_.reset(new HeuristicLocalPlannerROS(getPrivateNodeHandle()));
+        }
+
+        std::unique_ptr<HeuristicLocalPlannerROS> local_planner_;
+    };
+}
+PLUGINLIB_EXPORT_CLASS(heuristic_planners::LocalPlannerNodelet, nodelet::Nodelet)
+
+#else
 int main(int argc, char **argv)
 {
     ros::init(argc, argv, "heuristic_local_planner_ros_node");
@@ -1001,4 +1144,5 @@ int main(int argc, char **argv)
         loop_rate.sleep();
     }
     return 0;
-}
\ No newline at end of file
+}
+#endif
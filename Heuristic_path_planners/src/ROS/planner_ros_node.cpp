@@ -1,6 +1,9 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #include "Planners/AStar.hpp"
 #include "Planners/AStarM2.hpp"
@@ -15,11 +18,13 @@
 #include "Planners/LazyThetaStarM1Mod.hpp"
 #include "Planners/LazyThetaStarM2.hpp"
 #include "Planners/LazyThetaStarSIREN.hpp"
+#include "Planners/HierarchicalPlanner.hpp"
 #include "utils/ros/ROSInterfaces.hpp"
 #include "utils/SaveDataVariantToFile.hpp"
 #include "utils/misc.hpp"
 #include "utils/geometry_utils.hpp"
 #include "utils/metrics.hpp"
+#include "utils/LandmarkHeuristic.hpp"
 #include "utils/FCNet.hpp"
 
 #include "Grid3D/grid3d.hpp"
@@ -37,10 +42,12 @@
 #include <nav_msgs/OccupancyGrid.h>
 
 #include <heuristic_planners/GetPath.h>
+#include <heuristic_planners/GetPathBatch.h>
 #include <heuristic_planners/SetAlgorithm.h>
 #include <heuristic_planners/ShareWeights.h>
 #include <heuristic_planners/Vec3i.h>
 #include <heuristic_planners/CoordinateList.h>
+#include <heuristic_planners/StampedCoordinateList.h>
 
 #define USING_PRETRAINED_MODELS 1
 #define EXAMPLE_PATH 2
@@ -64,7 +71,10 @@ class HeuristicPlannerROS
 {
 
 public:
-    HeuristicPlannerROS(){
+    /**
+     * @param _lnh Private node handle: the one of the node, or of the nodelet
+     */
+    HeuristicPlannerROS(const ros::NodeHandle &_lnh = ros::NodeHandle("~")): lnh_(_lnh){
 
         std::string algorithm_name;
         lnh_.param("algorithm", algorithm_name, (std::string)"astar");
@@ -80,12 +90,14 @@ public:
         // sdf_sub_            = lnh_.subscribe<sensor_msgs::PointCloud2>("/data_slice", 1, &HeuristicPlannerROS::dataSliceCallback, this);
 
         request_path_server_   = lnh_.advertiseService("request_path",  &HeuristicPlannerROS::requestPathService, this);
+        request_path_batch_server_ = lnh_.advertiseService("request_path_batch", &HeuristicPlannerROS::requestPathBatchService, this);
         change_planner_server_ = lnh_.advertiseService("set_algorithm", &HeuristicPlannerROS::setAlgorithm, this);
 
 
         line_markers_pub_  = lnh_.advertise<visualization_msgs::Marker>("path_line_markers", 1);
         point_markers_pub_ = lnh_.advertise<visualization_msgs::Marker>("path_points_markers", 1);
         global_path_pub_ = lnh_.advertise<heuristic_planners::CoordinateList>("global_path", 1);
+        global_path_stamped_pub_ = lnh_.advertise<heuristic_planners::StampedCoordinateList>("global_path_stamped", 1);
 
     }
 
@@ -106,6 +118,10 @@ private:
         ROS_INFO("Occupancy Grid Loaded");
         occupancy_grid_ = *_grid;
         input_map_ = 1;
+        landmarks_failed_ = false;
+        if( heuristic_name_ == "alt" )
+            configureHeuristic(heuristic_name_);
+        configureHierarchicalPlanner();
     }
 
     void pointCloudCallback(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &_points)
@@ -114,10 +130,15 @@ private:
         ROS_INFO("Loading map... [MESSAGE /POINTS RECEIVED]");
         Planners::utils::configureWorldFromPointCloud(_points, *algorithm_, resolution_);
         algorithm_->publishOccupationMarkersMap();
-        Planners::utils::configureWorldCosts(*m_grid3d_, *algorithm_);
+        Planners::utils::configureWorldCosts(*m_grid3d_, *algorithm_, cost_far_field_);
+        ROS_INFO("Discrete world memory: %.1f MB", algorithm_->getInnerWorld()->getMemoryUsage() / 1e6);
         ROS_INFO("Published occupation marker map");
         cloud_ = *_points;
         input_map_ = 2;
+        landmarks_failed_ = false;
+        if( heuristic_name_ == "alt" )
+            configureHeuristic(heuristic_name_);
+        configureHierarchicalPlanner();
         pointcloud_sub_.shutdown();
     }   
 
@@ -614,48 +635,55 @@ private:
         int real_tries = _req.tries.data;
         if(real_tries == 0) real_tries = 1;
         for(int i = 0; i < real_tries; ++i){
-            //auto path_data = algorithm_->findPath(discrete_start, discrete_goal, *sdf_net_);
-            auto path_data = algorithm_->findPath(discrete_start, discrete_goal, loaded_sdf);
-
-            if( std::get<bool>(path_data["solved"]) ){
-                Planners::utils::CoordinateList path;
-                try{
-                    _rep.time_spent.data           = std::get<double>(path_data["time_spent"] );
-                    _rep.time_spent.data /= 1000;
-                    times.push_back(_rep.time_spent.data);
-
-                    if(_req.tries.data < 2 || i == ( _req.tries.data - 1) ){
-                        _rep.path_length.data          = std::get<double>(path_data["path_length"] );
-                        _rep.explored_nodes.data       = std::get<size_t>(path_data["explored_nodes"] );
-                        _rep.line_of_sight_checks.data = std::get<unsigned int>(path_data["line_of_sight_checks"] );
-
-                        _rep.total_cost1.data           = std::get<unsigned int>(path_data["total_cost1"] );
-                        _rep.total_cost2.data           = std::get<unsigned int>(path_data["total_cost2"] );
-                        _rep.h_cost.data               = std::get<unsigned int>(path_data["h_cost"]);
-                        _rep.g_cost1.data               = std::get<unsigned int>(path_data["g_cost1"]);
-                        _rep.g_cost2.data               = std::get<unsigned int>(path_data["g_cost2"]);
-                        _rep.c_cost.data               = std::get<unsigned int>(path_data["c_cost"]);
-
-                        _rep.cost_weight.data          = std::get<double>(path_data["cost_weight"]);
-                        _rep.max_los.data              = std::get<unsigned int>(path_data["max_line_of_sight_cells"]);
-                    }
-                    path = std::get<Planners::utils::CoordinateList>(path_data["path"]);
+            //algorithm_->findPath(discrete_start, discrete_goal, *sdf_net_, plan_result_);
+            if( hierarchical_planner_ ){
+                hierarchical_planner_->findPath(discrete_start, discrete_goal, loaded_sdf, plan_result_);
+                if( hierarchical_planner_->usedFallback() )
+                    ROS_WARN_THROTTLE(1.0, "Hierarchical planner: no path inside the corridor of clusters, the whole world was searched");
+            }else
+                algorithm_->findPath(discrete_start, discrete_goal, loaded_sdf, plan_result_);
 
-                    // Send a message through the global_path topic
-                    heuristic_planners::CoordinateList coord_msg;
-                    for (const auto& vec3 : path) {
-                        heuristic_planners::Vec3i vec_msg;
-                        vec_msg.x = vec3.x;
-                        vec_msg.y = vec3.y;
-                        vec_msg.z = vec3.z;
+            if( plan_result_.solved ){
+                const auto &path = plan_result_.path;
 
-                        coord_msg.coordinates.push_back(vec_msg);
-                    }
-                    global_path_pub_.publish(coord_msg);
+                _rep.time_spent.data = plan_result_.time_spent / 1000;
+                times.push_back(_rep.time_spent.data);
 
+                if(_req.tries.data < 2 || i == ( _req.tries.data - 1) ){
+                    _rep.path_length.data          = plan_result_.path_length;
+                    _rep.explored_nodes.data       = plan_result_.explored_nodes;
+                    _rep.line_of_sight_checks.data = plan_result_.line_of_sight_checks;
+
+                    _rep.total_cost1.data           = plan_result_.statistics.total_cost1;
+                    _rep.total_cost2.data           = plan_result_.statistics.total_cost2;
+                    _rep.h_cost.data               = plan_result_.statistics.h_cost;
+                    _rep.g_cost1.data               = plan_result_.statistics.g_cost1;
+                    _rep.g_cost2.data               = plan_result_.statistics.g_cost2;
+                    _rep.c_cost.data               = plan_result_.statistics.c_cost;
+
+                    _rep.cost_weight.data          = plan_result_.cost_weight;
+                    _rep.max_los.data              = plan_result_.max_line_of_sight_cells;
+                }
 
-                }catch(std::bad_variant_access const& ex){
-                    std::cerr << "Bad variant error: " << ex.what() << std::endl;
+                // Send a message through the global_path topic. Published as a shared pointer so that
+                // the subscribers in the same nodelet manager receive it without serialization
+                heuristic_planners::CoordinateListPtr coord_msg(new heuristic_planners::CoordinateList);
+                coord_msg->coordinates.reserve(path.size());
+                for (const auto& vec3 : path) {
+                    heuristic_planners::Vec3i vec_msg;
+                    vec_msg.x = vec3.x;
+                    vec_msg.y = vec3.y;
+                    vec_msg.z = vec3.z;
+
+                    coord_msg->coordinates.push_back(vec_msg);
+                }
+                global_path_pub_.publish(coord_msg);
+                // Same path with the publication time, for the local planner to measure its transport
+                if(global_path_stamped_pub_.getNumSubscribers() > 0){
+                    heuristic_planners::StampedCoordinateListPtr stamped_msg(new heuristic_planners::StampedCoordinateList);
+                    stamped_msg->coordinates = coord_msg->coordinates;
+                    stamped_msg->header.stamp = ros::Time::now();
+                    global_path_stamped_pub_.publish(stamped_msg);
                 }
 
                 if(save_data_){
@@ -668,6 +696,8 @@ private:
                     const auto result_distances = getClosestObstaclesToPathPoints(adjacent_path);
                     const auto [mean_dist, dist_stddev, min_dist, max_dist] = Planners::utils::metrics::calculateDistancesMetrics(result_distances );
 
+                    auto path_data = plan_result_.toPathData();
+
                     path_data["av_curv"]        = av_curvature;
                     path_data["std_dev_curv"]   = curv_sigma;
                     path_data["min_curv"]       = curv_min;
@@ -704,7 +734,7 @@ private:
 
                 if(_req.tries.data < 2 || i == ( _req.tries.data - 1) ){
 
-                    for(const auto &it: std::get<Planners::utils::CoordinateList>(path_data["path"])){
+                    for(const auto &it: path){
                         path_line_markers_.points.push_back(Planners::utils::continousPoint(it, resolution_));
                         path_points_markers_.points.push_back(Planners::utils::continousPoint(it, resolution_));
                     }
@@ -730,71 +760,171 @@ private:
         }
         return true;
     }
-    void configureAlgorithm(const std::string &algorithm_name, const std::string &_heuristic){
+    /**
+     * @brief Plan a list of start/goal pairs in parallel. Each worker thread has its own algorithm 
+     * object sharing the map of algorithm_ (see AlgorithmBase::shareMapFrom). The workers use the sparse
+     * world: a dense map is converted once by the first worker and the rest share its blocks.
+     * Markers and data files are not generated.
+     */
+    bool requestPathBatchService(heuristic_planners::GetPathBatchRequest &_req, heuristic_planners::GetPathBatchResponse &_rep){
+
+        if( _req.starts.size() != _req.goals.size() ){
+            ROS_ERROR("Batch request with %lu starts and %lu goals", _req.starts.size(), _req.goals.size());
+            return false;
+        }
+        if( !_req.algorithm.data.empty() ){
+            configureAlgorithm(_req.algorithm.data, _req.heuristic.data.empty() ? heuristic_ : _req.heuristic.data);
+        }else if( !_req.heuristic.data.empty() ){
+            configureHeuristic(_req.heuristic.data);
+        }
 
-        float ws_x, ws_y, ws_z;
+        const size_t n_queries = _req.starts.size();
+        unsigned int n_threads = _req.threads.data > 0 ? _req.threads.data : std::thread::hardware_concurrency();
+        n_threads = std::max(1u, std::min<unsigned int>(n_threads, n_queries));
 
-        lnh_.param("world_size_x", ws_x, (float)100.0); // In meters
-        lnh_.param("world_size_y", ws_y, (float)100.0); // In meters
-        lnh_.param("world_size_z", ws_z, (float)100.0); // In meters
-        lnh_.param("resolution", resolution_, (float)0.2);
-        lnh_.param("inflate_map", inflate_, (bool)true);
+        std::vector<std::unique_ptr<Planners::AlgorithmBase>> workers(n_threads);
+        for(auto &worker: workers){
+            worker = createAlgorithm(algorithm_name_, false);
+            worker->shareMapFrom(worker == workers.front() ? *algorithm_ : *workers.front());
+            worker->setComputeStatistics(false);
+        }
 
-        world_size_.x = std::floor(ws_x / resolution_);
-        world_size_.y = std::floor(ws_y / resolution_);
-        world_size_.z = std::floor(ws_z / resolution_);
-        
-        lnh_.param("use3d", use3d_, (bool)true);
+        _rep.solved.assign(n_queries, false);
+        _rep.time_spent.assign(n_queries, 0);
+        _rep.path_length.assign(n_queries, 0);
+        _rep.explored_nodes.assign(n_queries, 0);
+        _rep.paths.resize(n_queries);
+
+        ROS_INFO("Planning %lu queries with %u threads", n_queries, n_threads);
+        const auto start_time = std::chrono::steady_clock::now();
+
+        std::atomic<size_t> next_query{0};
+        auto worker_loop = [&](Planners::AlgorithmBase &_algorithm){
+            Planners::utils::PlanResult result;
+            for(size_t i = next_query++; i < n_queries; i = next_query++){
+                const auto discrete_start = Planners::utils::discretePoint(_req.starts[i], resolution_);
+                const auto discrete_goal  = Planners::utils::discretePoint(_req.goals[i], resolution_);
+                if( _algorithm.detectCollision(discrete_start) || _algorithm.detectCollision(discrete_goal) )
+                    continue;
+
+                _algorithm.findPath(discrete_start, discrete_goal, loaded_sdf, result);
+                if( !result.solved )
+                    continue;
+
+                _rep.solved[i]         = true;
+                _rep.time_spent[i]     = result.time_spent / 1000;
+                _rep.path_length[i]    = result.path_length;
+                _rep.explored_nodes[i] = result.explored_nodes;
+                for(const auto &vec3: result.path){
+                    heuristic_planners::Vec3i vec_msg;
+                    vec_msg.x = vec3.x;
+                    vec_msg.y = vec3.y;
+                    vec_msg.z = vec3.z;
+                    _rep.paths[i].coordinates.push_back(vec_msg);
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for(unsigned int t = 1; t < n_threads; ++t)
+            threads.emplace_back(worker_loop, std::ref(*workers[t]));
+        worker_loop(*workers[0]);
+        for(auto &thread: threads)
+            thread.join();
+
+        _rep.total_time.data = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        _rep.n_solved.data = std::count(_rep.solved.begin(), _rep.solved.end(), true);
+        _rep.queries_per_second.data = _rep.total_time.data > 0 ? n_queries / _rep.total_time.data : 0;
+
+        ROS_INFO("Batch planning: %d/%lu solved in %.3f s (%.1f queries/s)", _rep.n_solved.data, n_queries, 
+                 _rep.total_time.data, _rep.queries_per_second.data);
+        return true;
+    }
+    std::unique_ptr<Planners::AlgorithmBase> createAlgorithm(const std::string &algorithm_name, const bool _verbose){
 
+        std::unique_ptr<Planners::AlgorithmBase> algorithm;
         if( algorithm_name == "astar" ){
-            ROS_INFO("Using A*");
-            algorithm_.reset(new Planners::AStar(use3d_));
+            if(_verbose) ROS_INFO("Using A*");
+            algorithm.reset(new Planners::AStar(use3d_));
         }else if( algorithm_name == "costastar" ){
-            ROS_INFO("Using Cost Aware A*");
-            algorithm_.reset(new Planners::AStarM1(use3d_));
+            if(_verbose) ROS_INFO("Using Cost Aware A*");
+            algorithm.reset(new Planners::AStarM1(use3d_));
         }else if( algorithm_name == "astarsafetycost" ){
-            ROS_INFO("Using A* Safety Cost");
-            algorithm_.reset(new Planners::AStarM2(use3d_));
+            if(_verbose) ROS_INFO("Using A* Safety Cost");
+            algorithm.reset(new Planners::AStarM2(use3d_));
         }else if( algorithm_name == "astarsiren" ){
-            ROS_INFO("Using A* SIREN");
-            algorithm_.reset(new Planners::AStarSIREN(use3d_));    
+            if(_verbose) ROS_INFO("Using A* SIREN");
+            algorithm.reset(new Planners::AStarSIREN(use3d_));    
         }else if ( algorithm_name == "thetastar" ){
-            ROS_INFO("Using Theta*");
-            algorithm_.reset(new Planners::ThetaStar(use3d_));
+            if(_verbose) ROS_INFO("Using Theta*");
+            algorithm.reset(new Planners::ThetaStar(use3d_));
         }else if ( algorithm_name == "costhetastar" ){
-            ROS_INFO("Using Cost Aware Theta* ");
-            algorithm_.reset(new Planners::ThetaStarM1(use3d_));
+            if(_verbose) ROS_INFO("Using Cost Aware Theta* ");
+            algorithm.reset(new Planners::ThetaStarM1(use3d_));
         }else if ( algorithm_name == "thetastarsafetycost" ){
-            ROS_INFO("Using Theta* Safety Cost");
-            algorithm_.reset(new Planners::ThetaStarM2(use3d_));
+            if(_verbose) ROS_INFO("Using Theta* Safety Cost");
+            algorithm.reset(new Planners::ThetaStarM2(use3d_));
         }else if ( algorithm_name == "thetastarsiren" ){
-            ROS_INFO("Using Theta* SIREN");
-            algorithm_.reset(new Planners::ThetaStarSIREN(use3d_));
+            if(_verbose) ROS_INFO("Using Theta* SIREN");
+            algorithm.reset(new Planners::ThetaStarSIREN(use3d_));
         }else if( algorithm_name == "lazythetastar" ){
-            ROS_INFO("Using LazyTheta*");
-            algorithm_.reset(new Planners::LazyThetaStar(use3d_));
+            if(_verbose) ROS_INFO("Using LazyTheta*");
+            algorithm.reset(new Planners::LazyThetaStar(use3d_));
         }else if( algorithm_name == "costlazythetastar"){
-            ROS_INFO("Using Cost Aware LazyTheta*");
-            algorithm_.reset(new Planners::LazyThetaStarM1(use3d_));
+            if(_verbose) ROS_INFO("Using Cost Aware LazyTheta*");
+            algorithm.reset(new Planners::LazyThetaStarM1(use3d_));
         }else if( algorithm_name == "costlazythetastarmodified"){
-            ROS_INFO("Using Cost Aware LazyTheta*");
-            algorithm_.reset(new Planners::LazyThetaStarM1Mod(use3d_));
+            if(_verbose) ROS_INFO("Using Cost Aware LazyTheta*");
+            algorithm.reset(new Planners::LazyThetaStarM1Mod(use3d_));
         }else if( algorithm_name == "lazythetastarsafetycost"){
-            ROS_INFO("Using LazyTheta* Safety Cost");
-            algorithm_.reset(new Planners::LazyThetaStarM2(use3d_));
+            if(_verbose) ROS_INFO("Using LazyTheta* Safety Cost");
+            algorithm.reset(new Planners::LazyThetaStarM2(use3d_));
         }else if( algorithm_name == "lazythetastarsiren" ){
-            ROS_INFO("Using LazyTheta* SIREN");
-            algorithm_.reset(new Planners::LazyThetaStarSIREN(use3d_));
+            if(_verbose) ROS_INFO("Using LazyTheta* SIREN");
+            algorithm.reset(new Planners::LazyThetaStarSIREN(use3d_));
         }else{
-            ROS_WARN("Wrong algorithm name parameter. Using ASTAR by default");
-            algorithm_.reset(new Planners::AStar(use3d_));
+            if(_verbose) ROS_WARN("Wrong algorithm name parameter. Using ASTAR by default");
+            algorithm.reset(new Planners::AStar(use3d_));
         }
 
-        algorithm_->setWorldSize(world_size_, resolution_);
+        return algorithm;
+    }
+    void configureAlgorithm(const std::string &algorithm_name, const std::string &_heuristic){
 
-        configureHeuristic(_heuristic);
+        float ws_x, ws_y, ws_z;
+
+        lnh_.param("world_size_x", ws_x, (float)100.0); // In meters
+        lnh_.param("world_size_y", ws_y, (float)100.0); // In meters
+        lnh_.param("world_size_z", ws_z, (float)100.0); // In meters
+        lnh_.param("resolution", resolution_, (float)0.2);
+        lnh_.param("inflate_map", inflate_, (bool)true);
+
+        world_size_.x = std::floor(ws_x / resolution_);
+        world_size_.y = std::floor(ws_y / resolution_);
+        world_size_.z = std::floor(ws_z / resolution_);
+        
+        lnh_.param("use3d", use3d_, (bool)true);
+
+        // The hierarchical planner references the algorithm and unregisters from it when destroyed, so it
+        // has to go before the algorithm is replaced. It is rebuilt on the new one below
+        hierarchical_planner_.reset();
+        algorithm_ = createAlgorithm(algorithm_name, true);
+        algorithm_name_ = algorithm_name;
+
+        // Sparse block storage for big maps: nodes are only allocated in the blocks touched by the search
+        bool sparse_world, unknown_as_occupied;
+        lnh_.param("sparse_world", sparse_world, (bool)false);
+        lnh_.param("unknown_as_occupied", unknown_as_occupied, (bool)false);
+        algorithm_->getInnerWorld()->setSparse(sparse_world);
+        algorithm_->getInnerWorld()->setUnknownAsOccupied(unknown_as_occupied);
+        // Distance costs are clamped to cost_far_field (0 to disable), which is also the cost of the cells
+        // never set, so the cells far from the obstacles do not allocate sparse cost blocks
+        lnh_.param("cost_far_field", cost_far_field_, (double)0.0);
+        algorithm_->getInnerWorld()->setDefaultCost(cost_far_field_);
 
-        ROS_INFO("Using discrete world size: [%d, %d, %d]", world_size_.x, world_size_.y, world_size_.z);
+        algorithm_->setWorldSize(world_size_, resolution_);
+
+        ROS_INFO("Using discrete world size: [%d, %d, %d] (%s storage, %.1f MB)", world_size_.x, world_size_.y, world_size_.z,
+                 sparse_world ? "sparse" : "dense", algorithm_->getInnerWorld()->getMemoryUsage() / 1e6);
         ROS_INFO("Using resolution: [%f]", resolution_);
 
         if(inflate_){
@@ -805,7 +935,17 @@ private:
         }
         algorithm_->setInflationConfig(inflate_, inflation_steps_);
 
-        m_grid3d_.reset(new Grid3d); //TODO Costs not implement yet
+        // node_as_cube (default), cube or sphere. The last two use a distance transform of the obstacles
+        std::string inflation_mode;
+        lnh_.param("inflation_mode", inflation_mode, std::string("node_as_cube"));
+        if (inflation_mode == "cube")
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_DT_CUBE);
+        else if (inflation_mode == "sphere")
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_DT_SPHERE);
+        else
+            algorithm_->setInflationMode(Planners::AlgorithmBase::INFLATE_NODE_AS_CUBE);
+
+        m_grid3d_.reset(new Grid3d(lnh_)); //TODO Costs not implement yet
         double cost_scaling_factor, robot_radius;
         lnh_.param("cost_scaling_factor", cost_scaling_factor, 0.8);		
 		lnh_.param("robot_radius", robot_radius, 0.4);		
@@ -826,7 +966,7 @@ private:
             Planners::utils::configureWorldFromOccupancyWithCosts(occupancy_grid_, *algorithm_);
         }else if( input_map_ == 2 ){
             Planners::utils::configureWorldFromPointCloud(boost::make_shared<pcl::PointCloud<pcl::PointXYZ>>(cloud_), *algorithm_, resolution_);
-            Planners::utils::configureWorldCosts(*m_grid3d_, *algorithm_);
+            Planners::utils::configureWorldCosts(*m_grid3d_, *algorithm_, cost_far_field_);
         }
         //Algorithm specific parameters. Its important to set line of sight after configuring world size(it depends on the resolution)
         float sight_dist, cost_weight;
@@ -835,11 +975,18 @@ private:
         algorithm_->setMaxLineOfSight(sight_dist);
         algorithm_->setCostFactor(cost_weight);
 
+        // After loading the map, the ALT heuristic and the hierarchical planner need it
+        configureHeuristic(_heuristic);
+        configureHierarchicalPlanner();
+
         lnh_.param("overlay_markers", overlay_markers_, (bool)false);
     }
     void configureHeuristic(const std::string &_heuristic){
         
-        if( _heuristic == "euclidean" ){
+        heuristic_name_ = _heuristic;
+        if( _heuristic == "alt" ){
+            configureLandmarkHeuristic();
+        }else if( _heuristic == "euclidean" ){
             algorithm_->setHeuristic(Planners::Heuristic::euclidean);
             ROS_INFO("Using Euclidean Heuristics");
         }else if( _heuristic == "euclidean_optimized" ){
@@ -859,6 +1006,93 @@ private:
             ROS_WARN("Wrong Heuristic param. Using Euclidean Heuristics by default");
         }
     }
+    /**
+     * @brief Loads the landmark tables from the file next to the .gridm cache or computes and saves them.
+     * Until a map is received the euclidean heuristic is used
+     */
+    void configureLandmarkHeuristic(){
+
+        if( input_map_ == 0 ){
+            algorithm_->setHeuristic(Planners::Heuristic::euclidean);
+            ROS_INFO("Using Euclidean Heuristics until a map is received, the ALT landmarks need it");
+            return;
+        }
+
+        if( landmarks_failed_ ){
+            algorithm_->setHeuristic(Planners::Heuristic::euclidean);
+            ROS_INFO("Using Euclidean Heuristics, the ALT landmarks could not be computed for this map");
+            return;
+        }
+
+        int n_landmarks, n_threads;
+        lnh_.param("alt_landmarks", n_landmarks, 8);
+        lnh_.param("alt_threads", n_threads, 0);
+
+        const auto &world = *algorithm_->getInnerWorld();
+        if( !landmark_heuristic_ || !landmark_heuristic_->matches(world, n_landmarks, use3d_) ){
+            auto landmarks = std::make_shared<Planners::LandmarkHeuristic>();
+
+            // Same path as the .gridm cache, with .alt extension
+            std::string map_path, alt_path;
+            lnh_.param("map_path", map_path, std::string(""));
+            if( map_path.size() > 3 && ( map_path.compare(map_path.length() - 3, 3, ".bt") == 0 || 
+                                         map_path.compare(map_path.length() - 3, 3, ".ot") == 0 ) )
+                alt_path = map_path.substr(0, map_path.length() - 3) + ".alt";
+
+            if( !alt_path.empty() && landmarks->load(alt_path, world, n_landmarks, use3d_) ){
+                ROS_INFO("ALT landmarks loaded from %s", alt_path.c_str());
+            }else{
+                const auto start = std::chrono::steady_clock::now();
+                if( !landmarks->compute(world, n_landmarks, use3d_, n_threads) ){
+                    // Not retried until a new map is received
+                    landmarks_failed_ = true;
+                    landmark_heuristic_.reset();
+                    algorithm_->setHeuristic(Planners::Heuristic::euclidean);
+                    ROS_WARN("ALT landmarks could not be computed for this map. Using Euclidean Heuristics");
+                    return;
+                }
+                ROS_INFO("ALT: %lu landmarks computed in %.2f s (%.1f MB)", landmarks->getLandmarks().size(),
+                         std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), landmarks->getMemoryUsage() / 1e6);
+                if( !alt_path.empty() && landmarks->save(alt_path) )
+                    ROS_INFO("ALT landmarks saved on %s", alt_path.c_str());
+            }
+            landmark_heuristic_ = landmarks;
+        }
+        // Theta* paths can be shorter than the grid paths of the tables
+        landmark_heuristic_->setAnyAngle(algorithm_name_.find("theta") != std::string::npos);
+
+        auto landmarks = landmark_heuristic_;
+        algorithm_->setHeuristic([landmarks](Planners::utils::Vec3i _source, Planners::utils::Vec3i _target){ return (*landmarks)(_source, _target); });
+        ROS_INFO("Using ALT Heuristics");
+    }
+    /**
+     * @brief Builds the abstract graph of the hierarchical planner over the world of the algorithm.
+     * The requests are refined by the algorithm inside the corridor of clusters of the abstract path
+     */
+    void configureHierarchicalPlanner(){
+
+        hierarchical_planner_.reset();
+
+        bool hierarchical;
+        lnh_.param("hierarchical", hierarchical, (bool)false);
+        if( !hierarchical || input_map_ == 0 )
+            return;
+
+        int cluster_size, corridor_dilation, n_threads;
+        bool full_world_fallback;
+        lnh_.param("cluster_size", cluster_size, 16);
+        lnh_.param("corridor_dilation", corridor_dilation, 0);
+        lnh_.param("hierarchical_threads", n_threads, 0);
+        lnh_.param("hierarchical_fallback", full_world_fallback, (bool)true);
+
+        const auto start = std::chrono::steady_clock::now();
+        hierarchical_planner_.reset(new Planners::HierarchicalPlanner(*algorithm_, use3d_, std::max(2, cluster_size)));
+        hierarchical_planner_->setCorridorDilation(std::max(0, corridor_dilation));
+        hierarchical_planner_->setFullWorldFallback(full_world_fallback);
+        hierarchical_planner_->build(std::max(0, n_threads));
+        ROS_INFO("Hierarchical planner: %lu abstract nodes with clusters of %d cells computed in %.2f s", hierarchical_planner_->getAbstractNodes(),
+                 cluster_size, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
     std::vector<std::pair<Planners::utils::Vec3i, double>> getClosestObstaclesToPathPoints(const Planners::utils::CoordinateList &_path){
         
         std::vector<std::pair<Planners::utils::Vec3i, double>> result;
@@ -944,14 +1178,16 @@ private:
 
 
     ros::NodeHandle lnh_{"~"};
-    ros::ServiceServer request_path_server_, change_planner_server_;
+    ros::ServiceServer request_path_server_, request_path_batch_server_, change_planner_server_;
     ros::Subscriber pointcloud_sub_, occupancy_grid_sub_, sdf_sub_;
     //TODO Fix point markers
-    ros::Publisher line_markers_pub_, point_markers_pub_, global_path_pub_;
+    ros::Publisher line_markers_pub_, point_markers_pub_, global_path_pub_, global_path_stamped_pub_;
 
     std::unique_ptr<Grid3d> m_grid3d_;
 
     std::unique_ptr<Planners::AlgorithmBase> algorithm_;
+    Planners::utils::PlanResult plan_result_; // Reused between requests to keep the path buffer
+    std::string algorithm_name_;
         
     visualization_msgs::Marker path_line_markers_, path_points_markers_;
     
@@ -964,6 +1200,7 @@ private:
 
     bool inflate_{false};
     unsigned int inflation_steps_{0};
+    double cost_far_field_{0};
     std::string data_folder_;
     bool overlay_markers_{0};
     unsigned int color_id_{0};
@@ -974,9 +1211,37 @@ private:
     //2: using cloud
     int input_map_{0};
     std::string heuristic_;
+    std::string heuristic_name_; // Heuristic in use, heuristic_ is the default one
+    std::shared_ptr<Planners::LandmarkHeuristic> landmark_heuristic_;
+    bool landmarks_failed_{false}; // compute failed on the current map, the euclidean heuristic is used instead
+    std::unique_ptr<Planners::HierarchicalPlanner> hierarchical_planner_; // Wraps algorithm_, rebuilt with it
 
 };
 
+#ifdef HEURISTIC_PLANNERS_NODELET
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace heuristic_planners
+{
+    /**
+     * @brief The global planner as a nodelet, to share the process with the mapping and the local planner
+     * 
+     */
+    class PlannerNodelet : public nodelet::Nodelet
+    {
+        void onInit() override
+        {
+            NODELET_INFO("STARTING PLANNER NODELET");
+            planner_.reset(new HeuristicPlannerROS(getPrivateNodeHandle()));
+        }
+
+        std::unique_ptr<HeuristicPlannerROS> planner_;
+    };
+}
+PLUGINLIB_EXPORT_CLASS(heuristic_planners::PlannerNodelet, nodelet::Nodelet)
+
+#else
 int main(int argc, char **argv)
 {
     ROS_INFO("STARTING PLANNER ROS NODE");
@@ -985,4 +1250,5 @@ int main(int argc, char **argv)
     ros::spin();
 
 return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
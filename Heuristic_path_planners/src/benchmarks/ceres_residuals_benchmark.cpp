@@ -0,0 +1,69 @@
+/**
+ * @file ceres_residuals_benchmark.cpp
+ * @brief Times a residual + jacobian evaluation of every trajectory constraint, autodiff vs analytic.
+ *
+ * Usage: ceres_residuals_benchmark [iterations]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/CeresOpt.hpp"
+#include "ceres_test_utils.hpp"
+
+// Average time (ns) of a residual + jacobian evaluation
+static double timeEvaluation(ceres::CostFunction *cost_function_ptr, int iterations, std::mt19937 &gen){
+    std::unique_ptr<ceres::CostFunction> cost_function(cost_function_ptr);
+    const int num_blocks = cost_function->parameter_block_sizes().size();
+    std::vector<std::vector<double>> states(num_blocks, std::vector<double>(6));
+    std::vector<std::vector<double>> jacobians(num_blocks, std::vector<double>(6));
+    std::vector<double*> parameters(num_blocks), jacobians_ptr(num_blocks);
+    for (int b = 0; b < num_blocks; ++b){
+        ceres_test_utils::randomState(gen, states[b].data());
+        parameters[b] = states[b].data();
+        jacobians_ptr[b] = jacobians[b].data();
+    }
+
+    double residual, accumulated = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int n = 0; n < iterations; ++n){
+        states[0][0] += 1e-9;
+        cost_function->Evaluate(parameters.data(), &residual, jacobians_ptr.data());
+        accumulated += residual + jacobians[0][0];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> duration = end - start;
+
+    // Keep the loop from being optimized away
+    if (accumulated == std::numeric_limits<double>::infinity())
+        printf("%f\n", accumulated);
+
+    return duration.count() / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations{100000};
+    if( argc >= 2 )
+        iterations = std::atoi(argv[1]);
+
+    std::mt19937 gen(42);
+    auto bench = [&](const std::string &name, ceres::CostFunction *analytic, ceres::CostFunction *autodiff){
+        double t_autodiff = timeEvaluation(autodiff, iterations, gen);
+        double t_analytic = timeEvaluation(analytic, iterations, gen);
+        printf("%-16s autodiff: %8.1f ns | analytic: %8.1f ns | speedup: %.2fx\n", name.c_str(), t_autodiff, t_analytic, t_autodiff / t_analytic);
+    };
+    bench("Equidistance", Ceresopt::equidistanceCost(1.0, true), Ceresopt::equidistanceCost(1.0, false));
+    bench("Smoothness", Ceresopt::smoothnessCost(1.0, true), Ceresopt::smoothnessCost(1.0, false));
+    bench("PathLength", Ceresopt::pathLengthCost(1.0, true), Ceresopt::pathLengthCost(1.0, false));
+    bench("VelocityChange", Ceresopt::velocityChangeCost(1.0, 0.5, true), Ceresopt::velocityChangeCost(1.0, 0.5, false));
+    bench("MinAcceleration", Ceresopt::minAccelerationCost(1.0, true), Ceresopt::minAccelerationCost(1.0, false));
+    bench("PosVelCoherence", Ceresopt::posVelCoherenceCost(1.0, true), Ceresopt::posVelCoherenceCost(1.0, false));
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file grid3d_benchmark.cpp
+ * @brief Times the computation of the Grid3d distance grid with the per-cell kdtree search and with
+ * the distance transform, on random clouds of growing size.
+ *
+ * Usage: grid3d_benchmark [occupancy] [seed]
+ *
+ * The grids go from 50x50x20 to 200x200x40 cells of 0.2 m. The number of cells with a different
+ * distance between both algorithms is also printed, it should be 0.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "grid3d_test_utils.hpp"
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "grid3d_benchmark", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+    double occupancy{0.01};
+    unsigned int seed{1};
+    if( argc >= 2 )
+        occupancy = std::atof(argv[1]);
+    if( argc >= 3 )
+        seed = std::atoi(argv[2]);
+
+    const float resolution = 0.2;
+    const std::vector<std::vector<int>> sizes{{50, 50, 20}, {100, 100, 20}, {100, 100, 40}, {200, 200, 40}};
+
+    printf("%-14s %10s %12s %12s %10s %10s\n", "grid", "points", "kdtree [s]", "edt [s]", "speedup", "different");
+    for(const auto &size: sizes){
+        std::mt19937 gen(seed);
+        const auto cloud = grid3d_test_utils::randomCloud(gen, size[0], size[1], size[2], resolution, occupancy);
+
+        grid3d_test_utils::Grid3dAccess kdtree, transform;
+        kdtree.setCloud(cloud, size[0], size[1], size[2], resolution);
+        transform.setCloud(cloud, size[0], size[1], size[2], resolution);
+
+        auto start = std::chrono::steady_clock::now();
+        kdtree.compute(true);
+        const double kdtree_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        transform.compute(false);
+        const double transform_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int different{0};
+        for(int i = 0; i < kdtree.gridSize(); ++i)
+            different += kdtree.grid()[i].dist != transform.grid()[i].dist;
+
+        char grid[32];
+        snprintf(grid, sizeof(grid), "%dx%dx%d", size[0], size[1], size[2]);
+        printf("%-14s %10zu %12.3f %12.3f %9.1fx %10d\n", grid, cloud.points.size(), kdtree_time, transform_time,
+               kdtree_time / transform_time, different);
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file hierarchical_benchmark.cpp
+ * @brief Times the same queries with the plain A* search and with the HierarchicalPlanner (HPA*) on
+ * worlds of growing size, to check that the latency of a query depends on the length of its path and
+ * not on the size of the map.
+ *
+ * Usage: hierarchical_benchmark [2d|3d] [cluster_size] [queries] [seed]
+ *
+ * The 2D worlds go from 128x128 to 1024x1024 cells and the 3D ones from 64x64x32 to 256x256x32. They get
+ * random boxes and walls, and every query joins two free cells about 100 cells apart. The build time of
+ * the abstraction is printed apart, it is paid once per map. The times are the mean of all the queries,
+ * also the ones without a path, and the HPA* cost is its mean ratio to the optimal A* cost.
+ * When built with ROS support the algorithm configures its debug publishers, so a roscore should be running.
+ */
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "Planners/AStar.hpp"
+#include "Planners/HierarchicalPlanner.hpp"
+
+#ifdef ROS
+#include <ros/ros.h>
+#endif
+
+using namespace Planners;
+
+static CoordinateList randomObstacles(const Vec3i &_world_size, std::mt19937 &_generator){
+    std::uniform_int_distribution<int> random_x(0, _world_size.x - 1), random_y(0, _world_size.y - 1), random_z(0, _world_size.z - 1);
+    std::uniform_int_distribution<int> side(1, 6), wall(10, 40);
+    CoordinateList obstacles;
+    const size_t n_boxes = static_cast<size_t>(_world_size.x) * _world_size.y / 100;
+    for(size_t i = 0; i < n_boxes; ++i){
+        const Vec3i origin{random_x(_generator), random_y(_generator), random_z(_generator)};
+        Vec3i extent{side(_generator), side(_generator), _world_size.z > 1 ? _world_size.z : 1};
+        if( i % 4 == 0 )
+            ( i % 8 == 0 ? extent.x : extent.y ) = wall(_generator);
+        for(int z = origin.z; z < std::min(_world_size.z, origin.z + extent.z); ++z)
+            for(int y = origin.y; y < std::min(_world_size.y, origin.y + extent.y); ++y)
+                for(int x = origin.x; x < std::min(_world_size.x, origin.x + extent.x); ++x)
+                    obstacles.push_back({x, y, z});
+    }
+    return obstacles;
+}
+
+int main(int argc, char **argv)
+{
+#ifdef ROS
+    ros::init(argc, argv, "hierarchical_benchmark");
+#endif
+    std::string dimensions{"2d"};
+    unsigned int cluster_size{16};
+    int n_queries{50};
+    unsigned int seed{1};
+
+    if( argc >= 2 )
+        dimensions = argv[1];
+    if( argc >= 3 )
+        cluster_size = std::atoi(argv[2]);
+    if( argc >= 4 )
+        n_queries = std::atoi(argv[3]);
+    if( argc >= 5 )
+        seed = std::atoi(argv[4]);
+
+    const bool use_3d = dimensions == "3d";
+    std::vector<Vec3i> world_sizes;
+    if( use_3d )
+        world_sizes = {{64, 64, 32}, {128, 128, 32}, {256, 256, 32}};
+    else
+        world_sizes = {{128, 128, 1}, {256, 256, 1}, {512, 512, 1}, {1024, 1024, 1}};
+
+    std::cout << std::left << std::setw(18) << "world" << std::setw(12) << "build [ms]" << std::setw(14) << "astar [ms]"
+              << std::setw(14) << "hpa* [ms]" << std::setw(16) << "astar explored" << std::setw(14) << "hpa* explored"
+              << std::setw(12) << "hpa* cost" << "solved (hpa*/astar)" << std::endl;
+
+    torch::jit::script::Module sdf;
+    for(const auto &world_size: world_sizes){
+        std::mt19937 generator(seed);
+        const auto obstacles = randomObstacles(world_size, generator);
+
+        AStar algorithm(use_3d);
+        algorithm.setHeuristic(Heuristic::euclidean);
+        algorithm.setComputeStatistics(false);
+        algorithm.setWorldSize(world_size, 0.2);
+        algorithm.addCollisions(obstacles, false, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        HierarchicalPlanner planner(algorithm, use_3d, cluster_size);
+        planner.build();
+        const double build_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Free cells about 100 cells apart (less in the smallest worlds), in the middle height of the 3D worlds.
+        // The full-world fallback is disabled, so the queries without a path are rejected by the abstract search
+        planner.setFullWorldFallback(false);
+        const double length = std::min(100.0, 0.7 * std::min(world_size.x, world_size.y));
+        std::uniform_int_distribution<int> random_x(0, world_size.x - 1), random_y(0, world_size.y - 1);
+        std::uniform_real_distribution<double> random_angle(0, 2 * M_PI);
+        std::vector<std::pair<Vec3i, Vec3i>> queries;
+        while( static_cast<int>(queries.size()) < n_queries ){
+            const double angle = random_angle(generator);
+            const Vec3i source{random_x(generator), random_y(generator), world_size.z / 2};
+            const Vec3i target{source.x + static_cast<int>(std::round(length * std::cos(angle))),
+                               source.y + static_cast<int>(std::round(length * std::sin(angle))), world_size.z / 2};
+            if( target.x < 0 || target.y < 0 || target.x >= world_size.x || target.y >= world_size.y ||
+                algorithm.detectCollision(source) || algorithm.detectCollision(target) )
+                continue;
+            queries.push_back({source, target});
+        }
+
+        double astar_time{0}, hpa_time{0}, cost_ratio{0};
+        size_t astar_explored{0}, hpa_explored{0};
+        int astar_solved{0}, solved{0};
+        PlanResult astar_result, hpa_result;
+        for(const auto &query: queries){
+            start = std::chrono::steady_clock::now();
+            algorithm.findPath(query.first, query.second, sdf, astar_result);
+            astar_time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            planner.findPath(query.first, query.second, sdf, hpa_result);
+            hpa_time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            astar_explored += astar_result.explored_nodes;
+            hpa_explored   += hpa_result.explored_nodes;
+            astar_solved += astar_result.solved;
+            if( astar_result.solved && hpa_result.solved ){
+                cost_ratio += static_cast<double>(hpa_result.g_final_node) / astar_result.g_final_node;
+                solved++;
+            }
+        }
+
+        std::ostringstream world;
+        world << world_size.x << "x" << world_size.y << "x" << world_size.z;
+        std::cout << std::left << std::setw(18) << world.str() << std::fixed << std::setprecision(3) << std::setw(12) << build_time
+                  << std::setw(14) << astar_time / n_queries << std::setw(14) << hpa_time / n_queries
+                  << std::setw(16) << astar_explored / n_queries << std::setw(14) << hpa_explored / n_queries
+                  << std::setw(12) << ( solved > 0 ? cost_ratio / solved : 0 ) << solved << "/" << astar_solved << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file inflation_benchmark.cpp
+ * @brief Times the inflation of the same random obstacles with each inflation mode of addCollisions
+ * against the per-obstacle addCollision.
+ *
+ * Usage: inflation_benchmark [size_x size_y size_z] [points] [steps] [seed]
+ *
+ * The number of occupied cells is printed with each time, the cube modes mark the same cells.
+ * When built with ROS support the algorithm configures its debug publishers, so a roscore should be running.
+ */
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <chrono>
+
+#include "Planners/AStar.hpp"
+
+#ifdef ROS
+#include <ros/ros.h>
+#endif
+
+using namespace Planners;
+
+static std::unique_ptr<AlgorithmBase> makeAlgorithm(const Vec3i &_world_size, const AlgorithmBase::InflationMode _mode){
+    std::unique_ptr<AlgorithmBase> algorithm(new AStar(_world_size.z > 1));
+    algorithm->setWorldSize(_world_size, 0.2);
+    algorithm->setInflationMode(_mode);
+    return algorithm;
+}
+
+static size_t countOccupied(AlgorithmBase &_algorithm, const Vec3i &_world_size){
+    size_t occupied{0};
+    for(int z = 0; z < _world_size.z; ++z)
+        for(int y = 0; y < _world_size.y; ++y)
+            for(int x = 0; x < _world_size.x; ++x)
+                occupied += _algorithm.getInnerWorld()->isOccupied(x, y, z);
+    return occupied;
+}
+
+static void printResult(const std::string &_name, const double _time, const size_t _occupied){
+    std::cout << std::left << std::setw(28) << _name << std::setw(14) << std::fixed << std::setprecision(3) << _time
+              << _occupied << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+#ifdef ROS
+    ros::init(argc, argv, "inflation_benchmark");
+#endif
+    Vec3i world_size{200, 200, 50};
+    int n_points{100000};
+    unsigned int steps{10};
+    unsigned int seed{1};
+
+    if( argc >= 4 )
+        world_size = {std::atoi(argv[1]), std::atoi(argv[2]), std::atoi(argv[3])};
+    if( argc >= 5 )
+        n_points = std::atoi(argv[4]);
+    if( argc >= 6 )
+        steps = std::atoi(argv[5]);
+    if( argc >= 7 )
+        seed = std::atoi(argv[6]);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> random_x(0, world_size.x - 1), random_y(0, world_size.y - 1), random_z(0, world_size.z - 1);
+    CoordinateList obstacles;
+    for(int i = 0; i < n_points; ++i)
+        obstacles.push_back({random_x(generator), random_y(generator), random_z(generator)});
+
+    std::cout << std::left << std::setw(28) << "inflation" << std::setw(14) << "time [ms]" << "occupied" << std::endl;
+
+    // Each obstacle on its own, as configureWorldFromPointCloud did before addCollisions
+    {
+        auto algorithm = makeAlgorithm(world_size, AlgorithmBase::INFLATE_NODE_AS_CUBE);
+        auto start = std::chrono::steady_clock::now();
+        for(const auto &it: obstacles)
+            algorithm->addCollision(it, true, steps);
+        const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printResult("addCollision", time, countOccupied(*algorithm, world_size));
+    }
+
+    const std::pair<std::string, AlgorithmBase::InflationMode> modes[] = {
+        {"node_as_cube", AlgorithmBase::INFLATE_NODE_AS_CUBE},
+        {"cube",         AlgorithmBase::INFLATE_DT_CUBE},
+        {"sphere",       AlgorithmBase::INFLATE_DT_SPHERE},
+    };
+    for(const auto &mode: modes){
+        auto algorithm = makeAlgorithm(world_size, mode.second);
+        auto start = std::chrono::steady_clock::now();
+        algorithm->addCollisions(obstacles, true, steps);
+        const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printResult("addCollisions " + mode.first, time, countOccupied(*algorithm, world_size));
+    }
+
+    return 0;
+}
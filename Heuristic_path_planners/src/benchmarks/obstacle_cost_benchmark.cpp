@@ -0,0 +1,115 @@
+/**
+ * @file obstacle_cost_benchmark.cpp
+ * @brief Times the evaluation of all the obstacle residuals of a path, grid interpolation vs batched neural ESDF.
+ *
+ * Usage: obstacle_cost_benchmark model.pt [drone_x drone_y drone_z] [waypoints] [iterations]
+ *
+ * The local grid is computed once from the network around the given drone position, with the
+ * parameters of the private namespace (as the local planner node), and the path crosses it diagonally.
+ * A roscore should be running.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "utils/CeresOpt.hpp"
+#include "Grid3D/local_grid3d.hpp"
+
+#include <ros/ros.h>
+
+// Prints the cost of evaluating all the obstacle residuals of a path, grid interpolation vs batched neural ESDF
+static void benchmarkObstacleResiduals(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, torch::jit::script::Module &loaded_sdf, int iterations){
+    const int num_wp = initial_path.size();
+    if(num_wp == 0)
+        return;
+
+    std::vector<parameterBlockTrajectoryWP> wp_state_vector(num_wp);
+    for (int i = 0; i < num_wp; i++){
+        wp_state_vector[i].parameter[0] = initial_path[i].x;
+        wp_state_vector[i].parameter[1] = initial_path[i].y;
+        wp_state_vector[i].parameter[2] = initial_path[i].z;
+        for (int k = 3; k < 6; ++k)
+            wp_state_vector[i].parameter[k] = 0.0;
+    }
+
+    NeuralEsdfEvaluationCallback neural_esdf_callback(&loaded_sdf, &_grid);
+    std::vector<std::unique_ptr<ceres::CostFunction>> grid_functions, neural_functions;
+    for (int i = 0; i < num_wp; i++){
+        grid_functions.emplace_back(new ObstacleDistanceCostFunctor(&_grid, 1.0));
+        neural_functions.emplace_back(new NeuralObstacleDistanceCostFunction(&neural_esdf_callback, wp_state_vector[i].parameter, 1.0));
+    }
+
+    double residual, jacobian[6];
+    double* jacobians[1] = {jacobian};
+    double grid_residual_sum = 0.0, neural_residual_sum = 0.0;
+
+    // One "iteration" = every obstacle residual and jacobian evaluated once, as Ceres does per evaluation point
+    auto start_grid = std::chrono::high_resolution_clock::now();
+    for (int n = 0; n < iterations; n++){
+        for (int i = 0; i < num_wp; i++){
+            double* parameters[1] = {wp_state_vector[i].parameter};
+            grid_functions[i]->Evaluate(parameters, &residual, jacobians);
+            grid_residual_sum += residual;
+        }
+    }
+    auto end_grid = std::chrono::high_resolution_clock::now();
+
+    auto start_neural = std::chrono::high_resolution_clock::now();
+    for (int n = 0; n < iterations; n++){
+        neural_esdf_callback.PrepareForEvaluation(true, true);
+        for (int i = 0; i < num_wp; i++){
+            double* parameters[1] = {wp_state_vector[i].parameter};
+            neural_functions[i]->Evaluate(parameters, &residual, jacobians);
+            neural_residual_sum += residual;
+        }
+    }
+    auto end_neural = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::micro> grid_duration = end_grid - start_grid;
+    std::chrono::duration<double, std::micro> neural_duration = end_neural - start_neural;
+    printf("Obstacle cost (%d WP) | grid interpolation: %.2f us/iter | neural ESDF batched: %.2f us/iter\n",
+           num_wp, grid_duration.count() / iterations, neural_duration.count() / iterations);
+    printf("Obstacle cost mean residual | grid interpolation: %.4f | neural ESDF: %.4f\n",
+           grid_residual_sum / (iterations * num_wp), neural_residual_sum / (iterations * num_wp));
+}
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "obstacle_cost_benchmark");
+    if( argc < 2 ){
+        printf("Usage: %s model.pt [drone_x drone_y drone_z] [waypoints] [iterations]\n", argv[0]);
+        return 1;
+    }
+    float drone_x{0.0}, drone_y{0.0}, drone_z{1.0};
+    int num_wp{6};
+    int iterations{100};
+    if( argc >= 5 ){
+        drone_x = std::atof(argv[2]);
+        drone_y = std::atof(argv[3]);
+        drone_z = std::atof(argv[4]);
+    }
+    if( argc >= 6 )
+        num_wp = std::max(2, std::atoi(argv[5]));
+    if( argc >= 7 )
+        iterations = std::atoi(argv[6]);
+
+    torch::jit::script::Module loaded_sdf = torch::jit::load(argv[1], c10::kCPU);
+    Local_Grid3d grid(ros::NodeHandle("~"));
+    grid.computeLocalGrid(loaded_sdf, drone_x, drone_y, drone_z);
+
+    Planners::utils::CoordinateList path;
+    for (int i = 0; i < num_wp; i++){
+        Planners::utils::Vec3i point;
+        point.x = 1 + i * (grid.m_gridSizeX - 3) / (num_wp - 1);
+        point.y = 1 + i * (grid.m_gridSizeY - 3) / (num_wp - 1);
+        point.z = (grid.m_gridSizeZ - 1) / 2;
+        path.push_back(point);
+    }
+
+    benchmarkObstacleResiduals(path, grid, loaded_sdf, iterations);
+
+    return 0;
+}
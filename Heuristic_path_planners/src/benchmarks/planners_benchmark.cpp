@@ -0,0 +1,161 @@
+/**
+ * @file planners_benchmark.cpp
+ * @brief Times every HeuristicSearch composition on the same random world and queries.
+ *
+ * Usage: planners_benchmark [size_x size_y size_z] [obstacle_ratio] [queries] [seed] [euclidean|alt] [landmarks]
+ *
+ * With the alt heuristic the landmark tables are computed once, before the queries, and
+ * the precomputation time is reported separately.
+ *
+ * The SIREN compositions are not included as they need a trained network.
+ * When built with ROS support the algorithms configure their debug publishers,
+ * so a roscore should be running.
+ */
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <random>
+#include <functional>
+#include <chrono>
+
+#include "Planners/AStar.hpp"
+#include "Planners/AStarM1.hpp"
+#include "Planners/AStarM2.hpp"
+#include "Planners/ThetaStar.hpp"
+#include "Planners/ThetaStarM1.hpp"
+#include "Planners/ThetaStarM2.hpp"
+#include "Planners/LazyThetaStar.hpp"
+#include "Planners/LazyThetaStarM1.hpp"
+#include "Planners/LazyThetaStarM1Mod.hpp"
+#include "Planners/LazyThetaStarM2.hpp"
+#include "utils/heuristic.hpp"
+#include "utils/LandmarkHeuristic.hpp"
+
+#ifdef ROS
+#include <ros/ros.h>
+#endif
+
+using namespace Planners;
+
+struct Benchmark
+{
+    std::string name;
+    std::function<AlgorithmBase*()> create;
+};
+
+int main(int argc, char **argv)
+{
+#ifdef ROS
+    ros::init(argc, argv, "planners_benchmark");
+#endif
+    Vec3i world_size{150, 150, 30};
+    double obstacle_ratio{0.1};
+    int n_queries{20};
+    unsigned int seed{1};
+
+    if( argc >= 4 )
+        world_size = {std::atoi(argv[1]), std::atoi(argv[2]), std::atoi(argv[3])};
+    if( argc >= 5 )
+        obstacle_ratio = std::atof(argv[4]);
+    if( argc >= 6 )
+        n_queries = std::atoi(argv[5]);
+    if( argc >= 7 )
+        seed = std::atoi(argv[6]);
+    const bool use_alt = argc >= 8 && std::string(argv[7]) == "alt";
+    const unsigned int n_landmarks = argc >= 9 ? std::atoi(argv[8]) : 8;
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> random_x(0, world_size.x - 1), random_y(0, world_size.y - 1), random_z(0, world_size.z - 1);
+    std::uniform_real_distribution<double> random_cost(0.2, 4.0);
+
+    CoordinateList obstacles;
+    const size_t n_obstacles = static_cast<size_t>(obstacle_ratio * world_size.x * world_size.y * world_size.z);
+    for(size_t i = 0; i < n_obstacles; ++i)
+        obstacles.push_back({random_x(generator), random_y(generator), random_z(generator)});
+
+    std::vector<double> costs(static_cast<size_t>(world_size.x) * world_size.y * world_size.z);
+    for(auto &it: costs)
+        it = random_cost(generator);
+
+    std::vector<std::pair<Vec3i, Vec3i>> queries;
+    for(int i = 0; i < n_queries; ++i)
+        queries.push_back({ {random_x(generator), random_y(generator), random_z(generator)},
+                            {random_x(generator), random_y(generator), random_z(generator)} });
+
+    const bool use_3d = world_size.z > 1;
+    std::vector<Benchmark> benchmarks{
+        {"astar",              [&]{ return new AStar(use_3d); }},
+        {"astarm1",            [&]{ return new AStarM1(use_3d); }},
+        {"astarm2",            [&]{ return new AStarM2(use_3d); }},
+        {"thetastar",          [&]{ return new ThetaStar(use_3d); }},
+        {"thetastarm1",        [&]{ return new ThetaStarM1(use_3d); }},
+        {"thetastarm2",        [&]{ return new ThetaStarM2(use_3d); }},
+        {"lazythetastar",      [&]{ return new LazyThetaStar(use_3d); }},
+        {"lazythetastarm1",    [&]{ return new LazyThetaStarM1(use_3d); }},
+        {"lazythetastarm1mod", [&]{ return new LazyThetaStarM1Mod(use_3d); }},
+        {"lazythetastarm2",    [&]{ return new LazyThetaStarM2(use_3d); }},
+        {"astar (heap)",           [&]{ return new HeuristicSearch<NoCostPolicy, NoLineOfSight, BinaryHeapOpenList>(use_3d); }},
+        {"astarm1 (heap)",         [&]{ return new HeuristicSearch<CostAwarePolicy, NoLineOfSight, BinaryHeapOpenList>(use_3d); }},
+        {"thetastar (heap)",       [&]{ return new HeuristicSearch<NoCostPolicy, EagerLineOfSight, BinaryHeapOpenList>(use_3d); }},
+        {"lazythetastar (heap)",   [&]{ return new HeuristicSearch<NoCostPolicy, LazyLineOfSight, BinaryHeapOpenList>(use_3d); }},
+        {"lazythetastarm1 (heap)", [&]{ return new HeuristicSearch<CostAwarePolicy, LazyLineOfSight, BinaryHeapOpenList>(use_3d); }},
+    };
+
+    torch::jit::script::Module sdf;
+    std::shared_ptr<LandmarkHeuristic> landmarks;
+    std::cout << std::left << std::setw(26) << "algorithm" << std::setw(14) << "mean [ms]"
+              << std::setw(16) << "mean explored" << "solved" << std::endl;
+
+    for(auto &benchmark: benchmarks){
+        std::unique_ptr<AlgorithmBase> algorithm(benchmark.create());
+        algorithm->setWorldSize(world_size, 0.2);
+        algorithm->setHeuristic(Heuristic::euclidean);
+        algorithm->setCostFactor(1.0);
+        algorithm->setMaxLineOfSight(5.0);
+        algorithm->addCollisions(obstacles);
+        algorithm->setComputeStatistics(false);
+
+        auto world = algorithm->getInnerWorld();
+        size_t index = 0;
+        for(int z = 0; z < world_size.z; ++z)
+            for(int y = 0; y < world_size.y; ++y)
+                for(int x = 0; x < world_size.x; ++x)
+                    world->setNodeCost({x, y, z}, costs[index++]);
+
+        for(const auto &query: queries){
+            world->setUnoccupied(query.first);
+            world->setUnoccupied(query.second);
+        }
+        if( use_alt ){
+            if( !landmarks ){
+                landmarks = std::make_shared<LandmarkHeuristic>();
+                auto start = std::chrono::steady_clock::now();
+                landmarks->compute(*world, n_landmarks, use_3d);
+                std::cout << "ALT: " << landmarks->getLandmarks().size() << " landmarks computed in "
+                          << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s ("
+                          << landmarks->getMemoryUsage() / 1e6 << " MB)" << std::endl;
+            }
+            landmarks->setAnyAngle(benchmark.name.find("theta") != std::string::npos);
+            algorithm->setHeuristic([landmarks](Vec3i _source, Vec3i _target){ return (*landmarks)(_source, _target); });
+        }
+
+        double total_time{0};
+        size_t total_explored{0};
+        int solved{0};
+        PlanResult result;
+        for(const auto &query: queries){
+            auto start  = std::chrono::steady_clock::now();
+            algorithm->findPath(query.first, query.second, sdf, result);
+            total_time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            total_explored += result.explored_nodes;
+            solved         += result.solved;
+        }
+
+        std::cout << std::left << std::setw(26) << benchmark.name << std::setw(14) << std::fixed << std::setprecision(3) << total_time / n_queries
+                  << std::setw(16) << total_explored / n_queries << solved << "/" << n_queries << std::endl;
+    }
+
+    return 0;
+}
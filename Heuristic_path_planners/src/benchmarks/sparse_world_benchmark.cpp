@@ -0,0 +1,108 @@
+/**
+ * @file sparse_world_benchmark.cpp
+ * @brief Times the world setup and one search with the dense and the sparse storage of DiscreteWorld,
+ * and prints the memory used by each of them.
+ *
+ * Usage: sparse_world_benchmark [size_x size_y size_z] [dense|sparse|both] [astar|lazythetastar] [seed]
+ *
+ * The world gets x*y/20 random obstacle cells and the query crosses it along x, about 40 m at the
+ * 0.2 m resolution when the world is big enough. With "both" the two paths are also compared.
+ * When built with ROS support the algorithm configures its debug publishers, so a roscore should be running.
+ */
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <chrono>
+
+#include "Planners/AStar.hpp"
+#include "Planners/LazyThetaStar.hpp"
+
+#ifdef ROS
+#include <ros/ros.h>
+#endif
+
+using namespace Planners;
+
+static PlanResult runBenchmark(const std::string &_algorithm, const bool _sparse, const Vec3i &_world_size,
+                               const CoordinateList &_obstacles, const Vec3i &_start, const Vec3i &_goal){
+    const bool use_3d = _world_size.z > 1;
+    std::unique_ptr<AlgorithmBase> algorithm;
+    if( _algorithm == "lazythetastar" )
+        algorithm.reset(new LazyThetaStar(use_3d));
+    else
+        algorithm.reset(new AStar(use_3d));
+    algorithm->setHeuristic(Heuristic::euclidean);
+    algorithm->setComputeStatistics(false);
+
+    auto start = std::chrono::steady_clock::now();
+    algorithm->getInnerWorld()->setSparse(_sparse);
+    algorithm->setWorldSize(_world_size, 0.2);
+    algorithm->addCollisions(_obstacles, false, 0);
+    algorithm->getInnerWorld()->setUnoccupied(_start);
+    algorithm->getInnerWorld()->setUnoccupied(_goal);
+    const double setup_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    torch::jit::script::Module sdf;
+    PlanResult result;
+    start = std::chrono::steady_clock::now();
+    algorithm->findPath(_start, _goal, sdf, result);
+    const double search_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(10) << (_sparse ? "sparse" : "dense") << std::setw(14) << std::fixed << std::setprecision(3) << setup_time
+              << std::setw(14) << search_time << std::setw(14) << algorithm->getInnerWorld()->getMemoryUsage() / 1e6
+              << std::setw(12) << result.explored_nodes << result.path.size() << std::endl;
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+#ifdef ROS
+    ros::init(argc, argv, "sparse_world_benchmark");
+#endif
+    Vec3i world_size{200, 200, 50};
+    std::string storage{"both"};
+    std::string algorithm{"astar"};
+    unsigned int seed{1};
+
+    if( argc >= 4 )
+        world_size = {std::atoi(argv[1]), std::atoi(argv[2]), std::atoi(argv[3])};
+    if( argc >= 5 )
+        storage = argv[4];
+    if( argc >= 6 )
+        algorithm = argv[5];
+    if( argc >= 7 )
+        seed = std::atoi(argv[6]);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> random_x(0, world_size.x - 1), random_y(0, world_size.y - 1), random_z(0, world_size.z - 1);
+    CoordinateList obstacles;
+    const size_t n_obstacles = static_cast<size_t>(world_size.x) * world_size.y / 20;
+    for(size_t i = 0; i < n_obstacles; ++i)
+        obstacles.push_back({random_x(generator), random_y(generator), random_z(generator)});
+
+    // 100 cells on each side of the center, or up to the borders
+    const int half_length = std::min(100, world_size.x / 2 - 1);
+    const Vec3i start{world_size.x / 2 - half_length, world_size.y / 2, world_size.z / 2};
+    const Vec3i goal{world_size.x / 2 + half_length, world_size.y / 2, world_size.z / 2};
+
+    std::cout << std::left << std::setw(10) << "storage" << std::setw(14) << "setup [ms]" << std::setw(14) << "search [ms]"
+              << std::setw(14) << "memory [MB]" << std::setw(12) << "explored" << "path" << std::endl;
+
+    PlanResult dense_result, sparse_result;
+    if( storage != "sparse" )
+        dense_result = runBenchmark(algorithm, false, world_size, obstacles, start, goal);
+    if( storage != "dense" )
+        sparse_result = runBenchmark(algorithm, true, world_size, obstacles, start, goal);
+
+    if( storage == "both" ){
+        const bool same_path = dense_result.path.size() == sparse_result.path.size() &&
+                               std::equal(dense_result.path.begin(), dense_result.path.end(), sparse_result.path.begin(),
+                                          [](Vec3i _a, Vec3i _b){ return _a == _b; });
+        std::cout << "Same path: " << (same_path ? "yes" : "no") << std::endl;
+    }
+
+    return 0;
+}
@@ -1,7 +1,46 @@
 #include "utils/CeresOpt.hpp"
 
+#include <memory>
+
 namespace Ceresopt
 {
+    // Cost function factories: the same residual either with autodiff (templated functor) or with hand-derived jacobians
+    ceres::CostFunction* equidistanceCost(double weight, bool analytic){
+        if (analytic)
+            return new EquidistanceCostFunction(weight);
+        return new AutoDiffCostFunction<EquidistanceFunctor, 1, 6, 6, 6>(new EquidistanceFunctor(weight));
+    }
+
+    ceres::CostFunction* smoothnessCost(double weight, bool analytic){
+        if (analytic)
+            return new SmoothnessCostFunction(weight);
+        return new AutoDiffCostFunction<SmoothnessFunctor, 1, 6, 6, 6>(new SmoothnessFunctor(weight));
+    }
+
+    ceres::CostFunction* pathLengthCost(double weight, bool analytic){
+        if (analytic)
+            return new PathLengthCostFunction(weight);
+        return new AutoDiffCostFunction<PathLengthFunctor, 1, 6, 6>(new PathLengthFunctor(weight));
+    }
+
+    ceres::CostFunction* velocityChangeCost(double weight, double desired_vel, bool analytic){
+        if (analytic)
+            return new VelocityChangeCostFunction(weight, desired_vel);
+        return new AutoDiffCostFunction<VelocityChangeFunctor, 1, 6>(new VelocityChangeFunctor(weight, desired_vel));
+    }
+
+    ceres::CostFunction* minAccelerationCost(double weight, bool analytic){
+        if (analytic)
+            return new MinAccelerationCostFunction(weight);
+        return new AutoDiffCostFunction<MinAccelerationFunctor, 1, 6, 6>(new MinAccelerationFunctor(weight));
+    }
+
+    ceres::CostFunction* posVelCoherenceCost(double weight, bool analytic){
+        if (analytic)
+            return new PosVelCoherenceCostFunction(weight);
+        return new AutoDiffCostFunction<PosVelCoherenceFunctor, 1, 6, 6>(new PosVelCoherenceFunctor(weight));
+    }
+
     std::vector<double> InitVelCalculator(std::vector<parameterBlockTrajectoryWP> wp_state_vector, double desired_vel, int num_wp, float res){
         // Compute initial velocity module
         // double vini_module = 0;
@@ -46,7 +85,7 @@ namespace Ceresopt
 
     }
 
-    Planners::utils::OptimizedPath ceresOptimizerPath(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float res)
+    Planners::utils::OptimizedPath ceresOptimizerPath(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float res, bool analytic_jacobians)
     {
         // Convert trajectory to ceres state wp vector
         std::vector<parameterBlockPathWP> wp_state_vector;
@@ -90,10 +129,8 @@ namespace Ceresopt
         // 1/2 - Equidistance cost function + Smoothness cost function --> Tries to maintain equal distance between WP and avoid big changes in direction
         for (int i = 0; i < wp_state_vector.size() - 2; i++)
         {
-            ceres::CostFunction* equidistance_function = new AutoDiffCostFunction<EquidistanceFunctor, 1, 6, 6, 6>
-                                                        (new EquidistanceFunctor(weight_equidistance));
-            ceres::CostFunction* smoothness_function = new AutoDiffCostFunction<SmoothnessFunctor, 1, 6, 6, 6>
-                                                        (new SmoothnessFunctor(weight_smoothness));
+            ceres::CostFunction* equidistance_function = equidistanceCost(weight_equidistance, analytic_jacobians);
+            ceres::CostFunction* smoothness_function = smoothnessCost(weight_smoothness, analytic_jacobians);
             problem.AddResidualBlock(equidistance_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter, wp_state_vector[i+2].parameter);
             problem.AddResidualBlock(smoothness_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter, wp_state_vector[i+2].parameter);
         }
@@ -101,8 +138,7 @@ namespace Ceresopt
         // 3 - Path length cost function --> Tries to minimize path length
         for (int i = 0; i < wp_state_vector.size() - 1; i++)
         {
-            ceres::CostFunction* path_length_function = new AutoDiffCostFunction<PathLengthFunctor, 1, 6, 6>
-                                                        (new PathLengthFunctor(weight_path_length));
+            ceres::CostFunction* path_length_function = pathLengthCost(weight_path_length, analytic_jacobians);
             problem.AddResidualBlock(path_length_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter);
         }
 
@@ -166,7 +202,7 @@ namespace Ceresopt
         return optimized_path;
     }
 
-    Planners::utils::OptimizedTrajectory ceresOptimizerTrajectory(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float res)
+    Planners::utils::OptimizedTrajectory ceresOptimizerTrajectory(Planners::utils::CoordinateList initial_path, Local_Grid3d &_grid, float res, bool analytic_jacobians, torch::jit::script::Module* loaded_sdf)
     {
         // Convert trajectory to ceres state wp vector
         std::vector<parameterBlockTrajectoryWP> wp_state_vector;
@@ -211,7 +247,16 @@ namespace Ceresopt
 
 
         // Declare Ceres optimization problem
-        ceres::Problem problem;
+        // With the neural ESDF, the network is queried once per evaluation point for all the waypoints (see NeuralEsdfEvaluationCallback)
+        std::unique_ptr<NeuralEsdfEvaluationCallback> neural_esdf_callback;
+        ceres::Problem::Options problem_options;
+        if(loaded_sdf != nullptr){
+            neural_esdf_callback.reset(new NeuralEsdfEvaluationCallback(loaded_sdf, &_grid));
+#if CERES_VERSION_MAJOR >= 2
+            problem_options.evaluation_callback = neural_esdf_callback.get();
+#endif
+        }
+        ceres::Problem problem(problem_options);
 
         std::cout << "Created Ceres Problem" << std::endl;
 
@@ -242,10 +287,8 @@ namespace Ceresopt
         // 1/2 - Equidistance cost function + Smoothness cost function --> Tries to maintain equal distance between WP and avoid big changes in direction
         for (int i = 0; i < wp_state_vector.size() - 2; i++)
         {
-            ceres::CostFunction* equidistance_function = new AutoDiffCostFunction<EquidistanceFunctor, 1, 6, 6, 6>
-                                                        (new EquidistanceFunctor(weight_equidistance));
-            ceres::CostFunction* smoothness_function = new AutoDiffCostFunction<SmoothnessFunctor, 1, 6, 6, 6>
-                                                        (new SmoothnessFunctor(weight_smoothness));
+            ceres::CostFunction* equidistance_function = equidistanceCost(weight_equidistance, analytic_jacobians);
+            ceres::CostFunction* smoothness_function = smoothnessCost(weight_smoothness, analytic_jacobians);
             problem.AddResidualBlock(equidistance_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter, wp_state_vector[i+2].parameter);
             problem.AddResidualBlock(smoothness_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter, wp_state_vector[i+2].parameter);
         }
@@ -253,8 +296,7 @@ namespace Ceresopt
         // 3 - Path length cost function --> Tries to minimize path length
         for (int i = 0; i < wp_state_vector.size() - 1; i++)
         {
-            ceres::CostFunction* path_length_function = new AutoDiffCostFunction<PathLengthFunctor, 1, 6, 6>
-                                                        (new PathLengthFunctor(weight_path_length));
+            ceres::CostFunction* path_length_function = pathLengthCost(weight_path_length, analytic_jacobians);
             problem.AddResidualBlock(path_length_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter);
         }
 
@@ -262,7 +304,11 @@ namespace Ceresopt
         // 4 - Distance to obstacles cost function --> Tries to maintain the biggest distance to obstacles possible
         for (int i = 0; i < wp_state_vector.size(); i++)
         {
-            ceres::CostFunction* esdf_function = new ObstacleDistanceCostFunctor(&_grid, weight_esdf);
+            ceres::CostFunction* esdf_function;
+            if(neural_esdf_callback)
+                esdf_function = new NeuralObstacleDistanceCostFunction(neural_esdf_callback.get(), wp_state_vector[i].parameter, weight_esdf);
+            else
+                esdf_function = new ObstacleDistanceCostFunctor(&_grid, weight_esdf);
             problem.AddResidualBlock(esdf_function, nullptr, wp_state_vector[i].parameter);
 
         }
@@ -271,8 +317,7 @@ namespace Ceresopt
         // 5 - Velocity module function --> Tries to maintain the desired velocity module
         for (int i = 0; i < wp_state_vector.size() - 1; i++)
         {
-            ceres::CostFunction* velocity_change_function = new AutoDiffCostFunction<VelocityChangeFunctor, 1, 6>
-                                                        (new VelocityChangeFunctor(weight_velocity_module, desired_vel));
+            ceres::CostFunction* velocity_change_function = velocityChangeCost(weight_velocity_module, desired_vel, analytic_jacobians);
             problem.AddResidualBlock(velocity_change_function, nullptr, wp_state_vector[i].parameter);
         }
 
@@ -280,8 +325,7 @@ namespace Ceresopt
 
         for (int i = 0; i < wp_state_vector.size() - 2; i++)
         {
-            ceres::CostFunction* min_acceleration_function = new AutoDiffCostFunction<MinAccelerationFunctor, 1, 6, 6>
-                                                        (new MinAccelerationFunctor(weight_min_acceleration));
+            ceres::CostFunction* min_acceleration_function = minAccelerationCost(weight_min_acceleration, analytic_jacobians);
             problem.AddResidualBlock(min_acceleration_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter);
         }
 
@@ -289,8 +333,7 @@ namespace Ceresopt
 
         for (int i = 0; i < wp_state_vector.size() - 2; i++)
         {
-            ceres::CostFunction* pos_vel_coherence_function = new AutoDiffCostFunction<PosVelCoherenceFunctor, 1, 6, 6>
-                                                        (new PosVelCoherenceFunctor(weight_pos_vel_coherence));
+            ceres::CostFunction* pos_vel_coherence_function = posVelCoherenceCost(weight_pos_vel_coherence, analytic_jacobians);
             problem.AddResidualBlock(pos_vel_coherence_function, nullptr, wp_state_vector[i].parameter, wp_state_vector[i+1].parameter);
         }
 
@@ -304,6 +347,12 @@ namespace Ceresopt
         options.minimizer_progress_to_stdout = true;
         options.max_num_iterations = 100;
         options.num_threads = 12;
+#if CERES_VERSION_MAJOR < 2
+        if(neural_esdf_callback){
+            options.evaluation_callback = neural_esdf_callback.get();
+            options.update_state_every_iteration = true;
+        }
+#endif
 
         std::cout << "Configured options" << std::endl;
         
@@ -355,4 +404,3 @@ namespace Ceresopt
         return optimized_path;
     }
 }
-
@@ -0,0 +1,123 @@
+#include "utils/CloudVoxelizer.hpp"
+
+#include <cmath>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Planners
+{
+    namespace utils
+    {
+        namespace
+        {
+            /**
+             * @brief Same rounding as std::round (half away from zero), without the call
+             */
+            inline int roundToInt(const float _value)
+            {
+                return static_cast<int>(_value + std::copysign(0.5f, _value));
+            }
+        }
+
+        void CloudVoxelizer::setTransform(const float *_rotation, const float *_translation)
+        {
+            for(int i = 0; i < 9; ++i)
+                rotation_[i] = _rotation != nullptr ? _rotation[i] : ( i % 4 == 0 ? 1.0f : 0.0f );
+            for(int i = 0; i < 3; ++i)
+                translation_[i] = _translation != nullptr ? _translation[i] : 0.0f;
+        }
+
+        void CloudVoxelizer::setCropBox(const float _min[3], const float _max[3], const double _resolution)
+        {
+            inv_resolution_ = static_cast<float>(1.0 / _resolution);
+            for(int i = 0; i < 3; ++i){
+                min_[i] = _min[i];
+                max_[i] = _max[i];
+            }
+            min_key_ = {roundToInt(min_[0] * inv_resolution_), roundToInt(min_[1] * inv_resolution_), roundToInt(min_[2] * inv_resolution_)};
+            box_cells_ = {roundToInt(max_[0] * inv_resolution_) - min_key_.x + 1,
+                          roundToInt(max_[1] * inv_resolution_) - min_key_.y + 1,
+                          roundToInt(max_[2] * inv_resolution_) - min_key_.z + 1};
+
+            const size_t n_cells = static_cast<size_t>(box_cells_.x) * box_cells_.y * box_cells_.z;
+            seen_.assign(( n_cells + 63 ) / 64, 0);
+        }
+
+        size_t CloudVoxelizer::voxelize(const uint8_t *_data, const size_t _width, const size_t _height, const size_t _row_step, const Layout &_layout, CoordinateList &_voxels)
+        {
+            const size_t first_voxel = _voxels.size();
+            size_t inside_points{0};
+            for(size_t row = 0; row < _height; ++row)
+                inside_points += voxelizeRow(_data + row * _row_step, _width, _layout, _voxels);
+
+            // Clear only the bits that were set, the box can be much larger than the scan
+            for(size_t j = first_voxel; j < _voxels.size(); ++j)
+                seen_[bitIndex(_voxels[j].x, _voxels[j].y, _voxels[j].z) >> 6] = 0;
+
+            return inside_points;
+        }
+
+        size_t CloudVoxelizer::voxelizeRow(const uint8_t *_data, const size_t _n_points, const Layout &_layout, CoordinateList &_voxels)
+        {
+            size_t inside_points{0};
+            size_t i{0};
+            const uint8_t *point = _data;
+
+#ifdef __SSE2__
+            // One unaligned 16 bytes load per point: x, y, z and the next field, ignored. The last points
+            // are left to the scalar loop if that load would read past the end of the buffer
+            const bool packed = _layout.y_offset == _layout.x_offset + 4 && _layout.z_offset == _layout.x_offset + 8;
+            if( packed ){
+                const __m128 column_x = _mm_setr_ps(rotation_[0], rotation_[3], rotation_[6], 0.0f);
+                const __m128 column_y = _mm_setr_ps(rotation_[1], rotation_[4], rotation_[7], 0.0f);
+                const __m128 column_z = _mm_setr_ps(rotation_[2], rotation_[5], rotation_[8], 0.0f);
+                const __m128 translation = _mm_setr_ps(translation_[0], translation_[1], translation_[2], 0.0f);
+                const __m128 min = _mm_setr_ps(min_[0], min_[1], min_[2], 0.0f);
+                const __m128 max = _mm_setr_ps(max_[0], max_[1], max_[2], 0.0f);
+                const __m128 inv_resolution = _mm_set1_ps(inv_resolution_);
+                const __m128 sign = _mm_set1_ps(-0.0f);
+                const __m128 half = _mm_set1_ps(0.5f);
+                alignas(16) int key[4];
+
+                point += _layout.x_offset;
+                for(; i < _n_points && ( _n_points - i ) * _layout.point_step >= _layout.x_offset + 16; ++i, point += _layout.point_step){
+                    const __m128 p = _mm_loadu_ps(reinterpret_cast<const float *>(point));
+                    const __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, 0x00), column_x),
+                                                           _mm_mul_ps(_mm_shuffle_ps(p, p, 0x55), column_y)),
+                                                _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, 0xAA), column_z), translation));
+                    // NaN fails both comparisons
+                    if( ( _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(t, min), _mm_cmple_ps(t, max))) & 0x7 ) != 0x7 )
+                        continue;
+                    ++inside_points;
+
+                    // Round half away from zero, as std::round
+                    const __m128 scaled = _mm_mul_ps(t, inv_resolution);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(key), _mm_cvttps_epi32(_mm_add_ps(scaled, _mm_or_ps(_mm_and_ps(scaled, sign), half))));
+                    addVoxel(key[0], key[1], key[2], _voxels);
+                }
+                point -= _layout.x_offset;
+            }
+#endif
+            for(; i < _n_points; ++i, point += _layout.point_step){
+                float x, y, z;
+                // memcpy because the buffer has no alignment guarantees
+                std::memcpy(&x, point + _layout.x_offset, sizeof(float));
+                std::memcpy(&y, point + _layout.y_offset, sizeof(float));
+                std::memcpy(&z, point + _layout.z_offset, sizeof(float));
+
+                const float tx = rotation_[0] * x + rotation_[1] * y + rotation_[2] * z + translation_[0];
+                const float ty = rotation_[3] * x + rotation_[4] * y + rotation_[5] * z + translation_[1];
+                const float tz = rotation_[6] * x + rotation_[7] * y + rotation_[8] * z + translation_[2];
+                if( !( ( tx >= min_[0] ) & ( tx <= max_[0] ) & ( ty >= min_[1] ) & ( ty <= max_[1] ) & ( tz >= min_[2] ) & ( tz <= max_[2] ) ) )
+                    continue;
+                ++inside_points;
+
+                addVoxel(roundToInt(tx * inv_resolution_), roundToInt(ty * inv_resolution_), roundToInt(tz * inv_resolution_), _voxels);
+            }
+
+            return inside_points;
+        }
+    }
+}
@@ -0,0 +1,327 @@
+#include "utils/LandmarkHeuristic.hpp"
+#include "utils/heuristic.hpp"
+
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+
+namespace Planners
+{
+    namespace
+    {
+        // Header of the landmarks file, followed by the landmark coordinates (3 int32 each) and the tables
+        struct LandmarkFileHeader
+        {
+            char magic[8];              // "GRIDALT"
+            uint32_t version;
+            uint32_t headerSize;
+            int32_t sizeX, sizeY, sizeZ;
+            int32_t use3d;
+            uint32_t nLandmarks;
+            uint32_t reserved;
+            uint64_t occupancyHash;
+        };
+
+        // Worst grid distance / euclidean distance ratio, rounded up:
+        // sqrt(1 + (sqrt(2) - 1)^2) in 2D and sqrt(1 + (sqrt(2) - 1)^2 + (sqrt(3) - sqrt(2))^2) in 3D
+        constexpr double any_angle_ratio_2d{1.0825};
+        constexpr double any_angle_ratio_3d{1.1282};
+    }
+
+    bool LandmarkHeuristic::compute(const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d, unsigned int _n_threads)
+    {
+        world_size_ = _world.getWorldSize();
+        use_3d_     = _use_3d;
+
+        const auto occupancy = occupancySnapshot(_world);
+        occupancy_hash_ = occupancyHash(occupancy);
+
+        selectLandmarks(occupancy, _n_landmarks);
+        const size_t n_landmarks = landmarks_.size();
+        if( n_landmarks == 0 ){
+            distances_.clear();
+            std::cout << "[ALT] No free cells to place landmarks" << std::endl;
+            return false;
+        }
+
+        const size_t n_cells = occupancy.size();
+        distances_.assign(n_cells * n_landmarks, unreachable_);
+
+        if( _n_threads == 0 )
+            _n_threads = std::max(1u, std::thread::hardware_concurrency());
+        _n_threads = std::min<unsigned int>(_n_threads, n_landmarks);
+
+        std::atomic<size_t> next_landmark{0};
+        auto worker = [&](){
+            std::vector<uint32_t> distances;
+            for(size_t l = next_landmark++; l < n_landmarks; l = next_landmark++){
+                dijkstra(occupancy, landmarks_[l], distances);
+                for(size_t i = 0; i < n_cells; ++i)
+                    distances_[i * n_landmarks + l] = distances[i];
+            }
+        };
+        std::vector<std::thread> threads;
+        for(unsigned int t = 1; t < _n_threads; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for(auto &thread: threads)
+            thread.join();
+
+        return true;
+    }
+
+    bool LandmarkHeuristic::save(const std::string &_file_path) const
+    {
+        LandmarkFileHeader header;
+        memset(&header, 0, sizeof(LandmarkFileHeader));
+        strncpy(header.magic, "GRIDALT", sizeof(header.magic));
+        header.version       = file_version_;
+        header.headerSize    = sizeof(LandmarkFileHeader);
+        header.sizeX         = world_size_.x;
+        header.sizeY         = world_size_.y;
+        header.sizeZ         = world_size_.z;
+        header.use3d         = use_3d_;
+        header.nLandmarks    = landmarks_.size();
+        header.occupancyHash = occupancy_hash_;
+
+        std::vector<int32_t> coordinates;
+        for(const auto &it: landmarks_){
+            coordinates.push_back(it.x);
+            coordinates.push_back(it.y);
+            coordinates.push_back(it.z);
+        }
+
+        std::string tmp_path = _file_path + ".tmp";
+        FILE *pf = fopen(tmp_path.c_str(), "wb");
+        if( pf == NULL ){
+            std::cout << "[ALT] Error opening file " << tmp_path << " for writing" << std::endl;
+            return false;
+        }
+        bool ok = fwrite(&header, sizeof(LandmarkFileHeader), 1, pf) == 1;
+        ok = ok && fwrite(coordinates.data(), sizeof(int32_t), coordinates.size(), pf) == coordinates.size();
+        ok = ok && fwrite(distances_.data(), sizeof(uint32_t), distances_.size(), pf) == distances_.size();
+        ok = (fclose(pf) == 0) && ok;
+        if( !ok || rename(tmp_path.c_str(), _file_path.c_str()) != 0 ){
+            std::cout << "[ALT] Error writing file " << _file_path << std::endl;
+            remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool LandmarkHeuristic::load(const std::string &_file_path, const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d)
+    {
+        FILE *pf = fopen(_file_path.c_str(), "rb");
+        if( pf == NULL )
+            return false;
+
+        const auto world_size = _world.getWorldSize();
+        const auto hash       = occupancyHash(occupancySnapshot(_world));
+
+        LandmarkFileHeader header;
+        if( fread(&header, sizeof(LandmarkFileHeader), 1, pf) != 1 ||
+            strncmp(header.magic, "GRIDALT", sizeof(header.magic)) != 0 || header.version != file_version_ ||
+            header.headerSize != sizeof(LandmarkFileHeader) ){
+            std::cout << "[ALT] Old or unknown landmarks file format, recomputing landmarks" << std::endl;
+            fclose(pf);
+            return false;
+        }
+        if( header.sizeX != world_size.x || header.sizeY != world_size.y || header.sizeZ != world_size.z ||
+            header.use3d != _use_3d || header.nLandmarks != _n_landmarks || header.occupancyHash != hash ){
+            std::cout << "[ALT] Stale landmarks file (map or parameters changed), recomputing landmarks" << std::endl;
+            fclose(pf);
+            return false;
+        }
+
+        const size_t n_cells = static_cast<size_t>(world_size.x) * world_size.y * world_size.z;
+        std::vector<int32_t> coordinates(3 * header.nLandmarks);
+        std::vector<uint32_t> distances(n_cells * header.nLandmarks);
+        bool ok = fread(coordinates.data(), sizeof(int32_t), coordinates.size(), pf) == coordinates.size() &&
+                  fread(distances.data(), sizeof(uint32_t), distances.size(), pf) == distances.size();
+        fclose(pf);
+        if( !ok ){
+            std::cout << "[ALT] Truncated landmarks file, recomputing landmarks" << std::endl;
+            return false;
+        }
+
+        world_size_     = world_size;
+        use_3d_         = _use_3d;
+        occupancy_hash_ = hash;
+        landmarks_.clear();
+        for(size_t i = 0; i < coordinates.size(); i += 3)
+            landmarks_.push_back({coordinates[i], coordinates[i + 1], coordinates[i + 2]});
+        distances_.swap(distances);
+
+        return true;
+    }
+
+    bool LandmarkHeuristic::matches(const DiscreteWorld &_world, const unsigned int _n_landmarks, const bool _use_3d) const
+    {
+        const auto world_size = _world.getWorldSize();
+        if( landmarks_.size() != _n_landmarks || use_3d_ != _use_3d ||
+            world_size.x != world_size_.x || world_size.y != world_size_.y || world_size.z != world_size_.z )
+            return false;
+
+        return occupancyHash(occupancySnapshot(_world)) == occupancy_hash_;
+    }
+
+    unsigned int LandmarkHeuristic::operator()(const Vec3i &_source, const Vec3i &_target) const
+    {
+        const auto euclidean     = Heuristic::euclidean(_source, _target);
+        const size_t n_landmarks = landmarks_.size();
+        if( n_landmarks == 0 )
+            return euclidean;
+
+        const uint32_t *source_distances = &distances_[cellIndex(_source) * n_landmarks];
+        const uint32_t *target_distances = &distances_[cellIndex(_target) * n_landmarks];
+
+        uint32_t bound{0};
+        for(size_t l = 0; l < n_landmarks; ++l){
+            // Not reachable from this landmark (other connected component): no information
+            if( source_distances[l] == unreachable_ || target_distances[l] == unreachable_ )
+                continue;
+
+            const uint32_t difference = source_distances[l] > target_distances[l] ? source_distances[l] - target_distances[l]
+                                                                                  : target_distances[l] - source_distances[l];
+            bound = std::max(bound, difference);
+        }
+
+        if( any_angle_ )
+            bound = static_cast<uint32_t>(bound / ( use_3d_ ? any_angle_ratio_3d : any_angle_ratio_2d ));
+
+        return std::max<unsigned int>(euclidean, bound);
+    }
+
+    std::vector<uint8_t> LandmarkHeuristic::occupancySnapshot(const DiscreteWorld &_world)
+    {
+        const auto world_size = _world.getWorldSize();
+        std::vector<uint8_t> occupancy(static_cast<size_t>(world_size.x) * world_size.y * world_size.z);
+
+        size_t index{0};
+        for(int z = 0; z < world_size.z; ++z)
+            for(int y = 0; y < world_size.y; ++y)
+                for(int x = 0; x < world_size.x; ++x)
+                    occupancy[index++] = _world.isOccupied(x, y, z);
+
+        return occupancy;
+    }
+
+    uint64_t LandmarkHeuristic::occupancyHash(const std::vector<uint8_t> &_occupancy)
+    {
+        uint64_t hash{14695981039346656037ULL};
+        for(const auto &it: _occupancy){
+            hash ^= it;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void LandmarkHeuristic::selectLandmarks(const std::vector<uint8_t> &_occupancy, const unsigned int _n_landmarks)
+    {
+        landmarks_.clear();
+
+        std::vector<size_t> free_cells;
+        for(size_t i = 0; i < _occupancy.size(); ++i)
+            if( !_occupancy[i] )
+                free_cells.push_back(i);
+
+        if( free_cells.empty() )
+            return;
+
+        auto coordinates = [this](const size_t _index) -> Vec3i {
+            const size_t xy_size = static_cast<size_t>(world_size_.x) * world_size_.y;
+            const int z = _index / xy_size;
+            const int y = ( _index % xy_size ) / world_size_.x;
+            const int x = _index % world_size_.x;
+            return {x, y, z};
+        };
+        auto squared_distance = [](const Vec3i &_a, const Vec3i &_b) -> int64_t {
+            const int64_t dx = _a.x - _b.x, dy = _a.y - _b.y, dz = _a.z - _b.z;
+            return dx * dx + dy * dy + dz * dz;
+        };
+
+        // Farthest point sampling: the first landmark is the free cell farthest from the center of
+        // the world, the next ones the free cell farthest from the landmarks already chosen
+        const Vec3i center{world_size_.x / 2, world_size_.y / 2, world_size_.z / 2};
+        std::vector<int64_t> min_distance(free_cells.size());
+        for(size_t i = 0; i < free_cells.size(); ++i)
+            min_distance[i] = -squared_distance(coordinates(free_cells[i]), center);
+
+        size_t farthest = std::min_element(min_distance.begin(), min_distance.end()) - min_distance.begin();
+        std::fill(min_distance.begin(), min_distance.end(), std::numeric_limits<int64_t>::max());
+
+        while( landmarks_.size() < _n_landmarks ){
+            const Vec3i landmark = coordinates(free_cells[farthest]);
+            landmarks_.push_back(landmark);
+
+            farthest = 0;
+            for(size_t i = 0; i < free_cells.size(); ++i){
+                min_distance[i] = std::min(min_distance[i], squared_distance(coordinates(free_cells[i]), landmark));
+                if( min_distance[i] > min_distance[farthest] )
+                    farthest = i;
+            }
+            // Every free cell is already a landmark
+            if( min_distance[farthest] == 0 )
+                break;
+        }
+    }
+
+    void LandmarkHeuristic::dijkstra(const std::vector<uint8_t> &_occupancy, const Vec3i &_landmark, std::vector<uint32_t> &_distances) const
+    {
+        struct Step { int dx, dy, dz; uint32_t cost; };
+        std::vector<Step> steps;
+        for(int dz = -1; dz <= 1; ++dz){
+            if( !use_3d_ && dz != 0 )
+                continue;
+            for(int dy = -1; dy <= 1; ++dy)
+                for(int dx = -1; dx <= 1; ++dx){
+                    const int n_axes = std::abs(dx) + std::abs(dy) + std::abs(dz);
+                    if( n_axes == 0 )
+                        continue;
+                    // Same step costs used by the search
+                    steps.push_back({dx, dy, dz, static_cast<uint32_t>(n_axes == 1 ? dist_scale_factor_ : ( n_axes == 2 ? dd_2D_ : dd_3D_ ))});
+                }
+        }
+
+        _distances.assign(_occupancy.size(), unreachable_);
+
+        using QueueEntry = std::pair<uint32_t, size_t>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+        const size_t xy_size = static_cast<size_t>(world_size_.x) * world_size_.y;
+        _distances[cellIndex(_landmark)] = 0;
+        queue.push({0, cellIndex(_landmark)});
+
+        while( !queue.empty() ){
+            const auto [distance, index] = queue.top();
+            queue.pop();
+            if( distance != _distances[index] )
+                continue;
+
+            const int z = index / xy_size;
+            const int y = ( index % xy_size ) / world_size_.x;
+            const int x = index % world_size_.x;
+
+            for(const auto &step: steps){
+                const Vec3i neighbour{x + step.dx, y + step.dy, z + step.dz};
+                if( neighbour.x < 0 || neighbour.y < 0 || neighbour.z < 0 ||
+                    neighbour.x >= world_size_.x || neighbour.y >= world_size_.y || neighbour.z >= world_size_.z )
+                    continue;
+
+                const size_t neighbour_index = cellIndex(neighbour);
+                if( _occupancy[neighbour_index] )
+                    continue;
+
+                const uint32_t neighbour_distance = distance + step.cost;
+                if( neighbour_distance < _distances[neighbour_index] ){
+                    _distances[neighbour_index] = neighbour_distance;
+                    queue.push({neighbour_distance, neighbour_index});
+                }
+            }
+        }
+    }
+
+}
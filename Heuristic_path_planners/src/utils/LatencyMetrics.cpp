@@ -0,0 +1,98 @@
+#include "utils/LatencyMetrics.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace Planners
+{
+    namespace utils
+    {
+        uint64_t LatencyHistogram::percentile(const double _percentile) const
+        {
+            const uint64_t total = count();
+            if( total == 0 )
+                return 0;
+
+            const double fraction = std::min(100.0, std::max(0.0, _percentile)) / 100.0;
+            const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+
+            uint64_t accumulated{0};
+            for(size_t i = 0; i < n_buckets_; ++i){
+                accumulated += counts_[i].load(std::memory_order_relaxed);
+                if( accumulated >= target )
+                    return std::min(bucketUpperBound(i), max());
+            }
+            return max();
+        }
+
+        double LatencyHistogram::mean() const
+        {
+            const uint64_t total = count();
+            return total == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / total;
+        }
+
+        void LatencyHistogram::reset()
+        {
+            for(auto &it: counts_)
+                it.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+            sum_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+        uint64_t LatencyHistogram::bucketUpperBound(const size_t _index)
+        {
+            if( _index < sub_buckets_ )
+                return _index;
+
+            const unsigned int shift = _index / sub_buckets_ - 1;
+            const uint64_t sub_bucket = sub_buckets_ + _index % sub_buckets_;
+            return ( ( sub_bucket + 1 ) << shift ) - 1;
+        }
+
+        const char* LatencyMetrics::stageName(const Stage _stage)
+        {
+            switch(_stage){
+                case MODEL_RELOAD: return "model_reload";
+                case COORDINATES:  return "coordinates";
+                case INFERENCE:    return "inference";
+                case WORLD_UPDATE: return "world_update";
+                case SEARCH:       return "search";
+                case OPTIMIZATION: return "optimization";
+                case TICK:         return "tick";
+                case PATH_TRANSPORT: return "path_transport";
+                case VOXELIZE:     return "voxelize";
+                case CLOUD_UPDATE: return "cloud_update";
+                default:           return "unknown";
+            }
+        }
+
+        bool LatencyMetrics::appendCsv(const std::string &_file_path, const double _stamp) const
+        {
+            const bool new_file = !std::ifstream(_file_path).good();
+            std::ofstream file(_file_path, std::ios::app);
+            if( !file.is_open() )
+                return false;
+
+            if( new_file )
+                file << "stamp,stage,count,mean_ms,p50_ms,p90_ms,p99_ms,p999_ms,max_ms\n";
+
+            file << std::fixed;
+            for(int i = 0; i < N_STAGES; ++i){
+                const auto &histogram = histograms_[i];
+                file << std::setprecision(3) << _stamp << ',' << stageName(static_cast<Stage>(i)) << ',' << histogram.count() << ','
+                     << histogram.mean() / 1e3 << ',' << histogram.percentile(50) / 1e3 << ',' << histogram.percentile(90) / 1e3 << ','
+                     << histogram.percentile(99) / 1e3 << ',' << histogram.percentile(99.9) / 1e3 << ',' << histogram.max() / 1e3 << '\n';
+            }
+            return true;
+        }
+
+        void LatencyMetrics::reset()
+        {
+            for(auto &it: histograms_)
+                it.reset();
+        }
+    }
+}
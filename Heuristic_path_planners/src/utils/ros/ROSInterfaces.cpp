@@ -110,13 +110,73 @@ namespace Planners
         bool configureWorldFromPointCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &_points, AlgorithmBase &_algorithm, const double &_resolution)
         {
 
+            CoordinateList collisions;
+            collisions.reserve(_points->size());
             for (auto &it : *_points)
-                _algorithm.addCollision(discretePoint(it, _resolution));
+                collisions.push_back(discretePoint(it, _resolution));
+
+            utils::Clock clock;
+            clock.tic();
+            _algorithm.addCollisions(collisions);
+            clock.toc();
+            ROS_DEBUG("Added %lu collisions to the discrete world in %.2f ms", collisions.size(), clock.getElapsedMillisecs());
 
             return true;
         }
 
-        bool configureWorldCosts(Grid3d &_grid, AlgorithmBase &_algorithm)
+        bool configureWorldFromPointCloud2(const sensor_msgs::PointCloud2 &_cloud, const tf::Transform &_transform, CloudVoxelizer &_voxelizer, AlgorithmBase &_algorithm, CoordinateList &_voxels, LatencyMetrics *_metrics)
+        {
+            CloudVoxelizer::Layout layout;
+            layout.point_step = _cloud.point_step;
+            int found{0};
+            for (const auto &it : _cloud.fields)
+            {
+                if (it.datatype != sensor_msgs::PointField::FLOAT32)
+                    continue;
+                if (it.name == "x") { layout.x_offset = it.offset; found |= 1; }
+                else if (it.name == "y") { layout.y_offset = it.offset; found |= 2; }
+                else if (it.name == "z") { layout.z_offset = it.offset; found |= 4; }
+            }
+            if (found != 7 || _cloud.is_bigendian)
+            {
+                ROS_ERROR("PointCloud2 without little endian float32 x, y, z fields");
+                return false;
+            }
+
+            const tf::Matrix3x3 &basis = _transform.getBasis();
+            const tf::Vector3 &origin = _transform.getOrigin();
+            float rotation[9], translation[3];
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                    rotation[i * 3 + j] = basis[i][j];
+                translation[i] = origin[i];
+            }
+            _voxelizer.setTransform(rotation, translation);
+
+            utils::Clock clock;
+            clock.tic();
+            _voxels.clear();
+            // All the rows in one call, so a voxel hit by several rows is added once
+            const size_t inside = _voxelizer.voxelize(_cloud.data.data(), _cloud.width, _cloud.height, _cloud.row_step, layout, _voxels);
+            clock.toc();
+            const double voxelize_us = clock.getElapsedMicroSeconds();
+
+            clock.tic();
+            _algorithm.addCollisions(_voxels);
+            clock.toc();
+            const double update_us = clock.getElapsedMicroSeconds();
+            if (_metrics != nullptr)
+            {
+                _metrics->record(LatencyMetrics::VOXELIZE, static_cast<uint64_t>(voxelize_us));
+                _metrics->record(LatencyMetrics::CLOUD_UPDATE, static_cast<uint64_t>(update_us));
+            }
+            ROS_DEBUG("Voxelized %u points (%lu inside) in %.2f ms, added %lu collisions in %.2f ms", _cloud.width * _cloud.height, inside, voxelize_us / 1000, _voxels.size(), update_us / 1000);
+
+            return true;
+        }
+
+        bool configureWorldCosts(Grid3d &_grid, AlgorithmBase &_algorithm, const double _far_field)
         {
 
             auto world_size = _algorithm.getWorldSize();
@@ -131,10 +191,12 @@ namespace Planners
                         //JAC: Precision
                         // auto cost = _grid.getCellCost(i * resolution, j * resolution, k * resolution);
                         float cost = _grid.getCellCost(i * resolution, j * resolution, k * resolution);
-                        // std::cout << "Cost: " << cost << std::endl;   
+                        if (_far_field > 0 && cost > _far_field)
+                            cost = _far_field;
+                        // Costs equal to the stored ones leave the sparse blocks untouched
                         _algorithm.configureCellCost({i, j, k}, cost);
-                }
                     }
+                }
             }
 
             return true;
@@ -145,6 +207,7 @@ namespace Planners
             // Computar el grid local
             _grid.computeLocalGrid(loaded_sdf, drone_x, drone_y, drone_z);
 
+            LatencyMetrics::ScopedTimer world_update_timer(_grid.getMetrics(), LatencyMetrics::WORLD_UPDATE);
             auto world_size = _algorithm.getWorldSize();
             std::cout << "World size: " << world_size << std::endl;
             auto resolution = _algorithm.getWorldResolution();
@@ -0,0 +1,27 @@
+#ifndef CERES_TEST_UTILS_HPP
+#define CERES_TEST_UTILS_HPP
+/**
+ * @file ceres_test_utils.hpp
+ * @brief Helpers shared by the trajectory constraint tests and the residuals benchmark
+ */
+#include <random>
+
+namespace ceres_test_utils
+{
+    /**
+     * @brief Random waypoint state: positions in cells around the local map, velocities in cells/s
+     *
+     * @param gen Random generator, so the sequence of states is reproducible
+     * @param state The 6 parameters of the waypoint, positions then velocities
+     */
+    inline void randomState(std::mt19937 &gen, double *state){
+        std::uniform_real_distribution<double> pos_dist(-15.0, 15.0);
+        std::uniform_real_distribution<double> vel_dist(-3.0, 3.0);
+        for (int k = 0; k < 3; ++k){
+            state[k] = pos_dist(gen);
+            state[k + 3] = vel_dist(gen);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef GRID3D_TEST_UTILS_HPP
+#define GRID3D_TEST_UTILS_HPP
+/**
+ * @file grid3d_test_utils.hpp
+ * @brief Helpers shared by the Grid3d tests and the grid computation benchmark
+ */
+#include <random>
+#include <string>
+
+#include "Grid3D/grid3d.hpp"
+
+namespace grid3d_test_utils
+{
+    /**
+     * @brief Grid3d whose map is a point cloud instead of an octomap file.
+     * The tests run without a map_path parameter, so the constructor does not find any octomap to load.
+     */
+    class Grid3dAccess: public Grid3d
+    {
+    public:
+        /**
+         * @brief Replaces the map by the cloud, which is already shifted to have (0,0,0) as min values
+         *
+         * @param _sizeX, _sizeY, _sizeZ Size of the grid in cells
+         */
+        void setCloud(const pcl::PointCloud<pcl::PointXYZ> &_cloud, int _sizeX, int _sizeY, int _sizeZ, float _resolution){
+            *m_cloud = _cloud;
+            m_resolution = _resolution;
+            m_oneDivRes = 1.0 / m_resolution;
+            // Half a cell more, so that the truncation in computeGrid gives the requested size
+            m_maxX = (_sizeX + 0.5) * m_resolution;
+            m_maxY = (_sizeY + 0.5) * m_resolution;
+            m_maxZ = (_sizeZ + 0.5) * m_resolution;
+            m_octomapHash = "cloud";
+        }
+
+        void compute(bool _useKdtree){
+            m_useKdtreeGrid = _useKdtree;
+            computeGrid();
+        }
+
+        bool save(std::string _path){ return saveGrid(_path); }
+        bool load(std::string _path){ return loadGrid(_path); }
+
+        const Planners::utils::gridCell *grid() const { return m_grid; }
+        int gridSize() const { return m_gridSize; }
+    };
+
+    /**
+     * @brief Random occupied octomap leaves of a grid: leaves of one cell, centered at (i+0.5)*res,
+     * and pruned leaves of 2x2x2 cells, centered on the grid lattice
+     *
+     * @param gen Random generator, so the cloud is reproducible
+     * @param occupancy Fraction of the cells covered by each kind of leaf
+     */
+    inline pcl::PointCloud<pcl::PointXYZ> randomCloud(std::mt19937 &gen, int _sizeX, int _sizeY, int _sizeZ,
+                                                      float _resolution, double _occupancy){
+        pcl::PointCloud<pcl::PointXYZ> cloud;
+        std::uniform_real_distribution<double> occupied(0.0, 1.0);
+        for (int z = 0; z < _sizeZ; ++z)
+            for (int y = 0; y < _sizeY; ++y)
+                for (int x = 0; x < _sizeX; ++x){
+                    if (occupied(gen) < _occupancy)
+                        cloud.points.emplace_back((x + 0.5f) * _resolution, (y + 0.5f) * _resolution, (z + 0.5f) * _resolution);
+                    if (x % 2 == 0 && y % 2 == 0 && z % 2 == 0 && occupied(gen) < _occupancy)
+                        cloud.points.emplace_back((x + 1) * _resolution, (y + 1) * _resolution, (z + 1) * _resolution);
+                }
+        cloud.width = cloud.points.size();
+        cloud.height = 1;
+        return cloud;
+    }
+}
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file test_ceres_jacobians.cpp
+ * @brief Checks the analytic jacobians of the trajectory constraints against the autodiff
+ * ones (taken as reference) and against finite differences (ceres::GradientChecker).
+ */
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/CeresOpt.hpp"
+#include "ceres_test_utils.hpp"
+
+namespace
+{
+    const int kNumSamples = 1000;
+    const double kMaxRelativeError = 1e-9;
+    const double kFiniteDifferenceThreshold = 1e-6;
+
+    // GradientChecker takes manifolds since Ceres 2.1 and local parameterizations before. 2.1 has both
+    // overloads, so the null pointer must be typed
+#if CERES_VERSION_MAJOR > 2 || (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 1)
+    typedef std::vector<const ceres::Manifold*> NoManifolds;
+#else
+    typedef std::vector<const ceres::LocalParameterization*> NoManifolds;
+#endif
+
+    double relativeError(double value, double reference){
+        return std::fabs(value - reference) / std::max(1.0, std::fabs(reference));
+    }
+
+    void expectSameJacobians(ceres::CostFunction *analytic_ptr, ceres::CostFunction *autodiff_ptr){
+        std::unique_ptr<ceres::CostFunction> analytic(analytic_ptr), autodiff(autodiff_ptr);
+        std::mt19937 gen(42);
+
+        const int num_blocks = analytic->parameter_block_sizes().size();
+        ASSERT_EQ(num_blocks, static_cast<int>(autodiff->parameter_block_sizes().size()));
+        std::vector<std::vector<double>> states(num_blocks, std::vector<double>(6));
+        std::vector<std::vector<double>> jac_analytic(num_blocks, std::vector<double>(6)), jac_autodiff(num_blocks, std::vector<double>(6));
+        std::vector<double*> parameters(num_blocks), jac_analytic_ptr(num_blocks), jac_autodiff_ptr(num_blocks);
+        for (int b = 0; b < num_blocks; ++b){
+            parameters[b] = states[b].data();
+            jac_analytic_ptr[b] = jac_analytic[b].data();
+            jac_autodiff_ptr[b] = jac_autodiff[b].data();
+        }
+
+        ceres::NumericDiffOptions numeric_diff_options;
+        ceres::GradientChecker gradient_checker(analytic.get(), static_cast<const NoManifolds*>(nullptr), numeric_diff_options);
+
+        for (int n = 0; n < kNumSamples; ++n){
+            for (int b = 0; b < num_blocks; ++b)
+                ceres_test_utils::randomState(gen, parameters[b]);
+
+            double r_analytic, r_autodiff;
+            ASSERT_TRUE(analytic->Evaluate(parameters.data(), &r_analytic, jac_analytic_ptr.data()));
+            ASSERT_TRUE(autodiff->Evaluate(parameters.data(), &r_autodiff, jac_autodiff_ptr.data()));
+
+            EXPECT_LE(relativeError(r_analytic, r_autodiff), kMaxRelativeError);
+            for (int b = 0; b < num_blocks; ++b)
+                for (int k = 0; k < 6; ++k)
+                    EXPECT_LE(relativeError(jac_analytic[b][k], jac_autodiff[b][k]), kMaxRelativeError)
+                        << "block " << b << ", parameter " << k;
+
+            ceres::GradientChecker::ProbeResults results;
+            EXPECT_TRUE(gradient_checker.Probe(parameters.data(), kFiniteDifferenceThreshold, &results)) << results.error_log;
+        }
+    }
+}
+
+TEST(CeresJacobiansTest, Equidistance){
+    expectSameJacobians(Ceresopt::equidistanceCost(1.0, true), Ceresopt::equidistanceCost(1.0, false));
+}
+
+TEST(CeresJacobiansTest, Smoothness){
+    expectSameJacobians(Ceresopt::smoothnessCost(1.0, true), Ceresopt::smoothnessCost(1.0, false));
+}
+
+TEST(CeresJacobiansTest, PathLength){
+    expectSameJacobians(Ceresopt::pathLengthCost(1.0, true), Ceresopt::pathLengthCost(1.0, false));
+}
+
+TEST(CeresJacobiansTest, VelocityChange){
+    expectSameJacobians(Ceresopt::velocityChangeCost(1.0, 0.5, true), Ceresopt::velocityChangeCost(1.0, 0.5, false));
+}
+
+TEST(CeresJacobiansTest, MinAcceleration){
+    expectSameJacobians(Ceresopt::minAccelerationCost(1.0, true), Ceresopt::minAccelerationCost(1.0, false));
+}
+
+TEST(CeresJacobiansTest, PosVelCoherence){
+    expectSameJacobians(Ceresopt::posVelCoherenceCost(1.0, true), Ceresopt::posVelCoherenceCost(1.0, false));
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_cloud_voxelizer.cpp
+ * @brief Checks that the voxels of a cloud are distinct across all its rows, as in the organized
+ * clouds of the multi-beam lidars, and that the row padding is skipped.
+ */
+#include <cstring>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/CloudVoxelizer.hpp"
+
+namespace
+{
+    const double kResolution = 0.2;
+
+    Planners::utils::CloudVoxelizer makeVoxelizer(){
+        Planners::utils::CloudVoxelizer voxelizer;
+        const float min[3] = {-10, -10, -10};
+        const float max[3] = {10, 10, 10};
+        voxelizer.setCropBox(min, max, kResolution);
+        return voxelizer;
+    }
+
+    // x, y, z and an intensity field per point, rows padded to _row_step bytes
+    std::vector<uint8_t> makeCloud(const std::vector<std::vector<float>> &_rows, const size_t _row_step){
+        std::vector<uint8_t> data(_row_step * _rows.size(), 0xFF);
+        for (size_t row = 0; row < _rows.size(); ++row)
+            std::memcpy(data.data() + row * _row_step, _rows[row].data(), _rows[row].size() * sizeof(float));
+        return data;
+    }
+
+    std::set<std::tuple<int, int, int>> toSet(const Planners::utils::CoordinateList &_voxels){
+        std::set<std::tuple<int, int, int>> voxels;
+        for (const auto &it : _voxels)
+            voxels.emplace(it.x, it.y, it.z);
+        return voxels;
+    }
+}
+
+TEST(CloudVoxelizerTest, RowsHittingTheSameVoxel){
+    Planners::utils::CloudVoxelizer voxelizer = makeVoxelizer();
+    Planners::utils::CloudVoxelizer::Layout layout;
+    layout.point_step = 16;
+
+    // 4 rows of 2 points, all of them in the voxel (5, 0, 0) but the last one of each row
+    const std::vector<float> row = {1.0, 0.0, 0.0, 0.0, 1.02, 0.01, 0.0, 0.0};
+    std::vector<std::vector<float>> rows(4, row);
+    rows[3][4] = 3.0;
+    const std::vector<uint8_t> data = makeCloud(rows, 32);
+
+    Planners::utils::CoordinateList voxels;
+    EXPECT_EQ(8u, voxelizer.voxelize(data.data(), 2, rows.size(), 32, layout, voxels));
+    ASSERT_EQ(2u, voxels.size());
+    EXPECT_EQ(toSet(voxels), (std::set<std::tuple<int, int, int>>{{5, 0, 0}, {15, 0, 0}}));
+
+    // The bitset is cleared for the next cloud
+    voxels.clear();
+    EXPECT_EQ(8u, voxelizer.voxelize(data.data(), 2, rows.size(), 32, layout, voxels));
+    EXPECT_EQ(2u, voxels.size());
+}
+
+TEST(CloudVoxelizerTest, SkipsRowPadding){
+    Planners::utils::CloudVoxelizer voxelizer = makeVoxelizer();
+    Planners::utils::CloudVoxelizer::Layout layout;
+    layout.point_step = 16;
+
+    // The padding after each row of 3 points is 0xFF bytes, NaN if read as a point
+    std::vector<std::vector<float>> rows;
+    for (int r = 0; r < 5; ++r){
+        std::vector<float> row;
+        for (int p = 0; p < 3; ++p)
+            row.insert(row.end(), {0.4f * p, 0.4f * r, -1.0f, 0.0f});
+        rows.push_back(row);
+    }
+    const std::vector<uint8_t> data = makeCloud(rows, 3 * 16 + 20);
+
+    Planners::utils::CoordinateList voxels;
+    EXPECT_EQ(15u, voxelizer.voxelize(data.data(), 3, rows.size(), 3 * 16 + 20, layout, voxels));
+
+    std::set<std::tuple<int, int, int>> expected;
+    for (int r = 0; r < 5; ++r)
+        for (int p = 0; p < 3; ++p)
+            expected.emplace(2 * p, 2 * r, -5);
+    EXPECT_EQ(expected.size(), voxels.size());
+    EXPECT_EQ(expected, toSet(voxels));
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
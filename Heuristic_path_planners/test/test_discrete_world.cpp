@@ -0,0 +1,118 @@
+/**
+ * @file test_discrete_world.cpp
+ * @brief Checks that the sparse block storage of DiscreteWorld gives the same occupancy as the dense
+ * vector of nodes once the world is cleaned, also with the unknown cells treated as occupied, and 
+ * that worlds sharing the map of a dense world see the same occupancy and costs.
+ */
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "utils/world.hpp"
+
+namespace
+{
+    // Not a multiple of the 8 cells of the sparse blocks
+    const Planners::utils::Vec3i kWorldSize{21, 18, 11};
+    const double kResolution = 0.2;
+
+    void configureWorld(Planners::utils::DiscreteWorld &_world, const bool _sparse, const bool _unknown_as_occupied){
+        _world.setSparse(_sparse);
+        _world.setUnknownAsOccupied(_unknown_as_occupied);
+        _world.resizeWorld(kWorldSize, kResolution);
+    }
+
+    Planners::utils::CoordinateList randomCells(const int _n, const unsigned int _seed){
+        std::mt19937 gen(_seed);
+        std::uniform_int_distribution<int> x(0, kWorldSize.x - 1), y(0, kWorldSize.y - 1), z(0, kWorldSize.z - 1);
+        Planners::utils::CoordinateList cells;
+        for (int i = 0; i < _n; ++i)
+            cells.push_back({x(gen), y(gen), z(gen)});
+        return cells;
+    }
+
+    // Both through the occupancy query and through the nodes the search uses
+    void expectSameOccupancy(Planners::utils::DiscreteWorld &_dense, Planners::utils::DiscreteWorld &_sparse){
+        for (int i = 0; i < kWorldSize.x; ++i)
+            for (int j = 0; j < kWorldSize.y; ++j)
+                for (int k = 0; k < kWorldSize.z; ++k){
+                    const Planners::utils::Vec3i cell{i, j, k};
+                    ASSERT_EQ(_dense.isOccupied(cell), _sparse.isOccupied(cell)) << cell;
+                    ASSERT_EQ(_dense.getNodePtr(cell)->occuppied, _sparse.getNodePtr(cell)->occuppied) << cell;
+                    ASSERT_EQ(_dense.isUnknown(cell), _sparse.isUnknown(cell)) << cell;
+                }
+    }
+}
+
+TEST(DiscreteWorldTest, CleanFreesEveryCell){
+    for (const bool unknown_as_occupied : {false, true}){
+        Planners::utils::DiscreteWorld dense, sparse;
+        configureWorld(dense, false, unknown_as_occupied);
+        configureWorld(sparse, true, unknown_as_occupied);
+
+        for (const auto &it : randomCells(200, 1)){
+            dense.setOccupied(it);
+            sparse.setOccupied(it);
+        }
+        // Some blocks get their nodes before the clean
+        sparse.getNodePtr({0, 0, 0});
+        sparse.getNodePtr(kWorldSize - Planners::utils::Vec3i{1, 1, 1});
+
+        dense.cleanWorld();
+        sparse.cleanWorld();
+        expectSameOccupancy(dense, sparse);
+        EXPECT_FALSE(sparse.isOccupied({kWorldSize.x - 1, 0, kWorldSize.z - 1}));
+
+        // And the next scan on top of the clean world
+        for (const auto &it : randomCells(200, 2)){
+            dense.setOccupied(it);
+            sparse.setOccupied(it);
+        }
+        expectSameOccupancy(dense, sparse);
+    }
+}
+
+TEST(DiscreteWorldTest, UnknownCellsBeforeClean){
+    Planners::utils::DiscreteWorld sparse;
+    configureWorld(sparse, true, true);
+    sparse.setUnoccupied({1, 1, 1});
+
+    EXPECT_FALSE(sparse.isOccupied({1, 1, 1}));
+    EXPECT_TRUE(sparse.isOccupied({2, 1, 1}));
+    EXPECT_TRUE(sparse.isUnknown({2, 1, 1}));
+    EXPECT_TRUE(sparse.isOccupied({20, 17, 10}));
+}
+
+TEST(DiscreteWorldTest, ShareDenseMap){
+    Planners::utils::DiscreteWorld dense;
+    dense.setDefaultCost(1.0);
+    configureWorld(dense, false, true);
+    for (const auto &it : randomCells(200, 3))
+        dense.setOccupied(it);
+    for (const auto &it : randomCells(100, 4))
+        dense.setNodeCost(it, 5.5);
+
+    // The first world converts the dense map, the second one shares its blocks
+    Planners::utils::DiscreteWorld first, second;
+    first.shareMap(dense);
+    second.shareMap(first);
+    for (auto *shared : {&first, &second}){
+        EXPECT_TRUE(shared->isSparse());
+        expectSameOccupancy(dense, *shared);
+        for (int i = 0; i < kWorldSize.x; ++i)
+            for (int j = 0; j < kWorldSize.y; ++j)
+                for (int k = 0; k < kWorldSize.z; ++k)
+                    ASSERT_EQ(dense.getNodePtr({i, j, k})->cost, shared->getNodePtr({i, j, k})->cost);
+        shared->resetWorld();
+    }
+
+    // Writing to a shared world does not change the map of the others
+    second.setOccupied({0, 0, 0});
+    second.setUnoccupied(randomCells(1, 3).front());
+    expectSameOccupancy(dense, first);
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_grid3d.cpp
+ * @brief Checks that the distance transform of Grid3d::computeGrid gives the same cells as the
+ * per-cell kdtree search on random clouds, and that a corrupted .gridm cache is not used.
+ */
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include "grid3d_test_utils.hpp"
+
+namespace
+{
+    const double kResolution = 0.2;
+
+    /**
+     * @brief Computes the grid of the cloud with both algorithms and compares the cells
+     */
+    void expectSameGrid(const pcl::PointCloud<pcl::PointXYZ> &_cloud, int _sizeX, int _sizeY, int _sizeZ){
+        grid3d_test_utils::Grid3dAccess kdtree, transform;
+        kdtree.setCloud(_cloud, _sizeX, _sizeY, _sizeZ, kResolution);
+        transform.setCloud(_cloud, _sizeX, _sizeY, _sizeZ, kResolution);
+        kdtree.compute(true);
+        transform.compute(false);
+
+        ASSERT_EQ(_sizeX * _sizeY * _sizeZ, kdtree.gridSize());
+        ASSERT_EQ(kdtree.gridSize(), transform.gridSize());
+        int different_dist{0}, different_prob{0};
+        for (int i = 0; i < kdtree.gridSize(); ++i){
+            different_dist += kdtree.grid()[i].dist != transform.grid()[i].dist;
+            different_prob += kdtree.grid()[i].prob != transform.grid()[i].prob;
+        }
+        EXPECT_EQ(0, different_dist);
+        EXPECT_EQ(0, different_prob);
+    }
+}
+
+TEST(Grid3dTest, DistanceTransformMatchesKdtree){
+    std::mt19937 gen(7);
+    for (double occupancy : {0.002, 0.02, 0.2}){
+        SCOPED_TRACE(occupancy);
+        expectSameGrid(grid3d_test_utils::randomCloud(gen, 23, 17, 11, kResolution, occupancy), 23, 17, 11);
+    }
+}
+
+TEST(Grid3dTest, DistanceTransformMatchesKdtreeWithOnePoint){
+    pcl::PointCloud<pcl::PointXYZ> cloud;
+    cloud.points.emplace_back(1.3f, 0.1f, 2.5f);
+    cloud.width = 1;
+    expectSameGrid(cloud, 12, 9, 15);
+}
+
+TEST(Grid3dTest, CorruptedCacheIsRecomputed){
+    std::mt19937 gen(11);
+    const auto cloud = grid3d_test_utils::randomCloud(gen, 16, 12, 8, kResolution, 0.02);
+    const std::string path = testing::TempDir() + "test_grid3d.gridm";
+
+    grid3d_test_utils::Grid3dAccess saved;
+    saved.setCloud(cloud, 16, 12, 8, kResolution);
+    saved.compute(false);
+    ASSERT_TRUE(saved.save(path));
+
+    // The cost parameters don't change the cells, the cache is still valid
+    grid3d_test_utils::Grid3dAccess loaded;
+    loaded.setCloud(cloud, 16, 12, 8, kResolution);
+    loaded.setCostParams(2.0, 1.0);
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(saved.gridSize(), loaded.gridSize());
+    for (int i = 0; i < saved.gridSize(); ++i)
+        ASSERT_EQ(saved.grid()[i].dist, loaded.grid()[i].dist);
+
+    // Flip a byte of the last cell, the payload hash is checked by default
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        char last = file.get();
+        file.seekp(-1, std::ios::end);
+        file.put(last ^ 0x40);
+    }
+    grid3d_test_utils::Grid3dAccess corrupted;
+    corrupted.setCloud(cloud, 16, 12, 8, kResolution);
+    EXPECT_FALSE(corrupted.load(path));
+    std::remove(path.c_str());
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    // Grid3d reads its parameters through a node handle. No master is needed, the defaults are used
+    ros::init(argc, argv, "test_grid3d", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,333 @@
+/**
+ * @file test_hierarchical_planner.cpp
+ * @brief Checks the HierarchicalPlanner (HPA*) against plain full-world searches, in 2D and 3D: the same
+ * queries are solved, also after changing the obstacles through the planner and directly through the
+ * AlgorithmBase, the incremental cluster updates give the same abstraction as a full build, and the
+ * corridor fallback. It also checks that searching several times on the same world, which only resets
+ * the nodes touched by each search, gives the same results as searching on a fresh world.
+ */
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Planners/AStar.hpp"
+#include "Planners/AStarM1.hpp"
+#include "Planners/ThetaStar.hpp"
+#include "Planners/LazyThetaStar.hpp"
+#include "Planners/LazyThetaStarM2.hpp"
+#include "Planners/HierarchicalPlanner.hpp"
+
+namespace
+{
+    using Planners::utils::Vec3i;
+    using Planners::utils::CoordinateList;
+    using Planners::utils::PlanResult;
+
+    const double kResolution = 0.2;
+
+    struct Scene
+    {
+        std::string name;
+        Vec3i size;
+        unsigned int cluster_size;
+        bool use_3d() const { return size.z > 1; }
+    };
+
+    // Cluster sizes that do not divide the world, so the last clusters are smaller
+    const std::vector<Scene> kScenes{{"2D", {70, 60, 1}, 8}, {"3D", {30, 28, 14}, 6}};
+
+    using AlgorithmFactory = std::function<Planners::AlgorithmBase*(bool)>;
+
+    template<class Algorithm>
+    AlgorithmFactory factory(){
+        return [](bool _use_3d){ return new Algorithm(_use_3d); };
+    }
+
+    // Random boxes, some of them long walls, and scattered cells
+    CoordinateList randomObstacles(const Scene &_scene, const unsigned int _seed){
+        std::mt19937 gen(_seed);
+        std::uniform_int_distribution<int> x(0, _scene.size.x - 1), y(0, _scene.size.y - 1), z(0, _scene.size.z - 1);
+        std::uniform_int_distribution<int> side(1, 4), wall(8, 24);
+        CoordinateList obstacles;
+        const int n_boxes = _scene.size.x * _scene.size.y / 80;
+        for (int i = 0; i < n_boxes; ++i){
+            const Vec3i origin{x(gen), y(gen), z(gen)};
+            Vec3i extent{side(gen), side(gen), _scene.use_3d() ? side(gen) : 1};
+            if (i % 4 == 0)
+                (i % 8 == 0 ? extent.x : extent.y) = wall(gen);
+            for (int k = origin.z; k < std::min(_scene.size.z, origin.z + extent.z); ++k)
+                for (int j = origin.y; j < std::min(_scene.size.y, origin.y + extent.y); ++j)
+                    for (int i2 = origin.x; i2 < std::min(_scene.size.x, origin.x + extent.x); ++i2)
+                        obstacles.push_back({i2, j, k});
+        }
+        for (int i = 0; i < n_boxes * 4; ++i)
+            obstacles.push_back({x(gen), y(gen), z(gen)});
+        return obstacles;
+    }
+
+    std::unique_ptr<Planners::AlgorithmBase> makeAlgorithm(const AlgorithmFactory &_factory, const Scene &_scene,
+                                                           const CoordinateList &_obstacles){
+        std::unique_ptr<Planners::AlgorithmBase> algorithm(_factory(_scene.use_3d()));
+        algorithm->setHeuristic(Planners::Heuristic::euclidean);
+        algorithm->setWorldSize(_scene.size, kResolution);
+        algorithm->addCollisions(_obstacles, false, 0);
+        // Costs for the cost-aware algorithms, the same in every world
+        for (int k = 0; k < _scene.size.z; ++k)
+            for (int j = 0; j < _scene.size.y; ++j)
+                for (int i = 0; i < _scene.size.x; ++i)
+                    algorithm->configureCellCost({i, j, k}, 1 + (i * 7 + j * 3 + k * 5) % 11);
+        return algorithm;
+    }
+
+    std::vector<std::pair<Vec3i, Vec3i>> randomQueries(Planners::AlgorithmBase &_algorithm, const Scene &_scene,
+                                                       const int _n, const unsigned int _seed){
+        std::mt19937 gen(_seed);
+        std::uniform_int_distribution<int> x(0, _scene.size.x - 1), y(0, _scene.size.y - 1), z(0, _scene.size.z - 1);
+        auto freeCell = [&](){
+            Vec3i cell;
+            do {
+                cell = {x(gen), y(gen), z(gen)};
+            } while (_algorithm.detectCollision(cell));
+            return cell;
+        };
+        std::vector<std::pair<Vec3i, Vec3i>> queries;
+        for (int i = 0; i < _n; ++i){
+            const Vec3i start = freeCell();
+            queries.push_back({start, freeCell()});
+        }
+        return queries;
+    }
+
+    PlanResult plan(Planners::AlgorithmBase &_algorithm, const Vec3i &_start, const Vec3i &_goal){
+        torch::jit::script::Module sdf;
+        PlanResult result;
+        _algorithm.findPath(_start, _goal, sdf, result);
+        return result;
+    }
+
+    PlanResult plan(Planners::HierarchicalPlanner &_planner, const Vec3i &_start, const Vec3i &_goal){
+        torch::jit::script::Module sdf;
+        PlanResult result;
+        _planner.findPath(_start, _goal, sdf, result);
+        return result;
+    }
+
+    // Vec3i::operator== is not const
+    bool sameCell(Vec3i _a, Vec3i _b){
+        return _a == _b;
+    }
+
+    bool samePath(const CoordinateList &_a, const CoordinateList &_b){
+        return _a.size() == _b.size() && std::equal(_a.begin(), _a.end(), _b.begin(), sameCell);
+    }
+
+    // A* path from the goal to the start through free adjacent cells
+    void expectValidPath(Planners::AlgorithmBase &_algorithm, const PlanResult &_result, const Vec3i &_start, const Vec3i &_goal){
+        ASSERT_FALSE(_result.path.empty());
+        EXPECT_TRUE(sameCell(_goal, _result.path.front())) << _result.path.front();
+        EXPECT_TRUE(sameCell(_start, _result.path.back())) << _result.path.back();
+        for (size_t i = 0; i < _result.path.size(); ++i){
+            ASSERT_FALSE(_algorithm.detectCollision(_result.path[i])) << _result.path[i];
+            if (i == 0)
+                continue;
+            const Vec3i step = _result.path[i] - _result.path[i - 1];
+            ASSERT_TRUE(std::abs(step.x) <= 1 && std::abs(step.y) <= 1 && std::abs(step.z) <= 1) << _result.path[i];
+        }
+    }
+
+    // HPA* is not optimal: the abstract path goes through one cell of each entrance
+    const double kMaxSuboptimality = 1.25;
+
+    void expectSameQueries(Planners::AlgorithmBase &_algorithm, Planners::HierarchicalPlanner &_planner, const Scene &_scene,
+                           const unsigned int _seed){
+        // Plain full search on a fresh copy of the current world
+        auto reference = makeAlgorithm(factory<Planners::AStar>(), _scene, _algorithm.getInnerWorld()->getOccupiedCoordinates());
+        for (const auto &query : randomQueries(_algorithm, _scene, 30, _seed)){
+            const auto full = plan(*reference, query.first, query.second);
+            const auto hierarchical = plan(_planner, query.first, query.second);
+            ASSERT_EQ(full.solved, hierarchical.solved) << query.first << " -> " << query.second;
+            if (!full.solved)
+                continue;
+            expectValidPath(_algorithm, hierarchical, query.first, query.second);
+            EXPECT_GE(hierarchical.g_final_node, full.g_final_node);
+            EXPECT_LE(hierarchical.g_final_node, kMaxSuboptimality * full.g_final_node) << query.first << " -> " << query.second;
+        }
+    }
+
+    // Same abstraction as a planner built from scratch on the same map: same abstract nodes and same paths
+    void expectSameAsFullBuild(Planners::AlgorithmBase &_algorithm, Planners::HierarchicalPlanner &_planner, const Scene &_scene,
+                               const unsigned int _seed){
+        auto algorithm = makeAlgorithm(factory<Planners::AStar>(), _scene, _algorithm.getInnerWorld()->getOccupiedCoordinates());
+        Planners::HierarchicalPlanner planner(*algorithm, _scene.use_3d(), _scene.cluster_size);
+        planner.build(2);
+        // Any pending update is done before the first query
+        const auto queries = randomQueries(_algorithm, _scene, 20, _seed);
+        plan(_planner, queries.front().first, queries.front().second);
+        EXPECT_EQ(planner.getAbstractNodes(), _planner.getAbstractNodes());
+        for (const auto &query : queries){
+            const auto built = plan(planner, query.first, query.second);
+            const auto updated = plan(_planner, query.first, query.second);
+            ASSERT_EQ(built.solved, updated.solved) << query.first << " -> " << query.second;
+            EXPECT_EQ(built.g_final_node, updated.g_final_node) << query.first << " -> " << query.second;
+            EXPECT_EQ(planner.getLastCorridorSize(), _planner.getLastCorridorSize());
+            EXPECT_EQ(planner.usedFallback(), _planner.usedFallback());
+        }
+    }
+
+    CoordinateList randomCells(const CoordinateList &_cells, const int _n, const unsigned int _seed){
+        std::mt19937 gen(_seed);
+        std::uniform_int_distribution<size_t> index(0, _cells.size() - 1);
+        CoordinateList cells;
+        for (int i = 0; i < _n; ++i)
+            cells.push_back(_cells[index(gen)]);
+        return cells;
+    }
+}
+
+TEST(HierarchicalPlannerTest, SolvesTheSameQueriesAsTheFullSearch){
+    for (const auto &scene : kScenes){
+        SCOPED_TRACE(scene.name);
+        auto algorithm = makeAlgorithm(factory<Planners::AStar>(), scene, randomObstacles(scene, 1));
+        Planners::HierarchicalPlanner planner(*algorithm, scene.use_3d(), scene.cluster_size);
+        planner.build(2);
+        EXPECT_GT(planner.getAbstractNodes(), 0u);
+        expectSameQueries(*algorithm, planner, scene, 2);
+    }
+}
+
+TEST(HierarchicalPlannerTest, ChangesThroughThePlannerUpdateTheDirtyClusters){
+    for (const auto &scene : kScenes){
+        SCOPED_TRACE(scene.name);
+        const auto obstacles = randomObstacles(scene, 3);
+        auto algorithm = makeAlgorithm(factory<Planners::AStar>(), scene, obstacles);
+        Planners::HierarchicalPlanner planner(*algorithm, scene.use_3d(), scene.cluster_size);
+        planner.build(2);
+
+        // Open some of the obstacles and add new ones
+        for (const auto &it : randomCells(obstacles, 60, 4))
+            planner.removeCollision(it);
+        planner.addCollisions(randomObstacles(scene, 5));
+        for (const auto &it : randomCells(randomObstacles(scene, 6), 20, 7))
+            planner.addCollision(it);
+
+        expectSameAsFullBuild(*algorithm, planner, scene, 8);
+        expectSameQueries(*algorithm, planner, scene, 9);
+    }
+}
+
+TEST(HierarchicalPlannerTest, ChangesThroughTheAlgorithmUpdateTheDirtyClusters){
+    for (const auto &scene : kScenes){
+        SCOPED_TRACE(scene.name);
+        const auto obstacles = randomObstacles(scene, 10);
+        auto algorithm = makeAlgorithm(factory<Planners::AStar>(), scene, obstacles);
+        Planners::HierarchicalPlanner planner(*algorithm, scene.use_3d(), scene.cluster_size);
+        planner.build(2);
+        // Queries before the changes, so the abstraction is used and then updated
+        expectSameQueries(*algorithm, planner, scene, 11);
+
+        // With inflation, the changes reach the cells around the obstacles
+        algorithm->setInflationConfig(true, 1);
+        for (const auto &it : randomCells(obstacles, 60, 12))
+            algorithm->removeCollision(it);
+        algorithm->addCollisions(randomCells(randomObstacles(scene, 13), 15, 14));
+        algorithm->addCollision(randomCells(randomObstacles(scene, 15), 1, 16).front());
+        algorithm->setInflationConfig(false, 0);
+
+        expectSameAsFullBuild(*algorithm, planner, scene, 17);
+        expectSameQueries(*algorithm, planner, scene, 18);
+    }
+}
+
+TEST(HierarchicalPlannerTest, FallsBackToTheFullSearchOutsideTheCorridor){
+    // 2x2 clusters of 4x4 cells. The clusters at (1, 0) and (0, 1) are blocked, so the only way from the
+    // first cluster to the last one is the diagonal step from (3, 3) to (4, 4), which is not an entrance
+    const Scene scene{"2D", {8, 8, 1}, 4};
+    CoordinateList obstacles;
+    for (int j = 0; j < 8; ++j)
+        for (int i = 0; i < 8; ++i)
+            if ((i < 4) != (j < 4))
+                obstacles.push_back({i, j, 0});
+    auto algorithm = makeAlgorithm(factory<Planners::AStar>(), scene, obstacles);
+    auto reference = makeAlgorithm(factory<Planners::AStar>(), scene, obstacles);
+    Planners::HierarchicalPlanner planner(*algorithm, false, scene.cluster_size);
+    planner.build(1);
+
+    const Vec3i start{1, 1, 0}, goal{6, 6, 0};
+    const auto full = plan(*reference, start, goal);
+    ASSERT_TRUE(full.solved);
+
+    auto result = plan(planner, start, goal);
+    EXPECT_TRUE(planner.usedFallback());
+    ASSERT_TRUE(result.solved);
+    EXPECT_EQ(full.g_final_node, result.g_final_node);
+    expectValidPath(*algorithm, result, start, goal);
+
+    // Inside a cluster the corridor is enough
+    result = plan(planner, start, {2, 3, 0});
+    EXPECT_TRUE(result.solved);
+    EXPECT_FALSE(planner.usedFallback());
+
+    planner.setFullWorldFallback(false);
+    result = plan(planner, start, goal);
+    EXPECT_FALSE(result.solved);
+    EXPECT_TRUE(result.path.empty());
+    EXPECT_FALSE(planner.usedFallback());
+}
+
+TEST(HierarchicalPlannerTest, ReleasesTheAlgorithm){
+    const Scene &scene = kScenes.front();
+    auto algorithm = makeAlgorithm(factory<Planners::AStar>(), scene, {});
+    {
+        Planners::HierarchicalPlanner planner(*algorithm, false, scene.cluster_size);
+        planner.build(1);
+    }
+    // No callback into the destroyed planner
+    algorithm->addCollision({1, 1, 0});
+    algorithm->removeCollision({1, 1, 0});
+
+    Planners::HierarchicalPlanner planner(*algorithm, false, scene.cluster_size);
+    planner.build(1);
+    EXPECT_TRUE(plan(planner, {0, 0, 0}, {scene.size.x - 1, scene.size.y - 1, 0}).solved);
+}
+
+TEST(HeuristicSearchTest, BackToBackSearchesMatchAFreshWorld){
+    const std::vector<std::pair<std::string, AlgorithmFactory>> algorithms{
+        {"astar", factory<Planners::AStar>()}, {"astarm1", factory<Planners::AStarM1>()},
+        {"thetastar", factory<Planners::ThetaStar>()}, {"lazythetastar", factory<Planners::LazyThetaStar>()},
+        {"lazythetastarm2", factory<Planners::LazyThetaStarM2>()}};
+
+    for (const auto &scene : kScenes){
+        const auto obstacles = randomObstacles(scene, 19);
+        for (const auto &it : algorithms){
+            SCOPED_TRACE(scene.name + " " + it.first);
+            auto algorithm = makeAlgorithm(it.second, scene, obstacles);
+            // Corridor-restricted searches in between leave their nodes reset too
+            Planners::HierarchicalPlanner planner(*algorithm, scene.use_3d(), scene.cluster_size);
+            planner.build(2);
+
+            const auto queries = randomQueries(*algorithm, scene, 8, 20);
+            for (size_t i = 0; i < queries.size(); ++i){
+                const auto &query = queries[i];
+                auto fresh = makeAlgorithm(it.second, scene, obstacles);
+                const auto expected = plan(*fresh, query.first, query.second);
+                const auto result = plan(*algorithm, query.first, query.second);
+                ASSERT_EQ(expected.solved, result.solved) << query.first << " -> " << query.second;
+                EXPECT_EQ(expected.g_final_node, result.g_final_node) << query.first << " -> " << query.second;
+                EXPECT_EQ(expected.explored_nodes, result.explored_nodes) << query.first << " -> " << query.second;
+                EXPECT_TRUE(samePath(expected.path, result.path)) << query.first << " -> " << query.second;
+
+                plan(planner, queries[(i + 1) % queries.size()].first, query.first);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_inflation.cpp
+ * @brief Checks the cells marked by AlgorithmBase::addCollisions in each inflation mode against the
+ * per-obstacle addCollision, also with 0 inflation steps.
+ */
+#include <memory>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Planners/AStar.hpp"
+
+namespace
+{
+    const Planners::utils::Vec3i kWorldSize{24, 20, 12};
+    const double kResolution = 0.2;
+
+    std::unique_ptr<Planners::AlgorithmBase> makeAlgorithm(const Planners::AlgorithmBase::InflationMode _mode){
+        std::unique_ptr<Planners::AlgorithmBase> algorithm(new Planners::AStar(true));
+        algorithm->setWorldSize(kWorldSize, kResolution);
+        algorithm->setInflationMode(_mode);
+        return algorithm;
+    }
+
+    Planners::utils::CoordinateList randomObstacles(){
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<int> x(0, kWorldSize.x - 1), y(0, kWorldSize.y - 1), z(0, kWorldSize.z - 1);
+        Planners::utils::CoordinateList obstacles;
+        for (int i = 0; i < 40; ++i)
+            obstacles.push_back({x(gen), y(gen), z(gen)});
+        return obstacles;
+    }
+
+    // Adds the obstacles one by one, as configureWorldFromPointCloud did before addCollisions
+    std::unique_ptr<Planners::AlgorithmBase> legacyWorld(const Planners::utils::CoordinateList &_obstacles, const unsigned int _steps){
+        auto algorithm = makeAlgorithm(Planners::AlgorithmBase::INFLATE_NODE_AS_CUBE);
+        for (const auto &it : _obstacles)
+            algorithm->addCollision(it, true, _steps);
+        return algorithm;
+    }
+
+    int countOccupied(Planners::AlgorithmBase &_algorithm){
+        int occupied = 0;
+        for (int i = 0; i < kWorldSize.x; ++i)
+            for (int j = 0; j < kWorldSize.y; ++j)
+                for (int k = 0; k < kWorldSize.z; ++k)
+                    occupied += _algorithm.getInnerWorld()->isOccupied(i, j, k);
+        return occupied;
+    }
+
+    void expectSameCells(Planners::AlgorithmBase &_a, Planners::AlgorithmBase &_b){
+        for (int i = 0; i < kWorldSize.x; ++i)
+            for (int j = 0; j < kWorldSize.y; ++j)
+                for (int k = 0; k < kWorldSize.z; ++k)
+                    ASSERT_EQ(_a.getInnerWorld()->isOccupied(i, j, k), _b.getInnerWorld()->isOccupied(i, j, k)) << Planners::utils::Vec3i{i, j, k};
+    }
+}
+
+TEST(InflationTest, CubeModesMatchAddCollision){
+    const auto obstacles = randomObstacles();
+    for (const unsigned int steps : {0u, 1u, 3u}){
+        auto legacy = legacyWorld(obstacles, steps);
+        for (const auto mode : {Planners::AlgorithmBase::INFLATE_NODE_AS_CUBE, Planners::AlgorithmBase::INFLATE_DT_CUBE}){
+            auto algorithm = makeAlgorithm(mode);
+            algorithm->addCollisions(obstacles, true, steps);
+            expectSameCells(*legacy, *algorithm);
+        }
+    }
+}
+
+TEST(InflationTest, ZeroStepsMarkNothingButTheSpheres){
+    const auto obstacles = randomObstacles();
+    auto legacy = legacyWorld(obstacles, 0);
+    EXPECT_EQ(0, countOccupied(*legacy));
+
+    auto algorithm = makeAlgorithm(Planners::AlgorithmBase::INFLATE_DT_SPHERE);
+    algorithm->addCollisions(obstacles, true, 0);
+    auto raw = makeAlgorithm(Planners::AlgorithmBase::INFLATE_NODE_AS_CUBE);
+    raw->addCollisions(obstacles, false, 0);
+    expectSameCells(*raw, *algorithm);
+    EXPECT_GT(countOccupied(*algorithm), 0);
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
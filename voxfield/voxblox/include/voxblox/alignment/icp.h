@@ -48,7 +48,6 @@
 #include "voxblox/core/common.h"
 #include "voxblox/core/layer.h"
 #include "voxblox/integrator/integrator_utils.h"
-#include "voxblox/interpolator/interpolator.h"
 #include "voxblox/utils/approx_hash_array.h"
 
 namespace voxblox {
@@ -103,6 +102,21 @@ class ICP {
      */
     FloatingPoint inital_rotation_weighting = 100.0;
     size_t num_threads = std::thread::hardware_concurrency();
+    /**
+     * Maximum number of passes over the points. Each pass matches the points
+     * against the transform refined by the previous ones and fuses its mini
+     * batches with all the information gathered so far.
+     */
+    int max_iterations = 1;
+    /// Stop once a pass moves the sensor by less than these.
+    FloatingPoint min_delta_translation_m = 0.001;
+    FloatingPoint min_delta_rotation_rad = 0.001;
+    /**
+     * Stop once the information a pass adds is less than this ratio of all the
+     * information gathered so far, in each of the 6 dofs. Further passes
+     * would move the sensor by at most about this ratio of their alignment.
+     */
+    FloatingPoint min_information_gain = 0.05;
   };
 
   /**
@@ -112,7 +126,8 @@ class ICP {
   explicit ICP(const Config& config);
 
   /**
-   * Runs the ICP method to align the points with the tsdf_layer.
+   * Runs the ICP method to align the points with the tsdf_layer. Passes over
+   * the points until the refinement converges or max_iterations is reached.
    * @return the number of mini batches that were successful.
    */
   size_t runICP(
@@ -126,6 +141,11 @@ class ICP {
     return config_.refine_roll_pitch;
   }
 
+  /// Number of passes over the points of the last runICP call.
+  int getNumIterations() const {
+    return num_iterations_;
+  }
+
  private:
   typedef Transformation::Vector6 Vector6;
 
@@ -199,7 +219,21 @@ class ICP {
       const Point& point, const Point& normalized_point_normal,
       Vector6* info_vector);
 
-  /// Generates a set of matching points from a pointcloud and tsdf layer.
+  /**
+   * Gets the voxel at a global voxel index, from the given block if it holds
+   * it and from the layer otherwise.
+   * @return nullptr if the voxel is not observed.
+   */
+  const TsdfVoxel* getObservedVoxel(
+      const GlobalIndex& global_voxel_idx, const BlockIndex& block_idx,
+      const Block<TsdfVoxel>& block) const;
+
+  /**
+   * Generates a set of matching points from a pointcloud and tsdf layer. The
+   * mini batch is matched as one packet: the nearest distances of each point
+   * and of its 6 neighbors are gathered from the block of the point, then the
+   * gradients and targets of all the points are computed at once.
+   */
   void matchPoints(
       const Pointcloud& points, const size_t start_idx,
       const Transformation& T_tsdf_sensor, PointsMatrix* src, PointsMatrix* tgt,
@@ -227,9 +261,13 @@ class ICP {
   std::atomic<size_t> atomic_idx_;
   std::mutex mutex_;
 
+  int num_iterations_ = 0;
+
+  const Layer<TsdfVoxel>* tsdf_layer_ = nullptr;
   FloatingPoint voxel_size_;
   FloatingPoint voxel_size_inv_;
-  std::shared_ptr<Interpolator<TsdfVoxel>> interpolator_;
+  size_t voxels_per_side_;
+  FloatingPoint voxels_per_side_inv_;
 };
 
 }  // namespace voxblox
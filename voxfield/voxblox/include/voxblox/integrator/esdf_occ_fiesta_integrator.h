@@ -71,6 +71,14 @@ class EsdfOccFiestaIntegrator {
 
   void updateFromOccBlocks(const BlockIndexList& occ_blocks);
 
+  // Same as updateFromOccBlocks, but only initializes the given voxels
+  // (e.g. the changed list of the occupancy integrator) instead of all the
+  // voxels of their blocks. Load the insert and delete lists before. With
+  // clear_updated_flag, the flags of all the updated occupancy blocks are
+  // cleared, as in updateFromOccLayer; an empty list only clears them.
+  void updateFromOccVoxels(
+      const GlobalIndexList& occ_voxels, bool clear_updated_flag);
+
   /**
    * In FIESTA we set a range for the ESDF update.
    * This range is expanded from the bounding box of the TSDF voxels
@@ -122,6 +130,11 @@ class EsdfOccFiestaIntegrator {
   }
 
  protected:
+  // Initialize the ESDF voxel of an observed occupancy voxel
+  void initializeVoxel(
+      const OccupancyVoxel& occ_voxel, const BlockIndex& block_index,
+      const VoxelIndex& voxel_index, EsdfVoxel* esdf_voxel) const;
+
   Config config_;
 
   // Involved map layers (From Occupancy map to ESDF)
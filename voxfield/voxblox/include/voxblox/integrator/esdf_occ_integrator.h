@@ -49,6 +49,17 @@ class EsdfOccIntegrator {
   void updateFromOccLayerBatch();
   void updateFromOccBlocks(const BlockIndexList& occ_blocks);
 
+  /**
+   * Updates only the given voxels, e.g. the changed list of the
+   * OccupancyIntegrator, without rescanning their blocks. Newly occupied
+   * voxels and newly observed free ones lower the distances around them. As
+   * there is no raise set, a voxel that became free falls back to a batch
+   * update. With clear_updated_flag, the flags of all the updated occupancy
+   * blocks are cleared.
+   */
+  void updateFromOccVoxels(
+      const GlobalIndexList& occ_voxels, bool clear_updated_flag);
+
   void processOpenSet();
 
   /**
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -129,8 +130,17 @@ class RayCaster {
   bool nextRayIndex(GlobalIndex* ray_index);
 
  private:
+  friend class PacketRayCaster;
+
   void setupRayCaster(const Point& start_scaled, const Point& end_scaled);
 
+  /// Indices that nextRayIndex will still return.
+  inline size_t numRemainingIndices() const {
+    return current_step_ > ray_length_in_steps_
+               ? 0u
+               : ray_length_in_steps_ - current_step_ + 1u;
+  }
+
   Ray t_to_next_boundary_;
   GlobalIndex curr_index_;
   AnyIndex ray_step_signs_;
@@ -140,6 +150,88 @@ class RayCaster {
   uint current_step_;
 };
 
+/**
+ * Casts a batch of rays kPacketSize at a time, one ray per SIMD lane (AVX2 if
+ * the compiler targets it, a loop over the lanes otherwise). A lane takes the
+ * next ray of the batch as soon as its ray ends. The rays are set up by
+ * RayCaster and each one returns exactly the indices of
+ * RayCaster::nextRayIndex, in the same order, into a buffer that is reused
+ * between batches.
+ */
+class PacketRayCaster {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Rays traversed together.
+  static constexpr size_t kPacketSize = 8u;
+  /// Rays the integrators cast per batch.
+  static constexpr size_t kBatchSize = 256u;
+
+  PacketRayCaster() {
+    clear();
+  }
+
+  /// Adds the ray to the batch, from the index it would return next.
+  void addRay(const RayCaster& ray_caster) {
+    rays_.push_back(ray_caster);
+  }
+
+  size_t numRays() const {
+    return rays_.size();
+  }
+
+  /// Removes the rays of the batch and their indices.
+  void clear() {
+    rays_.clear();
+    indices_.clear();
+    ray_offsets_.assign(1u, 0u);
+  }
+
+  /// Casts all the rays added since the last clear.
+  void castRays();
+
+  /// Indices of the ray-th ray added to the batch, valid after castRays.
+  const GlobalIndex* rayBegin(const size_t ray) const {
+    DCHECK_LT(ray + 1u, ray_offsets_.size());
+    return indices_.data() + ray_offsets_[ray];
+  }
+  const GlobalIndex* rayEnd(const size_t ray) const {
+    DCHECK_LT(ray + 1u, ray_offsets_.size());
+    return indices_.data() + ray_offsets_[ray + 1u];
+  }
+
+ private:
+  /// State of the rays in the lanes, one array per component.
+  struct Lanes {
+    alignas(32) float t_to_next_boundary[3][kPacketSize];
+    alignas(32) float t_step_size[3][kPacketSize];
+    alignas(32) int32_t curr_index[3][kPacketSize];
+    alignas(32) int32_t ray_step_signs[3][kPacketSize];
+    /// Where the next index of the ray goes, spare_index for idle lanes.
+    GlobalIndex* next_index[kPacketSize];
+    /// 1 if the lane has a ray, 0 if it is idle.
+    size_t advance[kPacketSize];
+    /// Indices of the ray still to return.
+    size_t remaining[kPacketSize];
+    GlobalIndex spare_index;
+  };
+
+  /**
+   * Loads the next ray of the batch with indices in the lane. Rays whose
+   * indices might not fit in 32 bits are cast by RayCaster instead. Returns
+   * false, leaving the lane idle, if there are no rays left.
+   */
+  bool loadNextRay(const size_t lane, size_t* next_ray, Lanes* lanes);
+
+  /// One step of all the lanes, the same as RayCaster::nextRayIndex.
+  static void stepLanes(Lanes* lanes);
+
+  AlignedVector<RayCaster> rays_;
+  GlobalIndexVector indices_;
+  /// The indices of the ray-th ray start at ray_offsets_[ray].
+  std::vector<size_t> ray_offsets_;
+};
+
 /**
  * This function assumes PRE-SCALED coordinates, where one unit = one voxel
  * size. The indices are also returned in this scales coordinate system, which
@@ -2,6 +2,8 @@
 #define VOXBLOX_INTEGRATOR_MERGE_INTEGRATION_H_
 
 #include <algorithm>
+#include <list>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -10,11 +12,14 @@
 #include "voxblox/core/common.h"
 #include "voxblox/core/layer.h"
 #include "voxblox/core/voxel.h"
+#include "voxblox/integrator/integrator_utils.h"
 #include "voxblox/interpolator/interpolator.h"
 
 namespace voxblox {
 
 static const FloatingPoint kUnitCubeDiagonalLength = std::sqrt(3.0);
+/// Largest error, in voxels, of a translation that is copied voxel by voxel.
+static const FloatingPoint kVoxelAlignedTranslationTolerance = 1e-3;
 
 /// Merges layers, when the voxel or block size differs resampling occurs.
 template <typename VoxelType>
@@ -79,9 +84,175 @@ void mergeLayerAintoLayerB(
  */
 template <typename VoxelType>
 void resampleLayer(
-    const Layer<VoxelType>& layer_in, Layer<VoxelType>* layer_out) {
+    const Layer<VoxelType>& layer_in, Layer<VoxelType>* layer_out,
+    size_t num_threads = std::thread::hardware_concurrency()) {
   CHECK_NOTNULL(layer_out);
-  transformLayer(layer_in, Transformation(), layer_out);
+  transformLayer(layer_in, Transformation(), layer_out, num_threads);
+}
+
+/**
+ * Calls block_function on every block of the list, from num_threads threads
+ * that take the blocks from a ThreadSafeIndex. The blocks must be allocated
+ * beforehand, the threads only write to the blocks they are given.
+ */
+template <typename BlockPtrList, typename BlockFunction>
+void processBlocksInParallel(
+    const BlockPtrList& blocks, size_t num_threads,
+    const BlockFunction& block_function) {
+  num_threads = std::max<size_t>(1u, std::min(num_threads, blocks.size()));
+  MixedThreadSafeIndex index_getter(blocks.size());
+  auto process_blocks = [&blocks, &block_function, &index_getter]() {
+    size_t list_idx;
+    while (index_getter.getNextIndex(&list_idx)) {
+      block_function(blocks[list_idx].get());
+    }
+  };
+
+  std::list<std::thread> threads;
+  for (size_t i = 1u; i < num_threads; ++i) {
+    threads.emplace_back(process_blocks);
+  }
+  process_blocks();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * Allocates the blocks of the set in the layer, before they are filled in
+ * parallel.
+ */
+template <typename VoxelType>
+std::vector<typename Block<VoxelType>::Ptr> allocateBlocks(
+    const IndexSet& block_idx_set, Layer<VoxelType>* layer) {
+  CHECK_NOTNULL(layer);
+  std::vector<typename Block<VoxelType>::Ptr> blocks;
+  blocks.reserve(block_idx_set.size());
+  for (const BlockIndex& block_idx : block_idx_set) {
+    blocks.push_back(layer->allocateBlockPtrByIndex(block_idx));
+  }
+  return blocks;
+}
+
+/// Removes the blocks of the list that were not given any data.
+template <typename BlockPtrList, typename VoxelType>
+void removeBlocksWithoutData(
+    const BlockPtrList& blocks, Layer<VoxelType>* layer) {
+  CHECK_NOTNULL(layer);
+  for (const typename Block<VoxelType>::Ptr& block : blocks) {
+    if (!block->has_data()) {
+      layer->removeBlock(block->block_index());
+    }
+  }
+}
+
+/**
+ * True if both layers have the same voxel size and T_out_in is a translation
+ * by a whole number of voxels, which is returned in voxel_offset.
+ */
+template <typename VoxelType>
+bool isVoxelAlignedTranslation(
+    const Layer<VoxelType>& layer_in, const Transformation& T_out_in,
+    const Layer<VoxelType>& layer_out, GlobalIndex* voxel_offset) {
+  CHECK_NOTNULL(voxel_offset);
+  if (layer_in.voxel_size() != layer_out.voxel_size()) {
+    return false;
+  }
+  if (!T_out_in.getRotationMatrix().isIdentity(kEpsilon)) {
+    return false;
+  }
+  const Point offset = T_out_in.getPosition() * layer_in.voxel_size_inv();
+  const Point rounded_offset = offset.array().round();
+  if ((offset - rounded_offset).cwiseAbs().maxCoeff() >
+      kVoxelAlignedTranslationTolerance) {
+    return false;
+  }
+  *voxel_offset = rounded_offset.cast<LongIndexElement>();
+  return true;
+}
+
+/**
+ * Copies every voxel of layer_in to layer_out, voxel_offset voxels away,
+ * without interpolation. The block sizes of the layers may differ, the voxel
+ * sizes must be the same.
+ */
+template <typename VoxelType>
+void copyLayerWithVoxelOffset(
+    const Layer<VoxelType>& layer_in, const GlobalIndex& voxel_offset,
+    Layer<VoxelType>* layer_out,
+    size_t num_threads = std::thread::hardware_concurrency()) {
+  CHECK_NOTNULL(layer_out);
+  CHECK_EQ(layer_in.voxel_size(), layer_out->voxel_size());
+  const IndexElement voxels_per_side_in = layer_in.voxels_per_side();
+  const IndexElement voxels_per_side_out = layer_out->voxels_per_side();
+
+  // The output blocks covered by each input block once it is moved.
+  IndexSet block_idx_set;
+  BlockIndexList block_idx_list_in;
+  layer_in.getAllAllocatedBlocks(&block_idx_list_in);
+  for (const BlockIndex& block_idx : block_idx_list_in) {
+    const GlobalIndex min_voxel_idx = getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                                          block_idx, VoxelIndex::Zero(),
+                                          voxels_per_side_in) +
+                                      voxel_offset;
+    const BlockIndex min_block_idx = getBlockIndexFromGlobalVoxelIndex(
+        min_voxel_idx, layer_out->voxels_per_side_inv());
+    const BlockIndex max_block_idx = getBlockIndexFromGlobalVoxelIndex(
+        min_voxel_idx + GlobalIndex::Constant(voxels_per_side_in - 1),
+        layer_out->voxels_per_side_inv());
+    BlockIndex block_idx_out;
+    for (block_idx_out.x() = min_block_idx.x();
+         block_idx_out.x() <= max_block_idx.x(); ++block_idx_out.x()) {
+      for (block_idx_out.y() = min_block_idx.y();
+           block_idx_out.y() <= max_block_idx.y(); ++block_idx_out.y()) {
+        for (block_idx_out.z() = min_block_idx.z();
+             block_idx_out.z() <= max_block_idx.z(); ++block_idx_out.z()) {
+          block_idx_set.insert(block_idx_out);
+        }
+      }
+    }
+  }
+
+  const std::vector<typename Block<VoxelType>::Ptr> blocks_out =
+      allocateBlocks(block_idx_set, layer_out);
+
+  processBlocksInParallel(
+      blocks_out, num_threads, [&](Block<VoxelType>* block_out) {
+        typename Block<VoxelType>::ConstPtr block_in;
+        BlockIndex block_idx_in;
+        for (size_t linear_idx = 0u; linear_idx < block_out->num_voxels();
+             ++linear_idx) {
+          const GlobalIndex voxel_idx_in =
+              getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                  block_out->block_index(),
+                  block_out->computeVoxelIndexFromLinearIndex(linear_idx),
+                  voxels_per_side_out) -
+              voxel_offset;
+          const BlockIndex current_block_idx_in =
+              getBlockIndexFromGlobalVoxelIndex(
+                  voxel_idx_in, layer_in.voxels_per_side_inv());
+          if (linear_idx == 0u || current_block_idx_in != block_idx_in) {
+            block_idx_in = current_block_idx_in;
+            block_in = layer_in.getBlockPtrByIndex(block_idx_in);
+          }
+          if (block_in == nullptr) {
+            continue;
+          }
+
+          const VoxelIndex local_voxel_idx_in =
+              (voxel_idx_in - block_idx_in.cast<LongIndexElement>() *
+                                  voxels_per_side_in)
+                  .cast<IndexElement>();
+          const VoxelType& voxel_in =
+              block_in->getVoxelByVoxelIndex(local_voxel_idx_in);
+          block_out->getVoxelByLinearIndex(linear_idx) = voxel_in;
+          if (utils::isObservedVoxel(voxel_in)) {
+            block_out->has_data() = true;
+          }
+        }
+      });
+
+  removeBlocksWithoutData(blocks_out, layer_out);
 }
 
 /**
@@ -139,14 +310,25 @@ void naiveTransformLayer(
 /**
  * Performs a 3D transform on the input layer and writes the results to the
  * output layer. During the transformation resampling occurs so that the voxel
- * and block size of the input and output layer can differ.
+ * and block size of the input and output layer can differ. The output blocks
+ * are allocated first and then interpolated by num_threads threads. A
+ * translation by a whole number of voxels between layers of the same voxel
+ * size copies the voxels instead, see copyLayerWithVoxelOffset.
  */
 template <typename VoxelType>
 void transformLayer(
     const Layer<VoxelType>& layer_in, const Transformation& T_out_in,
-    Layer<VoxelType>* layer_out) {
+    Layer<VoxelType>* layer_out,
+    size_t num_threads = std::thread::hardware_concurrency()) {
   CHECK_NOTNULL(layer_out);
 
+  GlobalIndex voxel_offset;
+  if (isVoxelAlignedTranslation(
+          layer_in, T_out_in, *layer_out, &voxel_offset)) {
+    copyLayerWithVoxelOffset(layer_in, voxel_offset, layer_out, num_threads);
+    return;
+  }
+
   // first mark all the blocks in the output layer that may be filled by the
   // input layer (we are conservative here approximating the input blocks as
   // spheres of diameter sqrt(3)*block_size)
@@ -182,6 +364,10 @@ void transformLayer(
     }
   }
 
+  // The layer is only modified here, the threads below just fill the blocks.
+  const std::vector<typename Block<VoxelType>::Ptr> blocks_out =
+      allocateBlocks(block_idx_set, layer_out);
+
   // get inverse transform
   const Transformation T_in_out = T_out_in.inverse();
 
@@ -189,33 +375,29 @@ void transformLayer(
 
   // we now go through all the blocks in the output layer and interpolate the
   // input layer at the center of each output voxel position
-  for (const BlockIndex& block_idx : block_idx_set) {
-    typename Block<VoxelType>::Ptr block =
-        layer_out->allocateBlockPtrByIndex(block_idx);
-
-    for (IndexElement voxel_idx = 0;
-         voxel_idx < static_cast<IndexElement>(block->num_voxels());
-         ++voxel_idx) {
-      VoxelType& voxel = block->getVoxelByLinearIndex(voxel_idx);
-
-      // find voxel centers location in the input
-      const Point voxel_center =
-          T_in_out * block->computeCoordinatesFromLinearIndex(voxel_idx);
-
-      // interpolate voxel
-      if (interpolator.getVoxel(voxel_center, &voxel, true)) {
-        block->has_data() = true;
-
-        // if interpolated value fails use nearest
-      } else if (interpolator.getVoxel(voxel_center, &voxel, false)) {
-        block->has_data() = true;
-      }
-    }
+  processBlocksInParallel(
+      blocks_out, num_threads, [&](Block<VoxelType>* block) {
+        for (IndexElement voxel_idx = 0;
+             voxel_idx < static_cast<IndexElement>(block->num_voxels());
+             ++voxel_idx) {
+          VoxelType& voxel = block->getVoxelByLinearIndex(voxel_idx);
+
+          // find voxel centers location in the input
+          const Point voxel_center =
+              T_in_out * block->computeCoordinatesFromLinearIndex(voxel_idx);
+
+          // interpolate voxel
+          if (interpolator.getVoxel(voxel_center, &voxel, true)) {
+            block->has_data() = true;
+
+            // if interpolated value fails use nearest
+          } else if (interpolator.getVoxel(voxel_center, &voxel, false)) {
+            block->has_data() = true;
+          }
+        }
+      });
 
-    if (!block->has_data()) {
-      layer_out->removeBlock(block_idx);
-    }
-  }
+  removeBlocksWithoutData(blocks_out, layer_out);
 }
 
 typedef std::pair<
@@ -2,6 +2,8 @@
 #define VOXBLOX_INTEGRATOR_OCCUPANCY_INTEGRATOR_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 #include <Eigen/Core>
@@ -32,6 +34,13 @@ class OccupancyIntegrator {
     float threshold_occupancy = 0.7f;
     FloatingPoint min_ray_length_m = 0.1;
     FloatingPoint max_ray_length_m = 5.0;
+    /**
+     * By default a voxel gets one update per scan: a hit if any ray ends in
+     * it, a miss if rays only pass through it. With this set, it gets the
+     * summed log-odds of all the hits and misses of the scan, clamped once.
+     */
+    bool update_per_ray = false;
+    size_t integrator_threads = std::thread::hardware_concurrency();
   };
 
   OccupancyIntegrator(const Config& config, Layer<OccupancyVoxel>* layer)
@@ -41,6 +50,11 @@ class OccupancyIntegrator {
     DCHECK_GT(layer_->block_size(), 0.0);
     DCHECK_GT(layer_->voxels_per_side(), 0u);
 
+    if (config_.integrator_threads == 0) {
+      LOG(WARNING) << "Automatic core count failed, defaulting to 1 threads";
+      config_.integrator_threads = 1;
+    }
+
     voxel_size_ = layer_->voxel_size();
     block_size_ = layer_->block_size();
     voxels_per_side_ = layer_->voxels_per_side();
@@ -57,12 +71,19 @@ class OccupancyIntegrator {
     min_occupancy_log_ = logOddsFromProbability(config_.threshold_occupancy);
   }
 
-  inline void updateOccupancyVoxel(bool occupied, OccupancyVoxel* occ_voxel) {
+  inline void updateOccupancyVoxel(
+      bool occupied, OccupancyVoxel* occ_voxel) const {
+    updateOccupancyVoxelLogOdds(
+        occupied ? prob_hit_log_ : prob_miss_log_, occ_voxel);
+  }
+
+  /// Adds the log-odds to the voxel, unless it is already clamped that way.
+  inline void updateOccupancyVoxelLogOdds(
+      float log_odds_update, OccupancyVoxel* occ_voxel) const {
     DCHECK(occ_voxel != NULL);
     // Set voxel to observed.
     occ_voxel->observed = true;
     // Skip update if necessary.
-    float log_odds_update = occupied ? prob_hit_log_ : prob_miss_log_;
     if ((log_odds_update >= 0 &&
          occ_voxel->probability_log >= clamp_max_log_) ||
         (log_odds_update <= 0 &&
@@ -75,109 +96,66 @@ class OccupancyIntegrator {
         clamp_max_log_);
   }
 
+  /**
+   * Casts the rays of the scan on the integrator threads, each thread counting
+   * the hits and misses of the voxels in blocks of its own. The counts are
+   * then merged block by block and each voxel the scan touched is updated
+   * once.
+   */
   void integratePointCloud(
-      const Transformation& T_G_C, const Pointcloud& points_C) {
-    timing::Timer integrate_timer("integrate_occ");
-
-    const Point& origin = T_G_C.getPosition();
-
-    LongIndexSet free_cells;
-    LongIndexSet occupied_cells;
-
-    const Point start_scaled = origin * voxel_size_inv_;
-    Point end_scaled = Point::Zero();
-
-    for (size_t pt_idx = 0; pt_idx < points_C.size(); ++pt_idx) {
-      const Point& point_C = points_C[pt_idx];
-      const Point point_G = T_G_C * point_C;
-      const Ray unit_ray = (point_G - origin).normalized();
-
-      timing::Timer cast_ray_timer("integrate_occ/cast_ray");
-
-      AlignedVector<GlobalIndex> global_voxel_indices;
-      FloatingPoint ray_distance = (point_G - origin).norm();
-      if (ray_distance < config_.min_ray_length_m) {
-        continue;
-      } else if (ray_distance > config_.max_ray_length_m) {
-        // Simply clear up until the max ray distance in this case.
-        end_scaled =
-            (origin + config_.max_ray_length_m * unit_ray) * voxel_size_inv_;
-
-        if (free_cells.find(getGridIndexFromPoint<GlobalIndex>(end_scaled)) ==
-            free_cells.end()) {
-          castRay(start_scaled, end_scaled, &global_voxel_indices);
-          free_cells.insert(
-              global_voxel_indices.begin(), global_voxel_indices.end());
-        }
-      } else {
-        end_scaled = point_G * voxel_size_inv_;
-        if (occupied_cells.find(getGridIndexFromPoint<GlobalIndex>(
-                end_scaled)) == occupied_cells.end()) {
-          castRay(start_scaled, end_scaled, &global_voxel_indices);
-
-          if (global_voxel_indices.size() > 2) {
-            free_cells.insert(
-                global_voxel_indices.begin(), global_voxel_indices.end() - 1);
-            occupied_cells.insert(global_voxel_indices.back());
-          }
-        }
-      }
-      cast_ray_timer.Stop();
-    }
+      const Transformation& T_G_C, const Pointcloud& points_C);
 
-    timing::Timer update_voxels_timer("integrate_occ/update_occupancy");
+  /// Voxels of the last scan that became occupied.
+  GlobalIndexList getInsertList() const {
+    return insert_list_;
+  }
 
-    // Clean up the lists: remove any occupied cells from free cells.
-    for (const GlobalIndex& global_index : occupied_cells) {
-      LongIndexSet::iterator cell_it = free_cells.find(global_index);
-      if (cell_it != free_cells.end()) {
-        free_cells.erase(cell_it);
-      }
-    }
-    // Then actually update the occupancy voxels.
-    BlockIndex last_block_idx = BlockIndex::Zero();
-    Block<OccupancyVoxel>::Ptr block;
-
-    bool occupied = false;
-    for (const GlobalIndex& global_voxel_idx : free_cells) {
-      BlockIndex block_idx = getBlockIndexFromGlobalVoxelIndex(
-          global_voxel_idx, voxels_per_side_inv_);
-      VoxelIndex local_voxel_idx =
-          getLocalFromGlobalVoxelIndex(global_voxel_idx, voxels_per_side_);
-
-      if (!block || block_idx != last_block_idx) {
-        block = layer_->allocateBlockPtrByIndex(block_idx);
-        block->setUpdatedAll();
-        last_block_idx = block_idx;
-      }
-
-      OccupancyVoxel& occ_voxel = block->getVoxelByVoxelIndex(local_voxel_idx);
-      updateOccupancyVoxel(occupied, &occ_voxel);
-    }
-    block.reset();
-
-    occupied = true;
-    for (const GlobalIndex& global_voxel_idx : occupied_cells) {
-      BlockIndex block_idx = getBlockIndexFromGlobalVoxelIndex(
-          global_voxel_idx, voxels_per_side_inv_);
-      VoxelIndex local_voxel_idx =
-          getLocalFromGlobalVoxelIndex(global_voxel_idx, voxels_per_side_);
-
-      if (!block || block_idx != last_block_idx) {
-        block = layer_->allocateBlockPtrByIndex(block_idx);
-        block->setUpdatedAll();
-        last_block_idx = block_idx;
-      }
-
-      OccupancyVoxel& occ_voxel = block->getVoxelByVoxelIndex(local_voxel_idx);
-      updateOccupancyVoxel(occupied, &occ_voxel);
-    }
+  /// Voxels of the last scan that became free.
+  GlobalIndexList getDeleteList() const {
+    return delete_list_;
+  }
+
+  /**
+   * Voxels of the last scan observed for the first time or that changed
+   * occupancy, i.e. the ones the ESDF integrators need to look at.
+   */
+  GlobalIndexList getChangedList() const {
+    return changed_list_;
+  }
 
-    update_voxels_timer.Stop();
-    integrate_timer.Stop();
+  inline void clearList() {
+    GlobalIndexList().swap(insert_list_);
+    GlobalIndexList().swap(delete_list_);
+    GlobalIndexList().swap(changed_list_);
   }
 
  protected:
+  /// Rays of one scan that ended in or passed through a voxel.
+  struct RayCounts {
+    uint32_t hits = 0u;
+    uint32_t misses = 0u;
+  };
+  /// The counts of the voxels of a block, by linear index.
+  typedef std::vector<RayCounts> BlockRayCounts;
+  typedef AnyIndexHashMapType<BlockRayCounts>::type RayCountsMap;
+
+  /// Counts the voxels along the rays of the points the index getter yields.
+  void countRaysFunction(
+      const Transformation& T_G_C, const Pointcloud& points_C,
+      ThreadSafeIndex* index_getter, RayCountsMap* ray_counts) const;
+
+  /**
+   * Updates the voxels of the blocks the block getter yields, from the counts
+   * of all the threads. The changed voxels are returned per block.
+   */
+  void updateBlocksFunction(
+      const std::vector<Block<OccupancyVoxel>::Ptr>& blocks,
+      const std::vector<RayCountsMap>& thread_ray_counts,
+      ThreadSafeIndex* block_getter,
+      std::vector<GlobalIndexVector>* block_insert_lists,
+      std::vector<GlobalIndexVector>* block_delete_lists,
+      std::vector<GlobalIndexVector>* block_changed_lists) const;
+
   Config config_;
 
   Layer<OccupancyVoxel>* layer_;
@@ -197,6 +175,11 @@ class OccupancyIntegrator {
   FloatingPoint voxel_size_inv_;
   FloatingPoint voxels_per_side_inv_;
   FloatingPoint block_size_inv_;
+
+  // Changes of the last scan, for the ESDF integrators.
+  GlobalIndexList insert_list_;
+  GlobalIndexList delete_list_;
+  GlobalIndexList changed_list_;
 };
 
 }  // namespace voxblox
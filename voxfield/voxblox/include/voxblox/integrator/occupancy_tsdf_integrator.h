@@ -97,6 +97,8 @@ class OccTsdfIntegrator {
           if (tsdf_voxel.weight >= config_.min_weight) {
             OccupancyVoxel& occ_voxel =
                 occ_block->getVoxelByLinearIndex(lin_index);
+            const bool original_observed_state = occ_voxel.observed;
+            const bool original_behind_state = occ_voxel.behind;
             occ_voxel.observed = true;
             occ_voxel.behind = (tsdf_voxel.distance < 0.0);
             bool original_occ_state = occ_voxel.occupied;
@@ -118,6 +120,11 @@ class OccTsdfIntegrator {
               delete_list_.push_back(global_index);
             else if ((!original_occ_state) && occ_voxel.occupied)
               insert_list_.push_back(global_index);
+
+            if (!original_observed_state ||
+                original_behind_state != occ_voxel.behind ||
+                original_occ_state != occ_voxel.occupied)
+              changed_list_.push_back(global_index);
           }
         }
       }
@@ -133,9 +140,16 @@ class OccTsdfIntegrator {
     return delete_list_;
   }
 
+  // Voxels newly observed or whose occupancy or side of the surface changed,
+  // the ones the ESDF integrators have to initialize
+  GlobalIndexList getChangedList() {
+    return changed_list_;
+  }
+
   inline void clearList() {
     GlobalIndexList().swap(insert_list_);
     GlobalIndexList().swap(delete_list_);
+    GlobalIndexList().swap(changed_list_);
   }
 
  protected:
@@ -157,6 +171,7 @@ class OccTsdfIntegrator {
   // Used for FIESTA ESDF mapping
   GlobalIndexList insert_list_;
   GlobalIndexList delete_list_;
+  GlobalIndexList changed_list_;
 };
 
 }  // namespace voxblox
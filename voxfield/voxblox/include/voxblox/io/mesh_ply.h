@@ -27,6 +27,7 @@
 #include <iostream>
 #include <string>
 
+#include "voxblox/mesh/incremental_connected_mesh.h"
 #include "voxblox/mesh/mesh_layer.h"
 
 namespace voxblox {
@@ -54,6 +55,13 @@ bool outputMeshLayerAsPly(
 
 bool outputMeshAsPly(const std::string& filename, const Mesh& mesh);
 
+/**
+ * Same output as outputMeshLayerAsPly with a connected mesh, but only the
+ * blocks updated since the last export are welded again.
+ */
+bool outputConnectedMeshAsPly(
+    const std::string& filename, IncrementalConnectedMesh* connected_mesh);
+
 }  // namespace voxblox
 
 #endif  // VOXBLOX_IO_MESH_PLY_H_
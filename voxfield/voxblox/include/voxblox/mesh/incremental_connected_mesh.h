@@ -0,0 +1,373 @@
+#ifndef VOXBLOX_MESH_INCREMENTAL_CONNECTED_MESH_H_
+#define VOXBLOX_MESH_INCREMENTAL_CONNECTED_MESH_H_
+
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/block_hash.h"
+#include "voxblox/core/common.h"
+#include "voxblox/mesh/mesh.h"
+#include "voxblox/mesh/mesh_layer.h"
+
+namespace voxblox {
+
+/**
+ * Connected mesh of a mesh layer that is kept up to date block by block,
+ * instead of welding the vertices of the whole layer on every call as
+ * createConnectedMesh does.
+ *
+ * Each block keeps its vertices welded with the same discretization as
+ * createConnectedMesh, and for the vertices that are also in a neighbour block
+ * (the seams), a link to the copy that is kept in the output. That copy is the
+ * one of the lowest block in lexicographic order, so only the 13 lower
+ * neighbours have to be searched. Updating a block re-welds it and re-links the
+ * seams of its 26 neighbours; the rest of the map is not touched.
+ *
+ * The proximity threshold has to be smaller than the block size, so that
+ * merged vertices can only be in neighbouring blocks.
+ */
+class IncrementalConnectedMesh {
+ public:
+  explicit IncrementalConnectedMesh(
+      const FloatingPoint approximate_vertex_proximity_threshold = 1e-10)
+      : threshold_(approximate_vertex_proximity_threshold),
+        threshold_inv_(
+            1. / static_cast<double>(approximate_vertex_proximity_threshold)) {
+    CHECK_GT(threshold_, 0.0);
+  }
+
+  /**
+   * Re-weld the given blocks of the mesh layer, e.g. the ones returned by
+   * MeshIntegrator::getLastMeshedBlocks(). Blocks without a mesh in the layer
+   * are removed.
+   */
+  void updateBlocks(
+      const MeshLayer& mesh_layer, const BlockIndexList& updated_blocks) {
+    CHECK_LT(threshold_, mesh_layer.block_size());
+    for (const BlockIndex& block_index : updated_blocks) {
+      Mesh::ConstPtr mesh;
+      if (mesh_layer.hasMeshWithIndex(block_index)) {
+        mesh = mesh_layer.getMeshPtrByIndex(block_index);
+      }
+      if (mesh && !mesh->vertices.empty()) {
+        weldBlock(block_index, *mesh);
+      } else {
+        block_map_.erase(block_index);
+      }
+      markSeamsDirty(block_index);
+    }
+  }
+
+  /// Re-weld every block of the mesh layer.
+  void rebuild(const MeshLayer& mesh_layer) {
+    clear();
+    BlockIndexList mesh_indices;
+    mesh_layer.getAllAllocatedMeshes(&mesh_indices);
+    updateBlocks(mesh_layer, mesh_indices);
+  }
+
+  /// Same output as createConnectedMesh for all the blocks welded so far.
+  void getConnectedMesh(Mesh* connected_mesh) {
+    CHECK_NOTNULL(connected_mesh);
+    linkDirtySeams();
+
+    // Global index of the first vertex kept from each block.
+    size_t num_vertices = 0u;
+    size_t num_indices = 0u;
+    bool has_colors = false;
+    bool has_normals = false;
+    for (const BlockMap::value_type& kv : block_map_) {
+      BlockMesh& block = *kv.second;
+      block.first_vertex = connected_mesh->vertices.size() + num_vertices;
+      num_vertices += block.num_kept;
+      num_indices += block.indices.size();
+      has_colors |= !block.colors.empty();
+      has_normals |= !block.normals.empty();
+    }
+
+    const size_t first_vertex = connected_mesh->vertices.size();
+    connected_mesh->reserve(
+        first_vertex + num_vertices, has_normals, has_colors, true);
+    connected_mesh->indices.reserve(
+        connected_mesh->indices.size() + num_indices);
+    if (has_normals) {
+      connected_mesh->normals.resize(
+          first_vertex + num_vertices, Point::Zero());
+    }
+
+    std::vector<size_t> global_indices;
+    for (const BlockMap::value_type& kv : block_map_) {
+      const BlockMesh& block = *kv.second;
+      global_indices.resize(block.vertices.size());
+
+      for (size_t i = 0u; i < block.vertices.size(); ++i) {
+        if (block.seam_blocks[i] == nullptr) {
+          global_indices[i] = block.first_vertex + block.kept_rank[i];
+          connected_mesh->vertices.push_back(block.vertices[i]);
+          if (has_colors) {
+            connected_mesh->colors.push_back(
+                block.colors.empty() ? Color() : block.colors[i]);
+          }
+        } else {
+          global_indices[i] = resolveSeam(block, i);
+        }
+        // Add all normals (this will average them once they are renormalized)
+        if (!block.normals.empty()) {
+          connected_mesh->normals[global_indices[i]] += block.normals[i];
+        }
+      }
+
+      for (size_t i = 0u; i < block.indices.size(); i += 3u) {
+        const size_t vertex_0 = global_indices[block.indices[i]];
+        const size_t vertex_1 = global_indices[block.indices[i + 1u]];
+        const size_t vertex_2 = global_indices[block.indices[i + 2u]];
+        if ((vertex_0 == vertex_1) || (vertex_1 == vertex_2) ||
+            (vertex_0 == vertex_2)) {
+          continue;
+        }
+        connected_mesh->indices.push_back(vertex_0);
+        connected_mesh->indices.push_back(vertex_1);
+        connected_mesh->indices.push_back(vertex_2);
+      }
+    }
+
+    // Renormalize normals
+    if (has_normals) {
+      for (size_t i = first_vertex; i < connected_mesh->normals.size(); ++i) {
+        Point& normal = connected_mesh->normals[i];
+        const FloatingPoint length = normal.norm();
+        if (length > kEpsilon) {
+          normal /= length;
+        } else {
+          normal = Point(0.0f, 0.0f, 1.0f);
+        }
+      }
+    }
+    CHECK_EQ(connected_mesh->vertices.size(), first_vertex + num_vertices);
+  }
+
+  size_t getNumberOfBlocks() const {
+    return block_map_.size();
+  }
+
+  /// Blocks re-welded or re-linked by the last call to getConnectedMesh.
+  size_t getNumberOfLastLinkedBlocks() const {
+    return num_last_linked_blocks_;
+  }
+
+  void clear() {
+    block_map_.clear();
+    dirty_seams_.clear();
+  }
+
+ private:
+  /// Welded mesh of one block.
+  struct BlockMesh {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Pointcloud vertices;
+    Pointcloud normals;
+    Colors colors;
+    VertexIndexList indices;
+
+    /// Discretized position of each vertex, and the inverse mapping.
+    LongIndexVector keys;
+    LongIndexHashMapType<size_t>::type key_to_vertex;
+    Point min_vertex;
+    Point max_vertex;
+
+    /**
+     * For each vertex, the lower neighbour block and the vertex in it that
+     * the vertex is merged with. nullptr if the vertex is kept from this block.
+     */
+    std::vector<const BlockMesh*> seam_blocks;
+    std::vector<size_t> seam_vertices;
+    /// Index of each kept vertex among the kept vertices of the block.
+    std::vector<size_t> kept_rank;
+    size_t num_kept = 0u;
+
+    size_t first_vertex = 0u;
+  };
+  typedef typename AnyIndexHashMapType<std::unique_ptr<BlockMesh>>::type
+      BlockMap;
+
+  inline LongIndex computeVertexKey(const Point& vertex) const {
+    const Eigen::Vector3d scaled_vector =
+        vertex.cast<double>() * threshold_inv_;
+    return LongIndex(
+        std::round(scaled_vector.x()), std::round(scaled_vector.y()),
+        std::round(scaled_vector.z()));
+  }
+
+  /// True if the offset comes before the origin in lexicographic order.
+  static inline bool isLowerOffset(const BlockIndex& offset) {
+    return offset.x() < 0 || (offset.x() == 0 && offset.y() < 0) ||
+           (offset.x() == 0 && offset.y() == 0 && offset.z() < 0);
+  }
+
+  void weldBlock(const BlockIndex& block_index, const Mesh& mesh) {
+    // Make sure there are 3 distinct vertices for every triangle before
+    // merging.
+    CHECK_EQ(mesh.vertices.size(), mesh.indices.size());
+    CHECK_EQ(mesh.indices.size() % 3u, 0u);
+
+    std::unique_ptr<BlockMesh>& block_ptr = block_map_[block_index];
+    block_ptr.reset(new BlockMesh());
+    BlockMesh& block = *block_ptr;
+
+    const size_t num_vertices = mesh.vertices.size();
+    block.vertices.reserve(num_vertices);
+    block.keys.reserve(num_vertices);
+    block.key_to_vertex.reserve(num_vertices);
+    block.min_vertex = mesh.vertices.front();
+    block.max_vertex = mesh.vertices.front();
+
+    std::vector<size_t> old_to_new_indices(num_vertices);
+    for (size_t old_vertex_idx = 0u; old_vertex_idx < num_vertices;
+         ++old_vertex_idx) {
+      const Point& vertex = mesh.vertices[old_vertex_idx];
+      const LongIndex key = computeVertexKey(vertex);
+
+      auto insert_status =
+          block.key_to_vertex.emplace(key, block.vertices.size());
+      if (insert_status.second) {
+        block.vertices.push_back(vertex);
+        block.keys.push_back(key);
+        if (mesh.hasColors()) {
+          block.colors.push_back(mesh.colors[old_vertex_idx]);
+        }
+        if (mesh.hasNormals()) {
+          block.normals.push_back(mesh.normals[old_vertex_idx]);
+        }
+        block.min_vertex = block.min_vertex.cwiseMin(vertex);
+        block.max_vertex = block.max_vertex.cwiseMax(vertex);
+      } else if (mesh.hasNormals()) {
+        block.normals[insert_status.first->second] +=
+            mesh.normals[old_vertex_idx];
+      }
+      old_to_new_indices[old_vertex_idx] = insert_status.first->second;
+    }
+
+    // We discard triangles where two or three vertices were merged.
+    block.indices.reserve(mesh.indices.size());
+    for (size_t i = 0u; i < mesh.indices.size(); i += 3u) {
+      const size_t vertex_0 = old_to_new_indices[mesh.indices[i]];
+      const size_t vertex_1 = old_to_new_indices[mesh.indices[i + 1u]];
+      const size_t vertex_2 = old_to_new_indices[mesh.indices[i + 2u]];
+      if ((vertex_0 == vertex_1) || (vertex_1 == vertex_2) ||
+          (vertex_0 == vertex_2)) {
+        continue;
+      }
+      block.indices.push_back(vertex_0);
+      block.indices.push_back(vertex_1);
+      block.indices.push_back(vertex_2);
+    }
+
+    // Keep every vertex until the seams are linked.
+    block.seam_blocks.assign(block.vertices.size(), nullptr);
+    block.seam_vertices.assign(block.vertices.size(), 0u);
+    block.kept_rank.resize(block.vertices.size());
+    for (size_t i = 0u; i < block.kept_rank.size(); ++i) {
+      block.kept_rank[i] = i;
+    }
+    block.num_kept = block.vertices.size();
+  }
+
+  /// The block and its 26 neighbours have to link their seams again.
+  void markSeamsDirty(const BlockIndex& block_index) {
+    BlockIndex offset;
+    for (offset.x() = -1; offset.x() <= 1; ++offset.x()) {
+      for (offset.y() = -1; offset.y() <= 1; ++offset.y()) {
+        for (offset.z() = -1; offset.z() <= 1; ++offset.z()) {
+          dirty_seams_.insert(block_index + offset);
+        }
+      }
+    }
+  }
+
+  void linkDirtySeams() {
+    num_last_linked_blocks_ = 0u;
+    for (const BlockIndex& block_index : dirty_seams_) {
+      BlockMap::iterator it = block_map_.find(block_index);
+      if (it != block_map_.end()) {
+        linkSeams(block_index, it->second.get());
+        ++num_last_linked_blocks_;
+      }
+    }
+    dirty_seams_.clear();
+  }
+
+  /// Merge the vertices of the block that are also in a lower neighbour.
+  void linkSeams(const BlockIndex& block_index, BlockMesh* block) {
+    DCHECK(block != nullptr);
+    std::fill(block->seam_blocks.begin(), block->seam_blocks.end(), nullptr);
+
+    const Point margin = Point::Constant(threshold_);
+    BlockIndex offset;
+    for (offset.x() = -1; offset.x() <= 1; ++offset.x()) {
+      for (offset.y() = -1; offset.y() <= 1; ++offset.y()) {
+        for (offset.z() = -1; offset.z() <= 1; ++offset.z()) {
+          if (!isLowerOffset(offset)) {
+            continue;
+          }
+          BlockMap::const_iterator it = block_map_.find(block_index + offset);
+          if (it == block_map_.end()) {
+            continue;
+          }
+          const BlockMesh& neighbour = *it->second;
+
+          // Only the vertices near the box of the neighbour can be in it.
+          const Point box_min = neighbour.min_vertex - margin;
+          const Point box_max = neighbour.max_vertex + margin;
+          for (size_t i = 0u; i < block->vertices.size(); ++i) {
+            const Point& vertex = block->vertices[i];
+            if (block->seam_blocks[i] != nullptr ||
+                (vertex.array() < box_min.array()).any() ||
+                (vertex.array() > box_max.array()).any()) {
+              continue;
+            }
+            LongIndexHashMapType<size_t>::type::const_iterator vertex_it =
+                neighbour.key_to_vertex.find(block->keys[i]);
+            if (vertex_it != neighbour.key_to_vertex.end()) {
+              block->seam_blocks[i] = &neighbour;
+              block->seam_vertices[i] = vertex_it->second;
+            }
+          }
+        }
+      }
+    }
+
+    block->num_kept = 0u;
+    for (size_t i = 0u; i < block->vertices.size(); ++i) {
+      if (block->seam_blocks[i] == nullptr) {
+        block->kept_rank[i] = block->num_kept++;
+      }
+    }
+  }
+
+  /// Follow the seam links down to the block that keeps the vertex.
+  static size_t resolveSeam(const BlockMesh& block, size_t vertex) {
+    const BlockMesh* owner = &block;
+    while (owner->seam_blocks[vertex] != nullptr) {
+      const BlockMesh* next = owner->seam_blocks[vertex];
+      vertex = owner->seam_vertices[vertex];
+      owner = next;
+    }
+    return owner->first_vertex + owner->kept_rank[vertex];
+  }
+
+  FloatingPoint threshold_;
+  double threshold_inv_;
+
+  BlockMap block_map_;
+  IndexSet dirty_seams_;
+  size_t num_last_linked_blocks_ = 0u;
+};
+
+}  // namespace voxblox
+
+#endif  // VOXBLOX_MESH_INCREMENTAL_CONNECTED_MESH_H_
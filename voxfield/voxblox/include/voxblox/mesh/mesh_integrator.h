@@ -24,6 +24,7 @@
 #define VOXBLOX_MESH_MESH_INTEGRATOR_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
@@ -32,6 +33,9 @@
 
 #include <Eigen/Core>
 #include <glog/logging.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "voxblox/core/layer.h"
 #include "voxblox/core/voxel.h"
@@ -144,6 +148,8 @@ class MeshIntegrator {
       sdf_layer_const_->getAllAllocatedBlocks(&all_tsdf_blocks);
     }
 
+    last_meshed_blocks_ = all_tsdf_blocks;
+
     // Allocate all the mesh memory
     for (const BlockIndex& block_index : all_tsdf_blocks) {
       mesh_layer_->allocateMeshPtrByIndex(block_index);
@@ -164,6 +170,14 @@ class MeshIntegrator {
     }
   }
 
+  /**
+   * Blocks meshed by the last call to generateMesh, e.g. to update an
+   * IncrementalConnectedMesh.
+   */
+  const BlockIndexList& getLastMeshedBlocks() const {
+    return last_meshed_blocks_;
+  }
+
   void generateMeshBlocksFunction(
       const BlockIndexList& all_tsdf_blocks, bool clear_updated_flag,
       ThreadSafeIndex* index_getter) {
@@ -185,11 +199,52 @@ class MeshIntegrator {
     }
   }
 
+  /**
+   * Copies the block and a one voxel halo on its max sides into a contiguous
+   * tile, computes the configuration of all its cubes at once over the tile
+   * and only meshes the cubes crossed by the surface. The mesh is the same, to
+   * the bit, as the one of extractBlockMeshByCube: the cubes are visited in
+   * the same order and meshed from the same corner coordinates and distances.
+   */
   void extractBlockMesh(
       typename Block<VoxelType>::ConstPtr block, Mesh::Ptr mesh) {
     DCHECK(block != nullptr);
     DCHECK(mesh != nullptr);
 
+    // One tile per thread, generateMesh meshes the blocks in parallel.
+    static thread_local BlockTile tile;
+    loadBlockTile(*block, &tile);
+    computeCubeConfigurations(&tile);
+    compactActiveCubes(&tile);
+
+    const Eigen::Matrix<FloatingPoint, 3, 8> cube_coord_offsets =
+        cube_index_offsets_.cast<FloatingPoint>() * voxel_size_;
+    Eigen::Matrix<FloatingPoint, 3, 8> corner_coords;
+    Eigen::Matrix<FloatingPoint, 8, 1> corner_sdf;
+    VertexIndex next_mesh_index = 0;
+
+    for (const uint32_t cube : tile.active_cubes) {
+      const VoxelIndex voxel_index = tile.cubeVoxelIndex(cube);
+      const Point coords = block->computeCoordinatesFromVoxelIndex(voxel_index);
+      const FloatingPoint* sdf = &tile.sdf[tile.cubeTileIndex(voxel_index)];
+      for (unsigned int i = 0; i < 8; ++i) {
+        corner_sdf(i) = sdf[tile.corner_offsets[i]];
+        corner_coords.col(i) = coords + cube_coord_offsets.col(i);
+      }
+      MarchingCubes::meshCube(
+          corner_coords, corner_sdf, &next_mesh_index, mesh.get());
+    }
+  }
+
+  /**
+   * Meshes the block one cube at a time, fetching the corners of each cube
+   * from the block or its neighbors. Reference for extractBlockMesh.
+   */
+  void extractBlockMeshByCube(
+      typename Block<VoxelType>::ConstPtr block, Mesh::Ptr mesh) {
+    DCHECK(block != nullptr);
+    DCHECK(mesh != nullptr);
+
     IndexElement vps = block->voxels_per_side();
     VertexIndex next_mesh_index = 0;
 
@@ -384,6 +439,208 @@ class MeshIntegrator {
   }
 
  protected:
+  /**
+   * Distances and validity of the voxels of a block plus the first voxel of
+   * its neighbors on the max sides, the corners of all the cubes of the block.
+   * Both the tile and the cubes are stored with z running fastest, so the
+   * cubes are visited in the same order as extractBlockMeshByCube does.
+   */
+  struct BlockTile {
+    /// Index of the cube in configurations.
+    inline uint32_t cubeIndex(
+        const IndexElement x, const IndexElement y,
+        const IndexElement z) const {
+      return static_cast<uint32_t>((x * vps + y) * vps + z);
+    }
+
+    inline VoxelIndex cubeVoxelIndex(const uint32_t cube) const {
+      return VoxelIndex(cube / (vps * vps), (cube / vps) % vps, cube % vps);
+    }
+
+    /// Index of the first corner of the cube in sdf and valid.
+    inline size_t cubeTileIndex(const VoxelIndex& index) const {
+      return static_cast<size_t>((index.x() * side + index.y()) * side) +
+             index.z();
+    }
+
+    IndexElement vps = 0;
+    /// Voxels per side of the tile, vps + 1.
+    IndexElement side = 0;
+    /// Offset of each corner of a cube from its first one.
+    int corner_offsets[8];
+
+    std::vector<FloatingPoint> sdf;
+    /// All bits set if the voxel has a valid distance.
+    std::vector<uint32_t> valid;
+    /// 0 if the cube has no triangles or a corner is not valid.
+    std::vector<int32_t> configurations;
+    /// Cubes with triangles, in the order they are meshed.
+    std::vector<uint32_t> active_cubes;
+  };
+
+  void loadBlockTile(const Block<VoxelType>& block, BlockTile* tile) const {
+    DCHECK(tile != nullptr);
+    const IndexElement vps = block.voxels_per_side();
+    const IndexElement side = vps + 1;
+    if (tile->vps != vps) {
+      tile->vps = vps;
+      tile->side = side;
+      const size_t tile_voxels = static_cast<size_t>(side * side * side);
+      tile->sdf.resize(tile_voxels);
+      tile->valid.resize(tile_voxels);
+      tile->configurations.resize(static_cast<size_t>(vps * vps * vps));
+      for (unsigned int i = 0; i < 8; ++i) {
+        tile->corner_offsets[i] =
+            (cube_index_offsets_(0, i) * side + cube_index_offsets_(1, i)) *
+                side +
+            cube_index_offsets_(2, i);
+      }
+    }
+
+    // The block itself and then the faces, edges and corner of the 7
+    // neighbors with a larger index along some axis.
+    for (int neighbor = 0; neighbor < 8; ++neighbor) {
+      const BlockIndex block_offset(
+          neighbor & 1, (neighbor >> 1) & 1, (neighbor >> 2) & 1);
+      const Block<VoxelType>* source = &block;
+      if (neighbor > 0) {
+        const BlockIndex neighbor_index = block.block_index() + block_offset;
+        source = sdf_layer_const_->hasBlock(neighbor_index)
+                     ? &sdf_layer_const_->getBlockByIndex(neighbor_index)
+                     : nullptr;
+      }
+
+      // Voxels of the tile coming from this block.
+      VoxelIndex begin, end;
+      for (unsigned int j = 0u; j < 3u; ++j) {
+        begin(j) = block_offset(j) == 0 ? 0 : vps;
+        end(j) = block_offset(j) == 0 ? vps : side;
+      }
+
+      VoxelIndex index;
+      for (index.x() = begin.x(); index.x() < end.x(); ++index.x()) {
+        for (index.y() = begin.y(); index.y() < end.y(); ++index.y()) {
+          index.z() = begin.z();
+          for (size_t tile_index = tile->cubeTileIndex(index);
+               index.z() < end.z(); ++index.z(), ++tile_index) {
+            FloatingPoint sdf = 0.0;
+            bool valid = false;
+            if (source != nullptr) {
+              const VoxelIndex source_index = index - block_offset * vps;
+              valid = utils::getSdfIfValid(
+                  source->getVoxelByVoxelIndex(source_index),
+                  config_.min_weight, &sdf);
+            }
+            tile->sdf[tile_index] = valid ? sdf : 0.0;
+            tile->valid[tile_index] = valid ? ~0u : 0u;
+          }
+        }
+      }
+    }
+  }
+
+  /// Same configuration as MarchingCubes::calculateVertexConfiguration.
+  static void computeCubeConfigurations(BlockTile* tile) {
+    DCHECK(tile != nullptr);
+    const IndexElement vps = tile->vps;
+    const int* corner_offsets = tile->corner_offsets;
+
+    for (IndexElement x = 0; x < vps; ++x) {
+      for (IndexElement y = 0; y < vps; ++y) {
+        const size_t row = tile->cubeTileIndex(VoxelIndex(x, y, 0));
+        const FloatingPoint* sdf = &tile->sdf[row];
+        const uint32_t* valid = &tile->valid[row];
+        int32_t* configurations =
+            &tile->configurations[tile->cubeIndex(x, y, 0)];
+
+        IndexElement z = 0;
+#ifdef __SSE2__
+        // Four cubes along z at a time. The corners with a z offset read up
+        // to the halo voxel of the row, never past it.
+        const __m128 zero = _mm_setzero_ps();
+        const __m128i all_negative = _mm_set1_epi32(0xFF);
+        for (; z + 4 <= vps; z += 4) {
+          __m128i configuration = _mm_setzero_si128();
+          __m128i all_valid = _mm_set1_epi32(-1);
+          for (int i = 0; i < 8; ++i) {
+            const __m128 negative = _mm_cmplt_ps(
+                _mm_loadu_ps(sdf + z + corner_offsets[i]), zero);
+            configuration = _mm_or_si128(
+                configuration, _mm_and_si128(
+                                   _mm_castps_si128(negative),
+                                   _mm_set1_epi32(1 << i)));
+            all_valid = _mm_and_si128(
+                all_valid,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                    valid + z + corner_offsets[i])));
+          }
+          // All the corners on the same side of the surface: no triangles.
+          const __m128i empty = _mm_or_si128(
+              _mm_cmpeq_epi32(configuration, _mm_setzero_si128()),
+              _mm_cmpeq_epi32(configuration, all_negative));
+          _mm_storeu_si128(
+              reinterpret_cast<__m128i*>(configurations + z),
+              _mm_and_si128(
+                  _mm_andnot_si128(empty, all_valid), configuration));
+        }
+#endif
+        for (; z < vps; ++z) {
+          int32_t configuration = 0;
+          uint32_t all_valid = ~0u;
+          for (int i = 0; i < 8; ++i) {
+            configuration |= sdf[z + corner_offsets[i]] < 0 ? (1 << i) : 0;
+            all_valid &= valid[z + corner_offsets[i]];
+          }
+          configurations[z] =
+              (all_valid != 0u && configuration != 0xFF) ? configuration : 0;
+        }
+      }
+    }
+  }
+
+  /// Active cubes in the order of extractBlockMeshByCube.
+  static void compactActiveCubes(BlockTile* tile) {
+    DCHECK(tile != nullptr);
+    const IndexElement vps = tile->vps;
+    std::vector<uint32_t>& active_cubes = tile->active_cubes;
+    active_cubes.clear();
+    auto add_if_active = [tile, &active_cubes](
+                             const IndexElement x, const IndexElement y,
+                             const IndexElement z) {
+      const uint32_t cube = tile->cubeIndex(x, y, z);
+      if (tile->configurations[cube] != 0) {
+        active_cubes.push_back(cube);
+      }
+    };
+
+    // Inside the block.
+    for (IndexElement x = 0; x < vps - 1; ++x) {
+      for (IndexElement y = 0; y < vps - 1; ++y) {
+        for (IndexElement z = 0; z < vps - 1; ++z) {
+          add_if_active(x, y, z);
+        }
+      }
+    }
+    // Max X plane.
+    for (IndexElement z = 0; z < vps; ++z) {
+      for (IndexElement y = 0; y < vps; ++y) {
+        add_if_active(vps - 1, y, z);
+      }
+    }
+    // Max Y plane, without the max X edge.
+    for (IndexElement z = 0; z < vps; ++z) {
+      for (IndexElement x = 0; x < vps - 1; ++x) {
+        add_if_active(x, vps - 1, z);
+      }
+    }
+    // Max Z plane, without the max X and max Y edges.
+    for (IndexElement y = 0; y < vps - 1; ++y) {
+      for (IndexElement x = 0; x < vps - 1; ++x) {
+        add_if_active(x, y, vps - 1);
+      }
+    }
+  }
+
   MeshIntegratorConfig config_;
 
   /**
@@ -409,6 +666,8 @@ class MeshIntegrator {
 
   // Cached index map.
   Eigen::Matrix<int, 3, 8> cube_index_offsets_;
+
+  BlockIndexList last_meshed_blocks_;
 };
 
 }  // namespace voxblox
@@ -51,6 +51,10 @@ class MeshLayer {
     }
   }
 
+  inline bool hasMeshWithIndex(const BlockIndex& index) const {
+    return mesh_map_.find(index) != mesh_map_.end();
+  }
+
   inline typename Mesh::ConstPtr getMeshPtrByIndex(
       const BlockIndex& index) const {
     typename MeshMap::const_iterator it = mesh_map_.find(index);
@@ -45,6 +45,16 @@ class Object {
       FloatingPoint max_dist, Point* intersect_point,
       FloatingPoint* intersect_dist) const = 0;
 
+  /**
+   * Axis-aligned box containing the whole object, used to cull the objects
+   * that cannot be hit by a ray or be the closest to a voxel. Returns false
+   * for unbounded objects.
+   */
+  virtual bool getBoundingBox(
+      Point* /*min_point*/, Point* /*max_point*/) const {
+    return false;
+  }
+
  protected:
   Point center_;
   Type type_;
@@ -99,6 +109,14 @@ class Sphere : public Object {
     return true;
   }
 
+  virtual bool getBoundingBox(Point* min_point, Point* max_point) const {
+    CHECK_NOTNULL(min_point);
+    CHECK_NOTNULL(max_point);
+    *min_point = center_ - Point::Constant(radius_);
+    *max_point = center_ + Point::Constant(radius_);
+    return true;
+  }
+
  protected:
   FloatingPoint radius_;
 };
@@ -211,6 +229,14 @@ class Cube : public Object {
     return true;
   }
 
+  virtual bool getBoundingBox(Point* min_point, Point* max_point) const {
+    CHECK_NOTNULL(min_point);
+    CHECK_NOTNULL(max_point);
+    *min_point = center_ - size_ / 2.0;
+    *max_point = center_ + size_ / 2.0;
+    return true;
+  }
+
  protected:
   Point size_;
 };
@@ -406,6 +432,15 @@ class Cylinder : public Object {
     return true;
   }
 
+  virtual bool getBoundingBox(Point* min_point, Point* max_point) const {
+    CHECK_NOTNULL(min_point);
+    CHECK_NOTNULL(max_point);
+    const Point half_size(radius_, radius_, height_ / 2.0);
+    *min_point = center_ - half_size;
+    *max_point = center_ + half_size;
+    return true;
+  }
+
  protected:
   FloatingPoint radius_;
   FloatingPoint height_;
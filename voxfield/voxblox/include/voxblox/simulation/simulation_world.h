@@ -4,6 +4,7 @@
 #include <list>
 #include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include "voxblox/core/common.h"
@@ -69,6 +70,23 @@ class SimulationWorld {
       FloatingPoint fov_h_rad, FloatingPoint max_dist,
       FloatingPoint noise_sigma, Pointcloud* ptcloud, Colors* colors);
 
+  /**
+   * Generates a scan of a spinning LiDAR at the pose: num_beams beams evenly
+   * spread from min_elevation_rad to max_elevation_rad, fired at num_columns
+   * azimuths evenly spread over a full turn around the z axis of the sensor,
+   * starting along its x axis. The points are ordered by beam, then azimuth.
+   */
+  void getLidarPointcloudFromTransform(
+      const Transformation& pose, int num_beams, int num_columns,
+      FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+      FloatingPoint max_dist, Pointcloud* ptcloud, Colors* colors) const;
+  /// Same as getLidarPointcloudFromTransform, with noise in the distance.
+  void getNoisyLidarPointcloudFromTransform(
+      const Transformation& pose, int num_beams, int num_columns,
+      FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+      FloatingPoint max_dist, FloatingPoint noise_sigma, Pointcloud* ptcloud,
+      Colors* colors);
+
   // === Computing ground truth SDFs ===
   template <typename VoxelType>
   void generateSdfFromWorld(
@@ -90,12 +108,67 @@ class SimulationWorld {
     return max_bound_;
   }
 
+  /**
+   * Threads used to generate the SDFs and the pointclouds, which are the same
+   * for any number of threads.
+   */
+  void setNumThreads(size_t num_threads) {
+    num_threads_ = std::max<size_t>(1u, num_threads);
+  }
+  size_t getNumThreads() const {
+    return num_threads_;
+  }
+
  protected:
+  /// An object and its bounding box, if it is bounded.
+  struct ObjectBounds {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    const Object* object;
+    bool bounded;
+    Point min_point;
+    Point max_point;
+  };
+
   template <typename VoxelType>
   void setVoxel(FloatingPoint dist, const Color& color, VoxelType* voxel) const;
 
   FloatingPoint getNoise(FloatingPoint noise_sigma);
 
+  /// The objects in order, with their bounding boxes slightly padded.
+  void getObjectBounds(AlignedVector<ObjectBounds>* object_bounds) const;
+
+  /**
+   * Closest intersection of the ray with the objects within max_dist, testing
+   * only the objects whose bounding box is hit before the closest one so far.
+   */
+  bool castRay(
+      const AlignedVector<ObjectBounds>& object_bounds, const Point& ray_origin,
+      const Point& ray_direction, FloatingPoint max_dist, Point* ray_intersect,
+      FloatingPoint* ray_dist, Color* ray_color) const;
+
+  /**
+   * Casts the rays from the origin in rows of rays_per_row, split between the
+   * threads, and returns the valid intersections in the order of the rays.
+   */
+  void castRays(
+      const Point& ray_origin, const AlignedVector<Point>& ray_directions,
+      size_t rays_per_row, FloatingPoint max_dist, Pointcloud* ray_intersects,
+      AlignedVector<Point>* hit_ray_directions,
+      std::vector<FloatingPoint>* ray_dists, Colors* ray_colors) const;
+
+  /// Directions of the rays of the spinning LiDAR, by beam then azimuth.
+  void getLidarRayDirections(
+      const Rotation& rotation, int num_beams, int num_columns,
+      FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+      AlignedVector<Point>* ray_directions) const;
+
+  /// Moves each intersection along its ray by a noise drawn in order.
+  void addNoiseToRays(
+      const Point& ray_origin, const AlignedVector<Point>& ray_directions,
+      const std::vector<FloatingPoint>& ray_dists, FloatingPoint noise_sigma,
+      Pointcloud* ray_intersects);
+
   /// List storing pointers to all the objects in this world.
   std::list<std::unique_ptr<Object> > objects_;
 
@@ -106,6 +179,8 @@ class SimulationWorld {
 
   /// For producing noise. Sets a fixed seed (0).
   std::default_random_engine generator_;
+
+  size_t num_threads_;
 };
 
 }  // namespace voxblox
@@ -3,9 +3,13 @@
 
 #include <algorithm>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "voxblox/core/block.h"
+#include "voxblox/integrator/integrator_utils.h"
 #include "voxblox/utils/timing.h"
 
 namespace voxblox {
@@ -24,23 +28,45 @@ void SimulationWorld::generateSdfFromWorld(
   FloatingPoint block_size = layer->block_size();
   FloatingPoint half_block_size = block_size / 2.0;
 
-  BlockIndexList blocks;
+  // The blocks are allocated here, the threads below only fill them in.
+  IndexSet block_index_set;
+  std::vector<typename Block<VoxelType>::Ptr> blocks;
   for (FloatingPoint x = min_bound_.x() - half_block_size;
        x <= max_bound_.x() + half_block_size; x += block_size) {
     for (FloatingPoint y = min_bound_.y() - half_block_size;
          y <= max_bound_.y() + half_block_size; y += block_size) {
       for (FloatingPoint z = min_bound_.z() - half_block_size;
            z <= max_bound_.z() + half_block_size; z += block_size) {
-        blocks.push_back(
-            layer->computeBlockIndexFromCoordinates(Point(x, y, z)));
+        const BlockIndex block_index =
+            layer->computeBlockIndexFromCoordinates(Point(x, y, z));
+        if (block_index_set.insert(block_index).second) {
+          blocks.push_back(layer->allocateBlockPtrByIndex(block_index));
+        }
       }
     }
   }
 
-  // Iterate over all blocks filling this stuff in.
-  for (const BlockIndex& block_index : blocks) {
-    typename Block<VoxelType>::Ptr block =
-        layer->allocateBlockPtrByIndex(block_index);
+  AlignedVector<ObjectBounds> object_bounds;
+  getObjectBounds(&object_bounds);
+
+  auto fill_block = [&](Block<VoxelType>* block) {
+    // Only the objects whose bounding box is within max_dist of the block can
+    // be closer to one of its voxels than max_dist.
+    std::vector<const Object*> block_objects;
+    const Point block_min = block->origin();
+    const Point block_max = block_min + Point::Constant(block_size);
+    for (const ObjectBounds& bounds : object_bounds) {
+      if (bounds.bounded) {
+        const Point gap = (bounds.min_point - block_max)
+                              .cwiseMax(block_min - bounds.max_point)
+                              .cwiseMax(Point::Zero());
+        if (gap.norm() > max_dist) {
+          continue;
+        }
+      }
+      block_objects.push_back(bounds.object);
+    }
+
     for (size_t i = 0; i < block->num_voxels(); ++i) {
       VoxelType& voxel = block->getVoxelByLinearIndex(i);
       Point coords = block->computeCoordinatesFromLinearIndex(i);
@@ -54,7 +80,7 @@ void SimulationWorld::generateSdfFromWorld(
       // Iterate over all objects and get distances to this thing.
       FloatingPoint voxel_dist = max_dist;
       Color color;
-      for (const std::unique_ptr<Object>& object : objects_) {
+      for (const Object* object : block_objects) {
         FloatingPoint object_dist = object->getDistanceToPoint(coords);
         if (object_dist < voxel_dist) {
           voxel_dist = object_dist;
@@ -66,6 +92,23 @@ void SimulationWorld::generateSdfFromWorld(
       voxel_dist = std::max(voxel_dist, -max_dist);
       setVoxel(voxel_dist, color, &voxel);
     }
+  };
+
+  // Iterate over all blocks filling this stuff in.
+  MixedThreadSafeIndex block_index_getter(blocks.size());
+  auto fill_blocks = [&]() {
+    size_t list_idx;
+    while (block_index_getter.getNextIndex(&list_idx)) {
+      fill_block(blocks[list_idx].get());
+    }
+  };
+  std::list<std::thread> threads;
+  for (size_t i = 1u; i < std::min(num_threads_, blocks.size()); ++i) {
+    threads.emplace_back(fill_blocks);
+  }
+  fill_blocks();
+  for (std::thread& thread : threads) {
+    thread.join();
   }
 }
 
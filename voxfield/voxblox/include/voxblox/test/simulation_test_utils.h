@@ -0,0 +1,64 @@
+#ifndef VOXBLOX_TEST_SIMULATION_TEST_UTILS_H_
+#define VOXBLOX_TEST_SIMULATION_TEST_UTILS_H_
+
+#include <cmath>
+#include <memory>
+
+#include "voxblox/core/common.h"
+#include "voxblox/simulation/simulation_world.h"
+
+namespace voxblox {
+
+namespace test {
+
+/**
+ * An 8 x 8 m room with a ground plane, a sphere, a cube and a cylinder, the
+ * scene shared by the integrator and alignment tests.
+ */
+inline void createRoomWorld(SimulationWorld* world) {
+  CHECK_NOTNULL(world);
+  world->setBounds(Point(-5.0, -5.0, -1.0), Point(5.0, 5.0, 4.0));
+  world->addPlaneBoundaries(-4.0, 4.0, -4.0, 4.0);
+  world->addGroundLevel(0.0);
+  world->addObject(std::unique_ptr<Object>(
+      new Sphere(Point(1.5, 1.0, 1.0), 0.8, Color(255, 0, 0))));
+  world->addObject(std::unique_ptr<Object>(
+      new Cube(Point(-1.5, -1.0, 0.75), Point(1.0, 2.0, 1.5))));
+  world->addObject(std::unique_ptr<Object>(
+      new Cylinder(Point(0.5, -2.5, 1.0), 0.4, 2.0)));
+}
+
+/**
+ * Poses evenly spaced on a horizontal circle around the origin of the room,
+ * each one looking across the room.
+ */
+inline AlignedVector<Transformation> getCirclePoses(
+    size_t num_poses, FloatingPoint radius, FloatingPoint height) {
+  AlignedVector<Transformation> poses;
+  for (size_t i = 0u; i < num_poses; ++i) {
+    const FloatingPoint angle = 2.0 * M_PI * i / num_poses;
+    const Point position(radius * cos(angle), radius * sin(angle), height);
+    const Quaternion rotation(
+        Eigen::AngleAxis<FloatingPoint>(angle + M_PI * 0.75, Point::UnitZ()));
+    poses.emplace_back(rotation, position);
+  }
+  return poses;
+}
+
+/// The scan of the world seen from the pose, in the camera frame.
+inline void getScanFromPose(
+    const SimulationWorld& world, const Transformation& T_G_C,
+    const Eigen::Vector2i& camera_res, FloatingPoint fov_h_rad,
+    FloatingPoint max_dist, Pointcloud* ptcloud_C, Colors* colors) {
+  CHECK_NOTNULL(ptcloud_C);
+  CHECK_NOTNULL(colors);
+  Pointcloud ptcloud_G;
+  world.getPointcloudFromTransform(
+      T_G_C, camera_res, fov_h_rad, max_dist, &ptcloud_G, colors);
+  transformPointcloud(T_G_C.inverse(), ptcloud_G, ptcloud_C);
+}
+
+}  // namespace test
+}  // namespace voxblox
+
+#endif  // VOXBLOX_TEST_SIMULATION_TEST_UTILS_H_
@@ -0,0 +1,158 @@
+#ifndef VOXBLOX_UTILS_LAYER_EVALUATOR_H_
+#define VOXBLOX_UTILS_LAYER_EVALUATOR_H_
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/common.h"
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/utils/evaluation_utils.h"
+
+namespace voxblox {
+
+namespace utils {
+
+/**
+ * Accumulated distance errors of a set of voxels. The absolute errors are also
+ * counted in a histogram of fixed bins, the last one of which holds all the
+ * errors beyond the others, to get their percentiles without keeping them.
+ */
+struct ErrorStatistics {
+  ErrorStatistics(FloatingPoint histogram_bin_width, size_t num_histogram_bins);
+
+  void addError(FloatingPoint error);
+  void merge(const ErrorStatistics& other);
+
+  FloatingPoint rmse() const;
+  /// Mean absolute error.
+  FloatingPoint mae() const;
+  /// 0 without any evaluated voxels.
+  FloatingPoint minError() const;
+  /**
+   * Upper edge of the histogram bin that holds the given quantile (0 to 1) of
+   * the absolute errors, at most max_error.
+   */
+  FloatingPoint percentile(FloatingPoint quantile) const;
+
+  FloatingPoint histogram_bin_width;
+  size_t num_evaluated_voxels = 0u;
+  double sum_squared_error = 0.0;
+  double sum_absolute_error = 0.0;
+  // Max and min of absolute distance error.
+  FloatingPoint min_error;
+  FloatingPoint max_error = 0.0;
+  std::vector<size_t> histogram;
+};
+
+/**
+ * Result of the comparison of a test layer against a ground truth layer, for
+ * all the evaluated voxels and per band of ground truth distance.
+ */
+struct LayerEvaluationReport {
+  /**
+   * Band i holds the voxels with an absolute ground truth distance between
+   * band_edges_m[i - 1] and band_edges_m[i], the last one all the rest.
+   */
+  LayerEvaluationReport(
+      const std::vector<FloatingPoint>& band_edges_m,
+      const std::vector<FloatingPoint>& percentiles,
+      FloatingPoint histogram_bin_width, size_t num_histogram_bins);
+
+  void addError(FloatingPoint gt_distance, FloatingPoint error);
+  void merge(const LayerEvaluationReport& other);
+
+  /// The totals, as reported by evaluateLayersRmse.
+  VoxelEvaluationDetails getDetails() const;
+
+  /// Same log output as VoxelEvaluationDetails, followed by the bands.
+  std::string toString() const;
+  /// One row per distance band and a last one for all the voxels.
+  std::string toCsv() const;
+  /// Everything in the report, including the histograms.
+  std::string toJson() const;
+  /// Writes the JSON report if the path ends in ".json", the CSV otherwise.
+  bool saveToFile(const std::string& file_path) const;
+
+  std::vector<FloatingPoint> band_edges_m;
+  std::vector<FloatingPoint> percentiles;
+
+  ErrorStatistics total;
+  std::vector<ErrorStatistics> bands;
+  size_t num_ignored_voxels = 0u;
+  size_t num_non_overlapping_voxels = 0u;
+};
+
+/**
+ * Evaluates a test layer against a ground truth layer like evaluateLayersRmse,
+ * with the blocks split between several threads. The layers can also be read
+ * block by block from their files, so that maps that do not fit in memory can
+ * be evaluated.
+ */
+template <typename VoxelType>
+class LayerEvaluator {
+ public:
+  struct Config {
+    VoxelEvaluationMode evaluation_mode =
+        VoxelEvaluationMode::kIgnoreErrorBehindTestSurface;
+    /// 0 uses one thread per core.
+    size_t num_threads = std::thread::hardware_concurrency();
+    /// Upper edges of the bands of absolute ground truth distance.
+    std::vector<FloatingPoint> band_edges_m = {0.1, 0.2, 0.5, 1.0, 2.0};
+    std::vector<FloatingPoint> percentiles = {0.5, 0.9, 0.95, 0.99};
+    FloatingPoint histogram_bin_width_m = 0.01;
+    FloatingPoint histogram_max_error_m = 1.0;
+    /// Blocks of the test layer read from the file at once.
+    size_t blocks_per_chunk = 1024u;
+  };
+
+  explicit LayerEvaluator(const Config& config);
+
+  LayerEvaluationReport evaluateLayers(
+      const Layer<VoxelType>& layer_gt,
+      const Layer<VoxelType>& layer_test) const;
+
+  /**
+   * Evaluates the layers saved in the files, holding at most blocks_per_chunk
+   * blocks of each layer, and the offsets of the ground truth blocks in its
+   * file, in memory. Returns false if a file cannot be read or the layers do
+   * not match.
+   */
+  bool evaluateLayerFiles(
+      const std::string& gt_file_path, const std::string& test_file_path,
+      LayerEvaluationReport* report) const;
+
+ protected:
+  LayerEvaluationReport createReport() const;
+
+  /**
+   * Compares the test_blocks, or counts their observed voxels if they are not
+   * in the ground truth, and counts the observed voxels of the gt_only_blocks,
+   * which are not in the test layer.
+   */
+  void evaluateBlocks(
+      const Layer<VoxelType>& layer_gt, const Layer<VoxelType>& layer_test,
+      const BlockIndexList& test_blocks, const BlockIndexList& gt_only_blocks,
+      LayerEvaluationReport* report) const;
+
+  /**
+   * Opens a layer file and reads its header. byte_offset is then at the first
+   * block.
+   */
+  static bool openLayerFile(
+      const std::string& file_path, std::fstream* proto_file,
+      LayerProto* layer_proto, size_t* num_blocks, uint64_t* byte_offset);
+
+  Config config_;
+};
+
+}  // namespace utils
+}  // namespace voxblox
+
+#include "voxblox/utils/layer_evaluator_inl.h"
+
+#endif  // VOXBLOX_UTILS_LAYER_EVALUATOR_H_
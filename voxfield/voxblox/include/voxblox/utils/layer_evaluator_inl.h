@@ -0,0 +1,317 @@
+#ifndef VOXBLOX_UTILS_LAYER_EVALUATOR_INL_H_
+#define VOXBLOX_UTILS_LAYER_EVALUATOR_INL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "voxblox/Block.pb.h"
+#include "voxblox/Layer.pb.h"
+#include "voxblox/integrator/integrator_utils.h"
+#include "voxblox/io/layer_io.h"
+#include "voxblox/utils/protobuf_utils.h"
+
+namespace voxblox {
+
+namespace utils {
+
+template <typename VoxelType>
+LayerEvaluator<VoxelType>::LayerEvaluator(const Config& config)
+    : config_(config) {
+  if (config_.num_threads == 0u) {
+    config_.num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  CHECK_GT(config_.histogram_bin_width_m, 0.0);
+  CHECK_GE(config_.histogram_max_error_m, config_.histogram_bin_width_m);
+  CHECK_GT(config_.blocks_per_chunk, 0u);
+  CHECK(std::is_sorted(
+      config_.band_edges_m.begin(), config_.band_edges_m.end()));
+}
+
+template <typename VoxelType>
+LayerEvaluationReport LayerEvaluator<VoxelType>::createReport() const {
+  // One more bin for the errors beyond histogram_max_error_m.
+  const size_t num_histogram_bins =
+      static_cast<size_t>(std::ceil(
+          config_.histogram_max_error_m / config_.histogram_bin_width_m)) +
+      1u;
+  return LayerEvaluationReport(
+      config_.band_edges_m, config_.percentiles, config_.histogram_bin_width_m,
+      num_histogram_bins);
+}
+
+template <typename VoxelType>
+LayerEvaluationReport LayerEvaluator<VoxelType>::evaluateLayers(
+    const Layer<VoxelType>& layer_gt,
+    const Layer<VoxelType>& layer_test) const {
+  CHECK_EQ(layer_gt.voxels_per_side(), layer_test.voxels_per_side());
+
+  BlockIndexList test_blocks;
+  layer_test.getAllAllocatedBlocks(&test_blocks);
+  BlockIndexList gt_blocks;
+  layer_gt.getAllAllocatedBlocks(&gt_blocks);
+  BlockIndexList gt_only_blocks;
+  for (const BlockIndex& block_index : gt_blocks) {
+    if (!layer_test.hasBlock(block_index)) {
+      gt_only_blocks.push_back(block_index);
+    }
+  }
+
+  LayerEvaluationReport report = createReport();
+  evaluateBlocks(layer_gt, layer_test, test_blocks, gt_only_blocks, &report);
+  VLOG(2) << report.toString();
+  return report;
+}
+
+template <typename VoxelType>
+void LayerEvaluator<VoxelType>::evaluateBlocks(
+    const Layer<VoxelType>& layer_gt, const Layer<VoxelType>& layer_test,
+    const BlockIndexList& test_blocks, const BlockIndexList& gt_only_blocks,
+    LayerEvaluationReport* report) const {
+  CHECK_NOTNULL(report);
+  const size_t num_threads = std::max<size_t>(
+      1u, std::min(
+              config_.num_threads, test_blocks.size() + gt_only_blocks.size()));
+
+  // Each thread accumulates its own report, they are merged in order at the
+  // end.
+  std::vector<LayerEvaluationReport> thread_reports(
+      num_threads, createReport());
+  MixedThreadSafeIndex test_index_getter(test_blocks.size());
+  MixedThreadSafeIndex gt_only_index_getter(gt_only_blocks.size());
+
+  auto evaluate_blocks = [&](LayerEvaluationReport* thread_report) {
+    size_t list_idx;
+    while (test_index_getter.getNextIndex(&list_idx)) {
+      const BlockIndex& block_index = test_blocks[list_idx];
+      const Block<VoxelType>& test_block =
+          layer_test.getBlockByIndex(block_index);
+      typename Block<VoxelType>::ConstPtr gt_block =
+          layer_gt.getBlockPtrByIndex(block_index);
+
+      if (!gt_block) {
+        for (size_t linear_index = 0u; linear_index < test_block.num_voxels();
+             ++linear_index) {
+          if (isObservedVoxel(test_block.getVoxelByLinearIndex(linear_index))) {
+            ++thread_report->num_non_overlapping_voxels;
+          }
+        }
+        continue;
+      }
+
+      for (size_t linear_index = 0u; linear_index < test_block.num_voxels();
+           ++linear_index) {
+        const VoxelType& voxel_gt =
+            gt_block->getVoxelByLinearIndex(linear_index);
+        FloatingPoint error = 0.0;
+        const VoxelEvaluationResult result = computeVoxelError(
+            voxel_gt, test_block.getVoxelByLinearIndex(linear_index),
+            config_.evaluation_mode, &error);
+
+        switch (result) {
+          case VoxelEvaluationResult::kEvaluated:
+            thread_report->addError(getVoxelSdf(voxel_gt), error);
+            break;
+          case VoxelEvaluationResult::kIgnored:
+            ++thread_report->num_ignored_voxels;
+            break;
+          case VoxelEvaluationResult::kNoOverlap:
+            ++thread_report->num_non_overlapping_voxels;
+            break;
+          default:
+            LOG(FATAL) << "Unkown voxel evaluation result: "
+                       << static_cast<int>(result);
+        }
+      }
+    }
+
+    while (gt_only_index_getter.getNextIndex(&list_idx)) {
+      const Block<VoxelType>& gt_block =
+          layer_gt.getBlockByIndex(gt_only_blocks[list_idx]);
+      for (size_t linear_index = 0u; linear_index < gt_block.num_voxels();
+           ++linear_index) {
+        if (isObservedVoxel(gt_block.getVoxelByLinearIndex(linear_index))) {
+          ++thread_report->num_non_overlapping_voxels;
+        }
+      }
+    }
+  };
+
+  std::list<std::thread> threads;
+  for (size_t i = 1u; i < num_threads; ++i) {
+    threads.emplace_back(evaluate_blocks, &thread_reports[i]);
+  }
+  evaluate_blocks(&thread_reports[0]);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (const LayerEvaluationReport& thread_report : thread_reports) {
+    report->merge(thread_report);
+  }
+}
+
+template <typename VoxelType>
+bool LayerEvaluator<VoxelType>::openLayerFile(
+    const std::string& file_path, std::fstream* proto_file,
+    LayerProto* layer_proto, size_t* num_blocks, uint64_t* byte_offset) {
+  CHECK_NOTNULL(proto_file);
+  CHECK_NOTNULL(layer_proto);
+  CHECK_NOTNULL(num_blocks);
+  CHECK_NOTNULL(byte_offset);
+
+  proto_file->open(file_path, std::fstream::in);
+  if (!proto_file->is_open()) {
+    LOG(ERROR) << "Could not open protobuf file to load layer: " << file_path;
+    return false;
+  }
+  *byte_offset = 0u;
+
+  uint32_t num_protos;
+  if (!readProtoMsgCountFromStream(proto_file, &num_protos, byte_offset)) {
+    LOG(ERROR) << "Could not read number of messages.";
+    return false;
+  }
+  if (num_protos == 0u) {
+    LOG(WARNING) << "Empty protobuf file!";
+    return false;
+  }
+  if (!readProtoMsgFromStream(proto_file, layer_proto, byte_offset)) {
+    LOG(ERROR) << "Could not read layer protobuf message.";
+    return false;
+  }
+  if ((layer_proto->voxel_size() <= 0.0f) ||
+      (layer_proto->voxels_per_side() == 0u)) {
+    LOG(ERROR)
+        << "Invalid parameter in layer protobuf message. Check the format.";
+    return false;
+  }
+  if (getVoxelType<VoxelType>().compare(layer_proto->type()) != 0) {
+    LOG(ERROR) << "The layer in " << file_path << " is of type "
+               << layer_proto->type() << ", not "
+               << getVoxelType<VoxelType>();
+    return false;
+  }
+  *num_blocks = num_protos - 1u;
+  return true;
+}
+
+template <typename VoxelType>
+bool LayerEvaluator<VoxelType>::evaluateLayerFiles(
+    const std::string& gt_file_path, const std::string& test_file_path,
+    LayerEvaluationReport* report) const {
+  CHECK_NOTNULL(report);
+
+  std::fstream gt_file;
+  LayerProto gt_layer_proto;
+  size_t num_gt_blocks;
+  uint64_t gt_byte_offset;
+  if (!openLayerFile(
+          gt_file_path, &gt_file, &gt_layer_proto, &num_gt_blocks,
+          &gt_byte_offset)) {
+    return false;
+  }
+  std::fstream test_file;
+  LayerProto test_layer_proto;
+  size_t num_test_blocks;
+  uint64_t test_byte_offset;
+  if (!openLayerFile(
+          test_file_path, &test_file, &test_layer_proto, &num_test_blocks,
+          &test_byte_offset)) {
+    return false;
+  }
+
+  Layer<VoxelType> layer_gt(gt_layer_proto);
+  Layer<VoxelType> layer_test(test_layer_proto);
+  if (!layer_gt.isCompatible(test_layer_proto)) {
+    LOG(ERROR) << "The test layer does not match the ground truth layer.";
+    return false;
+  }
+
+  // Where each ground truth block starts in its file, and whether it was
+  // compared to a test block.
+  typedef std::pair<uint64_t, bool> BlockOffset;
+  typename AnyIndexHashMapType<BlockOffset>::type gt_block_offsets;
+  for (size_t i = 0u; i < num_gt_blocks; ++i) {
+    const uint64_t block_byte_offset = gt_byte_offset;
+    BlockProto block_proto;
+    if (!readProtoMsgFromStream(&gt_file, &block_proto, &gt_byte_offset)) {
+      LOG(ERROR) << "Could not read block protobuf message number " << i;
+      return false;
+    }
+    const Point origin(
+        block_proto.origin_x(), block_proto.origin_y(),
+        block_proto.origin_z());
+    gt_block_offsets.emplace(
+        getGridIndexFromOriginPoint<BlockIndex>(
+            origin, layer_gt.block_size_inv()),
+        BlockOffset(block_byte_offset, false));
+  }
+
+  auto load_gt_block = [&](const uint64_t block_byte_offset) {
+    uint64_t byte_offset = block_byte_offset;
+    BlockProto block_proto;
+    return readProtoMsgFromStream(&gt_file, &block_proto, &byte_offset) &&
+           layer_gt.addBlockFromProto(
+               block_proto, Layer<VoxelType>::BlockMergingStrategy::kProhibit);
+  };
+
+  *report = createReport();
+  const BlockIndexList no_blocks;
+  BlockIndexList test_blocks;
+  for (size_t first = 0u; first < num_test_blocks;
+       first += config_.blocks_per_chunk) {
+    const size_t last =
+        std::min(first + config_.blocks_per_chunk, num_test_blocks);
+    if (!io::LoadBlocksFromStream(
+            last - first, Layer<VoxelType>::BlockMergingStrategy::kProhibit,
+            &test_file, &layer_test, &test_byte_offset)) {
+      return false;
+    }
+    layer_test.getAllAllocatedBlocks(&test_blocks);
+    for (const BlockIndex& block_index : test_blocks) {
+      auto it = gt_block_offsets.find(block_index);
+      if (it != gt_block_offsets.end()) {
+        if (!load_gt_block(it->second.first)) {
+          return false;
+        }
+        it->second.second = true;
+      }
+    }
+
+    evaluateBlocks(layer_gt, layer_test, test_blocks, no_blocks, report);
+    layer_test.removeAllBlocks();
+    layer_gt.removeAllBlocks();
+  }
+
+  // The observed voxels of the ground truth blocks without a test block are
+  // not overlapping.
+  BlockIndexList gt_only_blocks;
+  for (auto it = gt_block_offsets.begin(); it != gt_block_offsets.end();
+       ++it) {
+    if (!it->second.second) {
+      gt_only_blocks.push_back(it->first);
+    }
+    if (gt_only_blocks.size() == config_.blocks_per_chunk ||
+        (std::next(it) == gt_block_offsets.end() && !gt_only_blocks.empty())) {
+      for (const BlockIndex& block_index : gt_only_blocks) {
+        if (!load_gt_block(gt_block_offsets.at(block_index).first)) {
+          return false;
+        }
+      }
+      evaluateBlocks(layer_gt, layer_test, no_blocks, gt_only_blocks, report);
+      layer_gt.removeAllBlocks();
+      gt_only_blocks.clear();
+    }
+  }
+
+  VLOG(2) << report->toString();
+  return true;
+}
+
+}  // namespace utils
+}  // namespace voxblox
+
+#endif  // VOXBLOX_UTILS_LAYER_EVALUATOR_INL_H_
@@ -21,11 +21,15 @@
 #define VOXBLOX_UTILS_TIMING_H_
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <mutex>
+#include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "voxblox/core/common.h"
@@ -34,90 +38,66 @@ namespace voxblox {
 
 namespace timing {
 
-template <typename T, typename Total, int N>
-class Accumulator {
+/**
+ * Statistics of the durations measured by a timer. Besides the totals, keeps a
+ * window of the latest samples and a log-scaled histogram for the
+ * percentiles, so that the statistics of several threads can be merged.
+ */
+class TimerStatistics {
  public:
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-
-  Accumulator()
-      : window_samples_(0),
-        totalsamples_(0),
-        window_sum_(0),
-        sum_(0),
-        min_(std::numeric_limits<T>::max()),
-        max_(std::numeric_limits<T>::min()) {}
-
-  void Add(T sample) {
-    if (window_samples_ < N) {
-      samples_[window_samples_++] = sample;
-      window_sum_ += sample;
-    } else {
-      T& oldest = samples_[window_samples_++ % N];
-      window_sum_ += sample - oldest;
-      oldest = sample;
-    }
-    sum_ += sample;
-    ++totalsamples_;
-    if (sample > max_) {
-      max_ = sample;
-    }
-    if (sample < min_) {
-      min_ = sample;
-    }
-  }
-
-  int TotalSamples() const {
-    return totalsamples_;
+  /// Number of latest samples the rolling mean and variance are taken over.
+  static constexpr size_t kWindowSize = 50u;
+  /**
+   * The histogram bins are 2^(1/kBinsPerOctave) wide, starting at
+   * kMinHistogramSeconds, so percentiles are within 9% of the true ones.
+   */
+  static constexpr int kBinsPerOctave = 8;
+  static constexpr int kNumOctaves = 40;
+  static constexpr double kMinHistogramSeconds = 1.e-9;
+
+  TimerStatistics();
+
+  /// stop_time_ns orders the samples of different threads in the window.
+  void Add(double seconds, int64_t stop_time_ns);
+  void Merge(const TimerStatistics& other);
+
+  size_t TotalSamples() const {
+    return total_samples_;
   }
-
   double Sum() const {
     return sum_;
   }
-
-  double Mean() const {
-    return sum_ / totalsamples_;
-  }
-
-  double RollingMean() const {
-    return window_sum_ / std::min(window_samples_, N);
-  }
-
-  double Max() const {
-    return max_;
-  }
-
-  double Min() const {
-    return min_;
-  }
-
-  double LazyVariance() const {
-    if (window_samples_ == 0) {
-      return 0.0;
-    }
-    double var = 0;
-    double mean = RollingMean();
-    for (int i = 0; i < std::min(window_samples_, N); ++i) {
-      var += (samples_[i] - mean) * (samples_[i] - mean);
-    }
-    var /= std::min(window_samples_, N);
-    return var;
-  }
+  double Mean() const;
+  double RollingMean() const;
+  double Max() const;
+  double Min() const;
+  double LazyVariance() const;
+  /// Upper edge of the histogram bin of the quantile, at most the max.
+  double Percentile(double quantile) const;
 
  private:
-  int window_samples_;
-  int totalsamples_;
-  Total window_sum_;
-  Total sum_;
-  T min_;
-  T max_;
-  T samples_[N];
+  struct Sample {
+    double seconds;
+    int64_t stop_time_ns;
+  };
+
+  static size_t GetHistogramBin(double seconds);
+
+  size_t total_samples_;
+  double sum_;
+  double min_;
+  double max_;
+  /// Ring buffer of the latest samples, window_next_ is the oldest once full.
+  std::vector<Sample> window_;
+  size_t window_next_;
+  /// Allocated on the first sample.
+  std::vector<uint64_t> histogram_;
 };
 
 struct TimerMapValue {
   TimerMapValue() {}
 
-  /// Create an accumulator with specified window size.
-  Accumulator<double, double, 50> acc_;
+  TimerStatistics acc_;
 };
 
 /**
@@ -156,7 +136,7 @@ class Timer {
   bool IsTiming() const;
 
  private:
-  std::chrono::time_point<std::chrono::system_clock> time_;
+  std::chrono::steady_clock::time_point time_;
 
   bool timing_;
   bool paused_ = false;
@@ -164,11 +144,17 @@ class Timer {
   size_t handle_;
 };
 
+/**
+ * Registry of the timers. The timers of each thread are accumulated in
+ * thread-local statistics, which are only merged when they are read, so
+ * stopping a timer does not lock a mutex shared with the other threads.
+ */
 class Timing {
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   typedef std::map<std::string, size_t> map_t;
+  typedef std::vector<std::pair<std::string, TimerStatistics>> StatisticsList;
   friend class Timer;
   // Definition of static functions to query the timers.
   static size_t GetHandle(std::string const& tag);
@@ -185,10 +171,22 @@ class Timing {
   static double GetMinSeconds(std::string const& tag);
   static double GetMaxSeconds(size_t handle);
   static double GetMaxSeconds(std::string const& tag);
+  static double GetPercentileSeconds(size_t handle, double quantile);
+  static double GetPercentileSeconds(std::string const& tag, double quantile);
   static double GetHz(size_t handle);
   static double GetHz(std::string const& tag);
+  /// The statistics of one timer, merged over all the threads.
+  static TimerStatistics GetStatistics(size_t handle);
+  /// The merged statistics of all the timers, sorted by tag.
+  static StatisticsList GetAllStatistics();
   static void Print(std::ostream& out);
   static std::string Print();
+  /// One row per timer, the percentiles are those of ExportPercentiles().
+  static std::string PrintCsv();
+  static std::string PrintJson();
+  /// Writes JSON if the file path ends in .json, CSV otherwise.
+  static bool SaveToFile(std::string const& file_path);
+  static const std::vector<double>& ExportPercentiles();
   static std::string SecondsToTimeString(double seconds);
   static void Reset();
   static const map_t& GetTimers() {
@@ -196,18 +194,27 @@ class Timing {
   }
 
  private:
-  void AddTime(size_t handle, double seconds);
+  struct ThreadTimers;
+
+  void AddTime(size_t handle, double seconds, int64_t stop_time_ns);
+  /// Requires mutex_ to be locked.
+  TimerStatistics MergeThreadTimers(size_t handle);
 
   static Timing& Instance();
+  static ThreadTimers& GetThreadTimers();
 
   Timing();
   ~Timing();
 
   typedef AlignedVector<TimerMapValue> list_t;
 
+  /// Statistics of the threads that have exited.
   list_t timers_;
   map_t tagMap_;
   size_t maxTagLength_;
+  std::vector<ThreadTimers*> thread_timers_;
+  /// Invalidates the handles cached by the threads.
+  std::atomic<size_t> num_resets_;
   std::mutex mutex_;
 };
 
@@ -39,8 +39,11 @@
  */
 #include "voxblox/alignment/icp.h"
 
+#include <functional>
 #include <random>
 
+#include "voxblox/utils/evaluation_utils.h"
+
 namespace voxblox {
 
 ICP::ICP(const Config& config) : config_(config) {}
@@ -99,6 +102,23 @@ void ICP::addNormalizedPointInfo(
                         normalized_point_normal.x());
 }
 
+const TsdfVoxel* ICP::getObservedVoxel(
+    const GlobalIndex& global_voxel_idx, const BlockIndex& block_idx,
+    const Block<TsdfVoxel>& block) const {
+  const TsdfVoxel* voxel;
+  if (getBlockIndexFromGlobalVoxelIndex(
+          global_voxel_idx, voxels_per_side_inv_) == block_idx) {
+    voxel = &block.getVoxelByVoxelIndex(
+        getLocalFromGlobalVoxelIndex(global_voxel_idx, voxels_per_side_));
+  } else {
+    voxel = tsdf_layer_->getVoxelPtrByGlobalIndex(global_voxel_idx);
+  }
+  if (voxel == nullptr || !utils::isObservedVoxel(*voxel)) {
+    return nullptr;
+  }
+  return voxel;
+}
+
 void ICP::matchPoints(
     const Pointcloud& points, const size_t start_idx,
     const Transformation& T_tsdf_sensor, PointsMatrix* src, PointsMatrix* tgt,
@@ -107,45 +127,99 @@ void ICP::matchPoints(
   CHECK_NOTNULL(tgt);
   CHECK_NOTNULL(info_vector);
 
-  constexpr bool kInterpolateDist = false;
-  constexpr bool kInterpolateGrad = false;
   constexpr FloatingPoint kMinGradMag = 0.1;
 
-  src->resize(3, config_.mini_batch_size);
-  tgt->resize(3, config_.mini_batch_size);
+  const size_t end_idx =
+      std::min(points.size(), start_idx + config_.mini_batch_size);
+  const int num_points =
+      static_cast<int>(end_idx - std::min(start_idx, end_idx));
 
   // epsilon to ensure we can always divide by it
   info_vector->setConstant(kEpsilon);
 
-  size_t idx = 0;
-  for (size_t i = start_idx;
-       i < std::min(points.size(), start_idx + config_.mini_batch_size); ++i) {
-    const Point& point_sensor = points[i];
-    const Point point_tsdf = T_tsdf_sensor * point_sensor;
-    const AnyIndex voxel_idx =
-        getGridIndexFromPoint<AnyIndex>(point_tsdf, voxel_size_inv_);
-
-    FloatingPoint distance;
-    Point gradient;
-
-    if (interpolator_->getDistance(point_tsdf, &distance, kInterpolateDist) &&
-        interpolator_->getGradient(point_tsdf, &gradient, kInterpolateGrad) &&
-        (gradient.squaredNorm() > kMinGradMag)) {
-      gradient.normalize();
-
-      addNormalizedPointInfo(
-          point_tsdf - T_tsdf_sensor.getPosition(), gradient, info_vector);
-
-      // uninterpolated distance is to the center of the voxel, as we now have
-      // the gradient we can use it to do better
-      const Point voxel_center =
-          getCenterPointFromGridIndex<AnyIndex>(voxel_idx, voxel_size_);
-      distance += gradient.dot(point_tsdf - voxel_center);
-
-      src->col(idx) = point_tsdf;
-      tgt->col(idx) = point_tsdf - distance * gradient;
-      ++idx;
+  PointsMatrix points_tsdf(3, num_points);
+  for (int i = 0; i < num_points; ++i) {
+    points_tsdf.col(i) = points[start_idx + i];
+  }
+  points_tsdf = (T_tsdf_sensor.getRotationMatrix() * points_tsdf).colwise() +
+                T_tsdf_sensor.getPosition();
+
+  // Nearest distance of the voxel of each point and of its 6 neighbors, a
+  // point is only matched if all of them are observed.
+  Eigen::Matrix<FloatingPoint, 1, Eigen::Dynamic> distances =
+      Eigen::Matrix<FloatingPoint, 1, Eigen::Dynamic>::Zero(num_points);
+  PointsMatrix distances_minus = PointsMatrix::Zero(3, num_points);
+  PointsMatrix distances_plus = PointsMatrix::Zero(3, num_points);
+  PointsMatrix voxel_centers = PointsMatrix::Zero(3, num_points);
+  std::vector<bool> observed(num_points, false);
+  for (int i = 0; i < num_points; ++i) {
+    const GlobalIndex global_voxel_idx =
+        getGridIndexFromPoint<GlobalIndex>(points_tsdf.col(i), voxel_size_inv_);
+    const BlockIndex block_idx = getBlockIndexFromGlobalVoxelIndex(
+        global_voxel_idx, voxels_per_side_inv_);
+    Block<TsdfVoxel>::ConstPtr block =
+        tsdf_layer_->getBlockPtrByIndex(block_idx);
+    if (!block) {
+      continue;
+    }
+    const TsdfVoxel* voxel =
+        getObservedVoxel(global_voxel_idx, block_idx, *block);
+    if (voxel == nullptr) {
+      continue;
+    }
+    distances(i) = voxel->distance;
+
+    bool all_observed = true;
+    for (unsigned int j = 0u; j < 3u && all_observed; ++j) {
+      GlobalIndex neighbor_idx = global_voxel_idx;
+      neighbor_idx(j) -= 1;
+      const TsdfVoxel* minus_voxel =
+          getObservedVoxel(neighbor_idx, block_idx, *block);
+      neighbor_idx(j) += 2;
+      const TsdfVoxel* plus_voxel =
+          getObservedVoxel(neighbor_idx, block_idx, *block);
+      all_observed = minus_voxel != nullptr && plus_voxel != nullptr;
+      if (all_observed) {
+        distances_minus(j, i) = minus_voxel->distance;
+        distances_plus(j, i) = plus_voxel->distance;
+      }
+    }
+    if (!all_observed) {
+      continue;
     }
+    voxel_centers.col(i) =
+        getCenterPointFromGridIndex(global_voxel_idx, voxel_size_);
+    observed[i] = true;
+  }
+
+  // Central differences, which are 2x voxel size apart.
+  PointsMatrix gradients =
+      (distances_plus - distances_minus) * (0.5 * voxel_size_inv_);
+  const Eigen::Array<FloatingPoint, 1, Eigen::Dynamic> gradient_norms =
+      gradients.colwise().norm().array();
+  gradients.array().rowwise() /= gradient_norms.max(kEpsilon);
+
+  // uninterpolated distance is to the center of the voxel, as we now have
+  // the gradient we can use it to do better
+  distances +=
+      gradients.cwiseProduct(points_tsdf - voxel_centers).colwise().sum();
+  const PointsMatrix targets =
+      points_tsdf - gradients * distances.asDiagonal();
+
+  src->resize(3, num_points);
+  tgt->resize(3, num_points);
+  int idx = 0;
+  for (int i = 0; i < num_points; ++i) {
+    if (!observed[i] ||
+        gradient_norms(i) * gradient_norms(i) <= kMinGradMag) {
+      continue;
+    }
+    addNormalizedPointInfo(
+        points_tsdf.col(i) - T_tsdf_sensor.getPosition(), gradients.col(i),
+        info_vector);
+    src->col(idx) = points_tsdf.col(i);
+    tgt->col(idx) = targets.col(i);
+    ++idx;
   }
 
   src->conservativeResize(3, idx);
@@ -230,9 +304,11 @@ size_t ICP::runICP(
     Transformation* refined_T_tsdf_sensor, const unsigned seed) {
   CHECK_NOTNULL(refined_T_tsdf_sensor);
 
-  interpolator_ = std::make_shared<Interpolator<TsdfVoxel>>(&tsdf_layer);
+  tsdf_layer_ = &tsdf_layer;
   voxel_size_ = tsdf_layer.voxel_size();
   voxel_size_inv_ = tsdf_layer.voxel_size_inv();
+  voxels_per_side_ = tsdf_layer.voxels_per_side();
+  voxels_per_side_inv_ = tsdf_layer.voxels_per_side_inv();
 
   Pointcloud shuffled_points = points;
 
@@ -247,20 +323,43 @@ size_t ICP::runICP(
   base_info_vector.head<3>().setConstant(config_.inital_translation_weighting);
   base_info_vector.tail<3>().setConstant(config_.inital_rotation_weighting);
 
-  std::list<std::thread> threads;
-  atomic_idx_.store(0);
   size_t num_updates = 0;
-
-  for (size_t i = 0; i < config_.num_threads; ++i) {
-    threads.emplace_back(
-        &ICP::runThread, this, shuffled_points, refined_T_tsdf_sensor,
-        &base_info_vector, &num_updates);
-  }
-  for (std::thread& thread : threads) {
-    thread.join();
+  num_iterations_ = 0;
+  while (num_iterations_ < std::max(config_.max_iterations, 1)) {
+    const Transformation last_T_tsdf_sensor = *refined_T_tsdf_sensor;
+    const Vector6 last_info_vector = base_info_vector;
+
+    std::list<std::thread> threads;
+    atomic_idx_.store(0);
+    for (size_t i = 0; i < config_.num_threads; ++i) {
+      threads.emplace_back(
+          &ICP::runThread, this, std::cref(shuffled_points),
+          refined_T_tsdf_sensor, &base_info_vector, &num_updates);
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    ++num_iterations_;
+
+    // Stop once the pass barely moved the sensor, or once its points weigh
+    // too little to move it in the next one.
+    const Transformation delta_T_tsdf_sensor =
+        last_T_tsdf_sensor.inverse() * *refined_T_tsdf_sensor;
+    const bool converged =
+        delta_T_tsdf_sensor.getPosition().norm() <
+            config_.min_delta_translation_m &&
+        delta_T_tsdf_sensor.getRotation().log().norm() <
+            config_.min_delta_rotation_rad;
+    const Vector6 information_gain =
+        (base_info_vector - last_info_vector).array() /
+        base_info_vector.array();
+    if (converged ||
+        information_gain.maxCoeff() < config_.min_information_gain) {
+      break;
+    }
   }
 
-  interpolator_.reset();
+  tsdf_layer_ = nullptr;
 
   return num_updates;
 }
@@ -71,26 +71,78 @@ void EsdfOccFiestaIntegrator::updateFromOccBlocks(
       // If this voxel is unobserved in the original map, skip it.
       // Initialization
       if (occupancy_voxel.observed) {
-        EsdfVoxel& esdf_voxel = esdf_block->getVoxelByLinearIndex(lin_index);
-        esdf_voxel.behind = occupancy_voxel.behind;
-        if (esdf_voxel.self_idx(0) == UNDEF) {
-          esdf_voxel.observed = true;
-          esdf_voxel.newly = true;
-          VoxelIndex voxel_index =
-              esdf_block->computeVoxelIndexFromLinearIndex(lin_index);
-          GlobalIndex global_index = getGlobalVoxelIndexFromBlockAndVoxelIndex(
-              block_index, voxel_index, esdf_layer_->voxels_per_side());
-          esdf_voxel.self_idx = global_index;
-          esdf_voxel.distance = esdf_voxel.behind
-                                    ? -config_.max_behind_surface_m
-                                    : config_.default_distance_m;
-        } else {
-          // already initialized
-          esdf_voxel.newly = false;
-        }
+        initializeVoxel(
+            occupancy_voxel, block_index,
+            esdf_block->computeVoxelIndexFromLinearIndex(lin_index),
+            &esdf_block->getVoxelByLinearIndex(lin_index));
+      }
+    }
+  }
+  getUpdateRange();
+  setLocalRange();
+
+  allocate_timer.Stop();
+  updateESDF();
+
+  esdf_timer.Stop();
+}
+
+void EsdfOccFiestaIntegrator::updateFromOccVoxels(
+    const GlobalIndexList& occ_voxels, bool clear_updated_flag) {
+  // The changed voxels cover all the changes of the scan, also in the updated
+  // blocks without any of them.
+  if (clear_updated_flag) {
+    BlockIndexList occ_blocks;
+    occ_layer_->getAllUpdatedBlocks(Update::kEsdf, &occ_blocks);
+    for (const BlockIndex& block_index : occ_blocks) {
+      occ_layer_->getBlockByIndex(block_index).setUpdated(Update::kEsdf, false);
+    }
+  }
+  if (occ_voxels.empty()) {
+    return;
+  }
+
+  CHECK_EQ(occ_layer_->voxels_per_side(), esdf_layer_->voxels_per_side());
+  timing::Timer esdf_timer("update_esdf/fiesta");
+
+  // Only the changed voxels of the occupancy map are initialized, their
+  // blocks are not rescanned.
+  timing::Timer allocate_timer("update_esdf/fiesta/allocate_vox");
+  VLOG(3) << "[ESDF update]: Propagating " << occ_voxels.size()
+          << " changed voxels from the Occupancy.";
+
+  const FloatingPoint voxels_per_side_inv = 1.0 / esdf_voxels_per_side_;
+  BlockIndex block_index;
+  Block<OccupancyVoxel>::ConstPtr occ_block;
+  Block<EsdfVoxel>::Ptr esdf_block;
+  bool has_block = false;
+  for (const GlobalIndex& global_index : occ_voxels) {
+    const BlockIndex voxel_block_index =
+        getBlockIndexFromGlobalVoxelIndex(global_index, voxels_per_side_inv);
+    if (!has_block || voxel_block_index != block_index) {
+      has_block = true;
+      block_index = voxel_block_index;
+      occ_block = occ_layer_->getBlockPtrByIndex(block_index);
+      if (occ_block) {
+        esdf_block = esdf_layer_->allocateBlockPtrByIndex(block_index);
+        esdf_block->setUpdatedAll();
       }
     }
+    if (!occ_block) {
+      continue;
+    }
+
+    const VoxelIndex voxel_index =
+        getLocalFromGlobalVoxelIndex(global_index, esdf_voxels_per_side_);
+    const OccupancyVoxel& occupancy_voxel =
+        occ_block->getVoxelByVoxelIndex(voxel_index);
+    if (occupancy_voxel.observed) {
+      initializeVoxel(
+          occupancy_voxel, block_index, voxel_index,
+          &esdf_block->getVoxelByVoxelIndex(voxel_index));
+    }
   }
+
   getUpdateRange();
   setLocalRange();
 
@@ -100,6 +152,23 @@ void EsdfOccFiestaIntegrator::updateFromOccBlocks(
   esdf_timer.Stop();
 }
 
+void EsdfOccFiestaIntegrator::initializeVoxel(
+    const OccupancyVoxel& occ_voxel, const BlockIndex& block_index,
+    const VoxelIndex& voxel_index, EsdfVoxel* esdf_voxel) const {
+  esdf_voxel->behind = occ_voxel.behind;
+  if (esdf_voxel->self_idx(0) == UNDEF) {
+    esdf_voxel->observed = true;
+    esdf_voxel->newly = true;
+    esdf_voxel->self_idx = getGlobalVoxelIndexFromBlockAndVoxelIndex(
+        block_index, voxel_index, esdf_voxels_per_side_);
+    esdf_voxel->distance = esdf_voxel->behind ? -config_.max_behind_surface_m
+                                              : config_.default_distance_m;
+  } else {
+    // already initialized
+    esdf_voxel->newly = false;
+  }
+}
+
 // Get the range of the changed occupancy grid (inserted or deleted)
 void EsdfOccFiestaIntegrator::getUpdateRange() {
   // initialization
@@ -101,6 +101,137 @@ void EsdfOccIntegrator::updateFromOccBlocks(const BlockIndexList& occ_blocks) {
   esdf_timer.Stop();
 }
 
+void EsdfOccIntegrator::updateFromOccVoxels(
+    const GlobalIndexList& occ_voxels, bool clear_updated_flag) {
+  // The changed voxels cover all the changes of the scan, also in the updated
+  // blocks without any of them.
+  if (clear_updated_flag) {
+    BlockIndexList occ_blocks;
+    occ_layer_->getAllUpdatedBlocks(Update::kEsdf, &occ_blocks);
+    for (const BlockIndex& block_index : occ_blocks) {
+      occ_layer_->getBlockByIndex(block_index).setUpdated(Update::kEsdf, false);
+    }
+  }
+
+  DCHECK_EQ(occ_layer_->voxels_per_side(), esdf_layer_->voxels_per_side());
+  timing::Timer esdf_timer("esdf_occ");
+
+  timing::Timer propagate_timer("esdf_occ/propagate_occ_voxels");
+  const FloatingPoint voxels_per_side_inv = 1.0 / esdf_voxels_per_side_;
+  AlignedVector<VoxelKey> voxel_keys;
+  std::vector<EsdfVoxel*> esdf_voxels;
+  std::vector<bool> occupied_voxels;
+  voxel_keys.reserve(occ_voxels.size());
+  esdf_voxels.reserve(occ_voxels.size());
+  occupied_voxels.reserve(occ_voxels.size());
+
+  BlockIndex block_index;
+  Block<OccupancyVoxel>::ConstPtr occ_block;
+  Block<EsdfVoxel>::Ptr esdf_block;
+  bool has_block = false;
+  for (const GlobalIndex& global_index : occ_voxels) {
+    const BlockIndex voxel_block_index =
+        getBlockIndexFromGlobalVoxelIndex(global_index, voxels_per_side_inv);
+    if (!has_block || voxel_block_index != block_index) {
+      has_block = true;
+      block_index = voxel_block_index;
+      occ_block = occ_layer_->getBlockPtrByIndex(block_index);
+      esdf_block = occ_block
+                       ? esdf_layer_->allocateBlockPtrByIndex(block_index)
+                       : Block<EsdfVoxel>::Ptr();
+    }
+    if (!occ_block) {
+      continue;
+    }
+
+    const VoxelIndex voxel_index =
+        getLocalFromGlobalVoxelIndex(global_index, esdf_voxels_per_side_);
+    const OccupancyVoxel& occ_voxel = occ_block->getVoxelByVoxelIndex(
+        voxel_index);
+    if (!occ_voxel.observed) {
+      continue;
+    }
+    EsdfVoxel& esdf_voxel = esdf_block->getVoxelByVoxelIndex(voxel_index);
+    const bool occupied = occ_voxel.probability_log > 0.0;
+    if (esdf_voxel.observed && esdf_voxel.fixed && !occupied) {
+      // Its distance and that of its children have to be raised.
+      VLOG(3) << "[ESDF update]: Freed voxel, updating in batch.";
+      propagate_timer.Stop();
+      esdf_timer.Stop();
+      updateFromOccLayerBatch();
+      return;
+    }
+    voxel_keys.emplace_back(block_index, voxel_index);
+    esdf_voxels.push_back(&esdf_voxel);
+    occupied_voxels.push_back(occupied);
+  }
+
+  // The occupied voxels are queued first, so that they lower their neighbors
+  // before any of them is propagated.
+  size_t num_lower = 0u;
+  for (size_t i = 0u; i < voxel_keys.size(); ++i) {
+    if (!occupied_voxels[i]) {
+      continue;
+    }
+    EsdfVoxel& esdf_voxel = *esdf_voxels[i];
+    esdf_voxel.distance = 0.0;
+    esdf_voxel.observed = true;
+    esdf_voxel.fixed = true;
+    esdf_voxel.parent.setZero();
+    if (!esdf_voxel.in_queue) {
+      esdf_voxel.in_queue = true;
+      open_.push(voxel_keys[i], esdf_voxel.distance);
+    }
+    num_lower++;
+  }
+
+  size_t num_new = 0u;
+  AlignedVector<VoxelKey> neighbors;
+  AlignedVector<float> distances;
+  AlignedVector<Eigen::Vector3i> directions;
+  for (size_t i = 0u; i < voxel_keys.size(); ++i) {
+    EsdfVoxel& esdf_voxel = *esdf_voxels[i];
+    if (occupied_voxels[i] || esdf_voxel.observed) {
+      continue;
+    }
+    esdf_voxel.distance = config_.default_distance_m;
+    esdf_voxel.observed = true;
+    esdf_voxel.fixed = false;
+    esdf_voxel.parent.setZero();
+    num_new++;
+
+    // The neighbors propagate their distances to the new voxel.
+    neighbors.clear();
+    distances.clear();
+    directions.clear();
+    getNeighborsAndDistances(
+        voxel_keys[i].first, voxel_keys[i].second, &neighbors, &distances,
+        &directions);
+    for (const VoxelKey& neighbor : neighbors) {
+      Block<EsdfVoxel>::Ptr neighbor_block =
+          esdf_layer_->getBlockPtrByIndex(neighbor.first);
+      if (!neighbor_block) {
+        continue;
+      }
+      EsdfVoxel& neighbor_voxel =
+          neighbor_block->getVoxelByVoxelIndex(neighbor.second);
+      if (neighbor_voxel.observed && !neighbor_voxel.in_queue &&
+          neighbor_voxel.distance < config_.max_distance_m) {
+        neighbor_voxel.in_queue = true;
+        open_.push(neighbor, neighbor_voxel.distance);
+      }
+    }
+  }
+  propagate_timer.Stop();
+  VLOG(3) << "[ESDF update]: Lower: " << num_lower << " New: " << num_new;
+
+  timing::Timer update_timer("esdf_occ/update_esdf");
+  processOpenSet();
+  update_timer.Stop();
+
+  esdf_timer.Stop();
+}
+
 void EsdfOccIntegrator::processOpenSet() {
   size_t num_updates = 0u;
   while (!open_.empty()) {
@@ -1,5 +1,11 @@
 #include "voxblox/integrator/integrator_utils.h"
 
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace voxblox {
 
 ThreadSafeIndex* ThreadSafeIndexFactory::get(
@@ -131,7 +137,9 @@ void RayCaster::setupRayCaster(
   if (std::isnan(start_scaled.x()) || std::isnan(start_scaled.y()) ||
       std::isnan(start_scaled.z()) || std::isnan(end_scaled.x()) ||
       std::isnan(end_scaled.y()) || std::isnan(end_scaled.z())) {
+    // No indices at all.
     ray_length_in_steps_ = 0;
+    current_step_ = 1;
     return;
   }
 
@@ -181,4 +189,164 @@ void RayCaster::setupRayCaster(
                                        : ray_step_signs_.z() / ray_scaled.z());
 }
 
+constexpr size_t PacketRayCaster::kPacketSize;
+constexpr size_t PacketRayCaster::kBatchSize;
+
+void PacketRayCaster::castRays() {
+  // The number of indices of each ray is known from its setup, so each lane
+  // writes its ray straight to its place in the buffer.
+  ray_offsets_.resize(rays_.size() + 1u);
+  for (size_t ray = 0u; ray < rays_.size(); ++ray) {
+    ray_offsets_[ray + 1u] =
+        ray_offsets_[ray] + rays_[ray].numRemainingIndices();
+  }
+  indices_.resize(ray_offsets_.back());
+
+  Lanes lanes;
+  size_t next_ray = 0u;
+  size_t busy_lanes = 0u;
+  for (size_t lane = 0u; lane < kPacketSize; ++lane) {
+    if (loadNextRay(lane, &next_ray, &lanes)) {
+      ++busy_lanes;
+    }
+  }
+
+  while (busy_lanes > 0u) {
+    // Until the first ray of the packet ends, every lane returns an index and
+    // steps, without any check.
+    size_t steps = std::numeric_limits<size_t>::max();
+    for (size_t lane = 0u; lane < kPacketSize; ++lane) {
+      if (lanes.advance[lane] != 0u) {
+        steps = std::min(steps, lanes.remaining[lane]);
+      }
+    }
+
+    for (size_t step = 0u; step < steps; ++step) {
+      for (size_t lane = 0u; lane < kPacketSize; ++lane) {
+        *lanes.next_index[lane] = GlobalIndex(
+            lanes.curr_index[0][lane], lanes.curr_index[1][lane],
+            lanes.curr_index[2][lane]);
+        lanes.next_index[lane] += lanes.advance[lane];
+      }
+      stepLanes(&lanes);
+    }
+
+    for (size_t lane = 0u; lane < kPacketSize; ++lane) {
+      if (lanes.advance[lane] == 0u) {
+        continue;
+      }
+      lanes.remaining[lane] -= steps;
+      if (lanes.remaining[lane] == 0u &&
+          !loadNextRay(lane, &next_ray, &lanes)) {
+        --busy_lanes;
+      }
+    }
+  }
+}
+
+bool PacketRayCaster::loadNextRay(
+    const size_t lane, size_t* next_ray, Lanes* lanes) {
+  DCHECK(next_ray != nullptr);
+  DCHECK(lanes != nullptr);
+  constexpr LongIndexElement kMaxLaneIndex =
+      std::numeric_limits<int32_t>::max();
+
+  while (*next_ray < rays_.size()) {
+    const size_t ray = (*next_ray)++;
+    const RayCaster& ray_caster = rays_[ray];
+    const size_t num_indices = ray_caster.numRemainingIndices();
+    if (num_indices == 0u) {
+      continue;
+    }
+
+    // An index moves at most one voxel per step.
+    if ((ray_caster.curr_index_.cwiseAbs().array() +
+         static_cast<LongIndexElement>(num_indices))
+            .maxCoeff() >= kMaxLaneIndex) {
+      RayCaster scalar_ray_caster(ray_caster);
+      GlobalIndex* index = indices_.data() + ray_offsets_[ray];
+      while (scalar_ray_caster.nextRayIndex(index)) {
+        ++index;
+      }
+      continue;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+      lanes->t_to_next_boundary[i][lane] = ray_caster.t_to_next_boundary_(i);
+      lanes->t_step_size[i][lane] = ray_caster.t_step_size_(i);
+      lanes->curr_index[i][lane] =
+          static_cast<int32_t>(ray_caster.curr_index_(i));
+      lanes->ray_step_signs[i][lane] = ray_caster.ray_step_signs_(i);
+    }
+    lanes->next_index[lane] = indices_.data() + ray_offsets_[ray];
+    lanes->advance[lane] = 1u;
+    lanes->remaining[lane] = num_indices;
+    return true;
+  }
+
+  // Idle lane, stepping it changes nothing.
+  for (int i = 0; i < 3; ++i) {
+    lanes->t_to_next_boundary[i][lane] = 0.0f;
+    lanes->t_step_size[i][lane] = 0.0f;
+    lanes->curr_index[i][lane] = 0;
+    lanes->ray_step_signs[i][lane] = 0;
+  }
+  lanes->next_index[lane] = &lanes->spare_index;
+  lanes->advance[lane] = 0u;
+  lanes->remaining[lane] = 0u;
+  return false;
+}
+
+void PacketRayCaster::stepLanes(Lanes* lanes) {
+  DCHECK(lanes != nullptr);
+  // The axis of each lane is the first minimum of t_to_next_boundary, as
+  // Eigen's minCoeff: a strict comparison, so ties and NaNs keep the lower
+  // axis.
+#ifdef __AVX2__
+  static_assert(kPacketSize == 8u, "One AVX register per component.");
+  __m256 t[3], t_step[3];
+  __m256i index[3], sign[3];
+  for (int i = 0; i < 3; ++i) {
+    t[i] = _mm256_load_ps(lanes->t_to_next_boundary[i]);
+    t_step[i] = _mm256_load_ps(lanes->t_step_size[i]);
+    index[i] = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(lanes->curr_index[i]));
+    sign[i] = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(lanes->ray_step_signs[i]));
+  }
+
+  const __m256 y_less = _mm256_cmp_ps(t[1], t[0], _CMP_LT_OQ);
+  const __m256 t_min = _mm256_blendv_ps(t[0], t[1], y_less);
+  const __m256 z_less = _mm256_cmp_ps(t[2], t_min, _CMP_LT_OQ);
+  __m256 step_axis[3];
+  step_axis[2] = z_less;
+  step_axis[1] = _mm256_andnot_ps(z_less, y_less);
+  step_axis[0] = _mm256_andnot_ps(
+      _mm256_or_ps(y_less, z_less),
+      _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+
+  for (int i = 0; i < 3; ++i) {
+    _mm256_store_ps(
+        lanes->t_to_next_boundary[i],
+        _mm256_blendv_ps(t[i], _mm256_add_ps(t[i], t_step[i]), step_axis[i]));
+    _mm256_store_si256(
+        reinterpret_cast<__m256i*>(lanes->curr_index[i]),
+        _mm256_add_epi32(
+            index[i],
+            _mm256_and_si256(sign[i], _mm256_castps_si256(step_axis[i]))));
+  }
+#else
+  for (size_t lane = 0u; lane < kPacketSize; ++lane) {
+    const float t_x = lanes->t_to_next_boundary[0][lane];
+    const float t_y = lanes->t_to_next_boundary[1][lane];
+    const float t_z = lanes->t_to_next_boundary[2][lane];
+    const bool y_less = t_y < t_x;
+    const bool z_less = t_z < (y_less ? t_y : t_x);
+    const int axis = z_less ? 2 : (y_less ? 1 : 0);
+    lanes->t_to_next_boundary[axis][lane] += lanes->t_step_size[axis][lane];
+    lanes->curr_index[axis][lane] += lanes->ray_step_signs[axis][lane];
+  }
+#endif
+}
+
 }  // namespace voxblox
@@ -0,0 +1,243 @@
+#include "voxblox/integrator/occupancy_integrator.h"
+
+#include <list>
+#include <memory>
+
+namespace voxblox {
+
+void OccupancyIntegrator::integratePointCloud(
+    const Transformation& T_G_C, const Pointcloud& points_C) {
+  timing::Timer integrate_timer("integrate_occ");
+
+  clearList();
+
+  timing::Timer cast_rays_timer("integrate_occ/cast_rays");
+  // The counts do not depend on which thread casts which ray.
+  std::unique_ptr<ThreadSafeIndex> index_getter(
+      new MixedThreadSafeIndex(points_C.size()));
+  std::vector<RayCountsMap> thread_ray_counts(config_.integrator_threads);
+
+  std::list<std::thread> integration_threads;
+  for (size_t i = 0; i < config_.integrator_threads; ++i) {
+    integration_threads.emplace_back(
+        &OccupancyIntegrator::countRaysFunction, this, std::cref(T_G_C),
+        std::cref(points_C), index_getter.get(), &thread_ray_counts[i]);
+  }
+  for (std::thread& thread : integration_threads) {
+    thread.join();
+  }
+  cast_rays_timer.Stop();
+
+  timing::Timer update_voxels_timer("integrate_occ/update_occupancy");
+  // Allocate the blocks in a fixed order, so that the lists of changed voxels
+  // do not depend on the threads either.
+  BlockIndexList block_indices;
+  for (const RayCountsMap& ray_counts : thread_ray_counts) {
+    for (const RayCountsMap::value_type& block_counts : ray_counts) {
+      block_indices.push_back(block_counts.first);
+    }
+  }
+  std::sort(
+      block_indices.begin(), block_indices.end(),
+      [](const BlockIndex& a, const BlockIndex& b) {
+        return std::lexicographical_compare(
+            a.data(), a.data() + 3, b.data(), b.data() + 3);
+      });
+  block_indices.erase(
+      std::unique(block_indices.begin(), block_indices.end()),
+      block_indices.end());
+
+  std::vector<Block<OccupancyVoxel>::Ptr> blocks;
+  blocks.reserve(block_indices.size());
+  for (const BlockIndex& block_index : block_indices) {
+    blocks.push_back(layer_->allocateBlockPtrByIndex(block_index));
+    blocks.back()->setUpdatedAll();
+  }
+
+  std::vector<GlobalIndexVector> block_insert_lists(blocks.size());
+  std::vector<GlobalIndexVector> block_delete_lists(blocks.size());
+  std::vector<GlobalIndexVector> block_changed_lists(blocks.size());
+  MixedThreadSafeIndex block_getter(blocks.size());
+  integration_threads.clear();
+  for (size_t i = 0; i < config_.integrator_threads; ++i) {
+    integration_threads.emplace_back(
+        &OccupancyIntegrator::updateBlocksFunction, this, std::cref(blocks),
+        std::cref(thread_ray_counts), &block_getter, &block_insert_lists,
+        &block_delete_lists, &block_changed_lists);
+  }
+  for (std::thread& thread : integration_threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0u; i < blocks.size(); ++i) {
+    insert_list_.insert(
+        insert_list_.end(), block_insert_lists[i].begin(),
+        block_insert_lists[i].end());
+    delete_list_.insert(
+        delete_list_.end(), block_delete_lists[i].begin(),
+        block_delete_lists[i].end());
+    changed_list_.insert(
+        changed_list_.end(), block_changed_lists[i].begin(),
+        block_changed_lists[i].end());
+  }
+  update_voxels_timer.Stop();
+
+  integrate_timer.Stop();
+}
+
+void OccupancyIntegrator::countRaysFunction(
+    const Transformation& T_G_C, const Pointcloud& points_C,
+    ThreadSafeIndex* index_getter, RayCountsMap* ray_counts) const {
+  DCHECK(index_getter != nullptr);
+  DCHECK(ray_counts != nullptr);
+
+  const Point& origin = T_G_C.getPosition();
+  const Point start_scaled = origin * voxel_size_inv_;
+  const size_t num_voxels_per_block =
+      voxels_per_side_ * voxels_per_side_ * voxels_per_side_;
+
+  // The rays are cast in batches, several at a time, and then counted ray by
+  // ray. A ray ends in a hit, or only clears up to the max ray length.
+  PacketRayCaster packet_ray_caster;
+  std::vector<bool> ray_hits;
+
+  size_t point_idx;
+  bool points_left = true;
+  while (points_left) {
+    packet_ray_caster.clear();
+    ray_hits.clear();
+    while (ray_hits.size() < PacketRayCaster::kBatchSize &&
+           (points_left = index_getter->getNextIndex(&point_idx))) {
+      const Point point_G = T_G_C * points_C[point_idx];
+      const FloatingPoint ray_distance = (point_G - origin).norm();
+      if (ray_distance < config_.min_ray_length_m) {
+        continue;
+      } else if (ray_distance > config_.max_ray_length_m) {
+        // Simply clear up until the max ray distance in this case.
+        const Ray unit_ray = (point_G - origin).normalized();
+        packet_ray_caster.addRay(RayCaster(
+            start_scaled,
+            (origin + config_.max_ray_length_m * unit_ray) * voxel_size_inv_));
+        ray_hits.push_back(false);
+      } else {
+        packet_ray_caster.addRay(
+            RayCaster(start_scaled, point_G * voxel_size_inv_));
+        ray_hits.push_back(true);
+      }
+    }
+    packet_ray_caster.castRays();
+
+    for (size_t ray = 0u; ray < ray_hits.size(); ++ray) {
+      const GlobalIndex* ray_begin = packet_ray_caster.rayBegin(ray);
+      const GlobalIndex* ray_end = packet_ray_caster.rayEnd(ray);
+      // Hits of two voxels or fewer do not update the map.
+      if (ray_hits[ray] && ray_end - ray_begin <= 2) {
+        continue;
+      }
+
+      BlockIndex block_idx;
+      BlockRayCounts* block_counts = nullptr;
+      for (const GlobalIndex* global_voxel_idx = ray_begin;
+           global_voxel_idx != ray_end; ++global_voxel_idx) {
+        const BlockIndex voxel_block_idx = getBlockIndexFromGlobalVoxelIndex(
+            *global_voxel_idx, voxels_per_side_inv_);
+        if (block_counts == nullptr || voxel_block_idx != block_idx) {
+          block_idx = voxel_block_idx;
+          block_counts = &(*ray_counts)[block_idx];
+          if (block_counts->empty()) {
+            block_counts->resize(num_voxels_per_block);
+          }
+        }
+
+        const VoxelIndex local_voxel_idx =
+            getLocalFromGlobalVoxelIndex(*global_voxel_idx, voxels_per_side_);
+        const size_t linear_index =
+            local_voxel_idx.x() +
+            voxels_per_side_ *
+                (local_voxel_idx.y() + local_voxel_idx.z() * voxels_per_side_);
+        RayCounts& voxel_counts = (*block_counts)[linear_index];
+        if (ray_hits[ray] && global_voxel_idx + 1 == ray_end) {
+          ++voxel_counts.hits;
+        } else {
+          ++voxel_counts.misses;
+        }
+      }
+    }
+  }
+}
+
+void OccupancyIntegrator::updateBlocksFunction(
+    const std::vector<Block<OccupancyVoxel>::Ptr>& blocks,
+    const std::vector<RayCountsMap>& thread_ray_counts,
+    ThreadSafeIndex* block_getter,
+    std::vector<GlobalIndexVector>* block_insert_lists,
+    std::vector<GlobalIndexVector>* block_delete_lists,
+    std::vector<GlobalIndexVector>* block_changed_lists) const {
+  DCHECK(block_getter != nullptr);
+  DCHECK(block_insert_lists != nullptr);
+  DCHECK(block_delete_lists != nullptr);
+  DCHECK(block_changed_lists != nullptr);
+
+  const size_t num_voxels_per_block =
+      voxels_per_side_ * voxels_per_side_ * voxels_per_side_;
+  BlockRayCounts block_counts(num_voxels_per_block);
+
+  size_t block_list_idx;
+  while (block_getter->getNextIndex(&block_list_idx)) {
+    Block<OccupancyVoxel>& block = *blocks[block_list_idx];
+    const BlockIndex block_idx = block.block_index();
+
+    // Merge the counts of all the threads.
+    std::fill(block_counts.begin(), block_counts.end(), RayCounts());
+    for (const RayCountsMap& ray_counts : thread_ray_counts) {
+      const RayCountsMap::const_iterator it = ray_counts.find(block_idx);
+      if (it == ray_counts.end()) {
+        continue;
+      }
+      for (size_t i = 0u; i < num_voxels_per_block; ++i) {
+        block_counts[i].hits += it->second[i].hits;
+        block_counts[i].misses += it->second[i].misses;
+      }
+    }
+
+    GlobalIndexVector& insert_list = (*block_insert_lists)[block_list_idx];
+    GlobalIndexVector& delete_list = (*block_delete_lists)[block_list_idx];
+    GlobalIndexVector& changed_list = (*block_changed_lists)[block_list_idx];
+    for (size_t i = 0u; i < num_voxels_per_block; ++i) {
+      const RayCounts& voxel_counts = block_counts[i];
+      if (voxel_counts.hits == 0u && voxel_counts.misses == 0u) {
+        continue;
+      }
+
+      OccupancyVoxel& occ_voxel = block.getVoxelByLinearIndex(i);
+      const bool was_observed = occ_voxel.observed;
+      const bool was_occupied = occ_voxel.occupied;
+      if (config_.update_per_ray) {
+        updateOccupancyVoxelLogOdds(
+            voxel_counts.hits * prob_hit_log_ +
+                voxel_counts.misses * prob_miss_log_,
+            &occ_voxel);
+      } else {
+        updateOccupancyVoxel(voxel_counts.hits > 0u, &occ_voxel);
+      }
+      // Occupied as the ESDF integrators take it: more likely than free.
+      occ_voxel.occupied = occ_voxel.probability_log > 0.0f;
+
+      if (was_observed && occ_voxel.occupied == was_occupied) {
+        continue;
+      }
+      const GlobalIndex global_voxel_idx =
+          getGlobalVoxelIndexFromBlockAndVoxelIndex(
+              block_idx, block.computeVoxelIndexFromLinearIndex(i),
+              voxels_per_side_);
+      changed_list.push_back(global_voxel_idx);
+      if (occ_voxel.occupied && !was_occupied) {
+        insert_list.push_back(global_voxel_idx);
+      } else if (!occ_voxel.occupied && was_occupied) {
+        delete_list.push_back(global_voxel_idx);
+      }
+    }
+  }
+}
+
+}  // namespace voxblox
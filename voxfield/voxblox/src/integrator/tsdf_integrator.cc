@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <list>
+#include <vector>
 
 namespace voxblox {
 
@@ -270,33 +271,58 @@ void SimpleTsdfIntegrator::integrateFunction(
     ThreadSafeIndex* index_getter) {
   DCHECK(index_getter != nullptr);
 
-  size_t point_idx;
-  while (index_getter->getNextIndex(&point_idx)) {
-    const Point& point_C = points_C[point_idx];
-    const Color& color = colors[point_idx];
-    bool is_clearing;
-    if (!isPointValid(point_C, freespace_points, &is_clearing)) {
-      continue;
-    }
-
-    const Point origin = T_G_C.getPosition();
-    const Point point_G = T_G_C * point_C;
+  const Point origin = T_G_C.getPosition();
 
-    RayCaster ray_caster(
-        origin, point_G, is_clearing, config_.voxel_carving_enabled,
-        config_.max_ray_length_m, voxel_size_inv_,
-        config_.default_truncation_distance);
+  // The rays of this thread are cast in batches, several at a time, into a
+  // buffer of voxel indices that is then integrated ray by ray.
+  PacketRayCaster packet_ray_caster;
+  std::vector<size_t> ray_point_indices;
+  Pointcloud ray_points_G;
 
-    Block<TsdfVoxel>::Ptr block = nullptr;
-    BlockIndex block_idx;
-    GlobalIndex global_voxel_idx;
-    while (ray_caster.nextRayIndex(&global_voxel_idx)) {
-      TsdfVoxel* voxel =
-          allocateStorageAndGetVoxelPtr(global_voxel_idx, &block, &block_idx);
+  size_t point_idx;
+  bool points_left = true;
+  while (points_left) {
+    packet_ray_caster.clear();
+    ray_point_indices.clear();
+    ray_points_G.clear();
+    while (ray_point_indices.size() < PacketRayCaster::kBatchSize &&
+           (points_left = index_getter->getNextIndex(&point_idx))) {
+      const Point& point_C = points_C[point_idx];
+      bool is_clearing;
+      if (!isPointValid(point_C, freespace_points, &is_clearing)) {
+        continue;
+      }
 
-      const float weight = getVoxelWeight(point_C);
+      const Point point_G = T_G_C * point_C;
 
-      updateTsdfVoxel(origin, point_G, global_voxel_idx, color, weight, voxel);
+      packet_ray_caster.addRay(RayCaster(
+          origin, point_G, is_clearing, config_.voxel_carving_enabled,
+          config_.max_ray_length_m, voxel_size_inv_,
+          config_.default_truncation_distance));
+      ray_point_indices.push_back(point_idx);
+      ray_points_G.push_back(point_G);
+    }
+    packet_ray_caster.castRays();
+
+    for (size_t ray = 0u; ray < ray_point_indices.size(); ++ray) {
+      const Point& point_C = points_C[ray_point_indices[ray]];
+      const Color& color = colors[ray_point_indices[ray]];
+      const Point& point_G = ray_points_G[ray];
+
+      Block<TsdfVoxel>::Ptr block = nullptr;
+      BlockIndex block_idx;
+      for (const GlobalIndex* global_voxel_idx =
+               packet_ray_caster.rayBegin(ray);
+           global_voxel_idx != packet_ray_caster.rayEnd(ray);
+           ++global_voxel_idx) {
+        TsdfVoxel* voxel = allocateStorageAndGetVoxelPtr(
+            *global_voxel_idx, &block, &block_idx);
+
+        const float weight = getVoxelWeight(point_C);
+
+        updateTsdfVoxel(
+            origin, point_G, *global_voxel_idx, color, weight, voxel);
+      }
     }
   }
 }
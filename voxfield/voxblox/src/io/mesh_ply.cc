@@ -59,6 +59,22 @@ bool outputMeshLayerAsPly(
   return success;
 }
 
+bool outputConnectedMeshAsPly(
+    const std::string& filename, IncrementalConnectedMesh* connected_mesh) {
+  CHECK_NOTNULL(connected_mesh);
+  Mesh combined_mesh;
+  connected_mesh->getConnectedMesh(&combined_mesh);
+  if (combined_mesh.size() == 0u) {
+    return false;
+  }
+
+  bool success = outputMeshAsPly(filename, combined_mesh);
+  if (!success) {
+    LOG(WARNING) << "Saving to PLY failed!";
+  }
+  return success;
+}
+
 bool outputMeshAsPly(const std::string& filename, const Mesh& mesh) {
   std::ofstream stream(filename.c_str());
 
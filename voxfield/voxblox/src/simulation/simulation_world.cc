@@ -1,9 +1,54 @@
 #include "voxblox/simulation/simulation_world.h"
 
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <vector>
+
+#include "voxblox/integrator/integrator_utils.h"
+
 namespace voxblox {
 
+namespace {
+
+/**
+ * Whether the ray enters the box before max_dist. A ray parallel to a face of
+ * the box only hits it if it starts between the planes of that face.
+ */
+bool rayEntersBox(
+    const Point& ray_origin, const Point& ray_direction, const Point& min_point,
+    const Point& max_point, FloatingPoint max_dist) {
+  FloatingPoint t_enter = 0.0;
+  FloatingPoint t_exit = max_dist;
+  for (int i = 0; i < 3; ++i) {
+    if (ray_direction(i) == 0.0) {
+      if (ray_origin(i) < min_point(i) || ray_origin(i) > max_point(i)) {
+        return false;
+      }
+      continue;
+    }
+    const FloatingPoint inv_dir = 1.0 / ray_direction(i);
+    FloatingPoint t_min = (min_point(i) - ray_origin(i)) * inv_dir;
+    FloatingPoint t_max = (max_point(i) - ray_origin(i)) * inv_dir;
+    if (t_min > t_max) {
+      std::swap(t_min, t_max);
+    }
+    t_enter = std::max(t_enter, t_min);
+    t_exit = std::min(t_exit, t_max);
+    if (t_enter > t_exit) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 SimulationWorld::SimulationWorld()
-    : min_bound_(-5.0, -5.0, -1.0), max_bound_(5.0, 5.0, 9.0), generator_(0) {}
+    : min_bound_(-5.0, -5.0, -1.0),
+      max_bound_(5.0, 5.0, 9.0),
+      generator_(0),
+      num_threads_(std::max(1u, std::thread::hardware_concurrency())) {}
 
 void SimulationWorld::addObject(std::unique_ptr<Object> object) {
   objects_.emplace_back(std::move(object));
@@ -64,6 +109,8 @@ void SimulationWorld::getPointcloudFromViewpoint(
     const Point& view_origin, const Point& view_direction,
     const Eigen::Vector2i& camera_res, FloatingPoint fov_h_rad,
     FloatingPoint max_dist, Pointcloud* ptcloud, Colors* colors) const {
+  CHECK_NOTNULL(ptcloud);
+  CHECK_NOTNULL(colors);
   // Focal length based on fov.
   const FloatingPoint focal_length =
       camera_res.x() / (2 * tan(fov_h_rad / 2.0));
@@ -78,44 +125,21 @@ void SimulationWorld::getPointcloudFromViewpoint(
   const Rotation ray_rotation(rotation_quaternion);
 
   // Now actually iterate over all pixels.
+  AlignedVector<Point> ray_directions;
   for (int u = -camera_res.x() / 2; u < camera_res.x() / 2; ++u) {
     for (int v = -camera_res.y() / 2; v < camera_res.y() / 2; ++v) {
       Point ray_camera_direction =
           Point(1.0, u / focal_length, v / focal_length);
-      Point ray_direction =
-          ray_rotation.rotate((ray_camera_direction).normalized());
-
-      // Cast this ray into every object.
-      bool ray_valid = false;
-      FloatingPoint ray_dist = max_dist;
-      Point ray_intersect = Point::Zero();
-      Color ray_color;
-      for (const std::unique_ptr<Object>& object : objects_) {
-        Point object_intersect;
-        FloatingPoint object_dist;
-        bool intersects = object->getRayIntersection(
-            view_origin, ray_direction, max_dist, &object_intersect,
-            &object_dist);
-        if (intersects) {
-          if (!ray_valid || object_dist < ray_dist) {
-            ray_valid = true;
-            ray_dist = object_dist;
-            ray_intersect = object_intersect;
-            ray_color = object->getColor();
-          }
-        }
-      }
-      if (ray_valid) {
-        if (std::isnan(ray_intersect.x()) || std::isnan(ray_intersect.y()) ||
-            std::isnan(ray_intersect.z())) {
-          LOG(ERROR) << "Simulation ray intersect is NaN!";
-          continue;
-        }
-        ptcloud->push_back(ray_intersect);
-        colors->push_back(ray_color);
-      }
+      ray_directions.push_back(
+          ray_rotation.rotate((ray_camera_direction).normalized()));
     }
   }
+
+  AlignedVector<Point> hit_ray_directions;
+  std::vector<FloatingPoint> ray_dists;
+  castRays(
+      view_origin, ray_directions, std::max(1, camera_res.y() / 2 * 2),
+      max_dist, ptcloud, &hit_ray_directions, &ray_dists, colors);
 }
 
 void SimulationWorld::getNoisyPointcloudFromTransform(
@@ -136,6 +160,8 @@ void SimulationWorld::getNoisyPointcloudFromViewpoint(
     const Eigen::Vector2i& camera_res, FloatingPoint fov_h_rad,
     FloatingPoint max_dist, FloatingPoint noise_sigma, Pointcloud* ptcloud,
     Colors* colors) {
+  CHECK_NOTNULL(ptcloud);
+  CHECK_NOTNULL(colors);
   // Focal length based on fov.
   const FloatingPoint focal_length =
       camera_res.x() / (2 * tan(fov_h_rad / 2.0));
@@ -147,51 +173,224 @@ void SimulationWorld::getNoisyPointcloudFromViewpoint(
       nominal_view_direction, view_direction));
 
   // Now actually iterate over all pixels.
+  AlignedVector<Point> ray_directions;
   for (int u = -camera_res.x() / 2; u < camera_res.x() / 2; ++u) {
     for (int v = -camera_res.y() / 2; v < camera_res.y() / 2; ++v) {
       Point ray_camera_direction =
           Point(1.0, u / focal_length, v / focal_length);
-      Point ray_direction =
-          ray_rotation.rotate((ray_camera_direction).normalized());
-
-      // Cast this ray into every object.
-      bool ray_valid = false;
-      FloatingPoint ray_dist = max_dist;
-      Point ray_intersect = Point::Zero();
-      Color ray_color;
-      for (const std::unique_ptr<Object>& object : objects_) {
-        Point object_intersect;
-        FloatingPoint object_dist;
-        bool intersects = object->getRayIntersection(
-            view_origin, ray_direction, max_dist, &object_intersect,
-            &object_dist);
-        if (intersects) {
-          if (!ray_valid || object_dist < ray_dist) {
-            ray_valid = true;
-            ray_dist = object_dist;
-            ray_intersect = object_intersect;
-            ray_color = object->getColor();
-          }
-        }
+      ray_directions.push_back(
+          ray_rotation.rotate((ray_camera_direction).normalized()));
+    }
+  }
+
+  Pointcloud ray_intersects;
+  AlignedVector<Point> hit_ray_directions;
+  std::vector<FloatingPoint> ray_dists;
+  castRays(
+      view_origin, ray_directions, std::max(1, camera_res.y() / 2 * 2),
+      max_dist, &ray_intersects, &hit_ray_directions, &ray_dists, colors);
+
+  // Apply noise now, in the order of the rays so that it does not depend on
+  // the threads.
+  addNoiseToRays(
+      view_origin, hit_ray_directions, ray_dists, noise_sigma,
+      &ray_intersects);
+  ptcloud->insert(ptcloud->end(), ray_intersects.begin(), ray_intersects.end());
+}
+
+void SimulationWorld::getLidarPointcloudFromTransform(
+    const Transformation& pose, int num_beams, int num_columns,
+    FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+    FloatingPoint max_dist, Pointcloud* ptcloud, Colors* colors) const {
+  CHECK_NOTNULL(ptcloud);
+  CHECK_NOTNULL(colors);
+  AlignedVector<Point> ray_directions;
+  getLidarRayDirections(
+      pose.getRotation(), num_beams, num_columns, min_elevation_rad,
+      max_elevation_rad, &ray_directions);
+
+  AlignedVector<Point> hit_ray_directions;
+  std::vector<FloatingPoint> ray_dists;
+  castRays(
+      pose.getPosition(), ray_directions, num_columns, max_dist, ptcloud,
+      &hit_ray_directions, &ray_dists, colors);
+}
+
+void SimulationWorld::getNoisyLidarPointcloudFromTransform(
+    const Transformation& pose, int num_beams, int num_columns,
+    FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+    FloatingPoint max_dist, FloatingPoint noise_sigma, Pointcloud* ptcloud,
+    Colors* colors) {
+  CHECK_NOTNULL(ptcloud);
+  CHECK_NOTNULL(colors);
+  AlignedVector<Point> ray_directions;
+  getLidarRayDirections(
+      pose.getRotation(), num_beams, num_columns, min_elevation_rad,
+      max_elevation_rad, &ray_directions);
+
+  Pointcloud ray_intersects;
+  AlignedVector<Point> hit_ray_directions;
+  std::vector<FloatingPoint> ray_dists;
+  castRays(
+      pose.getPosition(), ray_directions, num_columns, max_dist,
+      &ray_intersects, &hit_ray_directions, &ray_dists, colors);
+
+  addNoiseToRays(
+      pose.getPosition(), hit_ray_directions, ray_dists, noise_sigma,
+      &ray_intersects);
+  ptcloud->insert(ptcloud->end(), ray_intersects.begin(), ray_intersects.end());
+}
+
+void SimulationWorld::getLidarRayDirections(
+    const Rotation& rotation, int num_beams, int num_columns,
+    FloatingPoint min_elevation_rad, FloatingPoint max_elevation_rad,
+    AlignedVector<Point>* ray_directions) const {
+  CHECK_NOTNULL(ray_directions);
+  CHECK_GT(num_beams, 0);
+  CHECK_GT(num_columns, 0);
+  ray_directions->clear();
+  ray_directions->reserve(num_beams * num_columns);
+  for (int beam = 0; beam < num_beams; ++beam) {
+    const FloatingPoint elevation =
+        num_beams == 1
+            ? min_elevation_rad
+            : min_elevation_rad + (max_elevation_rad - min_elevation_rad) *
+                                      beam / (num_beams - 1);
+    for (int column = 0; column < num_columns; ++column) {
+      const FloatingPoint azimuth = 2.0 * M_PI * column / num_columns;
+      ray_directions->push_back(rotation.rotate(Point(
+          std::cos(elevation) * std::cos(azimuth),
+          std::cos(elevation) * std::sin(azimuth), std::sin(elevation))));
+    }
+  }
+}
+
+void SimulationWorld::getObjectBounds(
+    AlignedVector<ObjectBounds>* object_bounds) const {
+  CHECK_NOTNULL(object_bounds);
+  // Padding of the bounding boxes, so that rounding errors never cull an
+  // object that would be hit or be the closest.
+  constexpr FloatingPoint kBoundingBoxPadding = 1e-3;
+  object_bounds->clear();
+  for (const std::unique_ptr<Object>& object : objects_) {
+    ObjectBounds bounds;
+    bounds.object = object.get();
+    bounds.bounded =
+        object->getBoundingBox(&bounds.min_point, &bounds.max_point);
+    if (bounds.bounded) {
+      bounds.min_point -= Point::Constant(kBoundingBoxPadding);
+      bounds.max_point += Point::Constant(kBoundingBoxPadding);
+    }
+    object_bounds->push_back(bounds);
+  }
+}
+
+bool SimulationWorld::castRay(
+    const AlignedVector<ObjectBounds>& object_bounds, const Point& ray_origin,
+    const Point& ray_direction, FloatingPoint max_dist, Point* ray_intersect,
+    FloatingPoint* ray_dist, Color* ray_color) const {
+  // Cast this ray into every object that could be hit before the closest
+  // intersection so far.
+  bool ray_valid = false;
+  *ray_dist = max_dist;
+  for (const ObjectBounds& bounds : object_bounds) {
+    if (bounds.bounded &&
+        !rayEntersBox(
+            ray_origin, ray_direction, bounds.min_point, bounds.max_point,
+            *ray_dist)) {
+      continue;
+    }
+    Point object_intersect;
+    FloatingPoint object_dist;
+    bool intersects = bounds.object->getRayIntersection(
+        ray_origin, ray_direction, max_dist, &object_intersect, &object_dist);
+    if (intersects) {
+      if (!ray_valid || object_dist < *ray_dist) {
+        ray_valid = true;
+        *ray_dist = object_dist;
+        *ray_intersect = object_intersect;
+        *ray_color = bounds.object->getColor();
       }
-      if (ray_valid) {
-        if (std::isnan(ray_intersect.x()) || std::isnan(ray_intersect.y()) ||
-            std::isnan(ray_intersect.z())) {
-          LOG(ERROR) << "Simulation ray intersect is NaN!";
-          continue;
-        }
-        // Apply noise now!
-        FloatingPoint noise = getNoise(noise_sigma);
-        ray_dist += noise;
-        if (ray_dist < 0.0) {
-          ray_dist = 0.0;
-        }
-        ray_intersect = view_origin + ray_dist * ray_direction;
-
-        ptcloud->push_back(ray_intersect);
-        colors->push_back(ray_color);
+    }
+  }
+  return ray_valid;
+}
+
+void SimulationWorld::castRays(
+    const Point& ray_origin, const AlignedVector<Point>& ray_directions,
+    size_t rays_per_row, FloatingPoint max_dist, Pointcloud* ray_intersects,
+    AlignedVector<Point>* hit_ray_directions,
+    std::vector<FloatingPoint>* ray_dists, Colors* ray_colors) const {
+  CHECK_NOTNULL(ray_intersects);
+  CHECK_NOTNULL(hit_ray_directions);
+  CHECK_NOTNULL(ray_dists);
+  CHECK_NOTNULL(ray_colors);
+  CHECK_GT(rays_per_row, 0u);
+
+  AlignedVector<ObjectBounds> object_bounds;
+  getObjectBounds(&object_bounds);
+
+  // Every ray has its own slot, so the threads can fill them in any order.
+  const size_t num_rays = ray_directions.size();
+  Pointcloud intersects(num_rays);
+  std::vector<FloatingPoint> dists(num_rays);
+  Colors colors(num_rays);
+  std::vector<uint8_t> hits(num_rays, 0u);
+
+  const size_t num_rows = (num_rays + rays_per_row - 1u) / rays_per_row;
+  MixedThreadSafeIndex row_index_getter(num_rows);
+  auto cast_rows = [&]() {
+    size_t row;
+    while (row_index_getter.getNextIndex(&row)) {
+      const size_t end = std::min((row + 1u) * rays_per_row, num_rays);
+      for (size_t ray = row * rays_per_row; ray < end; ++ray) {
+        hits[ray] = castRay(
+            object_bounds, ray_origin, ray_directions[ray], max_dist,
+            &intersects[ray], &dists[ray], &colors[ray]);
       }
     }
+  };
+
+  std::list<std::thread> threads;
+  for (size_t i = 1u; i < std::min(num_threads_, num_rows); ++i) {
+    threads.emplace_back(cast_rows);
+  }
+  cast_rows();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t ray = 0u; ray < num_rays; ++ray) {
+    if (!hits[ray]) {
+      continue;
+    }
+    const Point& ray_intersect = intersects[ray];
+    if (std::isnan(ray_intersect.x()) || std::isnan(ray_intersect.y()) ||
+        std::isnan(ray_intersect.z())) {
+      LOG(ERROR) << "Simulation ray intersect is NaN!";
+      continue;
+    }
+    ray_intersects->push_back(ray_intersect);
+    hit_ray_directions->push_back(ray_directions[ray]);
+    ray_dists->push_back(dists[ray]);
+    ray_colors->push_back(colors[ray]);
+  }
+}
+
+void SimulationWorld::addNoiseToRays(
+    const Point& ray_origin, const AlignedVector<Point>& ray_directions,
+    const std::vector<FloatingPoint>& ray_dists, FloatingPoint noise_sigma,
+    Pointcloud* ray_intersects) {
+  CHECK_NOTNULL(ray_intersects);
+  CHECK_EQ(ray_directions.size(), ray_intersects->size());
+  CHECK_EQ(ray_dists.size(), ray_intersects->size());
+  for (size_t ray = 0u; ray < ray_intersects->size(); ++ray) {
+    FloatingPoint noise = getNoise(noise_sigma);
+    FloatingPoint ray_dist = ray_dists[ray] + noise;
+    if (ray_dist < 0.0) {
+      ray_dist = 0.0;
+    }
+    (*ray_intersects)[ray] = ray_origin + ray_dist * ray_directions[ray];
   }
 }
 
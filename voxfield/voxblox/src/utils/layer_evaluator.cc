@@ -0,0 +1,251 @@
+#include "voxblox/utils/layer_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace voxblox {
+
+namespace utils {
+
+ErrorStatistics::ErrorStatistics(
+    FloatingPoint histogram_bin_width, size_t num_histogram_bins)
+    : histogram_bin_width(histogram_bin_width),
+      min_error(std::numeric_limits<FloatingPoint>::max()),
+      histogram(num_histogram_bins, 0u) {
+  CHECK_GT(histogram_bin_width, 0.0);
+  CHECK_GT(num_histogram_bins, 0u);
+}
+
+void ErrorStatistics::addError(FloatingPoint error) {
+  const FloatingPoint abs_error = std::abs(error);
+  ++num_evaluated_voxels;
+  sum_squared_error += error * error;
+  sum_absolute_error += abs_error;
+  min_error = std::min(min_error, abs_error);
+  max_error = std::max(max_error, abs_error);
+  const size_t bin = std::min(
+      static_cast<size_t>(abs_error / histogram_bin_width),
+      histogram.size() - 1u);
+  ++histogram[bin];
+}
+
+void ErrorStatistics::merge(const ErrorStatistics& other) {
+  CHECK_EQ(histogram.size(), other.histogram.size());
+  num_evaluated_voxels += other.num_evaluated_voxels;
+  sum_squared_error += other.sum_squared_error;
+  sum_absolute_error += other.sum_absolute_error;
+  min_error = std::min(min_error, other.min_error);
+  max_error = std::max(max_error, other.max_error);
+  for (size_t bin = 0u; bin < histogram.size(); ++bin) {
+    histogram[bin] += other.histogram[bin];
+  }
+}
+
+FloatingPoint ErrorStatistics::rmse() const {
+  if (num_evaluated_voxels == 0u) {
+    return 0.0;
+  }
+  return std::sqrt(sum_squared_error / num_evaluated_voxels);
+}
+
+FloatingPoint ErrorStatistics::mae() const {
+  if (num_evaluated_voxels == 0u) {
+    return 0.0;
+  }
+  return sum_absolute_error / num_evaluated_voxels;
+}
+
+FloatingPoint ErrorStatistics::minError() const {
+  return num_evaluated_voxels == 0u ? 0.0 : min_error;
+}
+
+FloatingPoint ErrorStatistics::percentile(FloatingPoint quantile) const {
+  if (num_evaluated_voxels == 0u) {
+    return 0.0;
+  }
+  const double rank = std::max(
+      1.0, std::ceil(static_cast<double>(quantile) * num_evaluated_voxels));
+  size_t count = 0u;
+  for (size_t bin = 0u; bin + 1u < histogram.size(); ++bin) {
+    count += histogram[bin];
+    if (count >= rank) {
+      return std::min(max_error, (bin + 1u) * histogram_bin_width);
+    }
+  }
+  return max_error;
+}
+
+LayerEvaluationReport::LayerEvaluationReport(
+    const std::vector<FloatingPoint>& band_edges_m,
+    const std::vector<FloatingPoint>& percentiles,
+    FloatingPoint histogram_bin_width, size_t num_histogram_bins)
+    : band_edges_m(band_edges_m),
+      percentiles(percentiles),
+      total(histogram_bin_width, num_histogram_bins),
+      bands(
+          band_edges_m.size() + 1u,
+          ErrorStatistics(histogram_bin_width, num_histogram_bins)) {}
+
+void LayerEvaluationReport::addError(
+    FloatingPoint gt_distance, FloatingPoint error) {
+  const size_t band =
+      std::upper_bound(
+          band_edges_m.begin(), band_edges_m.end(), std::abs(gt_distance)) -
+      band_edges_m.begin();
+  bands[band].addError(error);
+  total.addError(error);
+}
+
+void LayerEvaluationReport::merge(const LayerEvaluationReport& other) {
+  CHECK_EQ(bands.size(), other.bands.size());
+  total.merge(other.total);
+  for (size_t band = 0u; band < bands.size(); ++band) {
+    bands[band].merge(other.bands[band]);
+  }
+  num_ignored_voxels += other.num_ignored_voxels;
+  num_non_overlapping_voxels += other.num_non_overlapping_voxels;
+}
+
+VoxelEvaluationDetails LayerEvaluationReport::getDetails() const {
+  VoxelEvaluationDetails details;
+  details.rmse = total.rmse();
+  details.max_error = total.max_error;
+  details.min_error = total.minError();
+  details.num_evaluated_voxels = total.num_evaluated_voxels;
+  details.num_ignored_voxels = num_ignored_voxels;
+  details.num_overlapping_voxels =
+      total.num_evaluated_voxels + num_ignored_voxels;
+  details.num_non_overlapping_voxels = num_non_overlapping_voxels;
+  return details;
+}
+
+namespace {
+
+FloatingPoint bandMinDistance(
+    const std::vector<FloatingPoint>& band_edges_m, size_t band) {
+  return band == 0u ? 0.0 : band_edges_m[band - 1u];
+}
+
+/// Infinite for the last band, written as -1 in the reports.
+FloatingPoint bandMaxDistance(
+    const std::vector<FloatingPoint>& band_edges_m, size_t band) {
+  return band < band_edges_m.size() ? band_edges_m[band] : -1.0;
+}
+
+void writeCsvRow(
+    const std::string& name, FloatingPoint min_distance,
+    FloatingPoint max_distance, const ErrorStatistics& statistics,
+    const std::vector<FloatingPoint>& percentiles, std::stringstream* ss) {
+  *ss << name << "," << min_distance << "," << max_distance << ","
+      << statistics.num_evaluated_voxels << "," << statistics.rmse() << ","
+      << statistics.mae() << "," << statistics.minError() << ","
+      << statistics.max_error;
+  for (const FloatingPoint quantile : percentiles) {
+    *ss << "," << statistics.percentile(quantile);
+  }
+  *ss << "\n";
+}
+
+void writeJsonStatistics(
+    const ErrorStatistics& statistics,
+    const std::vector<FloatingPoint>& percentiles, std::stringstream* ss) {
+  *ss << "\"num_evaluated_voxels\": " << statistics.num_evaluated_voxels
+      << ", \"rmse\": " << statistics.rmse() << ", \"mae\": "
+      << statistics.mae() << ", \"min_error\": " << statistics.minError()
+      << ", \"max_error\": " << statistics.max_error << ", \"percentiles\": {";
+  for (size_t i = 0u; i < percentiles.size(); ++i) {
+    *ss << (i == 0u ? "" : ", ") << "\"" << percentiles[i]
+        << "\": " << statistics.percentile(percentiles[i]);
+  }
+  *ss << "}, \"histogram\": [";
+  for (size_t bin = 0u; bin < statistics.histogram.size(); ++bin) {
+    *ss << (bin == 0u ? "" : ", ") << statistics.histogram[bin];
+  }
+  *ss << "]";
+}
+
+}  // namespace
+
+std::string LayerEvaluationReport::toString() const {
+  std::stringstream ss;
+  ss << getDetails().toString() << " MAE:                        "
+     << total.mae() << "\n";
+  for (const FloatingPoint quantile : percentiles) {
+    ss << " error percentile " << quantile << ": " << total.percentile(quantile)
+       << "\n";
+  }
+  ss << " per |gt distance| band: voxels, RMSE, max error\n";
+  for (size_t band = 0u; band < bands.size(); ++band) {
+    ss << "  [" << bandMinDistance(band_edges_m, band) << ", ";
+    if (band < band_edges_m.size()) {
+      ss << band_edges_m[band] << "): ";
+    } else {
+      ss << "inf): ";
+    }
+    ss << bands[band].num_evaluated_voxels << ", " << bands[band].rmse()
+       << ", " << bands[band].max_error << "\n";
+  }
+  ss << "========================================\n";
+  return ss.str();
+}
+
+std::string LayerEvaluationReport::toCsv() const {
+  std::stringstream ss;
+  ss << "band,min_gt_distance,max_gt_distance,num_evaluated_voxels,rmse,mae,"
+        "min_error,max_error";
+  for (const FloatingPoint quantile : percentiles) {
+    ss << ",p" << quantile * 100.0;
+  }
+  ss << "\n";
+  for (size_t band = 0u; band < bands.size(); ++band) {
+    writeCsvRow(
+        std::to_string(band), bandMinDistance(band_edges_m, band),
+        bandMaxDistance(band_edges_m, band), bands[band], percentiles, &ss);
+  }
+  writeCsvRow("all", 0.0, -1.0, total, percentiles, &ss);
+  return ss.str();
+}
+
+std::string LayerEvaluationReport::toJson() const {
+  std::stringstream ss;
+  ss << "{\n  \"num_overlapping_voxels\": "
+     << total.num_evaluated_voxels + num_ignored_voxels
+     << ",\n  \"num_non_overlapping_voxels\": " << num_non_overlapping_voxels
+     << ",\n  \"num_ignored_voxels\": " << num_ignored_voxels
+     << ",\n  \"histogram_bin_width\": " << total.histogram_bin_width
+     << ",\n  \"total\": {";
+  writeJsonStatistics(total, percentiles, &ss);
+  ss << "},\n  \"bands\": [";
+  for (size_t band = 0u; band < bands.size(); ++band) {
+    ss << (band == 0u ? "\n" : ",\n") << "    {\"min_gt_distance\": "
+       << bandMinDistance(band_edges_m, band)
+       << ", \"max_gt_distance\": " << bandMaxDistance(band_edges_m, band)
+       << ", ";
+    writeJsonStatistics(bands[band], percentiles, &ss);
+    ss << "}";
+  }
+  ss << "\n  ]\n}\n";
+  return ss.str();
+}
+
+bool LayerEvaluationReport::saveToFile(const std::string& file_path) const {
+  std::ofstream file(file_path);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not open the evaluation report file: " << file_path;
+    return false;
+  }
+  const std::string json_extension = ".json";
+  const bool is_json =
+      file_path.size() >= json_extension.size() &&
+      file_path.compare(
+          file_path.size() - json_extension.size(), json_extension.size(),
+          json_extension) == 0;
+  file << (is_json ? toJson() : toCsv());
+  return file.good();
+}
+
+}  // namespace utils
+}  // namespace voxblox
@@ -18,11 +18,14 @@
 /* Adapted from Paul Furgale Schweizer Messer sm_timing*/
 
 #include <algorithm>
+#include <fstream>
+#include <limits>
 #include <math.h>
 #include <ostream>
 #include <sstream>
 #include <stdio.h>
 #include <string>
+#include <unordered_map>
 
 #include <glog/logging.h>
 
@@ -34,32 +37,215 @@ namespace timing {
 
 const double kNumSecondsPerNanosecond = 1.e-9;
 
+constexpr size_t TimerStatistics::kWindowSize;
+constexpr int TimerStatistics::kBinsPerOctave;
+constexpr int TimerStatistics::kNumOctaves;
+constexpr double TimerStatistics::kMinHistogramSeconds;
+
+TimerStatistics::TimerStatistics()
+    : total_samples_(0u),
+      sum_(0.0),
+      min_(std::numeric_limits<double>::max()),
+      max_(0.0),
+      window_next_(0u) {}
+
+size_t TimerStatistics::GetHistogramBin(double seconds) {
+  // Bin 0 holds everything up to kMinHistogramSeconds, the last bin
+  // everything beyond the last octave.
+  if (seconds <= kMinHistogramSeconds) {
+    return 0u;
+  }
+  const double bin =
+      std::floor(std::log2(seconds / kMinHistogramSeconds) * kBinsPerOctave);
+  return std::min(
+      static_cast<size_t>(bin) + 1u,
+      static_cast<size_t>(kBinsPerOctave * kNumOctaves) + 1u);
+}
+
+void TimerStatistics::Add(double seconds, int64_t stop_time_ns) {
+  ++total_samples_;
+  sum_ += seconds;
+  min_ = std::min(min_, seconds);
+  max_ = std::max(max_, seconds);
+
+  if (window_.size() < kWindowSize) {
+    window_.push_back(Sample{seconds, stop_time_ns});
+  } else {
+    window_[window_next_] = Sample{seconds, stop_time_ns};
+    window_next_ = (window_next_ + 1u) % kWindowSize;
+  }
+
+  if (histogram_.empty()) {
+    histogram_.resize(kBinsPerOctave * kNumOctaves + 2u, 0u);
+  }
+  ++histogram_[GetHistogramBin(seconds)];
+}
+
+void TimerStatistics::Merge(const TimerStatistics& other) {
+  if (other.total_samples_ == 0u) {
+    return;
+  }
+  total_samples_ += other.total_samples_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+
+  // Keep the latest samples of both, from oldest to newest.
+  std::vector<Sample> samples(window_);
+  samples.insert(samples.end(), other.window_.begin(), other.window_.end());
+  std::sort(
+      samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+        return a.stop_time_ns < b.stop_time_ns;
+      });
+  if (samples.size() > kWindowSize) {
+    samples.erase(samples.begin(), samples.end() - kWindowSize);
+  }
+  window_.swap(samples);
+  window_next_ = 0u;
+
+  if (histogram_.empty()) {
+    histogram_ = other.histogram_;
+  } else {
+    for (size_t bin = 0u; bin < histogram_.size(); ++bin) {
+      histogram_[bin] += other.histogram_[bin];
+    }
+  }
+}
+
+double TimerStatistics::Mean() const {
+  return total_samples_ == 0u ? 0.0 : sum_ / total_samples_;
+}
+
+double TimerStatistics::RollingMean() const {
+  if (window_.empty()) {
+    return 0.0;
+  }
+  double window_sum = 0.0;
+  for (const Sample& sample : window_) {
+    window_sum += sample.seconds;
+  }
+  return window_sum / window_.size();
+}
+
+double TimerStatistics::Max() const {
+  return max_;
+}
+
+double TimerStatistics::Min() const {
+  return total_samples_ == 0u ? 0.0 : min_;
+}
+
+double TimerStatistics::LazyVariance() const {
+  if (window_.empty()) {
+    return 0.0;
+  }
+  const double mean = RollingMean();
+  double var = 0.0;
+  for (const Sample& sample : window_) {
+    var += (sample.seconds - mean) * (sample.seconds - mean);
+  }
+  return var / window_.size();
+}
+
+double TimerStatistics::Percentile(double quantile) const {
+  if (total_samples_ == 0u) {
+    return 0.0;
+  }
+  const double rank =
+      std::max(1.0, std::ceil(quantile * static_cast<double>(total_samples_)));
+  uint64_t count = 0u;
+  for (size_t bin = 0u; bin + 1u < histogram_.size(); ++bin) {
+    count += histogram_[bin];
+    if (count >= rank) {
+      const double upper_edge =
+          kMinHistogramSeconds *
+          std::exp2(static_cast<double>(bin) / kBinsPerOctave);
+      return std::min(max_, upper_edge);
+    }
+  }
+  return max_;
+}
+
+/**
+ * The timers of one thread. The mutex is only contended while the timers are
+ * read, the thread merges its timers into the registry when it exits.
+ */
+struct Timing::ThreadTimers {
+  ThreadTimers() : num_resets(0u) {
+    Timing& timing = Timing::Instance();
+    std::lock_guard<std::mutex> lock(timing.mutex_);
+    num_resets = timing.num_resets_;
+    timing.thread_timers_.push_back(this);
+  }
+
+  ~ThreadTimers() {
+    Timing& timing = Timing::Instance();
+    std::lock_guard<std::mutex> lock(timing.mutex_);
+    std::lock_guard<std::mutex> timers_lock(mutex);
+    if (timers.size() > timing.timers_.size()) {
+      timing.timers_.resize(timers.size());
+    }
+    for (size_t handle = 0u; handle < timers.size(); ++handle) {
+      timing.timers_[handle].acc_.Merge(timers[handle]);
+    }
+    timing.thread_timers_.erase(std::find(
+        timing.thread_timers_.begin(), timing.thread_timers_.end(), this));
+  }
+
+  std::mutex mutex;
+  std::vector<TimerStatistics> timers;
+
+  /// Handles of the tags this thread has used since the last reset.
+  std::unordered_map<std::string, size_t> handles;
+  size_t num_resets;
+};
+
 Timing& Timing::Instance() {
   static Timing t;
   return t;
 }
 
-Timing::Timing() : maxTagLength_(0) {}
+Timing::ThreadTimers& Timing::GetThreadTimers() {
+  thread_local ThreadTimers thread_timers;
+  return thread_timers;
+}
+
+Timing::Timing() : maxTagLength_(0), num_resets_(0u) {}
 
 Timing::~Timing() {}
 
 // Static functions to query the timers:
 size_t Timing::GetHandle(std::string const& tag) {
+  // Look up the handles this thread has already used without locking.
+  ThreadTimers& thread_timers = GetThreadTimers();
+  const size_t num_resets = Instance().num_resets_;
+  if (thread_timers.num_resets != num_resets) {
+    thread_timers.handles.clear();
+    thread_timers.num_resets = num_resets;
+  }
+  std::unordered_map<std::string, size_t>::const_iterator cached_handle =
+      thread_timers.handles.find(tag);
+  if (cached_handle != thread_timers.handles.end()) {
+    return cached_handle->second;
+  }
+
   std::lock_guard<std::mutex> lock(Instance().mutex_);
+  size_t handle;
   // Search for an existing tag.
   map_t::iterator i = Instance().tagMap_.find(tag);
   if (i == Instance().tagMap_.end()) {
     // If it is not there, create a tag.
-    size_t handle = Instance().timers_.size();
+    handle = Instance().timers_.size();
     Instance().tagMap_[tag] = handle;
     Instance().timers_.push_back(TimerMapValue());
     // Track the maximum tag length to help printing a table of timing values
     // later.
     Instance().maxTagLength_ = std::max(Instance().maxTagLength_, tag.size());
-    return handle;
   } else {
-    return i->second;
+    handle = i->second;
   }
+  thread_timers.handles[tag] = handle;
+  return handle;
 }
 
 std::string Timing::GetTag(size_t handle) {
@@ -92,7 +278,11 @@ Timer::~Timer() {
   if (IsTiming()) {
     Stop();
   } else if (paused_) {
-    Timing::Instance().AddTime(handle_, accumulated_time_);
+    Timing::Instance().AddTime(
+        handle_, accumulated_time_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
   }
 }
 
@@ -100,12 +290,12 @@ void Timer::Start() {
   timing_ = true;
   paused_ = false;
   accumulated_time_ = 0.0;
-  time_ = std::chrono::system_clock::now();
+  time_ = std::chrono::steady_clock::now();
 }
 
 void Timer::Stop() {
-  std::chrono::time_point<std::chrono::system_clock> now =
-      std::chrono::system_clock::now();
+  const std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
   double dt =
       static_cast<double>(
           std::chrono::duration_cast<std::chrono::nanoseconds>(now - time_)
@@ -113,14 +303,18 @@ void Timer::Stop() {
       kNumSecondsPerNanosecond;
   accumulated_time_ += dt;
 
-  Timing::Instance().AddTime(handle_, accumulated_time_);
+  Timing::Instance().AddTime(
+      handle_, accumulated_time_,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          now.time_since_epoch())
+          .count());
   timing_ = false;
   paused_ = false;
 }
 
 void Timer::Pause() {
-  std::chrono::time_point<std::chrono::system_clock> now =
-      std::chrono::system_clock::now();
+  const std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
   double dt =
       static_cast<double>(
           std::chrono::duration_cast<std::chrono::nanoseconds>(now - time_)
@@ -135,63 +329,96 @@ void Timer::Pause() {
 void Timer::Unpause() {
   timing_ = true;
   paused_ = false;
-  time_ = std::chrono::system_clock::now();
+  time_ = std::chrono::steady_clock::now();
 }
 
 bool Timer::IsTiming() const {
   return timing_;
 }
 
-void Timing::AddTime(size_t handle, double seconds) {
+void Timing::AddTime(size_t handle, double seconds, int64_t stop_time_ns) {
+  ThreadTimers& thread_timers = GetThreadTimers();
+  std::lock_guard<std::mutex> lock(thread_timers.mutex);
+  if (handle >= thread_timers.timers.size()) {
+    thread_timers.timers.resize(handle + 1u);
+  }
+  thread_timers.timers[handle].Add(seconds, stop_time_ns);
+}
+
+TimerStatistics Timing::MergeThreadTimers(size_t handle) {
+  TimerStatistics statistics;
+  if (handle < timers_.size()) {
+    statistics.Merge(timers_[handle].acc_);
+  }
+  for (ThreadTimers* thread_timers : thread_timers_) {
+    std::lock_guard<std::mutex> lock(thread_timers->mutex);
+    if (handle < thread_timers->timers.size()) {
+      statistics.Merge(thread_timers->timers[handle]);
+    }
+  }
+  return statistics;
+}
+
+TimerStatistics Timing::GetStatistics(size_t handle) {
   std::lock_guard<std::mutex> lock(Instance().mutex_);
-  timers_[handle].acc_.Add(seconds);
+  return Instance().MergeThreadTimers(handle);
 }
 
-double Timing::GetTotalSeconds(size_t handle) {
+Timing::StatisticsList Timing::GetAllStatistics() {
   std::lock_guard<std::mutex> lock(Instance().mutex_);
-  return Instance().timers_[handle].acc_.Sum();
+  StatisticsList statistics;
+  for (const map_t::value_type& tag : Instance().tagMap_) {
+    statistics.emplace_back(
+        tag.first, Instance().MergeThreadTimers(tag.second));
+  }
+  return statistics;
+}
+
+double Timing::GetTotalSeconds(size_t handle) {
+  return GetStatistics(handle).Sum();
 }
 double Timing::GetTotalSeconds(std::string const& tag) {
   return GetTotalSeconds(GetHandle(tag));
 }
 double Timing::GetMeanSeconds(size_t handle) {
-  std::lock_guard<std::mutex> lock(Instance().mutex_);
-  return Instance().timers_[handle].acc_.Mean();
+  return GetStatistics(handle).Mean();
 }
 double Timing::GetMeanSeconds(std::string const& tag) {
   return GetMeanSeconds(GetHandle(tag));
 }
 size_t Timing::GetNumSamples(size_t handle) {
-  return Instance().timers_[handle].acc_.TotalSamples();
+  return GetStatistics(handle).TotalSamples();
 }
 size_t Timing::GetNumSamples(std::string const& tag) {
   return GetNumSamples(GetHandle(tag));
 }
 double Timing::GetVarianceSeconds(size_t handle) {
-  std::lock_guard<std::mutex> lock(Instance().mutex_);
-  return Instance().timers_[handle].acc_.LazyVariance();
+  return GetStatistics(handle).LazyVariance();
 }
 double Timing::GetVarianceSeconds(std::string const& tag) {
   return GetVarianceSeconds(GetHandle(tag));
 }
 double Timing::GetMinSeconds(size_t handle) {
-  std::lock_guard<std::mutex> lock(Instance().mutex_);
-  return Instance().timers_[handle].acc_.Min();
+  return GetStatistics(handle).Min();
 }
 double Timing::GetMinSeconds(std::string const& tag) {
   return GetMinSeconds(GetHandle(tag));
 }
 double Timing::GetMaxSeconds(size_t handle) {
-  std::lock_guard<std::mutex> lock(Instance().mutex_);
-  return Instance().timers_[handle].acc_.Max();
+  return GetStatistics(handle).Max();
 }
 double Timing::GetMaxSeconds(std::string const& tag) {
   return GetMaxSeconds(GetHandle(tag));
 }
+double Timing::GetPercentileSeconds(size_t handle, double quantile) {
+  return GetStatistics(handle).Percentile(quantile);
+}
+double Timing::GetPercentileSeconds(std::string const& tag, double quantile) {
+  return GetPercentileSeconds(GetHandle(tag), quantile);
+}
 
 double Timing::GetHz(size_t handle) {
-  std::lock_guard<std::mutex> lock(Instance().mutex_);
-  const double rolling_mean = Instance().timers_[handle].acc_.RollingMean();
+  const double rolling_mean = GetStatistics(handle).RollingMean();
   CHECK_GT(rolling_mean, 0.0);
   return 1.0 / rolling_mean;
 }
@@ -206,37 +433,46 @@ std::string Timing::SecondsToTimeString(double seconds) {
   return buffer;
 }
 
+const std::vector<double>& Timing::ExportPercentiles() {
+  static const std::vector<double> percentiles = {0.5, 0.9, 0.95, 0.99};
+  return percentiles;
+}
+
 void Timing::Print(std::ostream& out) {
-  map_t& tagMap = Instance().tagMap_;
+  const StatisticsList statistics = GetAllStatistics();
 
-  if (tagMap.empty()) {
+  if (statistics.empty()) {
     return;
   }
 
   out << "SM Timing\n";
   out << "-----------\n";
-  for (typename map_t::value_type t : tagMap) {
-    size_t i = t.second;
+  for (const StatisticsList::value_type& t : statistics) {
+    const TimerStatistics& acc = t.second;
     out.width((std::streamsize)Instance().maxTagLength_);
     out.setf(std::ios::left, std::ios::adjustfield);
     out << t.first << "\t";
     out.width(7);
 
     out.setf(std::ios::right, std::ios::adjustfield);
-    out << GetNumSamples(i) << "\t";
-    if (GetNumSamples(i) > 0) {
-      out << SecondsToTimeString(GetTotalSeconds(i)) << "\t";
-      double meansec = GetMeanSeconds(i);
-      double stddev = sqrt(GetVarianceSeconds(i));
+    out << acc.TotalSamples() << "\t";
+    if (acc.TotalSamples() > 0) {
+      out << SecondsToTimeString(acc.Sum()) << "\t";
+      double meansec = acc.Mean();
+      double stddev = sqrt(acc.LazyVariance());
       out << "(" << SecondsToTimeString(meansec) << " +- ";
       out << SecondsToTimeString(stddev) << ")\t";
 
-      double minsec = GetMinSeconds(i);
-      double maxsec = GetMaxSeconds(i);
+      double minsec = acc.Min();
+      double maxsec = acc.Max();
 
       // The min or max are out of bounds.
       out << "[" << SecondsToTimeString(minsec) << ","
-          << SecondsToTimeString(maxsec) << "]";
+          << SecondsToTimeString(maxsec) << "]\t";
+
+      // The median and the tail.
+      out << "{" << SecondsToTimeString(acc.Percentile(0.5)) << ","
+          << SecondsToTimeString(acc.Percentile(0.99)) << "}";
     }
     out << std::endl;
   }
@@ -247,9 +483,86 @@ std::string Timing::Print() {
   return ss.str();
 }
 
+namespace {
+
+/// Tags are paths, but quotes and backslashes still need escaping.
+std::string EscapeJsonString(std::string const& string) {
+  std::string escaped;
+  for (const char c : string) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+}  // namespace
+
+std::string Timing::PrintCsv() {
+  const StatisticsList statistics = GetAllStatistics();
+  std::stringstream ss;
+  ss << "tag,num_samples,total_s,mean_s,stddev_s,min_s,max_s";
+  for (const double quantile : ExportPercentiles()) {
+    ss << ",p" << quantile * 100.0 << "_s";
+  }
+  ss << "\n";
+  for (const StatisticsList::value_type& t : statistics) {
+    const TimerStatistics& acc = t.second;
+    ss << t.first << "," << acc.TotalSamples() << "," << acc.Sum() << ","
+       << acc.Mean() << "," << sqrt(acc.LazyVariance()) << "," << acc.Min()
+       << "," << acc.Max();
+    for (const double quantile : ExportPercentiles()) {
+      ss << "," << acc.Percentile(quantile);
+    }
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+std::string Timing::PrintJson() {
+  const StatisticsList statistics = GetAllStatistics();
+  std::stringstream ss;
+  ss << "{\n  \"timers\": [";
+  for (size_t i = 0u; i < statistics.size(); ++i) {
+    const TimerStatistics& acc = statistics[i].second;
+    ss << (i == 0u ? "\n" : ",\n") << "    {\"tag\": \""
+       << EscapeJsonString(statistics[i].first)
+       << "\", \"num_samples\": " << acc.TotalSamples()
+       << ", \"total_s\": " << acc.Sum() << ", \"mean_s\": " << acc.Mean()
+       << ", \"stddev_s\": " << sqrt(acc.LazyVariance())
+       << ", \"min_s\": " << acc.Min() << ", \"max_s\": " << acc.Max()
+       << ", \"percentiles_s\": {";
+    for (size_t j = 0u; j < ExportPercentiles().size(); ++j) {
+      ss << (j == 0u ? "" : ", ") << "\"" << ExportPercentiles()[j]
+         << "\": " << acc.Percentile(ExportPercentiles()[j]);
+    }
+    ss << "}}";
+  }
+  ss << "\n  ]\n}\n";
+  return ss.str();
+}
+
+bool Timing::SaveToFile(std::string const& file_path) {
+  std::ofstream file(file_path);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not open the timing file: " << file_path;
+    return false;
+  }
+  const std::string json_extension = ".json";
+  const bool is_json =
+      file_path.size() >= json_extension.size() &&
+      file_path.compare(
+          file_path.size() - json_extension.size(), json_extension.size(),
+          json_extension) == 0;
+  file << (is_json ? PrintJson() : PrintCsv());
+  return file.good();
+}
+
 void Timing::Reset() {
   std::lock_guard<std::mutex> lock(Instance().mutex_);
   Instance().tagMap_.clear();
+  ++Instance().num_resets_;
 }
 
 }  // namespace timing
@@ -0,0 +1,113 @@
+// Time to mesh the blocks of a layer one cube at a time
+// (MeshIntegrator::extractBlockMeshByCube) against meshing them from a tile of
+// the block and its halo (MeshIntegrator::extractBlockMesh).
+//
+// Usage: benchmark_block_mesh [repetitions]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/mesh/mesh_integrator.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+constexpr FloatingPoint kVoxelSize = 0.1f;
+constexpr IndexElement kSideBlocks = 8;
+
+double millisecondsSince(
+    const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/// Wavy ground with bumps, crossing the middle of a cube of blocks.
+void generateGround(Layer<TsdfVoxel>* tsdf_layer) {
+  const FloatingPoint ground_height = 0.5f * kSideBlocks *
+                                      tsdf_layer->block_size();
+  for (IndexElement x = 0; x < kSideBlocks; ++x) {
+    for (IndexElement y = 0; y < kSideBlocks; ++y) {
+      for (IndexElement z = 0; z < kSideBlocks; ++z) {
+        Block<TsdfVoxel>::Ptr block =
+            tsdf_layer->allocateBlockPtrByIndex(BlockIndex(x, y, z));
+        for (size_t i = 0u; i < block->num_voxels(); ++i) {
+          const Point coordinates = block->computeCoordinatesFromLinearIndex(i);
+          TsdfVoxel& voxel = block->getVoxelByLinearIndex(i);
+          voxel.distance = coordinates.z() - ground_height -
+                           0.3f * std::sin(1.3f * coordinates.x()) *
+                               std::cos(0.7f * coordinates.y());
+          voxel.weight = 1.0f;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  const int repetitions = argc > 1 ? std::atoi(argv[1]) : 5;
+
+  std::printf(
+      "%6s %8s %14s %10s %16s %16s %8s\n", "vps", "blocks", "surface_blocks",
+      "triangles", "by_cube_us/block", "by_tile_us/block", "speedup");
+
+  for (const size_t voxels_per_side : {8u, 16u, 32u}) {
+    Layer<TsdfVoxel> tsdf_layer(kVoxelSize, voxels_per_side);
+    MeshLayer mesh_layer(tsdf_layer.block_size());
+    MeshIntegratorConfig config;
+    MeshIntegrator<TsdfVoxel> mesh_integrator(
+        config, &tsdf_layer, &mesh_layer);
+    generateGround(&tsdf_layer);
+
+    BlockIndexList blocks;
+    tsdf_layer.getAllAllocatedBlocks(&blocks);
+    Mesh::Ptr mesh(new Mesh);
+
+    double by_cube_ms = 0.0;
+    double by_tile_ms = 0.0;
+    size_t surface_blocks = 0u;
+    size_t triangles = 0u;
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+      surface_blocks = 0u;
+      triangles = 0u;
+      for (const BlockIndex& block_index : blocks) {
+        Block<TsdfVoxel>::ConstPtr block =
+            tsdf_layer.getBlockPtrByIndex(block_index);
+
+        auto start = std::chrono::steady_clock::now();
+        mesh->clear();
+        mesh_integrator.extractBlockMeshByCube(block, mesh);
+        by_cube_ms += millisecondsSince(start);
+        const size_t by_cube_triangles = mesh->indices.size() / 3u;
+
+        start = std::chrono::steady_clock::now();
+        mesh->clear();
+        mesh_integrator.extractBlockMesh(block, mesh);
+        by_tile_ms += millisecondsSince(start);
+
+        CHECK_EQ(by_cube_triangles, mesh->indices.size() / 3u);
+        triangles += by_cube_triangles;
+        if (by_cube_triangles > 0u) {
+          ++surface_blocks;
+        }
+      }
+    }
+    const double block_runs =
+        static_cast<double>(blocks.size()) * repetitions / 1000.0;
+    std::printf(
+        "%6zu %8zu %14zu %10zu %16.2f %16.2f %7.1fx\n", voxels_per_side,
+        blocks.size(), surface_blocks, triangles, by_cube_ms / block_runs,
+        by_tile_ms / block_runs, by_cube_ms / by_tile_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,144 @@
+// Export time of the connected mesh of a layer: createConnectedMesh over the
+// whole mesh layer against an IncrementalConnectedMesh that only re-welds the
+// blocks meshed since the last export.
+//
+// Usage: benchmark_connected_mesh [max_map_side_blocks]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/mesh/incremental_connected_mesh.h"
+#include "voxblox/mesh/mesh_integrator.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+constexpr FloatingPoint kVoxelSize = 0.1f;
+constexpr size_t kVoxelsPerSide = 8u;
+constexpr int kRepetitions = 5;
+
+double millisecondsSince(
+    const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/// Wavy ground with bumps, two blocks high.
+void generateGround(
+    const IndexElement side_blocks, Layer<TsdfVoxel>* tsdf_layer) {
+  for (IndexElement x = 0; x < side_blocks; ++x) {
+    for (IndexElement y = 0; y < side_blocks; ++y) {
+      for (IndexElement z = 0; z < 2; ++z) {
+        Block<TsdfVoxel>::Ptr block =
+            tsdf_layer->allocateBlockPtrByIndex(BlockIndex(x, y, z));
+        for (size_t i = 0u; i < block->num_voxels(); ++i) {
+          const Point coordinates = block->computeCoordinatesFromLinearIndex(i);
+          TsdfVoxel& voxel = block->getVoxelByLinearIndex(i);
+          voxel.distance = coordinates.z() - 0.8f -
+                           0.3f * std::sin(1.3f * coordinates.x()) *
+                               std::cos(0.7f * coordinates.y());
+          voxel.weight = 1.0f;
+          voxel.color = Color(128u, 128u, 128u);
+        }
+        block->setUpdated(Update::kMesh, true);
+      }
+    }
+  }
+}
+
+/// Raise the ground in num_blocks random columns of blocks.
+void changeBlocks(
+    const IndexElement side_blocks, const size_t num_blocks,
+    Layer<TsdfVoxel>* tsdf_layer) {
+  for (size_t n = 0u; n < num_blocks; ++n) {
+    const IndexElement x = std::rand() % side_blocks;  // NOLINT
+    const IndexElement y = std::rand() % side_blocks;  // NOLINT
+    for (IndexElement z = 0; z < 2; ++z) {
+      Block<TsdfVoxel>& block =
+          tsdf_layer->getBlockByIndex(BlockIndex(x, y, z));
+      for (size_t i = 0u; i < block.num_voxels(); ++i) {
+        block.getVoxelByLinearIndex(i).distance -= 0.05f;
+      }
+      block.setUpdated(Update::kMesh, true);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  const IndexElement max_side_blocks = argc > 1 ? std::atoi(argv[1]) : 64;
+  std::srand(0);
+
+  std::printf(
+      "%12s %8s %10s %12s %14s %14s %14s\n", "map_blocks", "updated",
+      "vertices", "full_ms", "incr_weld_ms", "incr_export_ms",
+      "linked_blocks");
+
+  for (IndexElement side_blocks = 16; side_blocks <= max_side_blocks;
+       side_blocks *= 2) {
+    Layer<TsdfVoxel> tsdf_layer(kVoxelSize, kVoxelsPerSide);
+    MeshLayer mesh_layer(tsdf_layer.block_size());
+    MeshIntegratorConfig config;
+    MeshIntegrator<TsdfVoxel> mesh_integrator(
+        config, &tsdf_layer, &mesh_layer);
+
+    generateGround(side_blocks, &tsdf_layer);
+    mesh_integrator.generateMesh(true, true);
+
+    IncrementalConnectedMesh incremental;
+    incremental.updateBlocks(
+        mesh_layer, mesh_integrator.getLastMeshedBlocks());
+    Mesh connected_mesh;
+    incremental.getConnectedMesh(&connected_mesh);
+
+    for (const size_t num_updated : {1u, 8u, 64u}) {
+      double full_ms = 0.0;
+      double weld_ms = 0.0;
+      double export_ms = 0.0;
+      size_t vertices = 0u;
+      size_t linked_blocks = 0u;
+      for (int repetition = 0; repetition < kRepetitions; ++repetition) {
+        changeBlocks(side_blocks, num_updated, &tsdf_layer);
+        mesh_integrator.generateMesh(true, true);
+
+        auto start = std::chrono::steady_clock::now();
+        Mesh full_mesh;
+        mesh_layer.getConnectedMesh(&full_mesh);
+        full_ms += millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        incremental.updateBlocks(
+            mesh_layer, mesh_integrator.getLastMeshedBlocks());
+        weld_ms += millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        Mesh incremental_mesh;
+        incremental.getConnectedMesh(&incremental_mesh);
+        export_ms += millisecondsSince(start);
+
+        CHECK_EQ(full_mesh.vertices.size(), incremental_mesh.vertices.size());
+        CHECK_EQ(full_mesh.indices.size(), incremental_mesh.indices.size());
+        vertices = full_mesh.vertices.size();
+        linked_blocks += incremental.getNumberOfLastLinkedBlocks();
+      }
+      std::printf(
+          "%12zu %8zu %10zu %12.2f %14.3f %14.2f %14.1f\n",
+          mesh_layer.getNumberOfAllocatedMeshes(), num_updated * 2u, vertices,
+          full_ms / kRepetitions, weld_ms / kRepetitions,
+          export_ms / kRepetitions,
+          static_cast<double>(linked_blocks) / kRepetitions);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+// Time to cast the rays of a spinning LiDAR scan one at a time (RayCaster)
+// against kPacketSize at a time (PacketRayCaster), and of the whole
+// integration of the scan by the SimpleTsdfIntegrator, which uses the latter.
+//
+// Usage: benchmark_ray_casting [repetitions]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/integrator/integrator_utils.h"
+#include "voxblox/integrator/tsdf_integrator.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+constexpr size_t kColumns = 1024u;
+constexpr FloatingPoint kSensorHeight = 1.8f;
+constexpr FloatingPoint kWallRadius = 15.0f;
+constexpr FloatingPoint kMaxRange = 30.0f;
+
+double millisecondsSince(
+    const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * Scan of a LiDAR with the given beams between -25 and 15 degrees of
+ * elevation, kSensorHeight over the ground inside a round wall with waves.
+ */
+void generateScan(const size_t beams, Pointcloud* points_C, Colors* colors) {
+  points_C->clear();
+  for (size_t beam = 0u; beam < beams; ++beam) {
+    const FloatingPoint elevation =
+        (-25.0f + 40.0f * beam / (beams - 1u)) * M_PI / 180.0f;
+    for (size_t column = 0u; column < kColumns; ++column) {
+      const FloatingPoint azimuth = 2.0f * M_PI * column / kColumns;
+      const Ray direction(
+          std::cos(elevation) * std::cos(azimuth),
+          std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+      FloatingPoint range =
+          (kWallRadius + 2.0f * std::sin(5.0f * azimuth)) /
+          std::cos(elevation);
+      if (direction.z() < 0.0f) {
+        range = std::min(range, -kSensorHeight / direction.z());
+      }
+      points_C->push_back(direction * std::min(range, kMaxRange));
+    }
+  }
+  colors->assign(points_C->size(), Color(128u, 128u, 128u));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  const int repetitions = argc > 1 ? std::atoi(argv[1]) : 5;
+
+  std::printf(
+      "%6s %8s %8s %10s %10s %10s %8s %14s\n", "beams", "voxel_m", "rays",
+      "voxels", "scalar_ms", "packet_ms", "speedup", "integrate_ms");
+
+  const Transformation T_G_C(
+      Transformation::Position(0.0f, 0.0f, kSensorHeight),
+      Transformation::Rotation());
+  const Point origin = T_G_C.getPosition();
+
+  for (const size_t beams : {64u, 128u}) {
+    Pointcloud points_C;
+    Colors colors;
+    generateScan(beams, &points_C, &colors);
+
+    for (const FloatingPoint voxel_size : {0.1f, 0.2f}) {
+      TsdfIntegratorBase::Config config;
+      config.default_truncation_distance = 2.0f * voxel_size;
+      config.max_ray_length_m = 20.0f;
+      config.integrator_threads = 1u;
+      const FloatingPoint voxel_size_inv = 1.0f / voxel_size;
+
+      AlignedVector<RayCaster> ray_casters;
+      for (const Point& point_C : points_C) {
+        const Point point_G = T_G_C * point_C;
+        const bool is_clearing = point_C.norm() > config.max_ray_length_m;
+        ray_casters.emplace_back(
+            origin, point_G, is_clearing, config.voxel_carving_enabled,
+            config.max_ray_length_m, voxel_size_inv,
+            config.default_truncation_distance);
+      }
+
+      GlobalIndexVector scalar_indices;
+      PacketRayCaster packet_ray_caster;
+      double scalar_ms = 0.0;
+      double packet_ms = 0.0;
+      double integrate_ms = 0.0;
+      for (int repetition = 0; repetition < repetitions; ++repetition) {
+        auto start = std::chrono::steady_clock::now();
+        scalar_indices.clear();
+        for (const RayCaster& ray_caster : ray_casters) {
+          RayCaster scalar_ray_caster(ray_caster);
+          GlobalIndex index;
+          while (scalar_ray_caster.nextRayIndex(&index)) {
+            scalar_indices.push_back(index);
+          }
+        }
+        scalar_ms += millisecondsSince(start);
+
+        // In batches, as the integrators do. The indices are checked after
+        // each batch, outside of the timing.
+        size_t num_indices = 0u;
+        for (size_t first = 0u; first < ray_casters.size();
+             first += PacketRayCaster::kBatchSize) {
+          const size_t last = std::min(
+              first + PacketRayCaster::kBatchSize, ray_casters.size());
+          start = std::chrono::steady_clock::now();
+          packet_ray_caster.clear();
+          for (size_t ray = first; ray < last; ++ray) {
+            packet_ray_caster.addRay(ray_casters[ray]);
+          }
+          packet_ray_caster.castRays();
+          packet_ms += millisecondsSince(start);
+
+          for (size_t ray = 0u; ray < last - first; ++ray) {
+            const GlobalIndex* index = packet_ray_caster.rayBegin(ray);
+            const size_t ray_indices = packet_ray_caster.rayEnd(ray) - index;
+            CHECK(std::equal(
+                index, index + ray_indices,
+                scalar_indices.begin() + num_indices));
+            num_indices += ray_indices;
+          }
+        }
+        CHECK_EQ(num_indices, scalar_indices.size());
+
+        Layer<TsdfVoxel> layer(voxel_size, 16u);
+        SimpleTsdfIntegrator integrator(config, &layer);
+        start = std::chrono::steady_clock::now();
+        integrator.integratePointCloud(T_G_C, points_C, colors);
+        integrate_ms += millisecondsSince(start);
+      }
+      std::printf(
+          "%6zu %8.1f %8zu %10zu %10.2f %10.2f %7.1fx %14.2f\n", beams,
+          voxel_size, ray_casters.size(), scalar_indices.size(),
+          scalar_ms / repetitions, packet_ms / repetitions,
+          scalar_ms / packet_ms, integrate_ms / repetitions);
+    }
+  }
+  return 0;
+}
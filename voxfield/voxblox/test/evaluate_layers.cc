@@ -0,0 +1,61 @@
+#include <stdexcept>
+#include <string>
+
+#include <glog/logging.h>
+
+#include "voxblox/core/voxel.h"
+#include "voxblox/utils/layer_evaluator.h"
+
+using namespace voxblox;  // NOLINT
+
+template <typename VoxelType>
+bool evaluateLayerFiles(
+    const std::string& gt_file, const std::string& test_file,
+    const size_t num_threads, const std::string& report_file) {
+  typename utils::LayerEvaluator<VoxelType>::Config config;
+  config.num_threads = num_threads;
+  utils::LayerEvaluator<VoxelType> evaluator(config);
+
+  utils::LayerEvaluationReport report(
+      config.band_edges_m, config.percentiles, config.histogram_bin_width_m,
+      1u);
+  if (!evaluator.evaluateLayerFiles(gt_file, test_file, &report)) {
+    return false;
+  }
+  LOG(INFO) << report.toString();
+  return report_file.empty() || report.saveToFile(report_file);
+}
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+
+  if (argc < 4 || argc > 6) {
+    throw std::runtime_error(
+        std::string("Args: ground truth layer file, test layer file") +
+        ", voxel type (tsdf or esdf), [report file (.csv or .json)]" +
+        ", [number of threads]");
+  }
+
+  const std::string gt_file = argv[1];
+  const std::string test_file = argv[2];
+  const std::string voxel_type = argv[3];
+  const std::string report_file = argc > 4 ? argv[4] : "";
+  const size_t num_threads = argc > 5 ? std::stoul(argv[5]) : 0u;
+
+  bool success = false;
+  if (voxel_type == "tsdf") {
+    success = evaluateLayerFiles<TsdfVoxel>(
+        gt_file, test_file, num_threads, report_file);
+  } else if (voxel_type == "esdf") {
+    success = evaluateLayerFiles<EsdfVoxel>(
+        gt_file, test_file, num_threads, report_file);
+  } else {
+    throw std::runtime_error("Unknown voxel type: " + voxel_type);
+  }
+
+  if (!success) {
+    throw std::runtime_error("Failed to evaluate the layers");
+  }
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/mesh/mesh_integrator.h"
+
+using namespace voxblox;  // NOLINT
+
+template <typename VoxelType>
+void setVoxel(
+    const FloatingPoint distance, const bool observed, VoxelType* voxel);
+
+template <>
+void setVoxel(
+    const FloatingPoint distance, const bool observed, TsdfVoxel* voxel) {
+  voxel->distance = distance;
+  voxel->weight = observed ? 1.0f : 0.0f;
+}
+
+template <>
+void setVoxel(
+    const FloatingPoint distance, const bool observed, EsdfVoxel* voxel) {
+  voxel->distance = distance;
+  voxel->observed = observed;
+}
+
+template <typename VoxelType>
+class BlockMeshTest : public ::testing::Test {
+ protected:
+  void initializeLayer(const size_t voxels_per_side) {
+    layer_.reset(new Layer<VoxelType>(kVoxelSize, voxels_per_side));
+    MeshIntegratorConfig config;
+    config.integrator_threads = 1u;
+    mesh_layer_.reset(new MeshLayer(layer_->block_size()));
+    mesh_integrator_.reset(new MeshIntegrator<VoxelType>(
+        config, layer_.get(), mesh_layer_.get()));
+  }
+
+  /**
+   * Two intersecting spheres over a cube of blocks, with a few voxels not
+   * observed and the blocks of one corner of the cube not allocated.
+   */
+  void fillLayer(const FloatingPoint unobserved_ratio) {
+    const IndexElement blocks_per_side =
+        static_cast<IndexElement>(std::ceil(2.0f / layer_->block_size()));
+    const Point center_a(0.05f, -0.02f, 0.01f);
+    const Point center_b(0.6f, 0.5f, 0.45f);
+    for (IndexElement x = -blocks_per_side; x < blocks_per_side; ++x) {
+      for (IndexElement y = -blocks_per_side; y < blocks_per_side; ++y) {
+        for (IndexElement z = -blocks_per_side; z < blocks_per_side; ++z) {
+          if (x > 0 && y > 0 && z < 0) {
+            continue;
+          }
+          typename Block<VoxelType>::Ptr block =
+              layer_->allocateBlockPtrByIndex(BlockIndex(x, y, z));
+          for (size_t i = 0u; i < block->num_voxels(); ++i) {
+            const Point coordinates =
+                block->computeCoordinatesFromLinearIndex(i);
+            const FloatingPoint distance = std::min(
+                (coordinates - center_a).norm() - 0.9f,
+                (coordinates - center_b).norm() - 0.5f);
+            const bool observed =
+                std::rand() >= unobserved_ratio * RAND_MAX;  // NOLINT
+            setVoxel(distance, observed, &block->getVoxelByLinearIndex(i));
+          }
+        }
+      }
+    }
+  }
+
+  /// Both paths mesh every block to exactly the same vertices and triangles.
+  void expectSameBlockMeshes() {
+    BlockIndexList blocks;
+    layer_->getAllAllocatedBlocks(&blocks);
+    size_t meshed_blocks = 0u;
+    for (const BlockIndex& block_index : blocks) {
+      typename Block<VoxelType>::ConstPtr block =
+          layer_->getBlockPtrByIndex(block_index);
+      Mesh::Ptr by_cube(new Mesh);
+      Mesh::Ptr by_tile(new Mesh);
+      mesh_integrator_->extractBlockMeshByCube(block, by_cube);
+      mesh_integrator_->extractBlockMesh(block, by_tile);
+
+      ASSERT_EQ(by_cube->vertices.size(), by_tile->vertices.size());
+      ASSERT_EQ(by_cube->normals.size(), by_tile->normals.size());
+      EXPECT_TRUE(by_cube->indices == by_tile->indices);
+      for (size_t i = 0u; i < by_cube->vertices.size(); ++i) {
+        EXPECT_TRUE(by_cube->vertices[i] == by_tile->vertices[i]);
+        EXPECT_TRUE(by_cube->normals[i] == by_tile->normals[i]);
+      }
+      if (by_cube->hasVertices()) {
+        ++meshed_blocks;
+      }
+    }
+    EXPECT_GT(meshed_blocks, 0u);
+  }
+
+  static constexpr FloatingPoint kVoxelSize = 0.1f;
+
+  std::unique_ptr<Layer<VoxelType>> layer_;
+  std::unique_ptr<MeshLayer> mesh_layer_;
+  std::unique_ptr<MeshIntegrator<VoxelType>> mesh_integrator_;
+};
+
+typedef ::testing::Types<TsdfVoxel, EsdfVoxel> VoxelTypes;
+TYPED_TEST_CASE(BlockMeshTest, VoxelTypes);
+
+TYPED_TEST(BlockMeshTest, FullyObserved) {
+  std::srand(0);
+  for (const size_t voxels_per_side : {8u, 16u}) {
+    this->initializeLayer(voxels_per_side);
+    this->fillLayer(0.0f);
+    this->expectSameBlockMeshes();
+  }
+}
+
+TYPED_TEST(BlockMeshTest, PartiallyObserved) {
+  std::srand(0);
+  for (const size_t voxels_per_side : {8u, 16u}) {
+    this->initializeLayer(voxels_per_side);
+    this->fillLayer(0.1f);
+    this->expectSameBlockMeshes();
+  }
+}
+
+TYPED_TEST(BlockMeshTest, VoxelsPerSideNotMultipleOfFour) {
+  std::srand(0);
+  for (const size_t voxels_per_side : {2u, 5u, 7u}) {
+    this->initializeLayer(voxels_per_side);
+    this->fillLayer(0.05f);
+    this->expectSameBlockMeshes();
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
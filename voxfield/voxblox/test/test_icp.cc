@@ -0,0 +1,161 @@
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/alignment/icp.h"
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/simulation/simulation_world.h"
+#include "voxblox/test/simulation_test_utils.h"
+#include "voxblox/utils/timing.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSize = 0.05f;
+const size_t kVoxelsPerSide = 16u;
+const FloatingPoint kTruncationDistance = 4.0f * kVoxelSize;
+const size_t kNumPoses = 8u;
+const size_t kNumThreads = 4u;
+const int kMaxIterations = 20;
+const unsigned kSeed = 0u;
+
+/// Mean errors of the refined poses of a sequence.
+struct SequenceErrors {
+  FloatingPoint translation_m = 0.0;
+  FloatingPoint rotation_rad = 0.0;
+  double iterations = 0.0;
+};
+
+}  // namespace
+
+class IcpTest : public ::testing::Test {
+ protected:
+  IcpTest() : tsdf_layer_(kVoxelSize, kVoxelsPerSide) {}
+
+  /**
+   * A room with a few objects and its TSDF, scanned from a circle of poses
+   * whose initial guesses are off by a few centimeters and about a degree.
+   */
+  void SetUp() override {
+    test::createRoomWorld(&world_);
+    world_.generateSdfFromWorld(kTruncationDistance, &tsdf_layer_);
+    poses_ = test::getCirclePoses(kNumPoses, 2.0, 1.5);
+
+    std::mt19937 generator(kSeed);
+    std::uniform_real_distribution<FloatingPoint> uniform(-1.0, 1.0);
+    for (const Transformation& pose : poses_) {
+      Pointcloud ptcloud_C;
+      Colors colors;
+      test::getScanFromPose(
+          world_, pose, Eigen::Vector2i(160, 120), 2.0, 6.0, &ptcloud_C,
+          &colors);
+
+      const Transformation perturbation(
+          Quaternion(Eigen::AngleAxis<FloatingPoint>(
+              0.02 * uniform(generator), Point::UnitZ())),
+          Point(
+              0.05 * uniform(generator), 0.05 * uniform(generator),
+              0.03 * uniform(generator)));
+      initial_poses_.push_back(pose * perturbation);
+      scans_.push_back(ptcloud_C);
+    }
+  }
+
+  ICP::Config getConfig(int max_iterations) const {
+    ICP::Config config;
+    config.num_threads = kNumThreads;
+    config.max_iterations = max_iterations;
+    return config;
+  }
+
+  SequenceErrors getErrors(
+      const AlignedVector<Transformation>& estimated_poses) const {
+    SequenceErrors errors;
+    for (size_t i = 0u; i < poses_.size(); ++i) {
+      const Transformation error = poses_[i].inverse() * estimated_poses[i];
+      errors.translation_m += error.getPosition().norm() / poses_.size();
+      errors.rotation_rad += error.getRotation().log().norm() / poses_.size();
+    }
+    return errors;
+  }
+
+  /// Refines all the initial guesses and logs the accuracy of the sequence.
+  SequenceErrors refineSequence(
+      const ICP::Config& config, const std::string& timer_tag) {
+    ICP icp(config);
+    AlignedVector<Transformation> refined_poses(poses_.size());
+    size_t num_iterations = 0u;
+    for (size_t i = 0u; i < poses_.size(); ++i) {
+      timing::Timer timer(timer_tag);
+      const size_t num_updates = icp.runICP(
+          tsdf_layer_, scans_[i], initial_poses_[i], &refined_poses[i], kSeed);
+      timer.Stop();
+      EXPECT_GT(num_updates, 0u);
+      num_iterations += icp.getNumIterations();
+    }
+
+    SequenceErrors errors = getErrors(refined_poses);
+    errors.iterations = static_cast<double>(num_iterations) / poses_.size();
+    LOG(INFO) << timer_tag << ": mean error " << errors.translation_m
+              << " m and " << errors.rotation_rad << " rad after "
+              << errors.iterations << " iterations.";
+    return errors;
+  }
+
+  SimulationWorld world_;
+  Layer<TsdfVoxel> tsdf_layer_;
+  AlignedVector<Transformation> poses_;
+  AlignedVector<Transformation> initial_poses_;
+  AlignedVector<Pointcloud> scans_;
+};
+
+TEST_F(IcpTest, SinglePassReducesError) {
+  const SequenceErrors initial_errors = getErrors(initial_poses_);
+  const SequenceErrors errors =
+      refineSequence(getConfig(1), "test/icp/single_pass");
+
+  EXPECT_EQ(1.0, errors.iterations);
+  EXPECT_LT(errors.translation_m, initial_errors.translation_m);
+  EXPECT_LT(errors.rotation_rad, initial_errors.rotation_rad);
+}
+
+TEST_F(IcpTest, IterationsRefineFurther) {
+  const SequenceErrors single_pass_errors =
+      refineSequence(getConfig(1), "test/icp/single_pass");
+  const SequenceErrors errors =
+      refineSequence(getConfig(kMaxIterations), "test/icp/iterated");
+
+  // The passes stop once converged, well before the maximum.
+  EXPECT_GT(errors.iterations, 1.0);
+  EXPECT_LT(errors.iterations, kMaxIterations);
+  EXPECT_LT(errors.translation_m, single_pass_errors.translation_m);
+  EXPECT_LT(errors.translation_m, 0.5 * kVoxelSize);
+}
+
+TEST_F(IcpTest, StopsAtGroundTruth) {
+  // Only the step criterion, the sensor barely moves from the true pose.
+  ICP::Config config = getConfig(kMaxIterations);
+  config.min_delta_translation_m = 0.2 * kVoxelSize;
+  config.min_delta_rotation_rad = 0.01;
+  config.min_information_gain = 0.0;
+  initial_poses_ = poses_;
+  const SequenceErrors errors =
+      refineSequence(config, "test/icp/ground_truth");
+
+  EXPECT_LT(errors.iterations, 3.0);
+  EXPECT_LT(errors.translation_m, 0.5 * kVoxelSize);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  timing::Timing::Print(std::cout);
+
+  return result;
+}
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/mesh/incremental_connected_mesh.h"
+#include "voxblox/mesh/mesh_integrator.h"
+#include "voxblox/mesh/mesh_utils.h"
+
+using namespace voxblox;  // NOLINT
+
+class IncrementalMeshTest : public ::testing::Test {
+ protected:
+  typedef std::array<LongIndexElement, 9> TriangleKey;
+
+  virtual void SetUp() {
+    tsdf_layer_.reset(new Layer<TsdfVoxel>(kVoxelSize, kVoxelsPerSide));
+    mesh_layer_.reset(new MeshLayer(tsdf_layer_->block_size()));
+    MeshIntegratorConfig config;
+    config.integrator_threads = 1u;
+    mesh_integrator_.reset(new MeshIntegrator<TsdfVoxel>(
+        config, tsdf_layer_.get(), mesh_layer_.get()));
+
+    for (IndexElement x = -2; x < 2; ++x) {
+      for (IndexElement y = -2; y < 2; ++y) {
+        for (IndexElement z = -2; z < 2; ++z) {
+          tsdf_layer_->allocateBlockPtrByIndex(BlockIndex(x, y, z));
+        }
+      }
+    }
+  }
+
+  /// Signed distance to a sphere in every voxel of the allocated blocks.
+  void setSphere(const Point& center, const FloatingPoint radius) {
+    BlockIndexList blocks;
+    tsdf_layer_->getAllAllocatedBlocks(&blocks);
+    for (const BlockIndex& block_index : blocks) {
+      Block<TsdfVoxel>& block = tsdf_layer_->getBlockByIndex(block_index);
+      for (size_t i = 0u; i < block.num_voxels(); ++i) {
+        TsdfVoxel& voxel = block.getVoxelByLinearIndex(i);
+        const FloatingPoint distance =
+            (block.computeCoordinatesFromLinearIndex(i) - center).norm() -
+            radius;
+        if (voxel.weight > 0.0f && voxel.distance == distance) {
+          continue;
+        }
+        voxel.distance = distance;
+        voxel.weight = 1.0f;
+        voxel.color = Color(255u, 0u, 0u);
+        block.setUpdated(Update::kMesh, true);
+      }
+    }
+  }
+
+  /// Triangles by the discretized positions of their vertices, in any order.
+  static std::vector<TriangleKey> triangleKeys(const Mesh& mesh) {
+    std::vector<TriangleKey> keys;
+    for (size_t i = 0u; i < mesh.indices.size(); i += 3u) {
+      std::array<LongIndex, 3> vertices;
+      for (size_t j = 0u; j < 3u; ++j) {
+        const Point& vertex = mesh.vertices[mesh.indices[i + j]];
+        vertices[j] = (vertex.cast<double>() * 1e4)
+                          .array()
+                          .round()
+                          .cast<LongIndexElement>();
+      }
+      // Keep the winding, start from the smallest vertex.
+      const size_t first =
+          std::min_element(
+              vertices.begin(), vertices.end(),
+              [](const LongIndex& a, const LongIndex& b) {
+                return std::lexicographical_compare(
+                    a.data(), a.data() + 3, b.data(), b.data() + 3);
+              }) -
+          vertices.begin();
+      TriangleKey key;
+      for (size_t j = 0u; j < 3u; ++j) {
+        const LongIndex& vertex = vertices[(first + j) % 3u];
+        key[3u * j] = vertex.x();
+        key[3u * j + 1u] = vertex.y();
+        key[3u * j + 2u] = vertex.z();
+      }
+      keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  }
+
+  void expectSameAsConnectedMesh(IncrementalConnectedMesh* incremental) {
+    Mesh expected;
+    mesh_layer_->getConnectedMesh(&expected);
+    Mesh connected;
+    incremental->getConnectedMesh(&connected);
+
+    EXPECT_GT(expected.indices.size(), 0u);
+    EXPECT_EQ(expected.vertices.size(), connected.vertices.size());
+    EXPECT_EQ(expected.normals.size(), connected.normals.size());
+    EXPECT_EQ(expected.colors.size(), connected.colors.size());
+    EXPECT_EQ(expected.indices.size(), connected.indices.size());
+    EXPECT_TRUE(triangleKeys(expected) == triangleKeys(connected));
+  }
+
+  static constexpr FloatingPoint kVoxelSize = 0.1f;
+  static constexpr size_t kVoxelsPerSide = 8u;
+
+  std::unique_ptr<Layer<TsdfVoxel>> tsdf_layer_;
+  std::unique_ptr<MeshLayer> mesh_layer_;
+  std::unique_ptr<MeshIntegrator<TsdfVoxel>> mesh_integrator_;
+};
+
+TEST_F(IncrementalMeshTest, Rebuild) {
+  setSphere(Point(0.03f, -0.02f, 0.01f), 0.9f);
+  mesh_integrator_->generateMesh(false, true);
+
+  IncrementalConnectedMesh incremental;
+  incremental.rebuild(*mesh_layer_);
+  expectSameAsConnectedMesh(&incremental);
+}
+
+TEST_F(IncrementalMeshTest, UpdateOnlyChangedBlocks) {
+  setSphere(Point(0.03f, -0.02f, 0.01f), 0.9f);
+  mesh_integrator_->generateMesh(false, true);
+
+  IncrementalConnectedMesh incremental;
+  incremental.updateBlocks(
+      *mesh_layer_, mesh_integrator_->getLastMeshedBlocks());
+  expectSameAsConnectedMesh(&incremental);
+  const size_t all_blocks = incremental.getNumberOfLastLinkedBlocks();
+
+  // Dent the sphere in a few blocks.
+  const Point dent_center(0.85f, 0.1f, 0.1f);
+  BlockIndexList blocks;
+  tsdf_layer_->getAllAllocatedBlocks(&blocks);
+  for (const BlockIndex& block_index : blocks) {
+    Block<TsdfVoxel>& block = tsdf_layer_->getBlockByIndex(block_index);
+    for (size_t i = 0u; i < block.num_voxels(); ++i) {
+      const Point coordinates = block.computeCoordinatesFromLinearIndex(i);
+      if ((coordinates - dent_center).norm() < 0.15f) {
+        block.getVoxelByLinearIndex(i).distance += 0.12f;
+        block.setUpdated(Update::kMesh, true);
+      }
+    }
+  }
+  mesh_integrator_->generateMesh(true, true);
+  EXPECT_LT(mesh_integrator_->getLastMeshedBlocks().size(), blocks.size());
+
+  incremental.updateBlocks(
+      *mesh_layer_, mesh_integrator_->getLastMeshedBlocks());
+  expectSameAsConnectedMesh(&incremental);
+  EXPECT_LT(incremental.getNumberOfLastLinkedBlocks(), all_blocks);
+
+  // Nothing changed, nothing to link.
+  Mesh connected;
+  incremental.getConnectedMesh(&connected);
+  EXPECT_EQ(incremental.getNumberOfLastLinkedBlocks(), 0u);
+}
+
+TEST_F(IncrementalMeshTest, RemoveBlock) {
+  setSphere(Point(0.03f, -0.02f, 0.01f), 0.9f);
+  mesh_integrator_->generateMesh(false, true);
+
+  IncrementalConnectedMesh incremental;
+  incremental.rebuild(*mesh_layer_);
+
+  const BlockIndex removed_block =
+      mesh_layer_->computeBlockIndexFromCoordinates(Point(0.85f, 0.1f, 0.1f));
+  ASSERT_TRUE(mesh_layer_->hasMeshWithIndex(removed_block));
+  mesh_layer_->removeMesh(removed_block);
+
+  BlockIndexList updated_blocks;
+  updated_blocks.push_back(removed_block);
+  incremental.updateBlocks(*mesh_layer_, updated_blocks);
+  expectSameAsConnectedMesh(&incremental);
+}
+
+TEST_F(IncrementalMeshTest, ClearDistantMesh) {
+  setSphere(Point(0.03f, -0.02f, 0.01f), 0.9f);
+  mesh_integrator_->generateMesh(false, true);
+
+  IncrementalConnectedMesh incremental;
+  incremental.updateBlocks(
+      *mesh_layer_, mesh_integrator_->getLastMeshedBlocks());
+
+  // Same as the servers: the meshes are published, then the distant ones are
+  // cleared and flagged as updated.
+  BlockIndexList meshes;
+  mesh_layer_->getAllAllocatedMeshes(&meshes);
+  for (const BlockIndex& block_index : meshes) {
+    mesh_layer_->getMeshPtrByIndex(block_index)->updated = false;
+  }
+  mesh_layer_->clearDistantMesh(Point(0.8f, 0.0f, 0.0f), 1.0);
+
+  BlockIndexList cleared_meshes;
+  mesh_layer_->getAllUpdatedMeshes(&cleared_meshes);
+  EXPECT_GT(cleared_meshes.size(), 0u);
+  EXPECT_LT(cleared_meshes.size(), meshes.size());
+  incremental.updateBlocks(*mesh_layer_, cleared_meshes);
+  expectSameAsConnectedMesh(&incremental);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
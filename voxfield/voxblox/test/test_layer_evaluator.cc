@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/io/layer_io.h"
+#include "voxblox/utils/evaluation_utils.h"
+#include "voxblox/utils/layer_evaluator.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSize = 0.1f;
+const size_t kVoxelsPerSide = 8u;
+
+}  // namespace
+
+class LayerEvaluatorTest : public ::testing::Test {
+ protected:
+  LayerEvaluatorTest()
+      : layer_gt_(kVoxelSize, kVoxelsPerSide),
+        layer_test_(kVoxelSize, kVoxelsPerSide) {}
+
+  /**
+   * Ground truth of a plane and a noisy test layer, which only share some of
+   * their blocks and have a few voxels not observed.
+   */
+  void SetUp() override {
+    std::normal_distribution<FloatingPoint> noise(0.0f, 0.05f);
+    std::uniform_real_distribution<FloatingPoint> uniform(0.0f, 1.0f);
+    for (IndexElement x = -3; x < 3; ++x) {
+      for (IndexElement y = -3; y < 3; ++y) {
+        for (IndexElement z = -3; z < 3; ++z) {
+          const BlockIndex block_index(x, y, z);
+          const bool in_gt = x < 2;
+          const bool in_test = x > -3;
+          Block<TsdfVoxel>::Ptr gt_block;
+          Block<TsdfVoxel>::Ptr test_block;
+          if (in_gt) {
+            gt_block = layer_gt_.allocateBlockPtrByIndex(block_index);
+          }
+          if (in_test) {
+            test_block = layer_test_.allocateBlockPtrByIndex(block_index);
+          }
+          const Block<TsdfVoxel>& block = in_gt ? *gt_block : *test_block;
+          for (size_t i = 0u; i < block.num_voxels(); ++i) {
+            const Point coordinates =
+                block.computeCoordinatesFromLinearIndex(i);
+            const FloatingPoint distance =
+                0.8f * coordinates.z() + 0.6f * coordinates.y() - 0.1f;
+            if (gt_block) {
+              TsdfVoxel& voxel = gt_block->getVoxelByLinearIndex(i);
+              voxel.distance = distance;
+              voxel.weight = uniform(generator_) < 0.05f ? 0.0f : 1.0f;
+            }
+            if (test_block) {
+              TsdfVoxel& voxel = test_block->getVoxelByLinearIndex(i);
+              voxel.distance = distance + noise(generator_);
+              voxel.weight = uniform(generator_) < 0.05f ? 0.0f : 1.0f;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /// Same counts and histograms, and the same errors up to the summation order.
+  void expectSameReports(
+      const utils::LayerEvaluationReport& report_a,
+      const utils::LayerEvaluationReport& report_b) {
+    EXPECT_EQ(report_a.num_ignored_voxels, report_b.num_ignored_voxels);
+    EXPECT_EQ(
+        report_a.num_non_overlapping_voxels,
+        report_b.num_non_overlapping_voxels);
+    ASSERT_EQ(report_a.bands.size(), report_b.bands.size());
+    for (size_t band = 0u; band < report_a.bands.size(); ++band) {
+      const utils::ErrorStatistics& statistics_a = report_a.bands[band];
+      const utils::ErrorStatistics& statistics_b = report_b.bands[band];
+      EXPECT_EQ(
+          statistics_a.num_evaluated_voxels, statistics_b.num_evaluated_voxels);
+      EXPECT_TRUE(statistics_a.histogram == statistics_b.histogram);
+      EXPECT_EQ(statistics_a.max_error, statistics_b.max_error);
+      EXPECT_EQ(statistics_a.min_error, statistics_b.min_error);
+      EXPECT_NEAR(statistics_a.rmse(), statistics_b.rmse(), 1e-5);
+    }
+    EXPECT_NEAR(report_a.total.rmse(), report_b.total.rmse(), 1e-5);
+  }
+
+  std::mt19937 generator_{0u};
+  Layer<TsdfVoxel> layer_gt_;
+  Layer<TsdfVoxel> layer_test_;
+};
+
+TEST_F(LayerEvaluatorTest, MatchesEvaluateLayersRmse) {
+  for (const utils::VoxelEvaluationMode evaluation_mode :
+       {utils::VoxelEvaluationMode::kEvaluateAllVoxels,
+        utils::VoxelEvaluationMode::kIgnoreErrorBehindTestSurface}) {
+    utils::VoxelEvaluationDetails expected_details;
+    utils::evaluateLayersRmse(
+        layer_gt_, layer_test_, evaluation_mode, &expected_details);
+
+    utils::LayerEvaluator<TsdfVoxel>::Config config;
+    config.evaluation_mode = evaluation_mode;
+    config.num_threads = 4u;
+    utils::LayerEvaluator<TsdfVoxel> evaluator(config);
+    const utils::VoxelEvaluationDetails details =
+        evaluator.evaluateLayers(layer_gt_, layer_test_).getDetails();
+
+    EXPECT_GT(details.num_evaluated_voxels, 0u);
+    EXPECT_EQ(
+        expected_details.num_evaluated_voxels, details.num_evaluated_voxels);
+    EXPECT_EQ(expected_details.num_ignored_voxels, details.num_ignored_voxels);
+    EXPECT_EQ(
+        expected_details.num_overlapping_voxels,
+        details.num_overlapping_voxels);
+    EXPECT_EQ(
+        expected_details.num_non_overlapping_voxels,
+        details.num_non_overlapping_voxels);
+    EXPECT_EQ(expected_details.max_error, details.max_error);
+    EXPECT_NEAR(expected_details.rmse, details.rmse, 1e-5);
+  }
+}
+
+TEST_F(LayerEvaluatorTest, ThreadsMatchSerial) {
+  utils::LayerEvaluator<TsdfVoxel>::Config config;
+  config.num_threads = 1u;
+  const utils::LayerEvaluationReport serial_report =
+      utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayers(
+          layer_gt_, layer_test_);
+  config.num_threads = 8u;
+  const utils::LayerEvaluationReport parallel_report =
+      utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayers(
+          layer_gt_, layer_test_);
+  expectSameReports(serial_report, parallel_report);
+}
+
+TEST_F(LayerEvaluatorTest, BandsAndPercentiles) {
+  utils::LayerEvaluator<TsdfVoxel>::Config config;
+  config.evaluation_mode = utils::VoxelEvaluationMode::kEvaluateAllVoxels;
+  config.band_edges_m = {0.1, 0.3};
+  config.percentiles = {0.5, 0.9, 1.0};
+  config.histogram_bin_width_m = 0.005;
+  config.histogram_max_error_m = 0.1;
+  const utils::LayerEvaluationReport report =
+      utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayers(
+          layer_gt_, layer_test_);
+
+  // The errors and distances of all the evaluated voxels, in each band.
+  std::vector<FloatingPoint> errors;
+  std::vector<size_t> band_voxels(3u, 0u);
+  BlockIndexList blocks;
+  layer_test_.getAllAllocatedBlocks(&blocks);
+  for (const BlockIndex& block_index : blocks) {
+    Block<TsdfVoxel>::ConstPtr gt_block =
+        layer_gt_.getBlockPtrByIndex(block_index);
+    if (!gt_block) {
+      continue;
+    }
+    const Block<TsdfVoxel>& test_block =
+        layer_test_.getBlockByIndex(block_index);
+    for (size_t i = 0u; i < test_block.num_voxels(); ++i) {
+      const TsdfVoxel& voxel_gt = gt_block->getVoxelByLinearIndex(i);
+      const TsdfVoxel& voxel_test = test_block.getVoxelByLinearIndex(i);
+      if (voxel_gt.weight > 0.0f && voxel_test.weight > 0.0f) {
+        errors.push_back(std::abs(voxel_test.distance - voxel_gt.distance));
+        const FloatingPoint gt_distance = std::abs(voxel_gt.distance);
+        ++band_voxels[gt_distance < 0.1f ? 0u : (gt_distance < 0.3f ? 1u : 2u)];
+      }
+    }
+  }
+  ASSERT_EQ(errors.size(), report.total.num_evaluated_voxels);
+  for (size_t band = 0u; band < band_voxels.size(); ++band) {
+    EXPECT_EQ(band_voxels[band], report.bands[band].num_evaluated_voxels);
+  }
+
+  // Percentiles are given to the histogram bin width, except past the last
+  // bin, where they are the max error.
+  std::sort(errors.begin(), errors.end());
+  for (const FloatingPoint quantile : {0.5f, 0.9f}) {
+    const FloatingPoint expected = errors[static_cast<size_t>(
+        std::ceil(quantile * errors.size())) - 1u];
+    const FloatingPoint percentile = report.total.percentile(quantile);
+    EXPECT_GE(percentile + 1e-6, expected);
+    EXPECT_LE(percentile, expected + config.histogram_bin_width_m);
+  }
+  EXPECT_EQ(errors.back(), report.total.percentile(1.0f));
+  EXPECT_EQ(errors.back(), report.total.max_error);
+}
+
+TEST_F(LayerEvaluatorTest, StreamedFilesMatchLayers) {
+  const std::string gt_file_path = "layer_evaluator_gt.voxblox";
+  const std::string test_file_path = "layer_evaluator_test.voxblox";
+  ASSERT_TRUE(io::SaveLayer(layer_gt_, gt_file_path));
+  ASSERT_TRUE(io::SaveLayer(layer_test_, test_file_path));
+
+  utils::LayerEvaluator<TsdfVoxel>::Config config;
+  config.num_threads = 4u;
+  const utils::LayerEvaluationReport layer_report =
+      utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayers(
+          layer_gt_, layer_test_);
+
+  // Fewer blocks per chunk than there are in the layers.
+  for (const size_t blocks_per_chunk : {7u, 1000u}) {
+    config.blocks_per_chunk = blocks_per_chunk;
+    utils::LayerEvaluationReport file_report(
+        config.band_edges_m, config.percentiles, 1.0, 1u);
+    ASSERT_TRUE(utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayerFiles(
+        gt_file_path, test_file_path, &file_report));
+    expectSameReports(layer_report, file_report);
+  }
+
+  // Layers of other voxel types are not evaluated.
+  utils::LayerEvaluator<EsdfVoxel> esdf_evaluator(
+      utils::LayerEvaluator<EsdfVoxel>::Config{});
+  utils::LayerEvaluationReport esdf_report(
+      config.band_edges_m, config.percentiles, 1.0, 1u);
+  EXPECT_FALSE(esdf_evaluator.evaluateLayerFiles(
+      gt_file_path, test_file_path, &esdf_report));
+}
+
+TEST_F(LayerEvaluatorTest, Reports) {
+  utils::LayerEvaluator<TsdfVoxel>::Config config;
+  const utils::LayerEvaluationReport report =
+      utils::LayerEvaluator<TsdfVoxel>(config).evaluateLayers(
+          layer_gt_, layer_test_);
+
+  // A header, one row per band and one for all the voxels.
+  const std::string csv = report.toCsv();
+  EXPECT_EQ(
+      config.band_edges_m.size() + 3u,
+      static_cast<size_t>(std::count(csv.begin(), csv.end(), '\n')));
+  EXPECT_EQ(0u, csv.find("band,min_gt_distance,max_gt_distance"));
+
+  const std::string json = report.toJson();
+  EXPECT_EQ('{', json.front());
+  EXPECT_NE(std::string::npos, json.find("\"histogram\": ["));
+  EXPECT_EQ(
+      std::count(json.begin(), json.end(), '{'),
+      std::count(json.begin(), json.end(), '}'));
+
+  EXPECT_TRUE(report.saveToFile("layer_evaluator_report.csv"));
+  EXPECT_TRUE(report.saveToFile("layer_evaluator_report.json"));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
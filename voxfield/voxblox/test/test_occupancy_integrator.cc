@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+
+#include "voxblox/core/block_hash.h"
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/integrator/esdf_occ_fiesta_integrator.h"
+#include "voxblox/integrator/esdf_occ_integrator.h"
+#include "voxblox/integrator/integrator_utils.h"
+#include "voxblox/integrator/occupancy_integrator.h"
+#include "voxblox/simulation/simulation_world.h"
+#include "voxblox/test/simulation_test_utils.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSize = 0.1f;
+const size_t kVoxelsPerSide = 8u;
+const FloatingPoint kMaxRayLength = 4.0f;
+const size_t kNumThreads = 4u;
+
+}  // namespace
+
+class OccupancyIntegratorTest : public ::testing::Test {
+ protected:
+  /// A room with a few objects, scanned from a circle of poses.
+  void SetUp() override {
+    test::createRoomWorld(&world_);
+    poses_ = test::getCirclePoses(4u, 1.5, 1.2);
+    for (const Transformation& pose : poses_) {
+      Pointcloud ptcloud_C;
+      Colors colors;
+      test::getScanFromPose(
+          world_, pose, Eigen::Vector2i(80, 60), 1.5, 6.0, &ptcloud_C, &colors);
+      scans_.push_back(ptcloud_C);
+    }
+  }
+
+  OccupancyIntegrator::Config getConfig(size_t num_threads) const {
+    OccupancyIntegrator::Config config;
+    config.max_ray_length_m = kMaxRayLength;
+    config.integrator_threads = num_threads;
+    return config;
+  }
+
+  /**
+   * The scan-level rules, one ray at a time: a voxel gets a hit if a ray ends
+   * in it and a miss if rays only pass through it, or all the hits and misses
+   * clamped once if update_per_ray is set.
+   */
+  void integrateReference(
+      const OccupancyIntegrator::Config& config, const Transformation& T_G_C,
+      const Pointcloud& points_C, Layer<OccupancyVoxel>* layer) {
+    LongIndexHashMapType<std::pair<size_t, size_t>>::type counts;
+    const Point origin = T_G_C.getPosition();
+    const FloatingPoint voxel_size_inv = 1.0 / layer->voxel_size();
+    for (const Point& point_C : points_C) {
+      const Point point_G = T_G_C * point_C;
+      const FloatingPoint ray_distance = (point_G - origin).norm();
+      if (ray_distance < config.min_ray_length_m) {
+        continue;
+      }
+      const bool hit = ray_distance <= config.max_ray_length_m;
+      const Point end =
+          hit ? point_G
+              : Point(
+                    origin + config.max_ray_length_m *
+                                 (point_G - origin).normalized());
+      AlignedVector<GlobalIndex> ray;
+      castRay(origin * voxel_size_inv, end * voxel_size_inv, &ray);
+      if (hit && ray.size() <= 2u) {
+        continue;
+      }
+      for (size_t i = 0u; i < ray.size(); ++i) {
+        if (hit && i + 1u == ray.size()) {
+          ++counts[ray[i]].first;
+        } else {
+          ++counts[ray[i]].second;
+        }
+      }
+    }
+
+    OccupancyIntegrator integrator(config, layer);
+    const float hit_log = logOddsFromProbability(config.probability_hit);
+    const float miss_log = logOddsFromProbability(config.probability_miss);
+    for (const auto& voxel_counts : counts) {
+      const BlockIndex block_index = getBlockIndexFromGlobalVoxelIndex(
+          voxel_counts.first, 1.0 / layer->voxels_per_side());
+      OccupancyVoxel& voxel =
+          layer->allocateBlockPtrByIndex(block_index)
+              ->getVoxelByVoxelIndex(getLocalFromGlobalVoxelIndex(
+                  voxel_counts.first, layer->voxels_per_side()));
+      if (config.update_per_ray) {
+        integrator.updateOccupancyVoxelLogOdds(
+            voxel_counts.second.first * hit_log +
+                voxel_counts.second.second * miss_log,
+            &voxel);
+      } else {
+        integrator.updateOccupancyVoxel(
+            voxel_counts.second.first > 0u, &voxel);
+      }
+      voxel.occupied = voxel.probability_log > 0.0f;
+    }
+  }
+
+  void expectSameOccupancy(
+      const Layer<OccupancyVoxel>& layer_a,
+      const Layer<OccupancyVoxel>& layer_b) {
+    BlockIndexList blocks;
+    layer_a.getAllAllocatedBlocks(&blocks);
+    ASSERT_EQ(
+        layer_a.getNumberOfAllocatedBlocks(),
+        layer_b.getNumberOfAllocatedBlocks());
+    size_t num_observed = 0u;
+    for (const BlockIndex& block_index : blocks) {
+      const Block<OccupancyVoxel>& block_a =
+          layer_a.getBlockByIndex(block_index);
+      Block<OccupancyVoxel>::ConstPtr block_b =
+          layer_b.getBlockPtrByIndex(block_index);
+      ASSERT_TRUE(block_b);
+      for (size_t i = 0u; i < block_a.num_voxels(); ++i) {
+        const OccupancyVoxel& voxel_a = block_a.getVoxelByLinearIndex(i);
+        const OccupancyVoxel& voxel_b = block_b->getVoxelByLinearIndex(i);
+        ASSERT_EQ(voxel_a.observed, voxel_b.observed);
+        EXPECT_EQ(voxel_a.occupied, voxel_b.occupied);
+        EXPECT_NEAR(voxel_a.probability_log, voxel_b.probability_log, 1e-5);
+        num_observed += voxel_a.observed ? 1u : 0u;
+      }
+    }
+    EXPECT_GT(num_observed, 0u);
+  }
+
+  /// Same observed voxels, with the same distances.
+  void expectSameEsdf(
+      const Layer<EsdfVoxel>& layer_a, const Layer<EsdfVoxel>& layer_b) {
+    BlockIndexList blocks;
+    layer_a.getAllAllocatedBlocks(&blocks);
+    size_t num_observed = 0u;
+    for (const BlockIndex& block_index : blocks) {
+      const Block<EsdfVoxel>& block_a = layer_a.getBlockByIndex(block_index);
+      Block<EsdfVoxel>::ConstPtr block_b =
+          layer_b.getBlockPtrByIndex(block_index);
+      for (size_t i = 0u; i < block_a.num_voxels(); ++i) {
+        const EsdfVoxel& voxel_a = block_a.getVoxelByLinearIndex(i);
+        if (!voxel_a.observed) {
+          continue;
+        }
+        ++num_observed;
+        ASSERT_TRUE(block_b);
+        const EsdfVoxel& voxel_b = block_b->getVoxelByLinearIndex(i);
+        ASSERT_TRUE(voxel_b.observed);
+        EXPECT_NEAR(voxel_a.distance, voxel_b.distance, 1e-4);
+      }
+    }
+    EXPECT_GT(num_observed, 0u);
+  }
+
+  SimulationWorld world_;
+  AlignedVector<Transformation> poses_;
+  AlignedVector<Pointcloud> scans_;
+};
+
+TEST_F(OccupancyIntegratorTest, MatchesReference) {
+  for (const bool update_per_ray : {false, true}) {
+    OccupancyIntegrator::Config config = getConfig(kNumThreads);
+    config.update_per_ray = update_per_ray;
+    Layer<OccupancyVoxel> layer(kVoxelSize, kVoxelsPerSide);
+    OccupancyIntegrator integrator(config, &layer);
+    Layer<OccupancyVoxel> reference_layer(kVoxelSize, kVoxelsPerSide);
+    for (size_t i = 0u; i < poses_.size(); ++i) {
+      integrator.integratePointCloud(poses_[i], scans_[i]);
+      integrateReference(config, poses_[i], scans_[i], &reference_layer);
+      expectSameOccupancy(reference_layer, layer);
+    }
+  }
+}
+
+TEST_F(OccupancyIntegratorTest, ThreadsMatchSerial) {
+  Layer<OccupancyVoxel> serial_layer(kVoxelSize, kVoxelsPerSide);
+  OccupancyIntegrator serial_integrator(getConfig(1u), &serial_layer);
+  Layer<OccupancyVoxel> parallel_layer(kVoxelSize, kVoxelsPerSide);
+  OccupancyIntegrator parallel_integrator(
+      getConfig(kNumThreads), &parallel_layer);
+
+  size_t num_inserted = 0u;
+  for (size_t i = 0u; i < poses_.size(); ++i) {
+    serial_integrator.integratePointCloud(poses_[i], scans_[i]);
+    parallel_integrator.integratePointCloud(poses_[i], scans_[i]);
+    expectSameOccupancy(serial_layer, parallel_layer);
+
+    // The same changes, in the same order.
+    EXPECT_TRUE(
+        serial_integrator.getChangedList() ==
+        parallel_integrator.getChangedList());
+    EXPECT_TRUE(
+        serial_integrator.getInsertList() ==
+        parallel_integrator.getInsertList());
+    EXPECT_TRUE(
+        serial_integrator.getDeleteList() ==
+        parallel_integrator.getDeleteList());
+
+    for (const GlobalIndex& global_index :
+         parallel_integrator.getInsertList()) {
+      EXPECT_TRUE(parallel_layer.getVoxelPtrByGlobalIndex(global_index)
+                      ->occupied);
+    }
+    for (const GlobalIndex& global_index :
+         parallel_integrator.getDeleteList()) {
+      EXPECT_FALSE(parallel_layer.getVoxelPtrByGlobalIndex(global_index)
+                       ->occupied);
+    }
+    EXPECT_GE(
+        parallel_integrator.getChangedList().size(),
+        parallel_integrator.getInsertList().size() +
+            parallel_integrator.getDeleteList().size());
+    num_inserted += parallel_integrator.getInsertList().size();
+  }
+  EXPECT_GT(num_inserted, 0u);
+}
+
+TEST_F(OccupancyIntegratorTest, EsdfFromChangedVoxels) {
+  Layer<OccupancyVoxel> occ_layer(kVoxelSize, kVoxelsPerSide);
+  OccupancyIntegrator occ_integrator(getConfig(kNumThreads), &occ_layer);
+
+  EsdfOccIntegrator::Config esdf_config;
+  Layer<EsdfVoxel> batch_layer(kVoxelSize, kVoxelsPerSide);
+  EsdfOccIntegrator batch_integrator(esdf_config, &occ_layer, &batch_layer);
+  Layer<EsdfVoxel> changed_layer(kVoxelSize, kVoxelsPerSide);
+  EsdfOccIntegrator changed_integrator(
+      esdf_config, &occ_layer, &changed_layer);
+
+  // The FIESTA integrator from the changed voxels or from the updated blocks.
+  EsdfOccFiestaIntegrator::Config fiesta_config;
+  fiesta_config.max_distance_m = 2.0;
+  fiesta_config.default_distance_m = 2.0;
+  Layer<EsdfVoxel> fiesta_blocks_layer(kVoxelSize, kVoxelsPerSide);
+  EsdfOccFiestaIntegrator fiesta_blocks_integrator(
+      fiesta_config, &occ_layer, &fiesta_blocks_layer);
+  Layer<EsdfVoxel> fiesta_voxels_layer(kVoxelSize, kVoxelsPerSide);
+  EsdfOccFiestaIntegrator fiesta_voxels_integrator(
+      fiesta_config, &occ_layer, &fiesta_voxels_layer);
+
+  for (size_t i = 0u; i < poses_.size(); ++i) {
+    occ_integrator.integratePointCloud(poses_[i], scans_[i]);
+
+    // The updated blocks first, the changed voxels clear their flags.
+    fiesta_blocks_integrator.loadInsertList(occ_integrator.getInsertList());
+    fiesta_blocks_integrator.loadDeleteList(occ_integrator.getDeleteList());
+    fiesta_blocks_integrator.updateFromOccLayer(false);
+    fiesta_blocks_integrator.clear();
+
+    batch_integrator.updateFromOccLayerBatch();
+    changed_integrator.updateFromOccVoxels(
+        occ_integrator.getChangedList(), false);
+    expectSameEsdf(batch_layer, changed_layer);
+
+    fiesta_voxels_integrator.loadInsertList(occ_integrator.getInsertList());
+    fiesta_voxels_integrator.loadDeleteList(occ_integrator.getDeleteList());
+    BlockIndexList updated_blocks;
+    occ_layer.getAllUpdatedBlocks(Update::kEsdf, &updated_blocks);
+    EXPECT_FALSE(updated_blocks.empty());
+    const bool kClearUpdatedFlag = true;
+    fiesta_voxels_integrator.updateFromOccVoxels(
+        occ_integrator.getChangedList(), kClearUpdatedFlag);
+    fiesta_voxels_integrator.clear();
+    expectSameEsdf(fiesta_blocks_layer, fiesta_voxels_layer);
+
+    // Also the flags of the updated blocks without any changed voxel.
+    occ_layer.getAllUpdatedBlocks(Update::kEsdf, &updated_blocks);
+    EXPECT_TRUE(updated_blocks.empty());
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/common.h"
+#include "voxblox/integrator/integrator_utils.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSizeInv = 10.0f;
+const FloatingPoint kTruncationDistance = 0.3f;
+const FloatingPoint kMaxRayLength = 5.0f;
+
+}  // namespace
+
+class PacketRayCasterTest : public ::testing::Test {
+ protected:
+  /// Every ray of the batch returns the same indices as RayCaster.
+  void expectSameIndices(
+      const AlignedVector<RayCaster>& ray_casters,
+      PacketRayCaster* packet_ray_caster) {
+    packet_ray_caster->clear();
+    for (const RayCaster& ray_caster : ray_casters) {
+      packet_ray_caster->addRay(ray_caster);
+    }
+    packet_ray_caster->castRays();
+
+    ASSERT_EQ(packet_ray_caster->numRays(), ray_casters.size());
+    for (size_t ray = 0u; ray < ray_casters.size(); ++ray) {
+      RayCaster ray_caster(ray_casters[ray]);
+      const GlobalIndex* index = packet_ray_caster->rayBegin(ray);
+      GlobalIndex expected_index;
+      while (ray_caster.nextRayIndex(&expected_index)) {
+        ASSERT_NE(index, packet_ray_caster->rayEnd(ray)) << "ray " << ray;
+        EXPECT_EQ(expected_index, *index) << "ray " << ray;
+        ++index;
+      }
+      EXPECT_EQ(index, packet_ray_caster->rayEnd(ray)) << "ray " << ray;
+    }
+  }
+
+  Point randomPoint(const FloatingPoint range) {
+    std::uniform_real_distribution<FloatingPoint> distribution(-range, range);
+    return Point(
+        distribution(generator_), distribution(generator_),
+        distribution(generator_));
+  }
+
+  std::mt19937 generator_{0u};
+};
+
+TEST_F(PacketRayCasterTest, RandomRays) {
+  PacketRayCaster packet_ray_caster;
+  for (int batch = 0; batch < 20; ++batch) {
+    AlignedVector<RayCaster> ray_casters;
+    const Point origin = randomPoint(3.0f);
+    for (size_t i = 0u; i < PacketRayCaster::kBatchSize; ++i) {
+      const Point point_G = origin + randomPoint(8.0f);
+      const bool is_clearing = (point_G - origin).norm() > kMaxRayLength;
+      const bool voxel_carving_enabled = i % 3u != 0u;
+      const bool cast_from_origin = i % 5u != 0u;
+      ray_casters.emplace_back(
+          origin, point_G, is_clearing, voxel_carving_enabled, kMaxRayLength,
+          kVoxelSizeInv, kTruncationDistance, cast_from_origin);
+    }
+    expectSameIndices(ray_casters, &packet_ray_caster);
+  }
+}
+
+TEST_F(PacketRayCasterTest, DegenerateRays) {
+  AlignedVector<RayCaster> ray_casters;
+  const Point origin(0.05f, 0.05f, 0.05f);
+  // Along the axes, on voxel boundaries, inside a single voxel, of length zero
+  // and with NaN coordinates.
+  ray_casters.emplace_back(Point(0.0f, 0.0f, 0.0f), Point(12.0f, 0.0f, 0.0f));
+  ray_casters.emplace_back(Point(0.5f, 0.5f, 0.5f), Point(0.5f, -7.5f, 0.5f));
+  ray_casters.emplace_back(Point(1.0f, 2.0f, 3.0f), Point(1.0f, 2.0f, -9.0f));
+  ray_casters.emplace_back(Point(0.1f, 0.2f, 0.3f), Point(0.7f, 0.6f, 0.5f));
+  ray_casters.emplace_back(Point(2.0f, 2.0f, 2.0f), Point(2.0f, 2.0f, 2.0f));
+  ray_casters.emplace_back(Point(0.0f, 0.0f, 0.0f), Point(5.0f, 5.0f, 5.0f));
+  ray_casters.emplace_back(
+      Point(std::numeric_limits<FloatingPoint>::quiet_NaN(), 0.0f, 0.0f),
+      Point(1.0f, 1.0f, 1.0f));
+  ray_casters.emplace_back(
+      origin, origin, false, true, kMaxRayLength, kVoxelSizeInv,
+      kTruncationDistance);
+  PacketRayCaster packet_ray_caster;
+  expectSameIndices(ray_casters, &packet_ray_caster);
+}
+
+TEST_F(PacketRayCasterTest, PartiallyCastRay) {
+  AlignedVector<RayCaster> ray_casters;
+  ray_casters.emplace_back(Point(0.3f, -0.2f, 0.1f), Point(20.3f, 7.9f, -4.4f));
+  GlobalIndex index;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(ray_casters.front().nextRayIndex(&index));
+  }
+  PacketRayCaster packet_ray_caster;
+  expectSameIndices(ray_casters, &packet_ray_caster);
+}
+
+TEST_F(PacketRayCasterTest, FarFromTheOrigin) {
+  // Beyond the indices of the lanes, cast by RayCaster.
+  AlignedVector<RayCaster> ray_casters;
+  const FloatingPoint far = 3e9f;
+  ray_casters.emplace_back(Point(far, 0.5f, 0.5f), Point(far, 10.5f, 3.5f));
+  ray_casters.emplace_back(Point(0.5f, 0.5f, 0.5f), Point(10.5f, 4.5f, 3.5f));
+  PacketRayCaster packet_ray_caster;
+  expectSameIndices(ray_casters, &packet_ray_caster);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
@@ -0,0 +1,201 @@
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/integrator/merge_integration.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSize = 0.1f;
+const size_t kNumThreads = 4u;
+
+}  // namespace
+
+class ParallelTransformLayerTest : public ::testing::Test {
+ protected:
+  void expectSameVoxel(const TsdfVoxel& voxel_a, const TsdfVoxel& voxel_b) {
+    EXPECT_EQ(voxel_a.distance, voxel_b.distance);
+    EXPECT_EQ(voxel_a.weight, voxel_b.weight);
+    EXPECT_EQ(voxel_a.color.r, voxel_b.color.r);
+    EXPECT_EQ(voxel_a.color.g, voxel_b.color.g);
+    EXPECT_EQ(voxel_a.color.b, voxel_b.color.b);
+    EXPECT_EQ(voxel_a.color.a, voxel_b.color.a);
+  }
+
+  /// A sphere over a few blocks, with some voxels not observed.
+  void fillLayer(Layer<TsdfVoxel>* layer) {
+    std::uniform_real_distribution<FloatingPoint> distribution(0.0f, 1.0f);
+    const Point center(0.13f, 0.41f, -0.22f);
+    for (IndexElement x = -2; x < 2; ++x) {
+      for (IndexElement y = -1; y < 2; ++y) {
+        for (IndexElement z = -2; z < 1; ++z) {
+          Block<TsdfVoxel>::Ptr block =
+              layer->allocateBlockPtrByIndex(BlockIndex(x, y, z));
+          for (size_t i = 0u; i < block->num_voxels(); ++i) {
+            TsdfVoxel& voxel = block->getVoxelByLinearIndex(i);
+            const Point coordinates =
+                block->computeCoordinatesFromLinearIndex(i);
+            voxel.distance = (coordinates - center).norm() - 0.6f;
+            voxel.weight = distribution(generator_) < 0.1f
+                               ? 0.0f
+                               : distribution(generator_);
+            voxel.color = Color(i % 256u, x + 10, y + 10);
+          }
+          block->has_data() = true;
+        }
+      }
+    }
+  }
+
+  /// Same blocks, with exactly the same voxels.
+  void expectSameLayers(
+      const Layer<TsdfVoxel>& layer_a, const Layer<TsdfVoxel>& layer_b) {
+    ASSERT_EQ(
+        layer_a.getNumberOfAllocatedBlocks(),
+        layer_b.getNumberOfAllocatedBlocks());
+    BlockIndexList blocks;
+    layer_a.getAllAllocatedBlocks(&blocks);
+    for (const BlockIndex& block_index : blocks) {
+      Block<TsdfVoxel>::ConstPtr block_a =
+          layer_a.getBlockPtrByIndex(block_index);
+      Block<TsdfVoxel>::ConstPtr block_b =
+          layer_b.getBlockPtrByIndex(block_index);
+      ASSERT_TRUE(block_b != nullptr);
+      EXPECT_EQ(block_a->has_data(), block_b->has_data());
+      for (size_t i = 0u; i < block_a->num_voxels(); ++i) {
+        expectSameVoxel(
+            block_a->getVoxelByLinearIndex(i),
+            block_b->getVoxelByLinearIndex(i));
+      }
+    }
+  }
+
+  std::mt19937 generator_{0u};
+};
+
+TEST_F(ParallelTransformLayerTest, TransformMatchesSerial) {
+  Layer<TsdfVoxel> layer_in(kVoxelSize, 8u);
+  fillLayer(&layer_in);
+  const Transformation T_out_in(
+      Transformation::Position(0.23f, -0.51f, 0.07f),
+      Transformation::Rotation(Quaternion(
+          Eigen::AngleAxis<FloatingPoint>(0.4f, Ray(1, 2, 3).normalized()))));
+
+  Layer<TsdfVoxel> serial_layer(kVoxelSize, 8u);
+  transformLayer(layer_in, T_out_in, &serial_layer, 1u);
+  Layer<TsdfVoxel> parallel_layer(kVoxelSize, 8u);
+  transformLayer(layer_in, T_out_in, &parallel_layer, kNumThreads);
+
+  EXPECT_GT(serial_layer.getNumberOfAllocatedBlocks(), 0u);
+  expectSameLayers(serial_layer, parallel_layer);
+}
+
+TEST_F(ParallelTransformLayerTest, ResampleMatchesSerial) {
+  Layer<TsdfVoxel> layer_in(kVoxelSize, 8u);
+  fillLayer(&layer_in);
+
+  Layer<TsdfVoxel> serial_layer(0.5f * kVoxelSize, 16u);
+  resampleLayer(layer_in, &serial_layer, 1u);
+  Layer<TsdfVoxel> parallel_layer(0.5f * kVoxelSize, 16u);
+  resampleLayer(layer_in, &parallel_layer, kNumThreads);
+
+  EXPECT_GT(serial_layer.getNumberOfAllocatedBlocks(), 0u);
+  expectSameLayers(serial_layer, parallel_layer);
+}
+
+TEST_F(ParallelTransformLayerTest, VoxelAlignedTranslationCopiesVoxels) {
+  Layer<TsdfVoxel> layer_in(kVoxelSize, 8u);
+  fillLayer(&layer_in);
+  const GlobalIndex voxel_offset(3, -11, 17);
+  const Transformation T_out_in(
+      Transformation::Position(
+          voxel_offset.cast<FloatingPoint>() * kVoxelSize),
+      Transformation::Rotation());
+
+  // Also between layers with different blocks.
+  for (const size_t voxels_per_side : {8u, 4u, 16u}) {
+    Layer<TsdfVoxel> layer_out(kVoxelSize, voxels_per_side);
+    GlobalIndex detected_offset;
+    ASSERT_TRUE(isVoxelAlignedTranslation(
+        layer_in, T_out_in, layer_out, &detected_offset));
+    EXPECT_EQ(voxel_offset, detected_offset);
+    transformLayer(layer_in, T_out_in, &layer_out, kNumThreads);
+
+    Layer<TsdfVoxel> serial_layer(kVoxelSize, voxels_per_side);
+    copyLayerWithVoxelOffset(layer_in, voxel_offset, &serial_layer, 1u);
+    expectSameLayers(serial_layer, layer_out);
+
+    // Every input voxel is in the output, voxel_offset voxels away.
+    BlockIndexList blocks;
+    layer_in.getAllAllocatedBlocks(&blocks);
+    for (const BlockIndex& block_index : blocks) {
+      Block<TsdfVoxel>::ConstPtr block_in =
+          layer_in.getBlockPtrByIndex(block_index);
+      for (size_t i = 0u; i < block_in->num_voxels(); ++i) {
+        const TsdfVoxel& voxel_in = block_in->getVoxelByLinearIndex(i);
+        const TsdfVoxel* voxel_out = layer_out.getVoxelPtrByGlobalIndex(
+            getGlobalVoxelIndexFromBlockAndVoxelIndex(
+                block_index, block_in->computeVoxelIndexFromLinearIndex(i),
+                layer_in.voxels_per_side()) +
+            voxel_offset);
+        ASSERT_TRUE(voxel_out != nullptr);
+        expectSameVoxel(voxel_in, *voxel_out);
+      }
+    }
+  }
+}
+
+TEST_F(ParallelTransformLayerTest, CopyMatchesInterpolation) {
+  Layer<TsdfVoxel> layer_in(kVoxelSize, 8u);
+  fillLayer(&layer_in);
+  const Point translation(0.3f, -0.2f, 0.5f);
+
+  Layer<TsdfVoxel> copied_layer(kVoxelSize, 8u);
+  transformLayer(
+      layer_in, Transformation(translation, Transformation::Rotation()),
+      &copied_layer, kNumThreads);
+
+  // Slightly off a whole number of voxels the output is interpolated instead.
+  Layer<TsdfVoxel> interpolated_layer(kVoxelSize, 8u);
+  const Point shift = Point::Constant(0.01f * kVoxelSize);
+  transformLayer(
+      layer_in, Transformation(translation + shift, Transformation::Rotation()),
+      &interpolated_layer, kNumThreads);
+
+  BlockIndexList blocks;
+  copied_layer.getAllAllocatedBlocks(&blocks);
+  size_t compared_voxels = 0u;
+  for (const BlockIndex& block_index : blocks) {
+    Block<TsdfVoxel>::ConstPtr copied_block =
+        copied_layer.getBlockPtrByIndex(block_index);
+    Block<TsdfVoxel>::ConstPtr interpolated_block =
+        interpolated_layer.getBlockPtrByIndex(block_index);
+    ASSERT_TRUE(interpolated_block != nullptr);
+    for (size_t i = 0u; i < copied_block->num_voxels(); ++i) {
+      const TsdfVoxel& copied_voxel = copied_block->getVoxelByLinearIndex(i);
+      const TsdfVoxel& interpolated_voxel =
+          interpolated_block->getVoxelByLinearIndex(i);
+      if (copied_voxel.weight > 0.0f && interpolated_voxel.weight > 0.0f) {
+        EXPECT_NEAR(
+            copied_voxel.distance, interpolated_voxel.distance,
+            0.1f * kVoxelSize);
+        ++compared_voxels;
+      }
+    }
+  }
+  EXPECT_GT(compared_voxels, 0u);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
@@ -0,0 +1,251 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/core/layer.h"
+#include "voxblox/core/voxel.h"
+#include "voxblox/simulation/simulation_world.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const FloatingPoint kVoxelSize = 0.1f;
+const FloatingPoint kMaxDist = 2.0f;
+const FloatingPoint kNoiseSigma = 0.05f;
+const size_t kNumThreads = 4u;
+
+}  // namespace
+
+class SimulationWorldTest : public ::testing::Test {
+ protected:
+  /**
+   * A room with objects of every type. The test keeps the objects of the last
+   * world set up, to cast the rays into all of them.
+   */
+  void setUpWorld(SimulationWorld* world, size_t num_threads) {
+    world->setBounds(Point(-5.0, -5.0, -1.0), Point(5.0, 5.0, 3.0));
+    world->setNumThreads(num_threads);
+    objects_.clear();
+    addObject(
+        new PlaneObject(Point(0.0, 0.0, -0.5), Point(0.0, 0.0, 1.0)), world);
+    addObject(
+        new PlaneObject(Point(0.0, 0.0, 2.5), Point(0.0, 0.0, -1.0)), world);
+    addObject(
+        new PlaneObject(Point(-4.5, 0.0, 0.0), Point(1.0, 0.0, 0.0)), world);
+    addObject(
+        new PlaneObject(Point(4.5, 0.0, 0.0), Point(-1.0, 0.0, 0.0)), world);
+    addObject(
+        new PlaneObject(Point(0.0, -4.5, 0.0), Point(0.0, 1.0, 0.0)), world);
+    addObject(
+        new PlaneObject(Point(0.0, 4.5, 0.0), Point(0.0, -1.0, 0.0)), world);
+    addObject(new Sphere(Point(2.0, 1.0, 0.5), 0.8, Color(255, 0, 0)), world);
+    addObject(new Sphere(Point(-2.5, -2.0, 1.5), 0.4), world);
+    addObject(
+        new Cube(Point(-1.5, 2.0, 0.0), Point(1.0, 0.6, 1.5), Color(0, 255, 0)),
+        world);
+    addObject(
+        new Cylinder(Point(1.0, -2.5, 0.5), 0.5, 2.0, Color(0, 0, 255)), world);
+    addObject(new Cube(Point(0.0, 0.0, 0.0), Point(0.3, 0.3, 0.3)), world);
+  }
+
+  void addObject(Object* object, SimulationWorld* world) {
+    objects_.push_back(object);
+    world->addObject(std::unique_ptr<Object>(object));
+  }
+
+  /// The closest intersection of the ray with any object, without culling.
+  bool castRayIntoAllObjects(
+      const Point& ray_origin, const Point& ray_direction, Point* ray_intersect,
+      Color* ray_color) {
+    bool ray_valid = false;
+    FloatingPoint ray_dist = kMaxDist;
+    for (const Object* object : objects_) {
+      Point object_intersect;
+      FloatingPoint object_dist;
+      if (object->getRayIntersection(
+              ray_origin, ray_direction, kMaxDist, &object_intersect,
+              &object_dist) &&
+          (!ray_valid || object_dist < ray_dist)) {
+        ray_valid = true;
+        ray_dist = object_dist;
+        *ray_intersect = object_intersect;
+        *ray_color = object->getColor();
+      }
+    }
+    return ray_valid;
+  }
+
+  void expectSamePointclouds(
+      const Pointcloud& ptcloud_a, const Colors& colors_a,
+      const Pointcloud& ptcloud_b, const Colors& colors_b) {
+    ASSERT_EQ(ptcloud_a.size(), ptcloud_b.size());
+    ASSERT_EQ(colors_a.size(), colors_b.size());
+    for (size_t i = 0u; i < ptcloud_a.size(); ++i) {
+      EXPECT_TRUE(ptcloud_a[i] == ptcloud_b[i]) << "point " << i;
+      EXPECT_EQ(colors_a[i].r, colors_b[i].r);
+      EXPECT_EQ(colors_a[i].g, colors_b[i].g);
+      EXPECT_EQ(colors_a[i].b, colors_b[i].b);
+    }
+  }
+
+  std::vector<const Object*> objects_;
+};
+
+TEST_F(SimulationWorldTest, SdfMatchesAllObjects) {
+  for (const size_t num_threads : {size_t(1u), kNumThreads}) {
+    SimulationWorld world;
+    setUpWorld(&world, num_threads);
+    Layer<TsdfVoxel> layer(kVoxelSize, 16u);
+    world.generateSdfFromWorld(kMaxDist, &layer);
+
+    BlockIndexList blocks;
+    layer.getAllAllocatedBlocks(&blocks);
+    ASSERT_GT(blocks.size(), 0u);
+    size_t num_voxels = 0u;
+    for (const BlockIndex& block_index : blocks) {
+      Block<TsdfVoxel>::ConstPtr block = layer.getBlockPtrByIndex(block_index);
+      for (size_t i = 0u; i < block->num_voxels(); ++i) {
+        const TsdfVoxel& voxel = block->getVoxelByLinearIndex(i);
+        if (voxel.weight == 0.0f) {
+          continue;
+        }
+        const Point coords = block->computeCoordinatesFromLinearIndex(i);
+        const FloatingPoint expected_distance = std::max(
+            world.getDistanceToPoint(coords, kMaxDist), -kMaxDist);
+        EXPECT_EQ(expected_distance, voxel.distance);
+        ++num_voxels;
+      }
+    }
+    EXPECT_GT(num_voxels, 0u);
+  }
+}
+
+TEST_F(SimulationWorldTest, PointcloudMatchesAllObjects) {
+  const Point view_origin(0.3, -0.4, 1.0);
+  const Point view_direction = Point(1.0, 0.5, -0.2).normalized();
+  const Eigen::Vector2i camera_res(64, 48);
+  const FloatingPoint fov_h_rad = 1.5;
+
+  SimulationWorld world;
+  setUpWorld(&world, kNumThreads);
+  Pointcloud ptcloud;
+  Colors colors;
+  world.getPointcloudFromViewpoint(
+      view_origin, view_direction, camera_res, fov_h_rad, kMaxDist, &ptcloud,
+      &colors);
+
+  // The same rays as the camera, cast into every object.
+  const FloatingPoint focal_length =
+      camera_res.x() / (2 * tan(fov_h_rad / 2.0));
+  Eigen::Quaternion<FloatingPoint> rotation_quaternion =
+      Eigen::Quaternion<FloatingPoint>::FromTwoVectors(
+          Point(1.0, 0.0, 0.0), view_direction);
+  rotation_quaternion.normalize();
+  const Rotation ray_rotation(rotation_quaternion);
+  Pointcloud expected_ptcloud;
+  Colors expected_colors;
+  for (int u = -camera_res.x() / 2; u < camera_res.x() / 2; ++u) {
+    for (int v = -camera_res.y() / 2; v < camera_res.y() / 2; ++v) {
+      const Point ray_direction = ray_rotation.rotate(
+          Point(1.0, u / focal_length, v / focal_length).normalized());
+      Point ray_intersect;
+      Color ray_color;
+      if (castRayIntoAllObjects(
+              view_origin, ray_direction, &ray_intersect, &ray_color)) {
+        expected_ptcloud.push_back(ray_intersect);
+        expected_colors.push_back(ray_color);
+      }
+    }
+  }
+  EXPECT_GT(expected_ptcloud.size(), 0u);
+  EXPECT_LT(
+      expected_ptcloud.size(),
+      static_cast<size_t>(camera_res.x() * camera_res.y()));
+  expectSamePointclouds(expected_ptcloud, expected_colors, ptcloud, colors);
+}
+
+TEST_F(SimulationWorldTest, NoisyPointcloudsDoNotDependOnThreads) {
+  const Transformation pose(
+      Transformation::Position(0.3, -0.4, 1.0),
+      Transformation::Rotation(Quaternion(
+          Eigen::AngleAxis<FloatingPoint>(
+              0.7, Point(1.0, 1.0, 0.0).normalized()))));
+  const Eigen::Vector2i camera_res(40, 30);
+
+  SimulationWorld serial_world;
+  setUpWorld(&serial_world, 1u);
+  SimulationWorld parallel_world;
+  setUpWorld(&parallel_world, kNumThreads);
+
+  Pointcloud serial_ptcloud, parallel_ptcloud;
+  Colors serial_colors, parallel_colors;
+  serial_world.getNoisyPointcloudFromTransform(
+      pose, camera_res, 1.5, kMaxDist, kNoiseSigma, &serial_ptcloud,
+      &serial_colors);
+  serial_world.getNoisyLidarPointcloudFromTransform(
+      pose, 16, 360, -0.3, 0.3, kMaxDist, kNoiseSigma, &serial_ptcloud,
+      &serial_colors);
+  parallel_world.getNoisyPointcloudFromTransform(
+      pose, camera_res, 1.5, kMaxDist, kNoiseSigma, &parallel_ptcloud,
+      &parallel_colors);
+  parallel_world.getNoisyLidarPointcloudFromTransform(
+      pose, 16, 360, -0.3, 0.3, kMaxDist, kNoiseSigma, &parallel_ptcloud,
+      &parallel_colors);
+  EXPECT_GT(serial_ptcloud.size(), 0u);
+  expectSamePointclouds(
+      serial_ptcloud, serial_colors, parallel_ptcloud, parallel_colors);
+}
+
+TEST_F(SimulationWorldTest, LidarScan) {
+  SimulationWorld world;
+  setUpWorld(&world, kNumThreads);
+  const Transformation pose(
+      Transformation::Position(0.5, 0.5, 1.0),
+      Transformation::Rotation(Quaternion(
+          Eigen::AngleAxis<FloatingPoint>(0.3, Point(0.0, 0.0, 1.0)))));
+  const int num_beams = 16;
+  const int num_columns = 512;
+  const FloatingPoint min_elevation_rad = -0.4;
+  const FloatingPoint max_elevation_rad = 0.3;
+  // Far enough to always hit the room.
+  const FloatingPoint max_dist = 20.0;
+
+  Pointcloud ptcloud;
+  Colors colors;
+  world.getLidarPointcloudFromTransform(
+      pose, num_beams, num_columns, min_elevation_rad, max_elevation_rad,
+      max_dist, &ptcloud, &colors);
+  ASSERT_EQ(static_cast<size_t>(num_beams * num_columns), ptcloud.size());
+  ASSERT_EQ(ptcloud.size(), colors.size());
+
+  const Transformation T_S_W = pose.inverse();
+  for (int beam = 0; beam < num_beams; ++beam) {
+    const FloatingPoint elevation =
+        min_elevation_rad +
+        (max_elevation_rad - min_elevation_rad) * beam / (num_beams - 1);
+    for (int column = 0; column < num_columns; ++column) {
+      const Point& point = ptcloud[beam * num_columns + column];
+      // On the surface of an object, along the ray of the beam and column.
+      EXPECT_NEAR(0.0, world.getDistanceToPoint(point, max_dist), 1e-3);
+      const Point point_S = T_S_W * point;
+      EXPECT_NEAR(elevation, std::asin(point_S.z() / point_S.norm()), 1e-4);
+      FloatingPoint azimuth = std::atan2(point_S.y(), point_S.x());
+      if (azimuth < -1e-4) {
+        azimuth += 2.0 * M_PI;
+      }
+      EXPECT_NEAR(2.0 * M_PI * column / num_columns, azimuth, 1e-3);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "voxblox/utils/timing.h"
+
+using namespace voxblox;  // NOLINT
+
+namespace {
+
+const size_t kNumThreads = 8u;
+const size_t kNumTimingsPerThread = 1000u;
+
+}  // namespace
+
+TEST(TimingTest, TimerStatistics) {
+  std::mt19937 generator(0u);
+  std::uniform_real_distribution<double> uniform(1.e-6, 1.e-2);
+
+  // Half the samples in each of two statistics, interleaved in time.
+  timing::TimerStatistics all, first, second;
+  std::vector<double> samples;
+  for (int64_t i = 0; i < 1000; ++i) {
+    const double seconds = uniform(generator);
+    samples.push_back(seconds);
+    all.Add(seconds, i);
+    (i % 2 == 0 ? first : second).Add(seconds, i);
+  }
+  first.Merge(second);
+
+  EXPECT_EQ(all.TotalSamples(), first.TotalSamples());
+  EXPECT_NEAR(all.Sum(), first.Sum(), 1e-9);
+  EXPECT_EQ(all.Min(), first.Min());
+  EXPECT_EQ(all.Max(), first.Max());
+  // The window holds the same latest samples.
+  EXPECT_NEAR(all.RollingMean(), first.RollingMean(), 1e-12);
+  EXPECT_NEAR(all.LazyVariance(), first.LazyVariance(), 1e-12);
+
+  double window_mean = 0.0;
+  for (size_t i = samples.size() - timing::TimerStatistics::kWindowSize;
+       i < samples.size(); ++i) {
+    window_mean += samples[i];
+  }
+  window_mean /= timing::TimerStatistics::kWindowSize;
+  EXPECT_NEAR(window_mean, all.RollingMean(), 1e-12);
+
+  // Percentiles are the upper edge of their bin, within a bin width.
+  std::sort(samples.begin(), samples.end());
+  const double bin_ratio =
+      std::exp2(1.0 / timing::TimerStatistics::kBinsPerOctave);
+  for (const double quantile : {0.5, 0.9, 0.99}) {
+    const double expected = samples[static_cast<size_t>(
+        std::ceil(quantile * samples.size())) - 1u];
+    const double percentile = all.Percentile(quantile);
+    EXPECT_EQ(percentile, first.Percentile(quantile));
+    EXPECT_GE(percentile, expected);
+    EXPECT_LE(percentile, expected * bin_ratio);
+  }
+  EXPECT_EQ(samples.back(), all.Percentile(1.0));
+
+  const timing::TimerStatistics empty;
+  EXPECT_EQ(0u, empty.TotalSamples());
+  EXPECT_EQ(0.0, empty.Min());
+  EXPECT_EQ(0.0, empty.Percentile(0.5));
+}
+
+TEST(TimingTest, ThreadsAreMergedOnRead) {
+  const std::string tag = "test_timing/threads";
+
+  // The main thread times while the other threads are running, the other
+  // threads are merged when they exit.
+  std::list<std::thread> threads;
+  for (size_t i = 1u; i < kNumThreads; ++i) {
+    threads.emplace_back([&tag]() {
+      for (size_t j = 0u; j < kNumTimingsPerThread; ++j) {
+        timing::Timer timer(tag);
+        timer.Stop();
+      }
+    });
+  }
+  for (size_t j = 0u; j < kNumTimingsPerThread; ++j) {
+    timing::Timer timer(tag);
+    timer.Stop();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(
+      kNumThreads * kNumTimingsPerThread, timing::Timing::GetNumSamples(tag));
+  EXPECT_GE(timing::Timing::GetTotalSeconds(tag), 0.0);
+  EXPECT_LE(
+      timing::Timing::GetMinSeconds(tag),
+      timing::Timing::GetPercentileSeconds(tag, 0.5));
+  EXPECT_LE(
+      timing::Timing::GetPercentileSeconds(tag, 0.5),
+      timing::Timing::GetMaxSeconds(tag));
+}
+
+TEST(TimingTest, PausedTimer) {
+  const std::string tag = "test_timing/paused";
+  {
+    timing::Timer timer(tag);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    timer.Pause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timer.Unpause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(1u, timing::Timing::GetNumSamples(tag));
+  EXPECT_GE(timing::Timing::GetTotalSeconds(tag), 0.01);
+  EXPECT_LT(timing::Timing::GetTotalSeconds(tag), 0.025);
+}
+
+TEST(TimingTest, Exports) {
+  timing::Timer timer("test_timing/exports");
+  timer.Stop();
+  const size_t num_timers = timing::Timing::GetTimers().size();
+
+  // A header and one row per timer.
+  const std::string csv = timing::Timing::PrintCsv();
+  EXPECT_EQ(
+      num_timers + 1u,
+      static_cast<size_t>(std::count(csv.begin(), csv.end(), '\n')));
+  EXPECT_EQ(0u, csv.find("tag,num_samples,total_s"));
+  EXPECT_NE(std::string::npos, csv.find("\ntest_timing/exports,1,"));
+
+  const std::string json = timing::Timing::PrintJson();
+  EXPECT_EQ('{', json.front());
+  EXPECT_NE(
+      std::string::npos, json.find("\"tag\": \"test_timing/exports\""));
+  EXPECT_EQ(
+      std::count(json.begin(), json.end(), '{'),
+      std::count(json.begin(), json.end(), '}'));
+
+  EXPECT_FALSE(timing::Timing::Print().empty());
+  EXPECT_TRUE(timing::Timing::SaveToFile("timing.csv"));
+  EXPECT_TRUE(timing::Timing::SaveToFile("timing.json"));
+
+  // New handles after a reset start from scratch.
+  timing::Timing::Reset();
+  EXPECT_TRUE(timing::Timing::GetTimers().empty());
+  timing::Timer new_timer("test_timing/exports");
+  new_timer.Stop();
+  EXPECT_EQ(1u, timing::Timing::GetNumSamples("test_timing/exports"));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InitGoogleLogging(argv[0]);
+
+  int result = RUN_ALL_TESTS();
+
+  return result;
+}
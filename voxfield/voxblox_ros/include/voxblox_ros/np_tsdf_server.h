@@ -22,6 +22,7 @@
 #include <voxblox/integrator/np_tsdf_integrator.h>
 #include <voxblox/io/layer_io.h>
 #include <voxblox/io/mesh_ply.h>
+#include <voxblox/mesh/incremental_connected_mesh.h>
 #include <voxblox/mesh/mesh_integrator.h>
 #include <voxblox/utils/color_maps.h>
 #include <voxblox_msgs/FilePath.h>
@@ -29,6 +30,7 @@
 
 #include "voxblox_ros/mesh_vis.h"
 #include "voxblox_ros/ptcloud_vis.h"
+#include "voxblox_ros/timing_publisher.h"
 #include "voxblox_ros/transformer.h"
 
 namespace voxblox {
@@ -301,6 +303,8 @@ class NpTsdfServer {
   // Mesh accessories.
   std::shared_ptr<MeshLayer> mesh_layer_;
   std::unique_ptr<MeshIntegrator<TsdfVoxel>> mesh_integrator_;
+  /// Connected mesh of the mesh layer for the PLY export, updated per block.
+  IncrementalConnectedMesh connected_mesh_;
   /// Optionally cached mesh message.
   voxblox_msgs::Mesh cached_mesh_msg_;
 
@@ -309,6 +313,8 @@ class NpTsdfServer {
    * a transform topic.
    */
   Transformer transformer_;
+  /// Publishes and saves the timers, for monitoring the cost of each stage.
+  TimingPublisher timing_publisher_;
   /**
    * Queue of incoming pointclouds, in case the transforms can't be immediately
    * resolved.
@@ -64,6 +64,18 @@ inline ICP::Config getICPConfigFromRosParam(const ros::NodeHandle& nh_private) {
   nh_private.param(
       "icp_inital_rotation_weighting", icp_config.inital_rotation_weighting,
       icp_config.inital_rotation_weighting);
+  nh_private.param(
+      "icp_max_iterations", icp_config.max_iterations,
+      icp_config.max_iterations);
+  nh_private.param(
+      "icp_min_delta_translation_m", icp_config.min_delta_translation_m,
+      icp_config.min_delta_translation_m);
+  nh_private.param(
+      "icp_min_delta_rotation_rad", icp_config.min_delta_rotation_rad,
+      icp_config.min_delta_rotation_rad);
+  nh_private.param(
+      "icp_min_information_gain", icp_config.min_information_gain,
+      icp_config.min_information_gain);
 
   return icp_config;
 }
@@ -0,0 +1,44 @@
+#ifndef VOXBLOX_ROS_TIMING_PUBLISHER_H_
+#define VOXBLOX_ROS_TIMING_PUBLISHER_H_
+
+#include <string>
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros/ros.h>
+#include <voxblox_msgs/FilePath.h>
+
+namespace voxblox {
+
+/**
+ * Exports the timers of voxblox::timing for monitoring: periodically as a
+ * diagnostic_msgs/DiagnosticArray with one status per timer, on request
+ * through the save_timings service, and to timing_file_path on shutdown.
+ */
+class TimingPublisher {
+ public:
+  explicit TimingPublisher(const ros::NodeHandle& nh_private);
+  ~TimingPublisher();
+
+  /// The merged statistics of all the timers, one status per timer.
+  diagnostic_msgs::DiagnosticArray getTimingsMsg() const;
+
+  void publishTimingsEvent(const ros::TimerEvent& event);
+
+  bool saveTimingsCallback(
+      voxblox_msgs::FilePath::Request& request,     // NOLINT
+      voxblox_msgs::FilePath::Response& response);  // NOLINT
+
+ private:
+  ros::NodeHandle nh_private_;
+
+  ros::Publisher timings_pub_;
+  ros::ServiceServer save_timings_srv_;
+  ros::Timer publish_timings_timer_;
+
+  /// Written on shutdown if not empty, JSON if it ends in .json, else CSV.
+  std::string timing_file_path_;
+};
+
+}  // namespace voxblox
+
+#endif  // VOXBLOX_ROS_TIMING_PUBLISHER_H_
@@ -0,0 +1,99 @@
+#include "voxblox_ros/timing_publisher.h"
+
+#include <string>
+
+#include <diagnostic_msgs/KeyValue.h>
+#include <voxblox/utils/timing.h>
+
+namespace voxblox {
+
+namespace {
+
+diagnostic_msgs::KeyValue makeKeyValue(
+    const std::string& key, const double value) {
+  diagnostic_msgs::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = std::to_string(value);
+  return key_value;
+}
+
+diagnostic_msgs::KeyValue makeKeyValue(
+    const std::string& key, const size_t value) {
+  diagnostic_msgs::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = std::to_string(value);
+  return key_value;
+}
+
+}  // namespace
+
+TimingPublisher::TimingPublisher(const ros::NodeHandle& nh_private)
+    : nh_private_(nh_private) {
+  nh_private_.param("timing_file_path", timing_file_path_, timing_file_path_);
+
+  timings_pub_ =
+      nh_private_.advertise<diagnostic_msgs::DiagnosticArray>("timings", 1);
+  save_timings_srv_ = nh_private_.advertiseService(
+      "save_timings", &TimingPublisher::saveTimingsCallback, this);
+
+  // Publishing the timings is disabled by default.
+  double publish_timings_every_n_sec = 0.0;
+  nh_private_.param(
+      "publish_timings_every_n_sec", publish_timings_every_n_sec,
+      publish_timings_every_n_sec);
+  if (publish_timings_every_n_sec > 0.0) {
+    publish_timings_timer_ = nh_private_.createTimer(
+        ros::Duration(publish_timings_every_n_sec),
+        &TimingPublisher::publishTimingsEvent, this);
+  }
+}
+
+TimingPublisher::~TimingPublisher() {
+  if (!timing_file_path_.empty() &&
+      !timing::Timing::SaveToFile(timing_file_path_)) {
+    ROS_ERROR_STREAM("Could not save the timings to " << timing_file_path_);
+  }
+}
+
+diagnostic_msgs::DiagnosticArray TimingPublisher::getTimingsMsg() const {
+  diagnostic_msgs::DiagnosticArray timings_msg;
+  timings_msg.header.stamp = ros::Time::now();
+  const std::string node_name = ros::this_node::getName();
+  for (const timing::Timing::StatisticsList::value_type& timer :
+       timing::Timing::GetAllStatistics()) {
+    const timing::TimerStatistics& statistics = timer.second;
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = node_name + ": " + timer.first;
+    status.hardware_id = node_name;
+    status.values.push_back(
+        makeKeyValue("num_samples", statistics.TotalSamples()));
+    status.values.push_back(makeKeyValue("total_s", statistics.Sum()));
+    status.values.push_back(makeKeyValue("mean_s", statistics.Mean()));
+    status.values.push_back(
+        makeKeyValue("rolling_mean_s", statistics.RollingMean()));
+    status.values.push_back(makeKeyValue("min_s", statistics.Min()));
+    status.values.push_back(makeKeyValue("max_s", statistics.Max()));
+    for (const double quantile : timing::Timing::ExportPercentiles()) {
+      status.values.push_back(makeKeyValue(
+          "p" + std::to_string(static_cast<int>(quantile * 100.0)) + "_s",
+          statistics.Percentile(quantile)));
+    }
+    timings_msg.status.push_back(status);
+  }
+  return timings_msg;
+}
+
+void TimingPublisher::publishTimingsEvent(const ros::TimerEvent& /*event*/) {
+  if (timings_pub_.getNumSubscribers() > 0) {
+    timings_pub_.publish(getTimingsMsg());
+  }
+}
+
+bool TimingPublisher::saveTimingsCallback(
+    voxblox_msgs::FilePath::Request& request, voxblox_msgs::FilePath::Response&
+    /*response*/) {  // NOLINT
+  return timing::Timing::SaveToFile(request.file_path);
+}
+
+}  // namespace voxblox
@@ -39,7 +39,8 @@ TsdfServer::TsdfServer(
       accumulate_icp_corrections_(true),
       pointcloud_queue_size_(1),
       num_subscribers_tsdf_map_(0),
-      transformer_(nh, nh_private) {
+      transformer_(nh, nh_private),
+      timing_publisher_(nh_private) {
   getServerConfigFromRosParam(nh_private);
 
   // Advertise topics.
@@ -356,6 +357,11 @@ void TsdfServer::processPointCloudMessageAndInsert(
       T_G_C.getPosition(), max_block_distance_from_body_);
   mesh_layer_->clearDistantMesh(
       T_G_C.getPosition(), max_block_distance_from_body_);
+  // The cleared meshes are flagged as updated, drop them from the connected
+  // mesh too.
+  BlockIndexList cleared_meshes;
+  mesh_layer_->getAllUpdatedMeshes(&cleared_meshes);
+  connected_mesh_.updateBlocks(*mesh_layer_, cleared_meshes);
   // block_remove_timer.Stop();
 
   publishRobotMesh(T_G_C_refined);
@@ -578,6 +584,8 @@ void TsdfServer::updateMesh() {
   constexpr bool only_mesh_updated_blocks = true;
   constexpr bool clear_updated_flag = true;
   mesh_integrator_->generateMesh(only_mesh_updated_blocks, clear_updated_flag);
+  connected_mesh_.updateBlocks(
+      *mesh_layer_, mesh_integrator_->getLastMeshedBlocks());
   generate_mesh_timer.Stop();
 
   timing::Timer publish_mesh_timer("mesh/publish");
@@ -612,6 +620,8 @@ bool TsdfServer::generateMesh() {
     mesh_integrator_->generateMesh(
         only_mesh_updated_blocks, clear_updated_flag);
   }
+  connected_mesh_.updateBlocks(
+      *mesh_layer_, mesh_integrator_->getLastMeshedBlocks());
   generate_mesh_timer.Stop();
 
   timing::Timer publish_mesh_timer("mesh/publish");
@@ -624,7 +634,8 @@ bool TsdfServer::generateMesh() {
 
   if (!mesh_filename_.empty()) {
     timing::Timer output_mesh_timer("mesh/output");
-    const bool success = outputMeshLayerAsPly(mesh_filename_, *mesh_layer_);
+    const bool success =
+        outputConnectedMeshAsPly(mesh_filename_, &connected_mesh_);
     output_mesh_timer.Stop();
     if (success) {
       ROS_INFO("Output file as PLY: %s", mesh_filename_.c_str());
@@ -707,6 +718,7 @@ void TsdfServer::publishMapEvent(const ros::TimerEvent& /*event*/) {
 void TsdfServer::clear() {
   tsdf_map_->getTsdfLayerPtr()->removeAllBlocks();
   mesh_layer_->clear();
+  connected_mesh_.clear();
 
   // Publish a message to reset the map to all subscribers.
   if (publish_tsdf_map_) {
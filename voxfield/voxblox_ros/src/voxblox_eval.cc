@@ -28,6 +28,7 @@
 #include <voxblox/io/layer_io.h>
 #include <voxblox/io/mesh_ply.h>
 #include <voxblox/mesh/mesh_integrator.h>
+#include <voxblox/utils/layer_evaluator.h>
 
 #include "voxblox_ros/mesh_vis.h"
 #include "voxblox_ros/ptcloud_vis.h"
@@ -43,6 +44,7 @@ class VoxbloxEvaluator {
   void evaluate();
   void visualize();
   void evaluateEsdf();
+  void evaluateEsdfAgainstGtLayer();
   void visualizeEsdf();
   void generatePointCloudFromOcc();
   bool shouldExit() const {
@@ -74,6 +76,14 @@ class VoxbloxEvaluator {
   float error_limit_m_;
   // evaluate only the voxels with positive ESDF
   bool eval_only_positive_;
+  // Ground truth ESDF layer file to compare the ESDF map against voxel by
+  // voxel, read block by block. Skipped if empty.
+  std::string gt_esdf_file_path_;
+  std::string voxblox_esdf_file_path_;
+  // Where to write the report of the comparison (.csv or .json), if not empty.
+  std::string report_file_path_;
+  // Threads used to compare the layers, 0 for one per core.
+  int eval_threads_;
 
   // Transformation between the ground truth dataset and the voxblox map.
   // The GT is transformed INTO the voxblox coordinate frame.
@@ -115,7 +125,8 @@ VoxbloxEvaluator::VoxbloxEvaluator(
       use_occ_ref_esdf_(true),
       slice_level_(1.0),
       error_limit_m_(0.2),
-      eval_only_positive_(false) {
+      eval_only_positive_(false),
+      eval_threads_(0) {
   // Load parameters.
   nh_private_.param("visualize", visualize_, visualize_);
   nh_private_.param("recolor_by_error", recolor_by_error_, recolor_by_error_);
@@ -126,6 +137,11 @@ VoxbloxEvaluator::VoxbloxEvaluator(
   nh_private_.param("error_limit_m", error_limit_m_, error_limit_m_);
   nh_private_.param(
       "eval_only_positive", eval_only_positive_, eval_only_positive_);
+  nh_private_.param(
+      "gt_esdf_file_path", gt_esdf_file_path_, gt_esdf_file_path_);
+  nh_private_.param(
+      "report_file_path", report_file_path_, report_file_path_);
+  nh_private_.param("eval_threads", eval_threads_, eval_threads_);
 
   // Load transformations.
   XmlRpc::XmlRpcValue T_V_G_xml;
@@ -143,7 +159,7 @@ VoxbloxEvaluator::VoxbloxEvaluator(
   // Just exit if there's any issues here (this is just an evaluation node,
   // after all).
   std::string voxblox_file_path, gt_file_path;
-  std::string voxblox_esdf_file_path, voxblox_occ_file_path;
+  std::string voxblox_occ_file_path;
   CHECK(nh_private_.getParam("voxblox_file_path", voxblox_file_path))
       << "No file path provided for voxblox map! Set the \"voxblox_file_path\" "
          "param.";
@@ -152,7 +168,7 @@ VoxbloxEvaluator::VoxbloxEvaluator(
          "\"gt_file_path\" param.";
   if (eval_esdf_) {
     CHECK(
-        nh_private_.getParam("voxblox_esdf_file_path", voxblox_esdf_file_path))
+        nh_private_.getParam("voxblox_esdf_file_path", voxblox_esdf_file_path_))
         << "No file path provided for voxblox esdf map! Set the "
            "\"voxblox_esdf_file_path\" param.";
     if (use_occ_ref_esdf_) {
@@ -166,7 +182,7 @@ VoxbloxEvaluator::VoxbloxEvaluator(
   CHECK(io::LoadLayer<TsdfVoxel>(voxblox_file_path, &tsdf_layer_))
       << "Could not load voxblox map.";
   if (eval_esdf_) {
-    CHECK(io::LoadLayer<EsdfVoxel>(voxblox_esdf_file_path, &esdf_layer_))
+    CHECK(io::LoadLayer<EsdfVoxel>(voxblox_esdf_file_path_, &esdf_layer_))
         << "Could not load voxblox esdf map.";
     if (use_occ_ref_esdf_) {
       CHECK(io::LoadLayer<OccupancyVoxel>(voxblox_occ_file_path, &occ_layer_))
@@ -297,6 +313,9 @@ void VoxbloxEvaluator::evaluate() {
       generatePointCloudFromOcc();
     }
     evaluateEsdf();
+    if (!gt_esdf_file_path_.empty()) {
+      evaluateEsdfAgainstGtLayer();
+    }
   }
 
   if (visualize_) {
@@ -383,6 +402,29 @@ void VoxbloxEvaluator::evaluateEsdf() {
             << "\nTotal evaluated:     " << total_evaluated_voxels << "\n";
 }
 
+void VoxbloxEvaluator::evaluateEsdfAgainstGtLayer() {
+  // Compared from the files, so that the ground truth does not need to fit in
+  // memory next to the maps.
+  utils::LayerEvaluator<EsdfVoxel>::Config config;
+  config.num_threads = static_cast<size_t>(std::max(0, eval_threads_));
+  utils::LayerEvaluator<EsdfVoxel> evaluator(config);
+  utils::LayerEvaluationReport report(
+      config.band_edges_m, config.percentiles, config.histogram_bin_width_m,
+      1u);
+  if (!evaluator.evaluateLayerFiles(
+          gt_esdf_file_path_, voxblox_esdf_file_path_, &report)) {
+    LOG(ERROR) << "Could not evaluate the ESDF map against "
+               << gt_esdf_file_path_;
+    return;
+  }
+  std::cout << "Finished evaluating ESDF map against the ground truth layer."
+            << report.toString();
+  if (!report_file_path_.empty() && report.saveToFile(report_file_path_)) {
+    std::cout << "Saved the evaluation report to " << report_file_path_
+              << "\n";
+  }
+}
+
 void VoxbloxEvaluator::generatePointCloudFromOcc() {
   // occupancy_integrator_->updateFromTsdfLayer(true, true);
 
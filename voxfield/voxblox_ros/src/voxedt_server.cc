@@ -309,20 +309,28 @@ void VoxedtServer::updateEsdfFromOcc() {
   if (occupancy_map_->getOccupancyLayer().getNumberOfAllocatedBlocks() > 0) {
     GlobalIndexList insert_list = occupancy_integrator_->getInsertList();
     GlobalIndexList delete_list = occupancy_integrator_->getDeleteList();
+    GlobalIndexList changed_list = occupancy_integrator_->getChangedList();
     occupancy_integrator_->clearList();
     esdf_integrator_->loadInsertList(insert_list);
     esdf_integrator_->loadDeleteList(delete_list);
-    if (insert_list.size() + delete_list.size() > 0) {
+    // Newly observed voxels are initialized even if nothing was inserted or
+    // deleted, they are not listed again. Without any changed voxel, only the
+    // updated flags of the occupancy blocks are cleared.
+    const bool clear_updated_flag_esdf = true;
+    if (changed_list.empty()) {
+      esdf_integrator_->updateFromOccVoxels(
+          changed_list, clear_updated_flag_esdf);
+    } else {
       if (verbose_)
         ROS_INFO_STREAM(
             "Insert [" << insert_list.size() << "] and delete ["
                        << delete_list.size() << "] occupied voxels.");
 
-      const bool clear_updated_flag_esdf = true;
       ros::WallTime start = ros::WallTime::now();
 
-      // set update state to 0 after the processing
-      esdf_integrator_->updateFromOccLayer(clear_updated_flag_esdf);
+      // Only the changed voxels, instead of the updated blocks
+      esdf_integrator_->updateFromOccVoxels(
+          changed_list, clear_updated_flag_esdf);
 
       ros::WallTime end = ros::WallTime::now();
 